@@ -0,0 +1,393 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <sys/syscall.h>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "gtp_types.hpp"
+#include "sim_cfg.hpp"
+#include "transport.hpp"
+#include "socket.hpp"
+#include "affinity.hpp"
+
+#define GSIM_CPU_ISOLATED_FILE   "/sys/devices/system/cpu/isolated"
+#define GSIM_INTERRUPTS_FILE     "/proc/interrupts"
+
+static S32        s_schedCpu       = GSIM_CPU_ANY;
+static cpu_set_t  s_workerCpus;
+static U32        s_numWorkerCpus  = 0;
+static U32        s_nextWorkerCpu  = 0;
+
+PUBLIC RETVAL parseCpuList(const std::string &cpuList, cpu_set_t *pSet)
+{
+    std::istringstream in(cpuList);
+    std::string        range;
+
+    CPU_ZERO(pSet);
+    while (std::getline(in, range, ','))
+    {
+        const S8 *pStr = range.c_str();
+        S8       *pEnd = NULL;
+
+        /* the lists in sysfs and procfs end with a new line */
+        while (' ' == *pStr || '\n' == *pStr)
+        {
+            pStr++;
+        }
+
+        if ('\0' == *pStr)
+        {
+            continue;
+        }
+
+        errno = 0;
+        U64 first = strtoul(pStr, &pEnd, 10);
+        U64 last  = first;
+        if (pEnd == pStr || 0 != errno)
+        {
+            return RFAILED;
+        }
+
+        if ('-' == *pEnd)
+        {
+            pStr = pEnd + 1;
+            last = strtoul(pStr, &pEnd, 10);
+            if (pEnd == pStr || last < first)
+            {
+                return RFAILED;
+            }
+        }
+
+        if (('\0' != *pEnd && '\n' != *pEnd) || last >= CPU_SETSIZE)
+        {
+            return RFAILED;
+        }
+
+        for (U64 cpu = first; cpu <= last; cpu++)
+        {
+            CPU_SET(cpu, pSet);
+        }
+    }
+
+    return (CPU_COUNT(pSet) > 0) ? ROK : RFAILED;
+}
+
+PRIVATE std::string cpuListStr(cpu_set_t *pSet)
+{
+    std::ostringstream out;
+
+    for (S32 cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (!CPU_ISSET(cpu, pSet))
+        {
+            continue;
+        }
+
+        S32 last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, pSet))
+        {
+            last++;
+        }
+
+        if (out.tellp() > 0)
+        {
+            out << ",";
+        }
+
+        out << cpu;
+        if (last > cpu)
+        {
+            out << "-" << last;
+        }
+
+        cpu = last;
+    }
+
+    return out.str();
+}
+
+PRIVATE BOOL isIsolatedCpu(S32 cpu)
+{
+    std::ifstream in(GSIM_CPU_ISOLATED_FILE);
+    std::string   list;
+    cpu_set_t     set;
+
+    if (!std::getline(in, list) || ROK != parseCpuList(list, &set))
+    {
+        return FALSE;
+    }
+
+    return CPU_ISSET(cpu, &set) ? TRUE : FALSE;
+}
+
+PUBLIC RETVAL initAffinity()
+{
+    LOG_ENTERFN();
+
+    Config      *pCfg = Config::getInstance();
+    cpu_set_t   set;
+
+    std::string workerCpus = pCfg->getWorkerCpus();
+    if (!workerCpus.empty())
+    {
+        if (ROK != parseCpuList(workerCpus, &s_workerCpus))
+        {
+            throw GsimError("Invalid worker CPU list " + workerCpus);
+        }
+
+        s_numWorkerCpus = CPU_COUNT(&s_workerCpus);
+        LOG_INFO("Worker threads pinned to CPUs %s",
+            cpuListStr(&s_workerCpus).c_str());
+    }
+
+    s_schedCpu = pCfg->getSchedCpu();
+    if (GSIM_CPU_ANY == s_schedCpu)
+    {
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        LOG_INFO("Scheduler not pinned, runs on CPUs %s",
+            cpuListStr(&set).c_str());
+        LOG_EXITFN(ROK);
+    }
+
+    CPU_ZERO(&set);
+    CPU_SET(s_schedCpu, &set);
+    if (0 != sched_setaffinity(0, sizeof(set), &set))
+    {
+        throw GsimError("Unable to pin the scheduler to CPU " +
+            std::to_string(s_schedCpu) + ", " + strerror(errno));
+    }
+
+    /* the kernel has moved the thread to the CPU when the call returns */
+    U32 cpu  = 0;
+    U32 node = 0;
+    syscall(SYS_getcpu, &cpu, &node, NULL);
+
+    BOOL isolated = isIsolatedCpu(s_schedCpu);
+    LOG_INFO("Scheduler, display and logging pinned to CPU %d, node %u%s",
+        s_schedCpu, node, isolated ? ", isolated" : "");
+    fprintf(stdout, "Scheduler pinned to CPU %d, NUMA node %u%s\n",
+        s_schedCpu, node, isolated ? ", isolated" : "");
+    if (!isolated)
+    {
+        LOG_WARN("CPU %d is not isolated, other tasks may be scheduled on it",
+            s_schedCpu);
+    }
+
+    LOG_EXITFN(ROK);
+}
+
+PUBLIC RETVAL nextWorkerCpuSet(cpu_set_t *pSet)
+{
+    if (0 == s_numWorkerCpus)
+    {
+        return RFAILED;
+    }
+
+    U32 nth = s_nextWorkerCpu++ % s_numWorkerCpus;
+    for (S32 cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, &s_workerCpus) && 0 == nth--)
+        {
+            CPU_ZERO(pSet);
+            CPU_SET(cpu, pSet);
+            break;
+        }
+    }
+
+    return ROK;
+}
+
+/**
+ * @brief
+ *    Name of the interface the local address is configured on
+ */
+PRIVATE std::string localIfName()
+{
+    struct ifaddrs          *pIfList = NULL;
+    struct sockaddr_storage local;
+    IPEndPoint              ep;
+    std::string             name;
+
+    ep.ipAddr = *(Config::getInstance()->getLocalIpAddr());
+    ep.port   = 0;
+    encSockAddr(&ep, &local);
+
+    if (0 != getifaddrs(&pIfList))
+    {
+        return name;
+    }
+
+    for (struct ifaddrs *pIf = pIfList; NULL != pIf; pIf = pIf->ifa_next)
+    {
+        if (NULL == pIf->ifa_addr ||
+            pIf->ifa_addr->sa_family != local.ss_family)
+        {
+            continue;
+        }
+
+        BOOL match = FALSE;
+        if (AF_INET == local.ss_family)
+        {
+            match = (0 == memcmp(
+                &((struct sockaddr_in *)pIf->ifa_addr)->sin_addr,
+                &((struct sockaddr_in *)&local)->sin_addr,
+                sizeof(struct in_addr)));
+        }
+        else
+        {
+            match = (0 == memcmp(
+                &((struct sockaddr_in6 *)pIf->ifa_addr)->sin6_addr,
+                &((struct sockaddr_in6 *)&local)->sin6_addr,
+                sizeof(struct in6_addr)));
+        }
+
+        if (match)
+        {
+            name = pIf->ifa_name;
+            break;
+        }
+    }
+
+    freeifaddrs(pIfList);
+    return name;
+}
+
+/**
+ * @brief
+ *    CPUs the interrupt is delivered to, the configured affinity on kernels
+ *    not reporting the effective one
+ */
+PRIVATE std::string readIrqAffinity(const std::string &irq)
+{
+    std::string list;
+    std::ifstream effective("/proc/irq/" + irq + "/effective_affinity_list");
+
+    if (!std::getline(effective, list) || list.empty())
+    {
+        std::ifstream configured("/proc/irq/" + irq + "/smp_affinity_list");
+        std::getline(configured, list);
+    }
+
+    return list;
+}
+
+/**
+ * @brief
+ *    Interrupts of the interface are the lines of /proc/interrupts whose
+ *    action is named after it, e.g. eth0 or eth0-TxRx-3. Drivers naming
+ *    the queue interrupts after the PCI device are not detected here, the
+ *    CPU receiving the packets is checked again once traffic arrives
+ */
+PUBLIC VOID checkIrqAffinity()
+{
+    LOG_ENTERFN();
+
+    if (GSIM_CPU_ANY == s_schedCpu)
+    {
+        LOG_EXITVOID();
+    }
+
+    std::string ifName = localIfName();
+    if (ifName.empty() || "lo" == ifName)
+    {
+        LOG_EXITVOID();
+    }
+
+    std::ifstream in(GSIM_INTERRUPTS_FILE);
+    std::string   line;
+    std::string   irqs;
+    cpu_set_t     irqCpus;
+    BOOL          served = FALSE;
+
+    CPU_ZERO(&irqCpus);
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string        irq;
+        std::string        action;
+        std::string        field;
+
+        fields >> irq;
+        while (fields >> field)
+        {
+            action = field;
+        }
+
+        if (0 != action.compare(0, ifName.size(), ifName) ||
+            (action.size() > ifName.size() && '-' != action[ifName.size()]))
+        {
+            continue;
+        }
+
+        irq.erase(irq.find_last_not_of(':') + 1);
+        std::string list = readIrqAffinity(irq);
+        cpu_set_t   set;
+        if (ROK != parseCpuList(list, &set))
+        {
+            continue;
+        }
+
+        irqs += (irqs.empty() ? "" : ",") + irq;
+        CPU_OR(&irqCpus, &irqCpus, &set);
+        if (CPU_ISSET(s_schedCpu, &set))
+        {
+            served = TRUE;
+        }
+    }
+
+    if (irqs.empty())
+    {
+        LOG_DEBUG("No interrupts found for interface %s", ifName.c_str());
+    }
+    else if (!served)
+    {
+        LOG_WARN("RX interrupts of %s (IRQ %s) are served by CPUs %s, the "
+            "scheduler is pinned to CPU %d", ifName.c_str(), irqs.c_str(),
+            cpuListStr(&irqCpus).c_str(), s_schedCpu);
+        fprintf(stdout, "Warning: RX interrupts of %s are served by CPUs %s, "
+            "the scheduler is pinned to CPU %d\n", ifName.c_str(),
+            cpuListStr(&irqCpus).c_str(), s_schedCpu);
+    }
+
+    LOG_EXITVOID();
+}
+
+PUBLIC VOID checkRxCpu(S32 cpu)
+{
+    if (GSIM_CPU_ANY == s_schedCpu || cpu < 0 || cpu == s_schedCpu)
+    {
+        return;
+    }
+
+    LOG_WARN("GTP-C packets are processed by the kernel on CPU %d, the "
+        "scheduler is pinned to CPU %d, steer the RX queue interrupt or RPS "
+        "of the interface to it", cpu, s_schedCpu);
+}
@@ -0,0 +1,62 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _AFFINITY_HPP_
+#define _AFFINITY_HPP_
+
+#include <sched.h>
+
+#define GSIM_CPU_ANY             -1
+
+/**
+ * @brief
+ *    Parses a CPU list such as "0-3,6" into the set
+ */
+EXTERN RETVAL parseCpuList(const std::string &cpuList, cpu_set_t *pSet);
+
+/**
+ * @brief
+ *    Pins the calling thread, which runs the scheduler and with it the
+ *    display and logging, to the configured CPU and reports its placement
+ */
+EXTERN RETVAL initAffinity();
+
+/**
+ * @brief
+ *    CPU set of the next worker thread, the configured worker CPUs are
+ *    handed out in turns
+ *
+ * @return RFAILED when worker threads are not pinned
+ */
+EXTERN RETVAL nextWorkerCpuSet(cpu_set_t *pSet);
+
+/**
+ * @brief
+ *    Warns when the receive queue interrupts of the interface of the local
+ *    address are not served by the CPU of the scheduler
+ */
+EXTERN VOID checkIrqAffinity();
+
+/**
+ * @brief
+ *    Warns once when received packets were processed by the kernel on a CPU
+ *    other than the one of the scheduler
+ *
+ * @param cpu CPU which processed the last received packet
+ */
+EXTERN VOID checkRxCpu(S32 cpu);
+
+#endif
@@ -0,0 +1,454 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <time.h>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "task.hpp"
+#include "transport.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "sim_cfg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "gtp_peer.hpp"
+#include "scenario.hpp"
+#include "tunnel.hpp"
+#include "session.hpp"
+#include "ssn_table.hpp"
+#include "traffic.hpp"
+#include "checkpoint.hpp"
+
+#define CKPT_BUF_LEN             (256 * 1024)
+
+static Scenario     *s_pCkptScn  = NULL;
+static string       s_ckptFile;
+static string       s_ckptTmpFile;
+static pid_t        s_ckptPid    = -1;
+static Time_t       s_ckptStart  = 0;
+static CkptStats_t  s_ckptStats;
+
+/* the checkpoint child writes through this buffer, it does not allocate
+ * memory as another thread may hold the allocator lock at the fork
+ */
+static U8           s_ckptBuf[CKPT_BUF_LEN];
+static U32          s_ckptBufLen = 0;
+
+/**
+ * @brief
+ *    FNV-1a hash of the procedures, a checkpoint is restored only with the
+ *    scenario it was taken with
+ */
+PRIVATE U32 scnSignature(Scenario *pScn)
+{
+    U32 hash = 2166136261u;
+
+    for (U32 i = 0; i < pScn->m_procSeq.size(); i++)
+    {
+        Procedure *pProc = pScn->m_procSeq[i];
+        Job       *pJob  = pProc->m_initial;
+        U32       val[3];
+
+        val[0] = pProc->type();
+        val[1] = (NULL == pJob) ? 0 : pJob->type();
+        val[2] = (NULL == pJob) ? 0 : pJob->getGtpMsg()->type();
+        for (U32 j = 0; j < 3; j++)
+        {
+            hash = (hash ^ val[j]) * 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+PRIVATE RETVAL ckptFlush(S32 fd)
+{
+    U32 off = 0;
+
+    while (off < s_ckptBufLen)
+    {
+        ssize_t len = write(fd, s_ckptBuf + off, s_ckptBufLen - off);
+        if (len < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            return RFAILED;
+        }
+
+        off += len;
+    }
+
+    s_ckptBufLen = 0;
+    return ROK;
+}
+
+PRIVATE RETVAL ckptWrite(S32 fd, const VOID *pData, U32 len)
+{
+    if (s_ckptBufLen + len > CKPT_BUF_LEN && ROK != ckptFlush(fd))
+    {
+        return RFAILED;
+    }
+
+    MEMCPY(s_ckptBuf + s_ckptBufLen, pData, len);
+    s_ckptBufLen += len;
+
+    return ROK;
+}
+
+/**
+ * @brief
+ *    Writes the checkpoint in the forked child. The header is written
+ *    again at the end with the number of sessions saved
+ */
+PRIVATE RETVAL writeCheckpoint(const S8 *pFile)
+{
+    S32 fd = open(pFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return RFAILED;
+    }
+
+    CkptHdr_t hdr;
+    MEMSET(&hdr, 0, sizeof(hdr));
+    hdr.magic        = CKPT_MAGIC;
+    hdr.version      = CKPT_VERSION;
+    hdr.peerLen      = sizeof(CkptPeer_t);
+    hdr.sessionLen   = sizeof(CkptSession_t);
+    hdr.scnSignature = scnSignature(s_pCkptScn);
+    hdr.numProcs     = s_pCkptScn->m_procSeq.size();
+    hdr.numPeers     = getNumPeers();
+    hdr.createTime   = time(NULL);
+    getTeidCounters(&hdr.cTeid, &hdr.uTeid);
+
+    TrafficTask *pTTask = getTrafficTask();
+    if (NULL != pTTask)
+    {
+        pTTask->lastImsi(hdr.imsi, GTP_IMSI_MAX_DIGITS);
+    }
+
+    RETVAL ret = ckptWrite(fd, &hdr, sizeof(hdr));
+    for (U32 i = 0; ROK == ret && i < hdr.numPeers; i++)
+    {
+        CkptPeer_t peer;
+        MEMSET(&peer, 0, sizeof(peer));
+        peer.peerEp    = getPeer(i)->peerEp;
+        peer.seqNumber = getPeer(i)->seqNumber;
+        ret = ckptWrite(fd, &peer, sizeof(peer));
+    }
+
+    /* sessions without a remote TEID are not established, they are
+     * skipped from the session table without touching the session
+     */
+    U32          now    = (U32)getMilliSeconds();
+    SessionTable *pTable = s_pCkptScn->m_pSsnTable;
+    for (U32 slot = 0; ROK == ret && slot < pTable->numSlots(); slot++)
+    {
+        CkptSession_t rec;
+        if (!pTable->isUsed(slot) || 0 == pTable->remTeid(slot))
+        {
+            continue;
+        }
+
+        if (pTable->session(slot)->save(&rec, now))
+        {
+            ret = ckptWrite(fd, &rec, sizeof(rec));
+            hdr.numSessions++;
+        }
+    }
+
+    if (ROK == ret)
+    {
+        ret = ckptFlush(fd);
+    }
+
+    if (ROK == ret &&
+        (sizeof(hdr) != pwrite(fd, &hdr, sizeof(hdr), 0) || 0 != fsync(fd)))
+    {
+        ret = RFAILED;
+    }
+
+    close(fd);
+    return ret;
+}
+
+PUBLIC VOID initCheckpoint(Scenario *pScn)
+{
+    Config *pCfg = Config::getInstance();
+
+    if (pCfg->getCheckpointFile().empty())
+    {
+        return;
+    }
+
+    s_pCkptScn    = pScn;
+    s_ckptFile    = pCfg->getCheckpointFile();
+    s_ckptTmpFile = s_ckptFile + ".tmp";
+
+    new CheckpointTask(pScn);
+}
+
+PUBLIC BOOL isCheckpointEnabled()
+{
+    return (NULL != s_pCkptScn);
+}
+
+PUBLIC CkptStats_t *getCkptStats()
+{
+    return &s_ckptStats;
+}
+
+/**
+ * @brief
+ *    Forks the checkpoint child, the child sees the sessions as they were
+ *    at the fork while the parent continues the traffic. The file replaces
+ *    the previous checkpoint only once it is complete
+ */
+PUBLIC VOID takeCheckpoint()
+{
+    LOG_ENTERFN();
+
+    if (!isCheckpointEnabled())
+    {
+        LOG_INFO("Checkpoint file not given");
+        LOG_EXITVOID();
+    }
+
+    if (s_ckptStats.inProgress)
+    {
+        LOG_INFO("Checkpoint in progress, skipped");
+        LOG_EXITVOID();
+    }
+
+    pid_t pid = fork();
+    if (0 == pid)
+    {
+        S32 status = 1;
+        if (ROK == writeCheckpoint(s_ckptTmpFile.c_str()) &&
+            0 == rename(s_ckptTmpFile.c_str(), s_ckptFile.c_str()))
+        {
+            status = 0;
+        }
+
+        _exit(status);
+    }
+    else if (pid < 0)
+    {
+        LOG_ERROR("Checkpoint fork failed, errno [%d]", errno);
+        s_ckptStats.numFailed++;
+        LOG_EXITVOID();
+    }
+
+    LOG_INFO("Checkpoint of %lu sessions started, pid [%d]",
+        s_pCkptScn->m_ueSessionMap.size(), pid);
+
+    s_ckptPid              = pid;
+    s_ckptStart            = getMilliSeconds();
+    s_ckptStats.inProgress = TRUE;
+
+    LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Collects the exit status of the checkpoint child, the number of
+ *    sessions is read back from the header of the new file
+ */
+PRIVATE VOID reapCheckpoint()
+{
+    S32   status = 0;
+    pid_t pid    = waitpid(s_ckptPid, &status, WNOHANG);
+    if (0 == pid)
+    {
+        return;
+    }
+
+    Time_t now = getMilliSeconds();
+    s_ckptStats.inProgress = FALSE;
+    s_ckptPid              = -1;
+
+    if (pid < 0 || !WIFEXITED(status) || 0 != WEXITSTATUS(status))
+    {
+        LOG_ERROR("Checkpoint to %s failed, status [%d]", s_ckptFile.c_str(),
+            status);
+        s_ckptStats.numFailed++;
+        return;
+    }
+
+    CkptHdr_t hdr;
+    MEMSET(&hdr, 0, sizeof(hdr));
+    S32 fd = open(s_ckptFile.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        if (sizeof(hdr) != pread(fd, &hdr, sizeof(hdr), 0))
+        {
+            hdr.numSessions = 0;
+        }
+
+        close(fd);
+    }
+
+    s_ckptStats.numTaken++;
+    s_ckptStats.numSessions  = hdr.numSessions;
+    s_ckptStats.lastTime     = now;
+    s_ckptStats.lastDuration = now - s_ckptStart;
+
+    LOG_INFO("Checkpoint of %u sessions to %s completed in %lums",
+        hdr.numSessions, s_ckptFile.c_str(), s_ckptStats.lastDuration);
+}
+
+CheckpointTask::CheckpointTask(Scenario *pScn)
+{
+    U32 intvl = Config::getInstance()->getCheckpointIntvl();
+
+    m_pScn         = pScn;
+    m_wakeTime     = 0;
+    m_nextCkptTime = (0 == intvl) ? 0 : getMilliSeconds() + intvl * 1000;
+}
+
+RETVAL CheckpointTask::run(VOID *arg)
+{
+    LOG_ENTERFN();
+
+    Time_t now = getMilliSeconds();
+
+    if (s_ckptStats.inProgress)
+    {
+        reapCheckpoint();
+    }
+
+    if (0 != m_nextCkptTime && now >= m_nextCkptTime)
+    {
+        takeCheckpoint();
+        m_nextCkptTime = now +
+            Config::getInstance()->getCheckpointIntvl() * 1000;
+    }
+
+    m_wakeTime = now + CKPT_TICK_INTVL;
+    pause();
+
+    LOG_EXITFN(ROK);
+}
+
+PUBLIC VOID restoreCheckpoint(Scenario *pScn)
+{
+    LOG_ENTERFN();
+
+    string file = Config::getInstance()->getRestoreFile();
+    if (file.empty())
+    {
+        LOG_EXITVOID();
+    }
+
+    S32 fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw GsimError("Unable to open checkpoint " + file);
+    }
+
+    struct stat st;
+    VOID *pMap = MAP_FAILED;
+    if (0 == fstat(fd, &st) && (U64)st.st_size >= sizeof(CkptHdr_t))
+    {
+        pMap = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE,
+            fd, 0);
+    }
+
+    close(fd);
+    if (MAP_FAILED == pMap)
+    {
+        throw GsimError("Unable to map checkpoint " + file);
+    }
+
+    const CkptHdr_t *pHdr = (const CkptHdr_t *)pMap;
+    U64 size = sizeof(CkptHdr_t) + (U64)pHdr->numPeers * sizeof(CkptPeer_t) +
+        (U64)pHdr->numSessions * sizeof(CkptSession_t);
+
+    if (CKPT_MAGIC != pHdr->magic || CKPT_VERSION != pHdr->version ||
+        sizeof(CkptPeer_t) != pHdr->peerLen ||
+        sizeof(CkptSession_t) != pHdr->sessionLen ||
+        size > (U64)st.st_size)
+    {
+        munmap(pMap, st.st_size);
+        throw GsimError("Invalid checkpoint " + file);
+    }
+
+    if (scnSignature(pScn) != pHdr->scnSignature ||
+        pScn->m_procSeq.size() != pHdr->numProcs)
+    {
+        munmap(pMap, st.st_size);
+        throw GsimError("Checkpoint " + file + " is of another scenario");
+    }
+
+    const CkptPeer_t *pPeer = (const CkptPeer_t *)(pHdr + 1);
+    for (U32 i = 0; i < pHdr->numPeers; i++)
+    {
+        PeerData *pPeerData = addPeerData(pPeer[i].peerEp);
+        if (pPeer[i].seqNumber > pPeerData->seqNumber)
+        {
+            pPeerData->seqNumber = pPeer[i].seqNumber;
+        }
+    }
+
+    /* TEIDs of new sessions follow the restored ones */
+    setTeidCounters(pHdr->cTeid, pHdr->uTeid);
+
+    const CkptSession_t *pRec =
+        (const CkptSession_t *)(pPeer + pHdr->numPeers);
+    for (U32 i = 0; i < pHdr->numSessions; i++)
+    {
+        if (NULL != UeSession::restore(pScn, &pRec[i]))
+        {
+            s_ckptStats.numRestored++;
+        }
+    }
+
+    /* IMSIs of new sessions follow the restored ones */
+    if (SCN_TYPE_INITIATING == pScn->getScnType() && 0 != pHdr->imsi[0])
+    {
+        S8 imsi[GTP_IMSI_MAX_DIGITS + 1];
+        MEMCPY(imsi, pHdr->imsi, sizeof(imsi));
+        imsi[GTP_IMSI_MAX_DIGITS] = 0;
+        Config::getInstance()->setImsi(imsi, STRLEN(imsi));
+    }
+
+    LOG_INFO("Restored %u of %u sessions from %s, taken at %lu",
+        s_ckptStats.numRestored, pHdr->numSessions, file.c_str(),
+        pHdr->createTime);
+
+    munmap(pMap, st.st_size);
+
+    LOG_EXITVOID();
+}
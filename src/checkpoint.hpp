@@ -0,0 +1,117 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+class Scenario;
+
+#define CKPT_MAGIC               0x4b435347  /* "GSCK" */
+#define CKPT_VERSION             2
+#define CKPT_TICK_INTVL          100   /* ms, checkpoint child reaped */
+
+/* the checkpoint file is a header, the peer records and then fixed size
+ * session records, all in host byte order. It is written by a forked child
+ * from its copy-on-write view of the sessions, so the traffic is not paused
+ */
+typedef struct
+{
+   U32            magic;
+   U32            version;
+   U32            peerLen;       /* sizeof(CkptPeer_t) */
+   U32            sessionLen;    /* sizeof(CkptSession_t) */
+   U32            scnSignature;  /* procedures of the scenario */
+   U32            numProcs;
+   U32            numPeers;
+   U32            numSessions;
+   U32            cTeid;         /* last allocated TEIDs */
+   U32            uTeid;
+   U64            createTime;    /* seconds since the epoch */
+   S8             imsi[GTP_IMSI_MAX_DIGITS + 1]; /* last allocated IMSI */
+} CkptHdr_t;
+
+typedef struct
+{
+   IPEndPoint     peerEp;
+   GtpSeqNumber_t seqNumber;
+} CkptPeer_t;
+
+typedef struct _CkptSession_t_
+{
+   GtpImsiKey     imsiKey;
+   U32            procIndx;      /* procedure the session continues with */
+   U32            wakeIn;        /* ms left in a wait procedure */
+   IPEndPoint     peerEp;
+   IPEndPoint     cTunPeerEp;
+   GtpTeid_t      cTeidLoc;
+   GtpTeid_t      cTeidRem;
+   U32            bearerMask;
+   U8             ebi[GTP_MAX_BEARERS];  /* 0 when not in use */
+   U8             dfltBearer[GTP_MAX_BEARERS];
+   GtpTeid_t      uTeid[GTP_MAX_BEARERS]; /* 0 when not allocated */
+   GtpSsnVar_t    vars[GTP_MAX_SSN_VARS];
+} CkptSession_t;
+
+typedef struct
+{
+   Counter        numTaken;
+   Counter        numFailed;
+   Counter        numSessions;   /* sessions of the last checkpoint */
+   Counter        numRestored;
+   Time_t         lastTime;      /* completion of the last checkpoint */
+   Time_t         lastDuration;
+   BOOL           inProgress;
+} CkptStats_t;
+
+/**
+ * @brief
+ *    Checkpoints the established sessions of the scenario to --checkpoint
+ *    every --checkpoint-intvl seconds. The sessions are written by a forked
+ *    child, a checkpoint is skipped while the previous one is in progress
+ */
+class CheckpointTask: public Task
+{
+   public:
+      CheckpointTask(Scenario *pScn);
+      ~CheckpointTask() {}
+      RETVAL run(VOID *arg = NULL);
+      inline Time_t wake() { return m_wakeTime; }
+
+   private:
+      Scenario          *m_pScn;
+      Time_t            m_nextCkptTime;
+      Time_t            m_wakeTime;
+};
+
+EXTERN VOID          initCheckpoint(Scenario *pScn);
+
+/**
+ * @brief
+ *    On demand checkpoint of the [k] key
+ */
+EXTERN VOID          takeCheckpoint();
+
+/**
+ * @brief
+ *    Restores the sessions of --restore, called before the traffic starts.
+ *    The session IMSIs and TEIDs are kept, new sessions continue after the
+ *    checkpointed IMSI and TEID counters
+ */
+EXTERN VOID          restoreCheckpoint(Scenario *pScn);
+EXTERN BOOL          isCheckpointEnabled();
+EXTERN CkptStats_t   *getCkptStats();
+
+#endif
@@ -0,0 +1,1145 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <list>
+
+using std::vector;
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "sim_cfg.hpp"
+#include "task.hpp"
+#include "keyboard.hpp"
+#include "display.hpp"
+#include "scenario.hpp"
+#include "tunnel.hpp"
+#include "latency.hpp"
+#include "poller.hpp"
+#include "drain.hpp"
+#include "cluster.hpp"
+
+#define CLUSTER_JOB_COUNTERS     7
+#define CLUSTER_RX_LEN           4096
+
+typedef enum
+{
+    CLUSTER_MSG_HELLO = 1,  /* agent, pid */
+    CLUSTER_MSG_ASSIGN,     /* coordinator, ClusterAssign_t */
+    CLUSTER_MSG_READY,      /* agent, transport is up */
+    CLUSTER_MSG_START,      /* coordinator, all agents are ready */
+    CLUSTER_MSG_STATS,      /* agent, ClusterStats_t and job counters */
+    CLUSTER_MSG_KEY,        /* coordinator, key pressed by the user */
+    CLUSTER_MSG_STOP,       /* coordinator */
+    CLUSTER_MSG_BYE         /* agent, after the final statistics */
+} ClusterMsgType_t;
+
+typedef struct
+{
+    U32         type;
+    U32         len;
+} ClusterMsgHdr_t;
+
+typedef struct
+{
+    U32         index;
+    U32         numAgents;
+    U32         rate;
+    U32         numSessions;  /* 0, no limit */
+    U32         teidBase;
+    U32         localPort;
+    S8          imsi[GTP_IMSI_MAX_DIGITS + 1];
+} ClusterAssign_t;
+
+/**
+ * @brief
+ *    Statistics snapshot of an agent, followed by CLUSTER_JOB_COUNTERS
+ *    counters of each job of the scenario in the order of the procedures
+ */
+typedef struct
+{
+    U32             numJobs;
+    Counter         stats[GSIM_STAT_MAX];
+    LatencyData_t   rspTime;
+    LatencyData_t   queueDelay;
+    LatencyData_t   rejectTime;
+    Counter         causes[GTP_CAUSE_MAX];
+} ClusterStats_t;
+
+typedef vector<U8> ByteVec;
+
+class ClusterAgent_t
+{
+  public:
+    ~ClusterAgent_t();
+
+    S32             fd;
+    pid_t           pid;      /* reported by the agent */
+    BOOL            running;
+    ClusterAssign_t assign;
+    ByteVec         rxBuf;
+    ByteVec         stats;    /* latest snapshot */
+};
+
+/* out of line, the two buffers make the implicit one too big to inline */
+ClusterAgent_t::~ClusterAgent_t()
+{
+}
+
+static vector<ClusterAgent_t>  s_agents;
+static U32                     s_numRunning   = 0;
+static S32                     s_coordFd      = -1;
+static ByteVec                 s_coordRxBuf;
+static Time_t                  s_nextPoll     = 0;
+static Time_t                  s_nextStats    = 0;
+
+PUBLIC BOOL isClusterCoordinator()
+{
+    return Config::getInstance()->getClusterAgents() > 0;
+}
+
+PUBLIC BOOL isClusterAgent()
+{
+    return !Config::getInstance()->getClusterCoordinator().empty();
+}
+
+PUBLIC U32 getNumClusterAgents()
+{
+    return s_agents.size();
+}
+
+PUBLIC U32 getNumRunningAgents()
+{
+    return s_numRunning;
+}
+
+/**
+ * @brief
+ *    Resolves a unix socket path, any address with a '/', or host:port
+ */
+PRIVATE RETVAL clusterAddr(const string &addr, struct sockaddr_storage *pSa,
+    socklen_t *pLen)
+{
+    MEMSET(pSa, 0, sizeof(*pSa));
+
+    if (string::npos != addr.find('/'))
+    {
+        struct sockaddr_un *pUn = (struct sockaddr_un *)pSa;
+        if (addr.size() >= sizeof(pUn->sun_path))
+        {
+            return RFAILED;
+        }
+
+        pUn->sun_family = AF_UNIX;
+        STRCPY(pUn->sun_path, addr.c_str());
+        *pLen = sizeof(struct sockaddr_un);
+        return ROK;
+    }
+
+    size_t colon = addr.rfind(':');
+    if (string::npos == colon)
+    {
+        return RFAILED;
+    }
+
+    struct addrinfo hints;
+    struct addrinfo *pRes = NULL;
+    MEMSET(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    string host       = addr.substr(0, colon);
+    if (host.size() > 1 && '[' == host[0])
+    {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    if (0 != getaddrinfo(host.empty() ? NULL : host.c_str(),
+                 addr.substr(colon + 1).c_str(), &hints, &pRes))
+    {
+        return RFAILED;
+    }
+
+    MEMCPY(pSa, pRes->ai_addr, pRes->ai_addrlen);
+    *pLen = pRes->ai_addrlen;
+    freeaddrinfo(pRes);
+
+    return ROK;
+}
+
+PRIVATE RETVAL sendClusterMsg(S32 fd, U32 type, const VOID *pData, U32 len)
+{
+    ClusterMsgHdr_t hdr;
+    hdr.type = type;
+    hdr.len  = len;
+
+    ByteVec msg(sizeof(hdr) + len);
+    MEMCPY(&msg[0], &hdr, sizeof(hdr));
+    if (len > 0)
+    {
+        MEMCPY(&msg[sizeof(hdr)], pData, len);
+    }
+
+    size_t off = 0;
+    while (off < msg.size())
+    {
+        ssize_t n = send(fd, &msg[off], msg.size() - off, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            LOG_ERROR("Sending cluster message, [%s]", strerror(errno));
+            return RFAILED;
+        }
+
+        off += n;
+    }
+
+    return ROK;
+}
+
+/**
+ * @brief
+ *    Waits at most wait milliseconds for a complete message, the bytes of
+ *    an incomplete one are kept in rxBuf
+ *
+ * @return 1 a message was received, 0 none yet, -1 the peer has gone
+ */
+PRIVATE S32 recvClusterMsg(S32 fd, ByteVec &rxBuf, U32 *pType,
+    ByteVec *pPayload, S32 wait)
+{
+    Time_t deadline = getMilliSeconds() + wait;
+
+    for (;;)
+    {
+        ClusterMsgHdr_t hdr;
+        if (rxBuf.size() >= sizeof(hdr))
+        {
+            MEMCPY(&hdr, &rxBuf[0], sizeof(hdr));
+            if (rxBuf.size() >= sizeof(hdr) + hdr.len)
+            {
+                *pType = hdr.type;
+                pPayload->assign(rxBuf.begin() + sizeof(hdr),
+                    rxBuf.begin() + sizeof(hdr) + hdr.len);
+                rxBuf.erase(rxBuf.begin(),
+                    rxBuf.begin() + sizeof(hdr) + hdr.len);
+                return 1;
+            }
+        }
+
+        Time_t now  = getMilliSeconds();
+        S32    left = (now < deadline) ? (S32)(deadline - now) : 0;
+
+        struct pollfd pollFd;
+        pollFd.fd      = fd;
+        pollFd.events  = POLLIN;
+        pollFd.revents = 0;
+        S32 rs         = poll(&pollFd, 1, left);
+        if (rs < 0 && EINTR != errno)
+        {
+            return -1;
+        }
+        else if (rs <= 0)
+        {
+            if (0 == left)
+            {
+                return 0;
+            }
+
+            continue;
+        }
+
+        U8      buf[CLUSTER_RX_LEN];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (0 == n || (n < 0 && EINTR != errno && EAGAIN != errno))
+        {
+            return -1;
+        }
+        else if (n > 0)
+        {
+            rxBuf.insert(rxBuf.end(), buf, buf + n);
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Jobs of the scenario in the order of its procedures, the coordinator
+ *    and the agents run the same scenario so the orders match
+ */
+PRIVATE VOID getScnJobs(vector<Job *> &jobs)
+{
+    ProcSequence *pSeq = &(Scenario::getInstance()->m_procSeq);
+
+    jobs.clear();
+    for (U32 i = 0; i < pSeq->size(); i++)
+    {
+        Procedure *pProc  = pSeq->at(i);
+        Job       *pJob[] = {pProc->m_initial, pProc->m_trigMsg,
+            pProc->m_trigReply, pProc->m_wait};
+
+        for (U32 j = 0; j < sizeof(pJob) / sizeof(pJob[0]); j++)
+        {
+            if (NULL != pJob[j])
+            {
+                jobs.push_back(pJob[j]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Adds a decimal offset to the IMSI digits, the number of digits is kept
+ */
+PRIVATE string imsiAdd(string imsi, U64 offset)
+{
+    for (S32 i = (S32)imsi.size() - 1; i >= 0 && offset > 0; i--)
+    {
+        U64 digit = (imsi[i] - '0') + offset;
+        imsi[i]   = '0' + (digit % 10);
+        offset    = digit / 10;
+    }
+
+    return imsi;
+}
+
+/**************************************************************************
+ * Agent
+ *************************************************************************/
+
+PRIVATE VOID sendClusterStats()
+{
+    vector<Job *> jobs;
+    getScnJobs(jobs);
+
+    ByteVec        snap(sizeof(ClusterStats_t) +
+        jobs.size() * CLUSTER_JOB_COUNTERS * sizeof(Counter));
+    ClusterStats_t *pStats = (ClusterStats_t *)&snap[0];
+
+    pStats->numJobs = jobs.size();
+    for (U32 i = 0; i < GSIM_STAT_MAX; i++)
+    {
+        pStats->stats[i] = Stats::getStats((GtpStat_t)i);
+    }
+
+    getRspTimeHist()->save(&pStats->rspTime);
+    getQueueDelayHist()->save(&pStats->queueDelay);
+    getRejectTimeHist()->save(&pStats->rejectTime);
+    for (U32 i = 0; i < GTP_CAUSE_MAX; i++)
+    {
+        pStats->causes[i] = Stats::getCause((GtpCause_t)i);
+    }
+
+    Counter *pCnt = (Counter *)(pStats + 1);
+    for (U32 i = 0; i < jobs.size(); i++)
+    {
+        *pCnt++ = jobs[i]->m_numSnd;
+        *pCnt++ = jobs[i]->m_numRcv;
+        *pCnt++ = jobs[i]->m_numSndRetrans;
+        *pCnt++ = jobs[i]->m_numRcvRetrans;
+        *pCnt++ = jobs[i]->m_numTimeOut;
+        *pCnt++ = jobs[i]->m_numUnexp;
+        *pCnt++ = jobs[i]->m_numRejected;
+    }
+
+    sendClusterMsg(s_coordFd, CLUSTER_MSG_STATS, &snap[0], snap.size());
+}
+
+/**
+ * @brief
+ *    Connects to the coordinator, retrying while it is not listening yet,
+ *    and applies its assignment: IMSI range, TEID base, local port and the
+ *    share of the session rate and of the number of sessions
+ */
+PUBLIC VOID joinCluster()
+{
+    LOG_ENTERFN();
+
+    Config                  *pCfg = Config::getInstance();
+    string                  addr  = pCfg->getClusterCoordinator();
+    struct sockaddr_storage sa;
+    socklen_t               saLen;
+
+    if (ROK != clusterAddr(addr, &sa, &saLen))
+    {
+        throw GsimError("Invalid cluster coordinator address " + addr);
+    }
+
+    Time_t deadline = getMilliSeconds() + CLUSTER_CONNECT_WAIT;
+    for (;;)
+    {
+        s_coordFd = socket(sa.ss_family, SOCK_STREAM, 0);
+        if (s_coordFd < 0)
+        {
+            throw GsimError("Cluster socket, " + string(strerror(errno)));
+        }
+
+        if (0 == connect(s_coordFd, (struct sockaddr *)&sa, saLen))
+        {
+            break;
+        }
+
+        close(s_coordFd);
+        s_coordFd = -1;
+        if (getMilliSeconds() >= deadline)
+        {
+            throw GsimError("Unable to connect cluster coordinator " + addr);
+        }
+
+        usleep(CLUSTER_POLL_INTVL * 1000);
+    }
+
+    U32 pid = getpid();
+    sendClusterMsg(s_coordFd, CLUSTER_MSG_HELLO, &pid, sizeof(pid));
+
+    U32     type = 0;
+    ByteVec payload;
+    if (1 != recvClusterMsg(s_coordFd, s_coordRxBuf, &type, &payload,
+                 CLUSTER_CONNECT_WAIT) ||
+        CLUSTER_MSG_ASSIGN != type ||
+        payload.size() != sizeof(ClusterAssign_t))
+    {
+        throw GsimError("No assignment from cluster coordinator " + addr);
+    }
+
+    ClusterAssign_t assign;
+    MEMCPY(&assign, &payload[0], sizeof(assign));
+
+    pCfg->setCallRate(assign.rate);
+    pCfg->setNoOfCalls(assign.numSessions);
+    pCfg->setLocalGtpcPort(assign.localPort);
+    pCfg->setImsi(assign.imsi, STRLEN(assign.imsi));
+    setTeidBase(assign.teidBase);
+
+    LOG_INFO("Cluster agent %u of %u, port %u, IMSI %s, TEID base %u, "
+             "rate %u, sessions %u", assign.index, assign.numAgents,
+        assign.localPort, assign.imsi, assign.teidBase, assign.rate,
+        assign.numSessions);
+
+    LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Reports the transport is up and waits until all agents are
+ */
+PUBLIC VOID clusterAgentReady()
+{
+    LOG_ENTERFN();
+
+    sendClusterMsg(s_coordFd, CLUSTER_MSG_READY, NULL, 0);
+
+    U32     type = 0;
+    ByteVec payload;
+    if (1 != recvClusterMsg(s_coordFd, s_coordRxBuf, &type, &payload,
+                 2 * CLUSTER_CONNECT_WAIT) ||
+        CLUSTER_MSG_START != type)
+    {
+        throw GsimError("Cluster coordinator did not start the agents");
+    }
+
+    s_nextStats = getMilliSeconds() + CLUSTER_STATS_INTVL;
+
+    LOG_EXITVOID();
+}
+
+PUBLIC VOID pollClusterAgent()
+{
+    if (s_coordFd < 0)
+    {
+        return;
+    }
+
+    Time_t now = getMilliSeconds();
+    if (now < s_nextPoll)
+    {
+        return;
+    }
+
+    s_nextPoll = now + CLUSTER_POLL_INTVL;
+
+    U32     type = 0;
+    ByteVec payload;
+    S32     rs;
+    while (1 == (rs = recvClusterMsg(s_coordFd, s_coordRxBuf, &type,
+                      &payload, 0)))
+    {
+        if (CLUSTER_MSG_KEY == type && sizeof(S32) == payload.size())
+        {
+            S32 key;
+            MEMCPY(&key, &payload[0], sizeof(key));
+            Keyboard::getInstance()->processKey(key);
+        }
+        else if (CLUSTER_MSG_STOP == type)
+        {
+            LOG_INFO("Stopped by the cluster coordinator");
+            requestQuit();
+        }
+    }
+
+    if (rs < 0)
+    {
+        LOG_ERROR("Cluster coordinator has gone, stopping");
+        Keyboard::key = KB_KEY_SIM_QUIT;
+        close(s_coordFd);
+        s_coordFd = -1;
+        return;
+    }
+
+    if (now >= s_nextStats)
+    {
+        s_nextStats = now + CLUSTER_STATS_INTVL;
+        sendClusterStats();
+    }
+}
+
+PUBLIC VOID leaveCluster()
+{
+    LOG_ENTERFN();
+
+    if (s_coordFd >= 0)
+    {
+        sendClusterStats();
+        sendClusterMsg(s_coordFd, CLUSTER_MSG_BYE, NULL, 0);
+        close(s_coordFd);
+        s_coordFd = -1;
+    }
+
+    LOG_EXITVOID();
+}
+
+/**************************************************************************
+ * Coordinator
+ *************************************************************************/
+
+PRIVATE S32 clusterListen(const string &addr)
+{
+    struct sockaddr_storage sa;
+    socklen_t               saLen;
+
+    if (ROK != clusterAddr(addr, &sa, &saLen))
+    {
+        throw GsimError("Invalid cluster listen address " + addr);
+    }
+
+    if (AF_UNIX == sa.ss_family)
+    {
+        unlink(addr.c_str());
+    }
+
+    S32 fd  = socket(sa.ss_family, SOCK_STREAM, 0);
+    S32 one = 1;
+    if (fd < 0 ||
+        0 != setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) ||
+        0 != bind(fd, (struct sockaddr *)&sa, saLen) ||
+        0 != listen(fd, CLUSTER_MAX_AGENTS))
+    {
+        throw GsimError("Cluster listen on " + addr + ", " +
+            string(strerror(errno)));
+    }
+
+    return fd;
+}
+
+/**
+ * @brief
+ *    Starts the agents with the command line of the coordinator, the
+ *    cluster and stats segment options replaced by the coordinator address.
+ *    Their display and keyboard are not used
+ */
+PRIVATE VOID spawnAgents(U32 numAgents, const string &addr,
+    vector<pid_t> &children)
+{
+    std::ifstream  cmdFile("/proc/self/cmdline");
+    vector<string> args;
+    string         arg;
+
+    while (std::getline(cmdFile, arg, '\0'))
+    {
+        /* the coordinator publishes the statistics of the cluster */
+        if (0 == arg.compare(0, 10, "--cluster-") ||
+            0 == arg.compare(0, 11, "--stats-shm"))
+        {
+            /* the value may be the next argument */
+            if (string::npos == arg.find('='))
+            {
+                std::getline(cmdFile, arg, '\0');
+            }
+
+            continue;
+        }
+
+        args.push_back(arg);
+    }
+
+    args.push_back("--cluster-coordinator=" + addr);
+
+    vector<S8 *> argv;
+    for (U32 i = 0; i < args.size(); i++)
+    {
+        argv.push_back(&args[i][0]);
+    }
+
+    argv.push_back(NULL);
+
+    for (U32 i = 0; i < numAgents; i++)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            throw GsimError("Starting cluster agent, " +
+                string(strerror(errno)));
+        }
+        else if (0 == pid)
+        {
+            S32 nullFd = open("/dev/null", O_RDWR);
+            dup2(nullFd, STDIN_FILENO);
+            dup2(nullFd, STDOUT_FILENO);
+            execv("/proc/self/exe", &argv[0]);
+            _exit(127);
+        }
+
+        children.push_back(pid);
+    }
+}
+
+/**
+ * @brief
+ *    Sums the latest snapshots of the agents into the statistics, jobs and
+ *    histograms shown by the display
+ */
+PRIVATE VOID aggregateClusterStats()
+{
+    static vector<Job *> jobs;
+    if (jobs.empty())
+    {
+        getScnJobs(jobs);
+    }
+
+    vector<Counter> cnt(jobs.size() * CLUSTER_JOB_COUNTERS, 0);
+    Counter         stats[GSIM_STAT_MAX] = {0};
+    Counter         causes[GTP_CAUSE_MAX] = {0};
+
+    getRspTimeHist()->reset();
+    getQueueDelayHist()->reset();
+    getRejectTimeHist()->reset();
+
+    for (U32 i = 0; i < s_agents.size(); i++)
+    {
+        ByteVec &snap = s_agents[i].stats;
+        if (snap.empty())
+        {
+            continue;
+        }
+
+        ClusterStats_t *pStats = (ClusterStats_t *)&snap[0];
+        Counter        *pCnt   = (Counter *)(pStats + 1);
+
+        for (U32 j = 0; j < GSIM_STAT_MAX; j++)
+        {
+            stats[j] += pStats->stats[j];
+        }
+
+        for (U32 j = 0; j < cnt.size(); j++)
+        {
+            cnt[j] += pCnt[j];
+        }
+
+        getRspTimeHist()->merge(&pStats->rspTime);
+        getQueueDelayHist()->merge(&pStats->queueDelay);
+        getRejectTimeHist()->merge(&pStats->rejectTime);
+
+        for (U32 j = 0; j < GTP_CAUSE_MAX; j++)
+        {
+            causes[j] += pStats->causes[j];
+        }
+    }
+
+    for (U32 i = 0; i < GSIM_STAT_MAX; i++)
+    {
+        Stats::setStats((GtpStat_t)i, stats[i]);
+    }
+
+    for (U32 i = 0; i < GTP_CAUSE_MAX; i++)
+    {
+        Stats::setCause((GtpCause_t)i, causes[i]);
+    }
+
+    for (U32 i = 0; i < jobs.size(); i++)
+    {
+        Counter *pCnt           = &cnt[i * CLUSTER_JOB_COUNTERS];
+        jobs[i]->m_numSnd        = pCnt[0];
+        jobs[i]->m_numRcv        = pCnt[1];
+        jobs[i]->m_numSndRetrans = pCnt[2];
+        jobs[i]->m_numRcvRetrans = pCnt[3];
+        jobs[i]->m_numTimeOut    = pCnt[4];
+        jobs[i]->m_numUnexp      = pCnt[5];
+        jobs[i]->m_numRejected   = pCnt[6];
+    }
+}
+
+PRIVATE VOID stopAgent(ClusterAgent_t *pAgent)
+{
+    if (pAgent->running)
+    {
+        pAgent->running = FALSE;
+        s_numRunning--;
+    }
+
+    if (pAgent->fd >= 0)
+    {
+        close(pAgent->fd);
+        pAgent->fd = -1;
+    }
+}
+
+/**
+ * @brief
+ *    Reads the messages an agent has sent
+ */
+PRIVATE VOID handleAgent(ClusterAgent_t *pAgent, U32 numJobs)
+{
+    U32     type = 0;
+    ByteVec payload;
+    S32     rs;
+
+    while (1 == (rs = recvClusterMsg(pAgent->fd, pAgent->rxBuf, &type,
+                      &payload, 0)))
+    {
+        if (CLUSTER_MSG_STATS == type)
+        {
+            if (payload.size() != sizeof(ClusterStats_t) +
+                    numJobs * CLUSTER_JOB_COUNTERS * sizeof(Counter))
+            {
+                LOG_ERROR("Cluster agent %u runs another scenario",
+                    pAgent->assign.index);
+                continue;
+            }
+
+            pAgent->stats.swap(payload);
+            aggregateClusterStats();
+        }
+        else if (CLUSTER_MSG_BYE == type)
+        {
+            LOG_INFO("Cluster agent %u has stopped", pAgent->assign.index);
+            stopAgent(pAgent);
+            return;
+        }
+    }
+
+    if (rs < 0)
+    {
+        LOG_ERROR("Cluster agent %u has gone", pAgent->assign.index);
+        stopAgent(pAgent);
+    }
+}
+
+PRIVATE VOID sendAllAgents(U32 type, const VOID *pData, U32 len)
+{
+    for (U32 i = 0; i < s_agents.size(); i++)
+    {
+        if (s_agents[i].running)
+        {
+            sendClusterMsg(s_agents[i].fd, type, pData, len);
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Accepts the agents and sends the assignments, agent i gets the i-th
+ *    part of the TEID space, the IMSIs after base + i * stride and the
+ *    local port + i
+ */
+PRIVATE VOID acceptAgents(S32 listenFd, U32 numAgents)
+{
+    Config *pCfg     = Config::getInstance();
+    U32     rate     = pCfg->getCallRate();
+    U32     sessions = pCfg->getNumSessions();
+    U64     stride   = sessions ? (sessions + numAgents - 1) / numAgents
+                                : CLUSTER_IMSI_STRIDE;
+    Time_t  deadline = getMilliSeconds() + CLUSTER_CONNECT_WAIT;
+
+    while (s_agents.size() < numAgents)
+    {
+        Time_t now = getMilliSeconds();
+        if (now >= deadline)
+        {
+            throw GsimError("Cluster agents did not attach in time");
+        }
+
+        struct pollfd pollFd;
+        pollFd.fd      = listenFd;
+        pollFd.events  = POLLIN;
+        pollFd.revents = 0;
+        if (poll(&pollFd, 1, deadline - now) <= 0)
+        {
+            continue;
+        }
+
+        S32 fd = accept(listenFd, NULL, NULL);
+        if (fd < 0)
+        {
+            continue;
+        }
+
+        ClusterAgent_t agent;
+        agent.fd      = fd;
+        agent.pid     = 0;
+        agent.running = TRUE;
+        MEMSET(&agent.assign, 0, sizeof(agent.assign));
+
+        U32     type = 0;
+        ByteVec payload;
+        if (1 != recvClusterMsg(fd, agent.rxBuf, &type, &payload,
+                     CLUSTER_CONNECT_WAIT) ||
+            CLUSTER_MSG_HELLO != type || sizeof(U32) != payload.size())
+        {
+            LOG_ERROR("Invalid cluster agent hello");
+            close(fd);
+            continue;
+        }
+
+        U32 pid;
+        MEMCPY(&pid, &payload[0], sizeof(pid));
+        agent.pid = pid;
+
+        U32              i       = s_agents.size();
+        ClusterAssign_t *pAssign = &agent.assign;
+        pAssign->index           = i;
+        pAssign->numAgents       = numAgents;
+        pAssign->rate            = rate / numAgents + (i < rate % numAgents);
+        pAssign->numSessions     = sessions / numAgents +
+            (i < sessions % numAgents);
+        pAssign->teidBase        = (U32)((0x100000000ULL / numAgents) * i);
+        pAssign->localPort       = pCfg->getLocalGtpcPort() + i;
+        STRCPY(pAssign->imsi, imsiAdd(pCfg->getImsi(), i * stride).c_str());
+
+        sendClusterMsg(fd, CLUSTER_MSG_ASSIGN, pAssign, sizeof(*pAssign));
+        s_agents.push_back(agent);
+        s_numRunning++;
+
+        LOG_INFO("Cluster agent %u, pid %u attached", i, pid);
+    }
+}
+
+PRIVATE VOID waitAgentsReady()
+{
+    Time_t deadline = getMilliSeconds() + CLUSTER_CONNECT_WAIT;
+
+    for (U32 i = 0; i < s_agents.size(); i++)
+    {
+        Time_t  now  = getMilliSeconds();
+        U32     type = 0;
+        ByteVec payload;
+
+        if (now >= deadline ||
+            1 != recvClusterMsg(s_agents[i].fd, s_agents[i].rxBuf, &type,
+                     &payload, deadline - now) ||
+            CLUSTER_MSG_READY != type)
+        {
+            std::ostringstream err;
+            err << "Cluster agent " << i << " is not ready, see log of pid "
+                << s_agents[i].pid;
+            throw GsimError(err.str());
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Writes the assignment and the statistics of every agent, the totals
+ *    and the merged histograms
+ */
+PRIVATE VOID writeClusterResults()
+{
+    vector<Job *> jobs;
+    getScnJobs(jobs);
+
+    string        file = "cluster-" + std::to_string(getpid()) + ".txt";
+    std::ofstream out(file.c_str());
+    if (!out)
+    {
+        LOG_ERROR("Unable to write cluster results %s", file.c_str());
+        return;
+    }
+
+    S8 buf[256];
+    out << "Cluster of " << s_agents.size() << " agents, node "
+        << Config::getInstance()->getNodeTypeStr() << std::endl
+        << std::endl;
+    snprintf(buf, sizeof(buf), "%-6s %-8s %-6s %-16s %-11s %-8s %-10s %-10s "
+        "%-10s %s", "Agent", "Pid", "Port", "IMSI", "TEID-Base", "Rate",
+        "Sessions", "Created", "Completed", "Aborted");
+    out << buf << std::endl;
+
+    for (U32 i = 0; i < s_agents.size(); i++)
+    {
+        ClusterAgent_t  *pAgent = &s_agents[i];
+        ClusterAssign_t *pA     = &pAgent->assign;
+        Counter         created = 0, succ = 0, fail = 0;
+
+        if (!pAgent->stats.empty())
+        {
+            ClusterStats_t *pStats = (ClusterStats_t *)&pAgent->stats[0];
+            created = pStats->stats[GSIM_STAT_NUM_SESSIONS_CREATED];
+            succ    = pStats->stats[GSIM_STAT_NUM_SESSIONS_SUCC];
+            fail    = pStats->stats[GSIM_STAT_NUM_SESSIONS_FAIL];
+        }
+
+        snprintf(buf, sizeof(buf), "%-6u %-8u %-6u %-16s %-11u %-8u %-10u "
+            "%-10u %-10u %u", pA->index, (U32)pAgent->pid, pA->localPort,
+            pA->imsi, pA->teidBase, pA->rate, pA->numSessions, created, succ,
+            fail);
+        out << buf << std::endl;
+    }
+
+    snprintf(buf, sizeof(buf), "%-6s %-8s %-6s %-16s %-11s %-8u %-10u %-10u "
+        "%-10u %u", "Total", "", "", "", "",
+        Config::getInstance()->getCallRate(),
+        Config::getInstance()->getNumSessions(),
+        Stats::getStats(GSIM_STAT_NUM_SESSIONS_CREATED),
+        Stats::getStats(GSIM_STAT_NUM_SESSIONS_SUCC),
+        Stats::getStats(GSIM_STAT_NUM_SESSIONS_FAIL));
+    out << buf << std::endl << std::endl;
+
+    snprintf(buf, sizeof(buf), "%-32s %-5s %-10s %-10s %-10s %s",
+        "Message", "Dir", "Messages", "Retrans", "Timeout", "Unexpected");
+    out << buf << std::endl;
+    for (U32 i = 0; i < jobs.size(); i++)
+    {
+        Job *pJob = jobs[i];
+        if (JOB_TYPE_SEND == pJob->type())
+        {
+            snprintf(buf, sizeof(buf), "%-32s %-5s %-10u %-10u %u",
+                pJob->m_msgName, "--->", pJob->m_numSnd,
+                pJob->m_numSndRetrans, pJob->m_numTimeOut);
+        }
+        else if (JOB_TYPE_RECV == pJob->type())
+        {
+            snprintf(buf, sizeof(buf), "%-32s %-5s %-10u %-10u %-10s %u",
+                pJob->m_msgName, "<---", pJob->m_numRcv,
+                pJob->m_numRcvRetrans, "", pJob->m_numUnexp);
+        }
+        else
+        {
+            continue;
+        }
+
+        out << buf << std::endl;
+    }
+
+    getRspTimeHist()->print(out);
+    getQueueDelayHist()->print(out);
+
+    std::cout << std::endl << "Cluster Results: " << file << std::endl;
+}
+
+/**
+ * @brief
+ *    Reaps the agents started here, those still running after the stop
+ *    wait are terminated
+ */
+PRIVATE VOID reapAgents(vector<pid_t> &children)
+{
+    Time_t deadline = getMilliSeconds() + CLUSTER_STOP_WAIT;
+
+    for (U32 i = 0; i < children.size(); i++)
+    {
+        while (0 == waitpid(children[i], NULL, WNOHANG))
+        {
+            if (getMilliSeconds() >= deadline)
+            {
+                LOG_ERROR("Terminating cluster agent pid %u",
+                    (U32)children[i]);
+                kill(children[i], SIGTERM);
+                waitpid(children[i], NULL, 0);
+                break;
+            }
+
+            usleep(CLUSTER_POLL_INTVL * 1000);
+        }
+    }
+}
+
+PUBLIC VOID runClusterCoordinator()
+{
+    LOG_ENTERFN();
+
+    Config        *pCfg      = Config::getInstance();
+    U32           numAgents  = pCfg->getClusterAgents();
+    string        addr       = pCfg->getClusterListen();
+    vector<pid_t> children;
+
+    if (numAgents > CLUSTER_MAX_AGENTS)
+    {
+        throw GsimError("At most " + std::to_string(CLUSTER_MAX_AGENTS) +
+            " cluster agents are supported");
+    }
+
+    if (SCN_TYPE_INITIATING == Scenario::getInstance()->getScnType() &&
+        pCfg->getCallRate() < numAgents)
+    {
+        throw GsimError("Session rate is lower than the number of agents");
+    }
+
+    if (addr.empty())
+    {
+        addr = "/tmp/gsim-cluster-" + std::to_string(getpid()) + ".sock";
+    }
+
+    S32 listenFd = clusterListen(addr);
+    if (pCfg->getClusterListen().empty())
+    {
+        spawnAgents(numAgents, addr, children);
+    }
+
+    acceptAgents(listenFd, numAgents);
+    close(listenFd);
+    if (string::npos != addr.find('/'))
+    {
+        unlink(addr.c_str());
+    }
+
+    waitAgentsReady();
+    sendAllAgents(CLUSTER_MSG_START, NULL, 0);
+    LOG_INFO("Started %u cluster agents", numAgents);
+
+    vector<Job *> jobs;
+    getScnJobs(jobs);
+
+    Keyboard *pKb   = Keyboard::getInstance();
+    Display  *pDisp = Display::getInstance();
+    pDisp->init();
+
+    S32    stdinFd  = fileno(stdin);
+    U32    numStops = 0;
+    Time_t stopTime = 0;
+    for (;;)
+    {
+        Time_t now = getMilliSeconds();
+        if (0 == s_numRunning || (0 != stopTime && now >= stopTime))
+        {
+            break;
+        }
+
+        TaskMgr::resumePausedTasks();
+        TaskMgr::runTasks();
+
+        vector<struct pollfd> pollFds;
+        vector<U32>           agentIdx;
+        struct pollfd         pollFd;
+        pollFd.events  = POLLIN;
+        pollFd.revents = 0;
+        if (stdinFd >= 0)
+        {
+            pollFd.fd = stdinFd;
+            pollFds.push_back(pollFd);
+            agentIdx.push_back(s_agents.size());
+        }
+
+        for (U32 i = 0; i < s_agents.size(); i++)
+        {
+            if (s_agents[i].running)
+            {
+                pollFd.fd = s_agents[i].fd;
+                pollFds.push_back(pollFd);
+                agentIdx.push_back(i);
+            }
+        }
+
+        Time_t wait = TaskMgr::nextWakeDelay(GSIM_POLL_MAX_WAIT);
+        if (poll(&pollFds[0], pollFds.size(), wait) <= 0)
+        {
+            continue;
+        }
+
+        for (U32 i = 0; i < pollFds.size(); i++)
+        {
+            if (0 == pollFds[i].revents)
+            {
+                continue;
+            }
+
+            if (agentIdx[i] < s_agents.size())
+            {
+                handleAgent(&s_agents[agentIdx[i]], jobs.size());
+                continue;
+            }
+
+            S32 input = getchar();
+            if (EOF == input)
+            {
+                stdinFd = -1;
+                continue;
+            }
+
+            if ('q' == input)
+            {
+                /* draining agents are waited for until a second stop */
+                LOG_INFO("Stopping cluster agents");
+                sendAllAgents(CLUSTER_MSG_STOP, NULL, 0);
+                if (++numStops > 1 || 0 == pCfg->getDrainRate())
+                {
+                    stopTime = getMilliSeconds() + CLUSTER_STOP_WAIT;
+                }
+
+                continue;
+            }
+
+            pKb->processKey(input);
+            sendAllAgents(CLUSTER_MSG_KEY, &input, sizeof(input));
+        }
+    }
+
+    Display::displayStats();
+    for (U32 i = 0; i < s_agents.size(); i++)
+    {
+        stopAgent(&s_agents[i]);
+    }
+
+    reapAgents(children);
+    writeClusterResults();
+
+    LOG_EXITVOID();
+}
@@ -0,0 +1,59 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CLUSTER_HPP_
+#define _CLUSTER_HPP_
+
+#define CLUSTER_MAX_AGENTS       64
+#define CLUSTER_CONNECT_WAIT     10000     /* ms, agents attaching, ready */
+#define CLUSTER_STOP_WAIT        5000      /* ms, final stats after a stop */
+#define CLUSTER_STATS_INTVL      1000      /* ms, agent stats snapshots */
+#define CLUSTER_POLL_INTVL       100       /* ms, agent reads of coordinator */
+#define CLUSTER_IMSI_STRIDE      100000000 /* IMSIs of an agent, no limit */
+
+/**
+ * @brief
+ *    Cluster mode runs the simulation in several processes, the agents,
+ *    steered by a coordinator. The coordinator assigns every agent disjoint
+ *    IMSI and TEID ranges, a local port and a share of the session rate,
+ *    starts them together and shows the sum of their statistics. Agents are
+ *    started locally or attach to the coordinator over a unix or TCP socket
+ */
+EXTERN BOOL       isClusterCoordinator();
+EXTERN BOOL       isClusterAgent();
+
+/**
+ * @brief
+ *    Runs the coordinator until the user quits or all agents have stopped,
+ *    the results are written to cluster-<pid>.txt
+ */
+EXTERN VOID       runClusterCoordinator();
+
+/**
+ * @brief
+ *    Agent side, joinCluster applies the assignment of the coordinator to
+ *    the configuration and clusterAgentReady waits for the common start.
+ *    pollClusterAgent is called by the scheduler, it sends the statistics
+ *    snapshots and handles the keys and the stop of the coordinator
+ */
+EXTERN VOID       joinCluster();
+EXTERN VOID       clusterAgentReady();
+EXTERN VOID       pollClusterAgent();
+EXTERN VOID       leaveCluster();
+EXTERN U32        getNumClusterAgents();
+EXTERN U32        getNumRunningAgents();
+
+#endif
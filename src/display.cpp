@@ -20,6 +20,8 @@
 #include <exception>
 #include <list>
 #include <vector>
+#include <unordered_map>
+#include <arpa/inet.h>
 
 #include "types.hpp"
 #include "error.hpp"
@@ -38,6 +40,15 @@
 #include "scenario.hpp"
 #include "gtp_stats.hpp"
 #include "display.hpp"
+#include "mempool.hpp"
+#include "poller.hpp"
+#include "latency.hpp"
+#include "cluster.hpp"
+#include "drain.hpp"
+#include "checkpoint.hpp"
+#include "gtp_peer.hpp"
+#include "overload.hpp"
+#include "traffic.hpp"
 
 #define COUT std::cout
 #define CIN std::cin
@@ -172,6 +183,7 @@ VOID Display::printJob(Job *job)
         fprintf(stdout, "\t%9d", job->m_numRcv);
         fprintf(stdout, "%9d", job->m_numRcvRetrans);
         fprintf(stdout, "                  %9d", job->m_numUnexp);
+        fprintf(stdout, "  %9d", job->m_numRejected);
         fprintf(stdout, ENDLINE);
         break;
     }
@@ -188,6 +200,283 @@ VOID Display::printJob(Job *job)
     }
 }
 
+/**
+ * @brief
+ *    Prints the percentiles of the response time of the peer and of the
+ *    time received messages waited in the simulator
+ */
+VOID Display::printLatency()
+{
+    LatencyHist *pRsp   = getRspTimeHist();
+    LatencyHist *pQueue = getQueueDelayHist();
+
+    if (0 == pRsp->count() && 0 == pQueue->count())
+    {
+        return;
+    }
+
+    fprintf(stdout, "Rsp-Time(us):      p50 %lu p99 %lu"
+        "\t  Queueing(us): p50 %lu p99 %lu\r\n",
+        pRsp->percentile(50) / 1000, pRsp->percentile(99) / 1000,
+        pQueue->percentile(50) / 1000, pQueue->percentile(99) / 1000);
+}
+
+/**
+ * @brief
+ *    Prints the number of responses rejected by the peer along with the
+ *    most frequent rejection causes
+ */
+VOID Display::printRejects()
+{
+    Counter    numRejected = getStats(GSIM_STAT_NUM_REJECTED);
+    GtpCause_t causes[DISP_MAX_TOP_CAUSES];
+
+    if (0 == numRejected)
+    {
+        return;
+    }
+
+    Counter numRsp = 0;
+    for (U32 cause = 0; cause < GTP_CAUSE_MAX; cause++)
+    {
+        numRsp += Stats::getCause((GtpCause_t)cause);
+    }
+
+    fprintf(stdout, "Rejected:          %u (%.1f%%)", numRejected,
+        (100.0 * numRejected) / (numRsp ? numRsp : 1));
+
+    U32 numCauses = Stats::getTopRejects(causes, DISP_MAX_TOP_CAUSES);
+    for (U32 i = 0; i < numCauses; i++)
+    {
+        const S8 *pName = gtpGetCauseName(causes[i]);
+        fprintf(stdout, "%s %u %s %u", (0 == i) ? "\t  Top:" : ",",
+            causes[i], pName ? pName : "Unknown",
+            Stats::getCause(causes[i]));
+    }
+
+    fprintf(stdout, "\r\n");
+}
+
+/**
+ * @brief
+ *    Formats the IP address of a peer
+ */
+PRIVATE VOID peerIpStr(PeerData *pPeer, S8 *pStr, U32 len)
+{
+    if (IP_ADDR_TYPE_V4 == pPeer->peerEp.ipAddr.ipAddrType)
+    {
+        U32 addr = htonl(pPeer->peerEp.ipAddr.u.ipv4Addr.addr);
+        inet_ntop(AF_INET, &addr, pStr, len);
+    }
+    else
+    {
+        inet_ntop(AF_INET6, pPeer->peerEp.ipAddr.u.ipv6Addr.addr, pStr, len);
+    }
+}
+
+/**
+ * @brief
+ *    Prints the overload and load control state advertised by the peers
+ *    and the session rate achieved against the configured one
+ */
+VOID Display::printOverload()
+{
+    TrafficTask *pTTask = getTrafficTask();
+
+    for (U32 i = 0; i < getNumPeers(); i++)
+    {
+        PeerData       *pPeer = getPeer(i);
+        PeerOverload_t *pOvld = &pPeer->overload;
+        S8             ipStr[INET6_ADDRSTRLEN] = {0};
+
+        if (!pOvld->ociPres && !pOvld->lciPres)
+        {
+            continue;
+        }
+
+        peerIpStr(pPeer, ipStr, sizeof(ipStr));
+        fprintf(stdout, "Overload:          %s:%d reduction %u%%", ipStr,
+            pPeer->peerEp.port, getReductionMetric(pPeer));
+        if (pOvld->ociPres)
+        {
+            Time_t now = getMilliSeconds();
+            if (GTP_OVERLOAD_NO_EXPIRY == pOvld->ociExpiry)
+            {
+                fprintf(stdout, " (no expiry)");
+            }
+            else if (pOvld->ociExpiry > now)
+            {
+                fprintf(stdout, " (%lus left)",
+                    (pOvld->ociExpiry - now + 999) / 1000);
+            }
+            fprintf(stdout, " seq %u", pOvld->ociSeq);
+        }
+        if (pOvld->lciPres)
+        {
+            fprintf(stdout, "\t  Load: %u%%", pOvld->lciMetric);
+        }
+        fprintf(stdout, "\r\n");
+    }
+
+    if (NULL != pTTask && 0 != pTTask->numThrottled())
+    {
+        fprintf(stdout, "Session-Rate:      %u/s of %u/s, %u throttled\r\n",
+            pTTask->effectiveRate(), pTTask->configuredRate(),
+            pTTask->numThrottled());
+    }
+}
+
+/**
+ * @brief
+ *    Prints the adaptive retransmission timeout of the peers and the
+ *    retransmissions deferred by the retransmission budget
+ */
+VOID Display::printRetrans()
+{
+    if (Config::getInstance()->getAdaptiveRto())
+    {
+        for (U32 i = 0; i < getNumPeers(); i++)
+        {
+            PeerData *pPeer = getPeer(i);
+            S8       ipStr[INET6_ADDRSTRLEN] = {0};
+
+            if (0 == pPeer->rto.srtt)
+            {
+                continue;
+            }
+
+            peerIpStr(pPeer, ipStr, sizeof(ipStr));
+            fprintf(stdout, "RTO:               %s:%d srtt %luus rttvar %luus "
+                "rto %lums\r\n", ipStr, pPeer->peerEp.port, pPeer->rto.srtt,
+                pPeer->rto.rttvar, pPeer->rto.rto / 1000);
+        }
+    }
+
+    if (0 != getStats(GSIM_STAT_NUM_RETRANS_DEFERRED))
+    {
+        fprintf(stdout, "Retrans-Deferred:  %u\r\n",
+            getStats(GSIM_STAT_NUM_RETRANS_DEFERRED));
+    }
+}
+
+/**
+ * @brief
+ *    Prints the progress of the teardown while draining, [q] again quits
+ *    without waiting for it
+ */
+VOID Display::printDrain()
+{
+    if (!isDraining())
+    {
+        return;
+    }
+
+    DrainStats_t *pStats = getDrainStats();
+    Time_t       endTime = pStats->endTime ? pStats->endTime : getMilliSeconds();
+
+    fprintf(stdout, "Draining [q]:      %u of %u released, %u torn down, "
+        "%u failed, %u left, %lus\r\n", pStats->numReleased,
+        pStats->numParked, pStats->numSucc, pStats->numFail, pStats->numLeft,
+        (endTime - pStats->startTime) / 1000);
+}
+
+/**
+ * @brief
+ *    Prints the last checkpoint, taken with [k], and the sessions restored
+ */
+VOID Display::printCheckpoint()
+{
+    CkptStats_t *pStats = getCkptStats();
+
+    if (isCheckpointEnabled())
+    {
+        fprintf(stdout, "Checkpoint [k]:    ");
+        if (pStats->inProgress)
+        {
+            fprintf(stdout, "in progress");
+        }
+        else if (0 != pStats->numTaken)
+        {
+            fprintf(stdout, "%u sessions, %lus ago in %lums",
+                pStats->numSessions,
+                (getMilliSeconds() - pStats->lastTime) / 1000,
+                pStats->lastDuration);
+        }
+        else
+        {
+            fprintf(stdout, "none");
+        }
+
+        fprintf(stdout, ", %u taken, %u failed\r\n", pStats->numTaken,
+            pStats->numFailed);
+    }
+
+    if (!Config::getInstance()->getRestoreFile().empty())
+    {
+        fprintf(stdout, "Restored:          %u sessions\r\n",
+            pStats->numRestored);
+    }
+}
+
+/**
+ * @brief
+ *    Prints the poll mode, switched with [m], and the CPU time per message
+ *    spent in the interrupt and the busy mode
+ */
+VOID Display::printPollMode()
+{
+    PollStats_t *pStats = getPollStats();
+    PollMode_t  mode    = getPollMode();
+
+    fprintf(stdout, "Poll-Mode [m]:     %s", pollModeStr(mode));
+    if (POLL_MODE_AUTO == mode)
+    {
+        fprintf(stdout, " (%s)", pollModeStr(getActivePollMode()));
+    }
+
+    fprintf(stdout, "\t  CPU/Msg:");
+    for (U32 i = POLL_MODE_INTERRUPT; i <= POLL_MODE_BUSY; i++)
+    {
+        if (pStats[i].numMsgs > 0)
+        {
+            fprintf(stdout, " %s %.1fus", pollModeStr((PollMode_t)i),
+                (double)pStats[i].cpuUsec / pStats[i].numMsgs);
+        }
+    }
+
+    fprintf(stdout, "\r\n");
+}
+
+/**
+ * @brief
+ *    Prints page size, NUMA node and usage of the memory pools in use
+ */
+VOID Display::printMemPools()
+{
+    BOOL header = TRUE;
+
+    for (U32 i = 0; i < MEM_POOL_MAX; i++)
+    {
+        MemPool *pPool = getMemPool((MemPoolId_t)i);
+        if (NULL == pPool)
+        {
+            continue;
+        }
+
+        if (header)
+        {
+            header = FALSE;
+            PRINT_SEPERATOR();
+            fprintf(stdout, "Memory-Pool   Page     Node  "
+                "Used        Total       Overflow\r\n");
+        }
+
+        fprintf(stdout, "%-13s %-8s %-5d %-11lu %-11lu %lu\r\n",
+            pPool->name(), memPoolPageStr(pPool).c_str(), pPool->node(),
+            pPool->numUsed(), pPool->numObjs(), pPool->numOverflow());
+    }
+}
+
 VOID Display::disp()
 {
     static BOOL firTime = TRUE;
@@ -228,11 +517,38 @@ VOID Display::disp()
     fprintf(stdout, "Session-Completed: %u\r\n", ssnSucc);
     fprintf(stdout, "Session-Aborted:   %u\r\n", ssnFail);
     fprintf(stdout, "Dead-Calls:        %u\r\n", deadCalls);
+    if (0 != getStats(GSIM_STAT_NUM_INVALID))
+    {
+        fprintf(stdout, "Invalid-Msgs:      %u\r\n",
+            getStats(GSIM_STAT_NUM_INVALID));
+    }
+    if (0 != getStats(GSIM_STAT_NUM_SEND_FAILED))
+    {
+        fprintf(stdout, "Send-Failed:       %u\r\n",
+            getStats(GSIM_STAT_NUM_SEND_FAILED));
+    }
+    if (isClusterCoordinator())
+    {
+        fprintf(stdout, "Cluster-Agents:    %u of %u running\r\n",
+            getNumRunningAgents(), getNumClusterAgents());
+    }
+    else
+    {
+        printPollMode();
+    }
+
+    printLatency();
+    printRejects();
+    printOverload();
+    printRetrans();
+    printDrain();
+    printCheckpoint();
+    printMemPools();
 
     PRINT_SEPERATOR();
     fprintf(stdout,
         "                                 "
-        "Messages  Retrans   Timeout   Unexpected-Msg\r\n");
+        "Messages  Retrans   Timeout   Unexpected-Msg  Rejected\r\n");
 
     for (U32 i = 0; i < m_procSeq->size(); i++)
     {
@@ -285,5 +601,9 @@ Counter Display::getStats(GtpStat_t type)
 
 VOID Display::displayStats()
 {
-    Display::getInstance()->disp();
+    /* nothing to refresh when the display was never initialized */
+    if (NULL != m_pDisp)
+    {
+        m_pDisp->disp();
+    }
 }
@@ -17,6 +17,9 @@
 #ifndef __DISPLAY_HPP__
 #define __DISPLAY_HPP__
 
+/* number of the most frequent rejection causes displayed */
+#define DISP_MAX_TOP_CAUSES         3
+
 class Display: virtual public Task
 {
    public:
@@ -45,6 +48,14 @@ class Display: virtual public Task
       S8                m_timeStr[GSIM_TIME_STR_MAX_LEN];
       ProcSequence      *m_procSeq;
       VOID              printJob(Job*);
+      VOID              printMemPools();
+      VOID              printPollMode();
+      VOID              printLatency();
+      VOID              printRejects();
+      VOID              printOverload();
+      VOID              printRetrans();
+      VOID              printDrain();
+      VOID              printCheckpoint();
       std::string       m_nodeTypStr;
 };
 
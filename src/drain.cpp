@@ -0,0 +1,207 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "task.hpp"
+#include "transport.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "sim_cfg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "scenario.hpp"
+#include "tunnel.hpp"
+#include "session.hpp"
+#include "ssn_table.hpp"
+#include "keyboard.hpp"
+#include "display.hpp"
+#include "drain.hpp"
+
+static Scenario               *s_pDrainScn = NULL;
+static ProcedureItr           s_drainProcItr;
+static BOOL                   s_draining   = FALSE;
+static std::deque<GtpImsiKey> s_drainQueue;
+static DrainStats_t           s_drainStats;
+static Counter                s_baseSucc   = 0;
+static Counter                s_baseFail   = 0;
+
+PUBLIC VOID initDrain(Scenario *pScn)
+{
+    LOG_ENTERFN();
+
+    Config *pCfg = Config::getInstance();
+    if (0 == pCfg->getDrainRate() ||
+        SCN_TYPE_INITIATING != pScn->getScnType())
+    {
+        LOG_EXITVOID();
+    }
+
+    GtpMsgType_t msgType = gtpGetMsgType(pCfg->getDrainFrom().c_str());
+    for (ProcedureItr itr = pScn->m_procSeq.begin();
+         itr != pScn->m_procSeq.end(); itr++)
+    {
+        Job *pJob = (*itr)->m_initial;
+        if (NULL != pJob && JOB_TYPE_SEND == pJob->type() &&
+            msgType == pJob->getGtpMsg()->type())
+        {
+            s_pDrainScn    = pScn;
+            s_drainProcItr = itr;
+            LOG_EXITVOID();
+        }
+    }
+
+    throw GsimError("Scenario sends no " + pCfg->getDrainFrom() +
+        " to drain the sessions with");
+}
+
+PUBLIC BOOL isDrainEnabled()
+{
+    return (NULL != s_pDrainScn);
+}
+
+PUBLIC BOOL isDraining()
+{
+    return s_draining;
+}
+
+PUBLIC ProcedureItr getDrainProcedure()
+{
+    return s_drainProcItr;
+}
+
+PUBLIC DrainStats_t *getDrainStats()
+{
+    return &s_drainStats;
+}
+
+PUBLIC VOID addDrainSession(const GtpImsiKey *pImsiKey)
+{
+    s_drainQueue.push_back(*pImsiKey);
+    s_drainStats.numParked++;
+}
+
+PUBLIC VOID requestQuit()
+{
+    if (!isDrainEnabled() || s_draining)
+    {
+        Keyboard::key = KB_KEY_SIM_QUIT;
+        return;
+    }
+
+    LOG_INFO("Draining %lu sessions at %u per second",
+        s_pDrainScn->m_ueSessionMap.size(),
+        Config::getInstance()->getDrainRate());
+
+    s_draining = TRUE;
+    MEMSET(&s_drainStats, 0, sizeof(s_drainStats));
+    s_drainStats.startTime = getMilliSeconds();
+    s_baseSucc             = Stats::getStats(GSIM_STAT_NUM_SESSIONS_SUCC);
+    s_baseFail             = Stats::getStats(GSIM_STAT_NUM_SESSIONS_FAIL);
+
+    new DrainTask(s_pDrainScn);
+}
+
+/**
+ * @brief
+ *    Sessions waiting in a wait procedure are woken up, on their next run
+ *    they park themselves until the teardown is released here
+ *
+ * @param pScn
+ */
+DrainTask::DrainTask(Scenario *pScn)
+{
+    m_pScn     = pScn;
+    m_wakeTime = 0;
+
+    /* the session table gives the candidates, a session resumed since
+     * its last run is not waiting anymore
+     */
+    std::vector<UeSession *> waiting;
+    pScn->m_pSsnTable->collectPaused(GSIM_UE_SSN_WAITING_FOR_RSP, &waiting);
+
+    for (U32 i = 0; i < waiting.size(); i++)
+    {
+        if (waiting[i]->isWaiting())
+        {
+            waiting[i]->resumeTask();
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Starts the teardown of the parked sessions at the drain rate, the
+ *    simulator quits once all sessions are gone
+ */
+RETVAL DrainTask::run(VOID *arg)
+{
+    LOG_ENTERFN();
+
+    Time_t now     = getMilliSeconds();
+    U64    allowed = 1 + ((U64)Config::getInstance()->getDrainRate() *
+        (now - s_drainStats.startTime)) / 1000;
+
+    while (!s_drainQueue.empty() && s_drainStats.numReleased < allowed)
+    {
+        UeSession *pSsn = UeSession::getUeSession(m_pScn,
+            s_drainQueue.front());
+        s_drainQueue.pop_front();
+
+        /* the session may have gone or been resumed by a message meanwhile
+         */
+        if (NULL != pSsn && pSsn->releaseDrain())
+        {
+            s_drainStats.numReleased++;
+        }
+    }
+
+    s_drainStats.numSucc =
+        Stats::getStats(GSIM_STAT_NUM_SESSIONS_SUCC) - s_baseSucc;
+    s_drainStats.numFail =
+        Stats::getStats(GSIM_STAT_NUM_SESSIONS_FAIL) - s_baseFail;
+    s_drainStats.numLeft = m_pScn->m_ueSessionMap.size();
+
+    if (0 == s_drainStats.numLeft)
+    {
+        s_drainStats.endTime = now;
+        LOG_INFO("Drained in %lums, %u sessions torn down, %u failed",
+            now - s_drainStats.startTime, s_drainStats.numSucc,
+            s_drainStats.numFail);
+        Display::displayStats();
+        Keyboard::key = KB_KEY_SIM_QUIT;
+        stop();
+    }
+    else
+    {
+        m_wakeTime = now + DRAIN_TICK_INTVL;
+        pause();
+    }
+
+    LOG_EXITFN(ROK);
+}
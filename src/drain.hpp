@@ -0,0 +1,75 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DRAIN_HPP_
+#define _DRAIN_HPP_
+
+class Scenario;
+
+#define DRAIN_TICK_INTVL         10   /* ms, teardown releases */
+
+typedef struct
+{
+   Counter     numParked;     /* sessions waiting for their teardown */
+   Counter     numReleased;   /* teardowns started */
+   Counter     numSucc;       /* sessions completed since the drain start */
+   Counter     numFail;       /* sessions failed since the drain start */
+   Counter     numLeft;       /* sessions not yet completed */
+   Time_t      startTime;
+   Time_t      endTime;       /* 0 while draining */
+} DrainStats_t;
+
+/**
+ * @brief
+ *    Ends the traffic of an initiating scenario without leaving sessions on
+ *    the peer. No new sessions are created, procedures in flight complete
+ *    and every established session then runs the teardown procedure, the
+ *    one sending --drain-from, at --drain-rate sessions per second. The
+ *    simulator quits when no session is left
+ */
+class DrainTask: public Task
+{
+   public:
+      DrainTask(Scenario *pScn);
+      ~DrainTask() {}
+      RETVAL run(VOID *arg = NULL);
+      inline Time_t wake() { return m_wakeTime; }
+
+   private:
+      Scenario          *m_pScn;
+      Time_t            m_wakeTime;
+};
+
+/**
+ * @brief
+ *    Finds the teardown procedure of the scenario, drain is enabled when
+ *    --drain-rate is set and the scenario initiates the sessions
+ */
+EXTERN VOID          initDrain(Scenario *pScn);
+
+/**
+ * @brief
+ *    Quit of the user or the cluster coordinator, starts the drain if it is
+ *    enabled and not running yet, otherwise quits at once
+ */
+EXTERN VOID          requestQuit();
+EXTERN BOOL          isDraining();
+EXTERN BOOL          isDrainEnabled();
+EXTERN ProcedureItr  getDrainProcedure();
+EXTERN VOID          addDrainSession(const GtpImsiKey *pImsiKey);
+EXTERN DrainStats_t  *getDrainStats();
+
+#endif
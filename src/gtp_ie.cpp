@@ -132,6 +132,49 @@ RETVAL GtpIe::buildIeHelper(const HexString *inbuf, U8 *outbuf,\
 }
 
 
+/**
+ * @brief
+ *    Helper function used by grouped IE classes to build IE from the
+ *    IEs within it
+ *
+ * @return
+ *    RFAILED if the IEs do not fit the grouped IE
+ */
+RETVAL GtpIe::buildGroupedIeHelper(const GtpIeLst *pIeLst, U8 *outbuf,\
+      GtpLength_t maxIeLen)
+{
+   LOG_ENTERFN();
+
+   RETVAL                     ret = ROK;
+   U8                         buf[GTP_MSG_BUF_LEN];
+   U32                        len = 0;
+   GtpIeLst::const_iterator  ie;
+
+   /* the IEs are encoded while they fit, the grouped IE is much smaller
+    * than the buffer
+    */
+   for (ie = pIeLst->begin(); ie != pIeLst->end(); ie++)
+   {
+      if (len <= maxIeLen)
+      {
+         len += (*ie)->encode(buf + len);
+      }
+
+      delete *ie;
+   }
+
+   if (len > maxIeLen)
+   {
+      LOG_ERROR("IEs of grouped IE [%s] exceed [%d] octets",\
+            gtpGetIeName(this->m_hdr.ieType), maxIeLen);
+      LOG_EXITFN(RFAILED);
+   }
+
+   MEMCPY(outbuf, buf, len);
+   this->m_hdr.len = len;
+
+   LOG_EXITFN(ret);
+}
 
 /**
  * @brief Factor Method to create GTP IE
@@ -317,6 +360,16 @@ GtpIe* GtpIe::createGtpIe(GtpIeType_t  ieType, GtpInstance_t instance)
          return new GtpAdditionalMmCntxtForSrvcc(instance);
       case GTP_IE_ADDITIONAL_FLAGS_FOR_SRVCC:
          return new GtpAdditionalFlagsForSrvcc(instance);
+      case GTP_IE_EPC_TIMER:
+         return new GtpEpcTimer(instance);
+      case GTP_IE_OVERLOAD_CNTRL_INFO:
+         return new GtpOverloadCntrlInfo(instance);
+      case GTP_IE_LOAD_CNTRL_INFO:
+         return new GtpLoadCntrlInfo(instance);
+      case GTP_IE_METRIC:
+         return new GtpMetric(instance);
+      case GTP_IE_SEQUENCE_NUMBER:
+         return new GtpSequenceNumber(instance);
       default:
          return NULL;
    }
@@ -1717,5 +1770,43 @@ RETVAL GtpSelectionMode::buildIe(const S8 *pVal)
    LOG_EXITFN(ROK);
 }
 
+/**
+ * @brief Builds EPC Timer IE from the decimal value of its octet, the
+ *    timer unit in bits 8-6 and the timer value in bits 5-1
+ */
+RETVAL GtpEpcTimer::buildIe(const S8 *pVal)
+{
+   LOG_ENTERFN();
+
+   m_val[0] = (U8)gtpConvStrToU32((const S8*)pVal, STRLEN(pVal));
+   this->m_hdr.len = GTP_EPC_TIMER_MAX_BUF_LEN;
+
+   LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief Builds Metric IE from a decimal percentage
+ */
+RETVAL GtpMetric::buildIe(const S8 *pVal)
+{
+   LOG_ENTERFN();
+
+   m_val[0] = (U8)gtpConvStrToU32((const S8*)pVal, STRLEN(pVal));
+   this->m_hdr.len = GTP_METRIC_MAX_BUF_LEN;
+
+   LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief Builds Sequence Number IE from a decimal value
+ */
+RETVAL GtpSequenceNumber::buildIe(const S8 *pVal)
+{
+   LOG_ENTERFN();
 
+   U32 seqNum = gtpConvStrToU32((const S8*)pVal, STRLEN(pVal));
+   GSIM_ENC_U32(m_val, seqNum);
+   this->m_hdr.len = GTP_SEQUENCE_NUMBER_MAX_BUF_LEN;
 
+   LOG_EXITFN(ROK);
+}
@@ -3309,4 +3309,197 @@ class GtpAdditionalFlagsForSrvcc : public GtpIe
       BOOL   isGroupedIe() {return FALSE;}
 };
 
+class GtpEpcTimer : public GtpIe
+{
+#define GTP_EPC_TIMER_MAX_BUF_LEN    1
+   private:
+      U8             m_val[GTP_EPC_TIMER_MAX_BUF_LEN];
+
+   public:
+      GtpEpcTimer(GtpInstance_t inst)
+      {
+         m_hdr.ieType = GTP_IE_EPC_TIMER;
+         m_hdr.instance = inst;
+         m_hdr.len = 0;
+      }
+
+      RETVAL buildIe(const S8 *pVal);
+
+      RETVAL buildIe(const HexString *value)
+      {
+         return buildIeHelper(value, m_val, GTP_EPC_TIMER_MAX_BUF_LEN);
+      }
+
+      RETVAL buildIe(IeParamLst *pBuf) {return ROK;}
+      RETVAL buildIe(const GtpIeLst *pIeLst) {return ROK;};
+
+      GtpLength_t encode(U8 *outbuf)
+      {
+         return encodeHelper(m_val, outbuf);
+      }
+
+      GtpLength_t decode(const U8 *inbuf)
+      {
+         return decodeHelper(inbuf, m_val, GTP_EPC_TIMER_MAX_BUF_LEN);
+      }
+
+      BOOL   isGroupedIe() {return FALSE;}
+};
+
+class GtpMetric : public GtpIe
+{
+#define GTP_METRIC_MAX_BUF_LEN    1
+   private:
+      U8             m_val[GTP_METRIC_MAX_BUF_LEN];
+
+   public:
+      GtpMetric(GtpInstance_t inst)
+      {
+         m_hdr.ieType = GTP_IE_METRIC;
+         m_hdr.instance = inst;
+         m_hdr.len = 0;
+      }
+
+      RETVAL buildIe(const S8 *pVal);
+
+      RETVAL buildIe(const HexString *value)
+      {
+         return buildIeHelper(value, m_val, GTP_METRIC_MAX_BUF_LEN);
+      }
+
+      RETVAL buildIe(IeParamLst *pBuf) {return ROK;}
+      RETVAL buildIe(const GtpIeLst *pIeLst) {return ROK;};
+
+      GtpLength_t encode(U8 *outbuf)
+      {
+         return encodeHelper(m_val, outbuf);
+      }
+
+      GtpLength_t decode(const U8 *inbuf)
+      {
+         return decodeHelper(inbuf, m_val, GTP_METRIC_MAX_BUF_LEN);
+      }
+
+      BOOL   isGroupedIe() {return FALSE;}
+};
+
+class GtpSequenceNumber : public GtpIe
+{
+#define GTP_SEQUENCE_NUMBER_MAX_BUF_LEN    4
+   private:
+      U8             m_val[GTP_SEQUENCE_NUMBER_MAX_BUF_LEN];
+
+   public:
+      GtpSequenceNumber(GtpInstance_t inst)
+      {
+         m_hdr.ieType = GTP_IE_SEQUENCE_NUMBER;
+         m_hdr.instance = inst;
+         m_hdr.len = 0;
+      }
+
+      RETVAL buildIe(const S8 *pVal);
+
+      RETVAL buildIe(const HexString *value)
+      {
+         return buildIeHelper(value, m_val, GTP_SEQUENCE_NUMBER_MAX_BUF_LEN);
+      }
+
+      RETVAL buildIe(IeParamLst *pBuf) {return ROK;}
+      RETVAL buildIe(const GtpIeLst *pIeLst) {return ROK;};
+
+      GtpLength_t encode(U8 *outbuf)
+      {
+         return encodeHelper(m_val, outbuf);
+      }
+
+      GtpLength_t decode(const U8 *inbuf)
+      {
+         return decodeHelper(inbuf, m_val, GTP_SEQUENCE_NUMBER_MAX_BUF_LEN);
+      }
+
+      BOOL   isGroupedIe() {return FALSE;}
+};
+
+class GtpOverloadCntrlInfo : public GtpIe
+{
+#define GTP_OVERLOAD_CNTRL_INFO_MAX_BUF_LEN    128
+   private:
+      U8             m_val[GTP_OVERLOAD_CNTRL_INFO_MAX_BUF_LEN];
+
+   public:
+      GtpOverloadCntrlInfo(GtpInstance_t inst)
+      {
+         m_hdr.ieType = GTP_IE_OVERLOAD_CNTRL_INFO;
+         m_hdr.instance = inst;
+         m_hdr.len = 0;
+      }
+
+      RETVAL buildIe(const S8 *pVal) {return ROK;}
+
+      RETVAL buildIe(const HexString *value)
+      {
+         return buildIeHelper(value, m_val, GTP_OVERLOAD_CNTRL_INFO_MAX_BUF_LEN);
+      }
+
+      RETVAL buildIe(IeParamLst *pBuf) {return ROK;}
+
+      RETVAL buildIe(const GtpIeLst *pIeLst)
+      {
+         return buildGroupedIeHelper(pIeLst, m_val, GTP_OVERLOAD_CNTRL_INFO_MAX_BUF_LEN);
+      }
+
+      GtpLength_t encode(U8 *outbuf)
+      {
+         return encodeHelper(m_val, outbuf);
+      }
+
+      GtpLength_t decode(const U8 *inbuf)
+      {
+         return decodeHelper(inbuf, m_val, GTP_OVERLOAD_CNTRL_INFO_MAX_BUF_LEN);
+      }
+
+      BOOL   isGroupedIe() {return TRUE;}
+};
+
+class GtpLoadCntrlInfo : public GtpIe
+{
+#define GTP_LOAD_CNTRL_INFO_MAX_BUF_LEN    128
+   private:
+      U8             m_val[GTP_LOAD_CNTRL_INFO_MAX_BUF_LEN];
+
+   public:
+      GtpLoadCntrlInfo(GtpInstance_t inst)
+      {
+         m_hdr.ieType = GTP_IE_LOAD_CNTRL_INFO;
+         m_hdr.instance = inst;
+         m_hdr.len = 0;
+      }
+
+      RETVAL buildIe(const S8 *pVal) {return ROK;}
+
+      RETVAL buildIe(const HexString *value)
+      {
+         return buildIeHelper(value, m_val, GTP_LOAD_CNTRL_INFO_MAX_BUF_LEN);
+      }
+
+      RETVAL buildIe(IeParamLst *pBuf) {return ROK;}
+
+      RETVAL buildIe(const GtpIeLst *pIeLst)
+      {
+         return buildGroupedIeHelper(pIeLst, m_val, GTP_LOAD_CNTRL_INFO_MAX_BUF_LEN);
+      }
+
+      GtpLength_t encode(U8 *outbuf)
+      {
+         return encodeHelper(m_val, outbuf);
+      }
+
+      GtpLength_t decode(const U8 *inbuf)
+      {
+         return decodeHelper(inbuf, m_val, GTP_LOAD_CNTRL_INFO_MAX_BUF_LEN);
+      }
+
+      BOOL   isGroupedIe() {return TRUE;}
+};
+
 #endif
@@ -81,6 +81,12 @@ class GtpIe
       RETVAL buildIeHelper(const HexString *inbuf, U8 *outbuf,\
             GtpLength_t maxIeLen);
 
+      /* Helper function used by grouped IE classes to build IE from
+       * the list of IEs within it, the list is freed
+       */
+      RETVAL buildGroupedIeHelper(const GtpIeLst *pIeLst, U8 *outbuf,\
+            GtpLength_t maxIeLen);
+
 };
 
 #endif
@@ -51,6 +51,15 @@ GtpMsg::GtpMsg(Buffer *pBuf)
 
    decodeHdr(pBuf->pVal);
 
+   /* the IEs are walked up to the length in the header, a header claiming
+    * more octets than were received is cut to the datagram
+    */
+   if ((U32)m_msgHdr.len + GTPC_HDR_MAND_LEN > pBuf->len)
+   {
+      m_msgHdr.len = (pBuf->len > GTPC_HDR_MAND_LEN) ? \
+         pBuf->len - GTPC_HDR_MAND_LEN : 0;
+   }
+
    if (pBuf->len <= GTP_MSG_BUF_LEN)
    {
       if (GSIM_CHK_MASK(m_msgHdr.pres, GTP_MSG_T_BIT_PRES))
@@ -205,9 +214,8 @@ RETVAL GtpMsg::decode()
 {
    LOG_ENTERFN();
 
-   U8 *pMsgBuf = m_gtpMsgBuf;
-   GtpLength_t len = m_msgHdr.len - (GTP_TEID_LEN + GTPC_HDR_SEQN_LEN + \
-         GTPC_HDR_SPARE_LEN);
+   U32 len      = 0;
+   U8  *pMsgBuf = getIeBuf(&len);
    while (len > 0)
    {
       GtpIeType_t    ieType = GTP_IE_RESERVED;
@@ -220,9 +228,24 @@ RETVAL GtpMsg::decode()
          updateBearerCount(ieInst);
       }
 
-      GtpIe *pIe = GtpIe::createGtpIe(ieType, ieInst);
-      U32 ieLen = pIe->decode(pMsgBuf);
-      m_ieLst.push_back(pIe);
+      U32   ieLen = 0;
+      GtpIe *pIe  = GtpIe::createGtpIe(ieType, ieInst);
+      if (NULL != pIe)
+      {
+         ieLen = pIe->decode(pMsgBuf);
+         m_ieLst.push_back(pIe);
+      }
+      else
+      {
+         /* IEs without a codec are skipped */
+         GTP_GET_IE_LEN(pMsgBuf, ieLen);
+         ieLen += GTP_IE_HDR_LEN;
+      }
+
+      if (ieLen > len)
+      {
+         break;
+      }
 
       pMsgBuf += ieLen;
       len -= ieLen;
@@ -278,10 +301,15 @@ VOID GtpMsg::decodeHdr(U8 *pBuf)
 {
    LOG_ENTERFN();
 
+   /* the header defaults to carrying a TEID, echo messages do not */
    if (GTP_CHK_T_BIT_PRESENT(pBuf))
    {
       GSIM_SET_MASK(m_msgHdr.pres, GTP_MSG_T_BIT_PRES);
    }
+   else
+   {
+      GSIM_UNSET_MASK(m_msgHdr.pres, GTP_MSG_T_BIT_PRES);
+   }
 
    if (GTP_CHK_P_BIT_PRESENT(pBuf))
    {
@@ -339,6 +367,25 @@ GtpIe* GtpMsg::getIe(GtpIeType_t  ieType, GtpInstance_t  inst, U32 occurance)
    LOG_EXITFN(pIe);
 }
 
+/**
+ * @brief
+ *    Returns the encoded IEs of a received message
+ *
+ * @param pLen
+ *    length of the IEs, bounded by the message buffer
+ */
+U8* GtpMsg::getIeBuf(U32 *pLen)
+{
+   /* the message length leaves out the first 4 octets of the header */
+   U32 len    = m_msgHdr.len + GTPC_HDR_MAND_LEN;
+   U32 hdrLen = GSIM_CHK_MASK(m_msgHdr.pres, GTP_MSG_T_BIT_PRES) ? \
+         GTP_MSG_HDR_LEN : GTP_MSG_HDR_LEN_WITHOUT_TEID;
+
+   len   = (len > hdrLen) ? len - hdrLen : 0;
+   *pLen = (len > GTP_MSG_BUF_LEN) ? GTP_MSG_BUF_LEN : len;
+   return m_gtpMsgBuf;
+}
+
 /**
  * @brief
  *    Returns the buffer pointer at which the IE indicated by ietype, instance
@@ -363,12 +410,17 @@ U32               occr
    U8          *pIeBufPtr = NULL;
    GtpIeHdr    ieHdr;
    U32         cnt = 0;
-   GtpLength_t len = m_msgHdr.len;
-   U8          *pBuf = m_gtpMsgBuf;
+   U32         len = 0;
+   U8          *pBuf = getIeBuf(&len);
 
-   while (len)
+   while (len >= GTP_IE_HDR_LEN)
    {
       decIeHdr(pBuf, &ieHdr);
+      if ((U32)ieHdr.len + GTP_IE_HDR_LEN > len)
+      {
+         break;
+      }
+
       if (ieHdr.ieType == ieType && ieHdr.instance == inst)
       {
          cnt++;
@@ -386,6 +438,27 @@ U32               occr
    LOG_EXITFN(pIeBufPtr);
 }
 
+/**
+ * @brief
+ *    Cause value of the message, read in place without decoding the IEs
+ *
+ * @return
+ *    GTP_CAUSE_NONE if the message carries no Cause IE
+ */
+GtpCause_t GtpMsg::getCause()
+{
+   GtpIeHdr ieHdr;
+   U8       *pIe = getIeBufPtr(GTP_IE_CAUSE, 0, 1);
+
+   if (NULL == pIe)
+   {
+      return GTP_CAUSE_NONE;
+   }
+
+   decIeHdr(pIe, &ieHdr);
+   return (0 == ieHdr.len) ? GTP_CAUSE_NONE : pIe[GTP_IE_HDR_LEN];
+}
+
 VOID GtpMsg::setImsi(GtpImsiKey *pImsiKey)
 {
    LOG_ENTERFN();
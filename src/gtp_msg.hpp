@@ -36,6 +36,8 @@ class GtpMsg
       GtpIe*            getIe(GtpIeType_t, GtpInstance_t, U32);
       U32               getIeCount(GtpIeType_t ieType, GtpInstance_t inst);
       U8*               getIeBufPtr(GtpIeType_t, GtpInstance_t, U32);
+      U8*               getIeBuf(U32 *pLen);
+      GtpCause_t        getCause();
       GtpSeqNumber_t    seqNumber() {return m_msgHdr.seqN;}
       VOID              setImsi(GtpImsiKey*);
       GtpTeid_t         getTeid();
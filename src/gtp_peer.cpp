@@ -15,6 +15,7 @@
  */  
 
 #include <vector>
+#include <unordered_map>
 using std::vector;
 
 #include "types.hpp"
@@ -48,20 +49,37 @@ PUBLIC BOOL isOldReq(PeerData *peer, Buffer *gtpMsg)
    LOG_EXITFN(isOld);
 }
 
+/**
+ * @return
+ *    index of the peer in the peer table, getNumPeers() if not present
+ */
+PUBLIC U32 getPeerIndex(IPEndPoint *ep)
+{
+   U32 i = 0;
+
+   for (i = 0; i < g_peerData.size(); i++)
+   {
+      PeerData *peer = g_peerData[i];
+      if ((peer->peerEp.ipAddr.u.ipv4Addr.addr == \
+         ep->ipAddr.u.ipv4Addr.addr) && (peer->peerEp.port == ep->port))
+      {
+         break;
+      }
+   }
+
+   return i;
+}
+
 PRIVATE PeerData *findPeer(IPEndPoint *ep)
 {
    LOG_ENTERFN();
 
    PeerData *peerData = NULL;
+   U32      indx = getPeerIndex(ep);
 
-   for (U32 i = 0; i < g_peerData.size(); i++)
+   if (indx < g_peerData.size())
    {
-      peerData = g_peerData[i];
-      if ((peerData->peerEp.ipAddr.u.ipv4Addr.addr == \
-         ep->ipAddr.u.ipv4Addr.addr) &&(peerData->peerEp.port == ep->port))
-      {
-         break;
-      }
+      peerData = g_peerData[indx];
    }
 
    LOG_EXITFN(peerData);
@@ -93,6 +111,8 @@ PeerData *addPeerData(IPEndPoint ep)
    peerData = new PeerData;
    peerData->peerEp = ep;
    peerData->seqNumber = 0;
+   MEMSET(&peerData->overload, 0, sizeof(PeerOverload_t));
+   MEMSET(&peerData->rto, 0, sizeof(PeerRto_t));
    g_peerData.push_back(peerData);
 
    return peerData;
@@ -110,7 +130,7 @@ PUBLIC GtpSeqNumber_t generateSeqNum(IPEndPoint *ep, GtpMsgCategory_t cat)
 {
    LOG_ENTERFN();
 
-   PeerData *peer = findPeer(ep);
+   PeerData *peer = addPeerData(*ep);
    GtpSeqNumber_t seqNumber = ++(peer->seqNumber);
    if (GTP_MSG_CAT_CMD == cat)
       GTP_SET_SEQN_MSB(seqNumber);
@@ -118,10 +138,95 @@ PUBLIC GtpSeqNumber_t generateSeqNum(IPEndPoint *ep, GtpMsgCategory_t cat)
    LOG_EXITFN(seqNumber);
 }
 
+/**
+ * @brief Adds an outstanding request sent to the peer to the peer's
+ *    transaction table
+ *
+ * @param ep
+ * @param seqNumber
+ * @param pUeSsn
+ */
+PUBLIC VOID addPeerTrans(IPEndPoint *ep, GtpSeqNumber_t seqNumber,\
+      UeSession *pUeSsn)
+{
+   LOG_ENTERFN();
+
+   PeerData *peer = addPeerData(*ep);
+   peer->transMap[seqNumber] = pUeSsn;
+
+   LOG_EXITVOID();
+}
+
+/**
+ * @brief Finds the session waiting for a response with the sequence number
+ *    from the peer
+ *
+ * @param ep
+ * @param seqNumber
+ *
+ * @return session which sent the request, NULL if no such request is
+ *    outstanding
+ */
+PUBLIC UeSession *findPeerTrans(IPEndPoint *ep, GtpSeqNumber_t seqNumber)
+{
+   LOG_ENTERFN();
+
+   UeSession *pUeSsn = NULL;
+   PeerData  *peer = findPeer(ep);
+   if (NULL != peer)
+   {
+      PeerTransMapItr itr = peer->transMap.find(seqNumber);
+      if (itr != peer->transMap.end())
+      {
+         pUeSsn = itr->second;
+      }
+   }
+
+   LOG_EXITFN(pUeSsn);
+}
+
+/**
+ * @brief Removes the outstanding request from the peer's transaction table,
+ *    the entry is removed only if it belongs to the session
+ *
+ * @param ep
+ * @param seqNumber
+ * @param pUeSsn
+ */
+PUBLIC VOID delPeerTrans(IPEndPoint *ep, GtpSeqNumber_t seqNumber,\
+      UeSession *pUeSsn)
+{
+   LOG_ENTERFN();
+
+   PeerData *peer = findPeer(ep);
+   if (NULL != peer)
+   {
+      PeerTransMapItr itr = peer->transMap.find(seqNumber);
+      if (itr != peer->transMap.end() && itr->second == pUeSsn)
+      {
+         peer->transMap.erase(itr);
+      }
+   }
+
+   LOG_EXITVOID();
+}
+
+PUBLIC U32 getNumPeers()
+{
+   return g_peerData.size();
+}
+
+PUBLIC PeerData *getPeer(U32 indx)
+{
+   return g_peerData[indx];
+}
+
 PUBLIC VOID deletePeerTable()
 {
    for (U32 i = 0; i < g_peerData.size(); i++)
    {
       delete g_peerData[i];
    }
+
+   g_peerData.clear();
 }
@@ -17,10 +17,49 @@
 #ifndef __GTP_PEER__
 #define __GTP_PEER_
 
+class UeSession;
+
+/* outstanding requests sent to a peer, keyed by the sequence number of the
+ * request. responses are matched to their transaction using the sequence
+ * number alone, so that responses carrying TEID 0 (e.g. rejection of a
+ * Create Session Request) reach the session that sent the request
+ */
+typedef std::unordered_map<GtpSeqNumber_t, UeSession*> PeerTransMap;
+typedef PeerTransMap::iterator PeerTransMapItr;
+
+/* overload and load control state advertised by the peer (TS 29.274
+ * section 12.2/12.3), only node level information is maintained
+ */
+typedef struct
+{
+   BOOL              ociPres;
+   U32               ociSeq;
+   U8                ociMetric;     /* requested reduction, 0 - 100 % */
+   Time_t            ociExpiry;     /* msec, GTP_OVERLOAD_NO_EXPIRY if none */
+   BOOL              lciPres;
+   U32               lciSeq;
+   U8                lciMetric;     /* load of the peer, 0 - 100 % */
+   U32               credit;        /* admission credit of loss algorithm */
+   Counter           numThrottled;
+} PeerOverload_t;
+
+/* retransmission timeout estimated from the response times of the peer,
+ * RFC 6298 style, in usec
+ */
+typedef struct
+{
+   U64               srtt;          /* 0 until the first sample */
+   U64               rttvar;
+   U64               rto;
+} PeerRto_t;
+
 typedef struct
 {
    IPEndPoint        peerEp;
    GtpSeqNumber_t    seqNumber;
+   PeerTransMap      transMap;
+   PeerOverload_t    overload;
+   PeerRto_t         rto;
 } PeerData;
 
 typedef vector<PeerData*> PeerDataVec;
@@ -29,5 +68,13 @@ PUBLIC BOOL isOldReq(PeerData *peer, Buffer *gtpMsg);
 PeerData *addPeerData(IPEndPoint ep);
 VOID updatePeerSeqNumber(IPEndPoint *ep, GtpSeqNumber_t seqNumber);
 PUBLIC GtpSeqNumber_t generateSeqNum(IPEndPoint *peer, GtpMsgCategory_t cat);
+PUBLIC VOID addPeerTrans(IPEndPoint *ep, GtpSeqNumber_t seqNumber,\
+      UeSession *pUeSsn);
+PUBLIC UeSession *findPeerTrans(IPEndPoint *ep, GtpSeqNumber_t seqNumber);
+PUBLIC VOID delPeerTrans(IPEndPoint *ep, GtpSeqNumber_t seqNumber,\
+      UeSession *pUeSsn);
+PUBLIC U32 getNumPeers();
+PUBLIC PeerData *getPeer(U32 indx);
+PUBLIC U32 getPeerIndex(IPEndPoint *ep);
 PUBLIC VOID deletePeerTable();
 #endif
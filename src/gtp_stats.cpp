@@ -63,6 +63,7 @@ do \
 
 // GTP Statistics counters
 static Counter  s_gsimStats[GSIM_STAT_MAX];
+static Counter  s_gsimCauses[GTP_CAUSE_MAX];
 static Stats   *s_pStats = NULL;
 
 /**
@@ -141,5 +142,106 @@ VOID Stats::decStats(GtpStat_t statsType)
    --s_gsimStats[statsType];
 }
 
+VOID Stats::setStats(GtpStat_t statsType, Counter value)
+{
+   s_gsimStats[statsType] = value;
+}
+
+VOID Stats::incCause(GtpCause_t cause)
+{
+   ++s_gsimCauses[cause];
+}
+
+VOID Stats::setCause(GtpCause_t cause, Counter value)
+{
+   s_gsimCauses[cause] = value;
+}
+
+Counter Stats::getCause(GtpCause_t cause)
+{
+   return s_gsimCauses[cause];
+}
+
+U32 Stats::getTopRejects(GtpCause_t *pCauses, U32 max)
+{
+   U32 num = 0;
+
+   for (U32 cause = GTP_CAUSE_REJECT_MIN; cause <= GTP_CAUSE_REJECT_MAX;
+        cause++)
+   {
+      if (0 == s_gsimCauses[cause])
+      {
+         continue;
+      }
+
+      /* insertion into the short sorted list */
+      U32 pos = num;
+      while (pos > 0 && s_gsimCauses[pCauses[pos - 1]] < s_gsimCauses[cause])
+      {
+         if (pos < max)
+         {
+            pCauses[pos] = pCauses[pos - 1];
+         }
+         pos--;
+      }
+
+      if (pos < max)
+      {
+         pCauses[pos] = (GtpCause_t)cause;
+         num = (num < max) ? num + 1 : max;
+      }
+   }
+
+   return num;
+}
+
+/**
+ * @brief
+ *    Prints and logs the distribution of the cause values of the responses
+ *    received, per procedure
+ */
+VOID Stats::printCauseStats()
+{
+   Scenario *pScn = Scenario::getInstance();
+
+   for (U32 i = 0; i < pScn->m_procSeq.size(); i++)
+   {
+      Procedure *proc = pScn->m_procSeq.at(i);
+      if (PROC_TYPE_WAIT == proc->type() ||
+          JOB_TYPE_RECV != proc->m_trigMsg->type() ||
+          0 == proc->m_trigMsg->m_numRcv)
+      {
+         continue;
+      }
 
+      /* the cluster coordinator only has the totals of all procedures */
+      Job     *pJob   = proc->m_trigMsg;
+      Counter numRsp  = 0;
+      for (U32 cause = 0; cause < GTP_CAUSE_MAX; cause++)
+      {
+         numRsp += pJob->m_numCause[cause];
+      }
 
+      if (0 == numRsp)
+      {
+         continue;
+      }
+
+      std::cout << "Causes " << pJob->m_msgName << ":";
+      for (U32 cause = 0; cause < GTP_CAUSE_MAX; cause++)
+      {
+         if (0 == pJob->m_numCause[cause])
+         {
+            continue;
+         }
+
+         const S8 *pName = (GTP_CAUSE_NONE == cause) ? "No Cause IE" :
+            gtpGetCauseName((GtpCause_t)cause);
+         std::cout << " " << cause << " " << (pName ? pName : "Unknown")
+            << " " << pJob->m_numCause[cause];
+         LOG_INFO("%s cause [%u] %s, count [%u]", pJob->m_msgName, cause,
+               pName ? pName : "Unknown", pJob->m_numCause[cause]);
+      }
+      std::cout << std::endl;
+   }
+}
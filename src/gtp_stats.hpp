@@ -35,6 +35,10 @@ typedef enum
    GSIM_STAT_NUM_SESSIONS_FAIL,
    GSIM_STAT_UNEXCEPTED_MSG_RECD,
    GSIM_STAT_NUM_DEADCALLS,
+   GSIM_STAT_NUM_REJECTED,
+   GSIM_STAT_NUM_INVALID,
+   GSIM_STAT_NUM_RETRANS_DEFERRED,
+   GSIM_STAT_NUM_SEND_FAILED,       /* messages the transport failed to send */
 
    GSIM_STAT_MAX
 } GtpStat_t;
@@ -52,11 +56,33 @@ class Stats
    void static incStats(GtpStat_t   statType);
    void static decStats(GtpStat_t   statType);
 
+   /**
+    * Overwrites a counter, used to show the totals of the cluster agents
+    */
+   void static setStats(GtpStat_t statType, Counter value);
+
    /**
     * Get the GTP statistics counter values
     */
    Counter static getStats(GtpStat_t statType);
 
+   /**
+    * Cause values of the responses received, of all procedures
+    */
+   void static incCause(GtpCause_t cause);
+   void static setCause(GtpCause_t cause, Counter value);
+   Counter static getCause(GtpCause_t cause);
+
+   /**
+    * Most frequent rejection causes, most frequent first
+    */
+   U32 static getTopRejects(GtpCause_t *pCauses, U32 max);
+
+   /**
+    * Prints the cause distribution of the responses of each procedure
+    */
+   void static printCauseStats();
+
    /**
     * Destructor
     */
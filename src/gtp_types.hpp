@@ -34,6 +34,7 @@
                                                  * sending a msg */
 #define GTP_MSG_BUF_LEN                   1024
 #define GTP_MAX_BEARERS                   11
+#define GTP_MIN_EBI                       5     /* EBI 0-4 are spare */
 
 typedef U8           GtpVersion_t;
 typedef U32          GtpTeid_t;
@@ -50,6 +51,15 @@ typedef U8           GtpEbi_t;
 typedef U8           GtpArp_t;
 typedef U8           GtpQci_t;
 typedef U8           GtpCause_t;
+
+/* cause values 16-63 accept a request, 64-239 reject it */
+#define GTP_CAUSE_NONE                    0     /* no Cause IE */
+#define GTP_CAUSE_REQ_ACCEPTED            16
+#define GTP_CAUSE_REJECT_MIN              64
+#define GTP_CAUSE_REJECT_MAX              239
+#define GTP_CAUSE_MAX                     256
+#define GTP_CAUSE_IS_REJECT(_c)           ((_c) >= GTP_CAUSE_REJECT_MIN && \
+                                           (_c) <= GTP_CAUSE_REJECT_MAX)
 typedef U8           GtpRecovery_t;
 
 typedef enum
@@ -247,7 +257,7 @@ typedef enum
    GTP_IE_MBMS_TIME_TO_DATA_TRANSFER,
    GTP_IE_RESERVED6,
    GTP_IE_RESERVED7,
-   GTP_IE_RESERVED8,
+   GTP_IE_EPC_TIMER,
    GTP_IE_RESERVED9,
    GTP_IE_TMGI,
    GTP_IE_ADDITIONAL_MM_CNTXT_FOR_SRVCC,
@@ -255,6 +265,10 @@ typedef enum
    GTP_IE_RESERVED10,
    GTP_IE_RESERVED11,
    GTP_IE_SPARE                                 = 163,
+   GTP_IE_OVERLOAD_CNTRL_INFO                   = 180,
+   GTP_IE_LOAD_CNTRL_INFO,
+   GTP_IE_METRIC,
+   GTP_IE_SEQUENCE_NUMBER,
    GTP_IE_PRIVATE_IE                            = 255,
    GTP_IE_MAX
 } GtpIeType_t;
@@ -289,6 +303,16 @@ typedef struct
    GtpLength_t      len;
 } GtpIeHdr;
 
+/* values of received IEs stored in session variables by <store> tags */
+#define GTP_MAX_SSN_VARS                  8
+#define GTP_SSN_VAR_LEN                   31
+
+typedef struct
+{
+   U8               len;     /* 0 until the value is stored */
+   U8               val[GTP_SSN_VAR_LEN];
+} GtpSsnVar_t;
+
 struct GtpMsgHdr 
 {
    U8                pres;
@@ -523,7 +523,7 @@ S8 g_gtpIeName[GTP_IE_MAX][GTP_IE_NAME_LEN] = \
    "mbms_time_to_data_transfer",
    "reserved",
    "reserved",
-   "reserved",
+   "epc_timer",
    "reserved",
    "tmgi",
    "additional_mm_context_for_srvcc",
@@ -547,10 +547,10 @@ S8 g_gtpIeName[GTP_IE_MAX][GTP_IE_NAME_LEN] = \
    "spare",
    "spare",
    "spare",
-   "spare",
-   "spare",
-   "spare",
-   "spare",
+   "oci",
+   "lci",
+   "metric",
+   "seq_number",
    "spare",
    "spare",
    "spare",
@@ -734,6 +734,70 @@ S8* gtpGetMsgName(GtpMsgType_t msgType)
    return pMsgName;
 }
 
+typedef struct
+{
+   GtpCause_t  cause;
+   const S8    *pName;
+} GtpCauseName_t;
+
+/* 3GPP TS 29.274 Table 8.4-1, the causes seen in responses */
+static const GtpCauseName_t g_gtpCauseName[] =
+{
+   {16,  "Request accepted"},
+   {17,  "Partially accepted"},
+   {18,  "New PDN type, network pref"},
+   {19,  "New PDN type, single address"},
+   {64,  "Context not found"},
+   {65,  "Invalid message format"},
+   {66,  "Version not supported"},
+   {67,  "Invalid length"},
+   {68,  "Service not supported"},
+   {69,  "Mandatory IE incorrect"},
+   {70,  "Mandatory IE missing"},
+   {72,  "System failure"},
+   {73,  "No resources available"},
+   {78,  "Missing or unknown APN"},
+   {83,  "PDN type not supported"},
+   {84,  "All dynamic addresses occupied"},
+   {87,  "UE not responding"},
+   {88,  "UE refuses"},
+   {89,  "Service denied"},
+   {90,  "Unable to page UE"},
+   {91,  "No memory available"},
+   {92,  "User authentication failed"},
+   {93,  "APN access denied"},
+   {94,  "Request rejected"},
+   {96,  "IMSI/IMEI not known"},
+   {100, "Remote peer not responding"},
+   {101, "Collision with network request"},
+   {103, "Conditional IE missing"},
+   {107, "Invalid reply from remote peer"},
+   {109, "Invalid peer"},
+   {110, "Temporarily rejected, HO/TAU"},
+   {113, "APN congestion"},
+   {116, "Multiple PDN connections"},
+   {120, "GTP-C entity congestion"},
+   {121, "Late overlapping request"},
+   {122, "Timed out request"},
+};
+
+/**
+ * @brief Returns the name of a cause value, NULL if it is not known
+ */
+const S8* gtpGetCauseName(GtpCause_t cause)
+{
+   for (U32 i = 0; i < sizeof(g_gtpCauseName) / sizeof(g_gtpCauseName[0]);
+        i++)
+   {
+      if (g_gtpCauseName[i].cause == cause)
+      {
+         return g_gtpCauseName[i].pName;
+      }
+   }
+
+   return NULL;
+}
+
 GtpIeType_t gtpGetIeType(const S8   *pIeName)
 {
    for (U32 ieType = GTP_IE_RESERVED; ieType < GTP_IE_MAX; ieType++)
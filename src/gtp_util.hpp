@@ -24,6 +24,7 @@
 #define GTP_MSG_XML_TAG_MAX_LEN  16
 
 S8* gtpGetMsgName(GtpMsgType_t msgType);
+const S8* gtpGetCauseName(GtpCause_t cause);
 GtpIeType_t gtpGetIeType(const S8   *pIeName);
 GtpMsgType_t gtpGetMsgType(const S8 *pXmlMsgTag);
 GtpMsgCategory_t gtpGetMsgCategory(GtpMsgType_t msgType);
@@ -16,6 +16,7 @@
 
 #include <exception>
 #include <list>
+#include <vector>
 
 #include "types.hpp"
 #include "logger.hpp"
@@ -24,7 +25,16 @@
 #include "macros.hpp"
 #include "gtp_types.hpp"
 #include "sim_cfg.hpp"
+#include "task.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
 #include "keyboard.hpp" 
+#include "poller.hpp"
+#include "drain.hpp"
+#include "checkpoint.hpp"
 
 EXTERN RETVAL setupStdinSock();
 
@@ -79,7 +89,8 @@ S32   kbInput
       }
       case 'q':
       {
-         key = KB_KEY_SIM_QUIT;
+         /* drains the sessions first if enabled, quits on a second [q] */
+         requestQuit();
          break;
       }
       case '+':
@@ -102,6 +113,16 @@ S32   kbInput
          Config::getInstance()->decrRate(10);
          break;
       }
+      case 'm':
+      {
+         nextPollMode();
+         break;
+      }
+      case 'k':
+      {
+         takeCheckpoint();
+         break;
+      }
       default:
       {
          LOG_DEBUG("Invalid Keyboard Input");
@@ -0,0 +1,252 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <time.h>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "latency.hpp"
+
+static LatencyHist s_rspTimeHist("Response-Time");
+static LatencyHist s_queueDelayHist("Queueing-Delay");
+static LatencyHist s_rejectTimeHist("Reject-Time");
+
+LatencyHist::LatencyHist(const S8 *pName)
+{
+    m_pName = pName;
+    reset();
+}
+
+VOID LatencyHist::reset()
+{
+    m_count = 0;
+    m_sum   = 0;
+    m_min   = 0;
+    m_max   = 0;
+    MEMSET(m_buckets, 0, sizeof(m_buckets));
+}
+
+VOID LatencyHist::save(LatencyData_t *pData)
+{
+    pData->count = m_count;
+    pData->sum   = m_sum;
+    pData->min   = m_min;
+    pData->max   = m_max;
+    MEMCPY(pData->buckets, m_buckets, sizeof(m_buckets));
+}
+
+/**
+ * @brief
+ *    Adds the samples of another histogram, the buckets of both are equal
+ *    so merging loses no precision
+ */
+VOID LatencyHist::merge(const LatencyData_t *pData)
+{
+    if (0 == pData->count)
+    {
+        return;
+    }
+
+    if (0 == m_count || pData->min < m_min)
+    {
+        m_min = pData->min;
+    }
+
+    if (pData->max > m_max)
+    {
+        m_max = pData->max;
+    }
+
+    m_count += pData->count;
+    m_sum += pData->sum;
+    for (U32 i = 0; i < LAT_NUM_BUCKETS; i++)
+    {
+        m_buckets[i] += pData->buckets[i];
+    }
+}
+
+/**
+ * @brief
+ *    Values below LAT_SUB_BUCKETS have a bucket each, larger values are
+ *    bucketed by their most significant bit and the LAT_SUB_BUCKET_BITS
+ *    bits following it
+ */
+U32 LatencyHist::bucketOf(U64 ns)
+{
+    if (ns < LAT_SUB_BUCKETS)
+    {
+        return (U32)ns;
+    }
+
+    U32 msb   = 63 - __builtin_clzll(ns);
+    U32 shift = msb - LAT_SUB_BUCKET_BITS;
+    return ((shift + 1) << LAT_SUB_BUCKET_BITS) +
+        (U32)((ns >> shift) & (LAT_SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief
+ *    Largest value of the bucket
+ */
+U64 LatencyHist::bucketMax(U32 bucket)
+{
+    if (bucket < LAT_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    U32 shift = (bucket >> LAT_SUB_BUCKET_BITS) - 1;
+    U64 sub   = bucket & (LAT_SUB_BUCKETS - 1);
+    return ((LAT_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+VOID LatencyHist::record(U64 ns)
+{
+    if (0 == m_count || ns < m_min)
+    {
+        m_min = ns;
+    }
+
+    if (ns > m_max)
+    {
+        m_max = ns;
+    }
+
+    m_sum += ns;
+    m_count++;
+    m_buckets[bucketOf(ns)]++;
+}
+
+/**
+ * @brief
+ *    Upper bound of the bucket holding the pct percentile, capped to the
+ *    largest value recorded
+ */
+U64 LatencyHist::percentile(U32 pct)
+{
+    U64 rank = (m_count * pct + 99) / 100;
+    U64 seen = 0;
+
+    for (U32 i = 0; i < LAT_NUM_BUCKETS && rank > 0; i++)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+        {
+            U64 val = bucketMax(i);
+            return (val < m_max) ? val : m_max;
+        }
+    }
+
+    return m_max;
+}
+
+VOID LatencyHist::print(std::ostream &out)
+{
+    out << std::endl << m_pName << ": " << m_count << " samples";
+    if (0 == m_count)
+    {
+        out << std::endl;
+        return;
+    }
+
+    out << ", min " << m_min / 1000 << "us, avg " << mean() / 1000
+        << "us, p50 " << percentile(50) / 1000 << "us, p99 "
+        << percentile(99) / 1000 << "us, max " << m_max / 1000 << "us"
+        << std::endl;
+    out << std::right << std::setw(14) << "< (us)" << std::setw(12)
+        << "Count" << std::setw(10) << "Cum(%)" << std::endl;
+
+    U64 cum = 0;
+    for (U32 i = 0; i < LAT_NUM_BUCKETS; i++)
+    {
+        if (0 == m_buckets[i])
+        {
+            continue;
+        }
+
+        cum += m_buckets[i];
+        out << std::setw(14) << std::fixed << std::setprecision(1)
+            << (bucketMax(i) + 1) / 1000.0 << std::setw(12) << m_buckets[i]
+            << std::setw(10) << std::setprecision(2)
+            << (cum * 100.0) / m_count << std::endl;
+    }
+}
+
+VOID LatencyHist::log()
+{
+    if (0 == m_count)
+    {
+        return;
+    }
+
+    LOG_INFO("%s, %lu samples, min %luus, avg %luus, p50 %luus, p99 %luus, "
+        "max %luus", m_pName, m_count, m_min / 1000, mean() / 1000,
+        percentile(50) / 1000, percentile(99) / 1000, m_max / 1000);
+}
+
+PUBLIC U64 getWallNanoSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ((U64)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+PUBLIC LatencyHist *getRspTimeHist()
+{
+    return &s_rspTimeHist;
+}
+
+PUBLIC LatencyHist *getQueueDelayHist()
+{
+    return &s_queueDelayHist;
+}
+
+PUBLIC LatencyHist *getRejectTimeHist()
+{
+    return &s_rejectTimeHist;
+}
+
+/**
+ * @brief
+ *    Prints the response time and the queueing delay histograms, the
+ *    response time is measured against the kernel receive timestamp so it
+ *    does not include the queueing delay
+ */
+PUBLIC VOID printLatencyStats()
+{
+    s_rspTimeHist.log();
+    s_queueDelayHist.log();
+    s_rejectTimeHist.log();
+
+    if (s_rspTimeHist.count() > 0)
+    {
+        s_rspTimeHist.print(std::cout);
+    }
+
+    if (s_rejectTimeHist.count() > 0)
+    {
+        s_rejectTimeHist.print(std::cout);
+    }
+
+    if (s_queueDelayHist.count() > 0)
+    {
+        s_queueDelayHist.print(std::cout);
+    }
+}
@@ -0,0 +1,104 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LATENCY_HPP_
+#define _LATENCY_HPP_
+
+#include <iostream>
+
+#define LAT_SUB_BUCKET_BITS      2   /* 4 buckets per power of two */
+#define LAT_SUB_BUCKETS          (1 << LAT_SUB_BUCKET_BITS)
+#define LAT_NUM_BUCKETS          (64 * LAT_SUB_BUCKETS)
+
+/**
+ * @brief
+ *    Counters of a histogram, exchanged between the cluster agents and the
+ *    coordinator
+ */
+typedef struct
+{
+    U64         count;
+    U64         sum;
+    U64         min;
+    U64         max;
+    U64         buckets[LAT_NUM_BUCKETS];
+} LatencyData_t;
+
+/**
+ * @brief
+ *    Log-linear histogram of nanosecond latencies, every power of two is
+ *    split into LAT_SUB_BUCKETS buckets so that a bucket is at most 25%
+ *    wide. Recording is a few shifts and an increment
+ */
+class LatencyHist
+{
+   public:
+      LatencyHist(const S8 *pName);
+
+      VOID        record(U64 ns);
+      VOID        reset();
+      VOID        save(LatencyData_t *pData);
+      VOID        merge(const LatencyData_t *pData);
+      U64         count() { return m_count; }
+      U64         min() { return m_min; }
+      U64         max() { return m_max; }
+      U64         mean() { return m_count ? m_sum / m_count : 0; }
+      U64         percentile(U32 pct);
+      VOID        print(std::ostream &out);
+      VOID        log();
+
+   private:
+      U32         bucketOf(U64 ns);
+      U64         bucketMax(U32 bucket);
+
+      const S8    *m_pName;
+      U64         m_count;
+      U64         m_sum;
+      U64         m_min;
+      U64         m_max;
+      U64         m_buckets[LAT_NUM_BUCKETS];
+};
+
+/**
+ * @brief
+ *    Nanoseconds of CLOCK_REALTIME, the clock of the kernel receive
+ *    timestamps
+ */
+EXTERN U64 getWallNanoSeconds();
+
+/**
+ * @brief
+ *    Time from sending a request until the kernel received its response
+ */
+EXTERN LatencyHist *getRspTimeHist();
+
+/**
+ * @brief
+ *    Time a received message waited in the socket queue and the simulator
+ *    before it was processed
+ */
+EXTERN LatencyHist *getQueueDelayHist();
+
+/**
+ * @brief
+ *    Response time of rejected responses, kept apart from the response time
+ *    with --reject-fail
+ */
+EXTERN LatencyHist *getRejectTimeHist();
+
+EXTERN VOID printLatencyStats();
+
+#endif
@@ -90,6 +90,123 @@ int main(int argc, char **argv)
              cxxopts::value<std::uint32_t>());
         options.add_options()
             ("scenario", "Scenario file", cxxopts::value<std::string>());
+        options.add_options()
+            ("replay", "Replays the GTP-C requests of a pcap file instead "\
+             "of running a scenario", cxxopts::value<std::string>());
+        options.add_options()
+            ("replay-speed", "Replay speed factor, 1 (default) keeps the "\
+             "captured pace, 0 replays as fast as possible",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("transport", "GTP-C transport, udp (default), io_uring or "\
+             "packet. Falls back to udp if the transport is not supported",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("sqpoll-idle", "io_uring submission queue polling thread idle "\
+             "time in milli seconds, 0 (default) disables SQPOLL",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("packet-if", "Interface of the packet transport, lo (default)",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("peer-mac", "Destination MAC address of the packet transport, "\
+             "resolved from the ARP cache by default",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("huge-pages", "Back the session, tunnel, tombstone and buffer "\
+             "pools with 1g or 2m huge pages, falling back to smaller pages. "\
+             "4k uses small pages, off (default) allocates from the heap",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("mem-pool-size", "Size of each memory pool in MB, 64 (default)",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("numa-node", "NUMA node of the memory pools, the node of the "\
+             "simulator thread by default",
+             cxxopts::value<std::int32_t>());
+        options.add_options()
+            ("sched-cpu", "Pin the scheduler thread, which also runs the "\
+             "display and logging, to the CPU. Not pinned by default",
+             cxxopts::value<std::int32_t>());
+        options.add_options()
+            ("worker-cpus", "CPU list, e.g. 2-3,6, the worker threads are "\
+             "pinned to in turns. Not pinned by default",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("poll-mode", "interrupt (default) blocks until a message "\
+             "arrives or a task is due, busy spins on non-blocking reads, "\
+             "auto spins while the receive rate is above --busy-poll-rate",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("busy-poll", "Microseconds the device queue is busy polled per "\
+             "read in busy mode (SO_BUSY_POLL), 50 (default), 0 disables",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("busy-poll-rate", "Received messages per second above which the "\
+             "auto poll mode spins, 20000 (default)",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("drain-rate", "Sessions per second torn down on quit, new "\
+             "sessions are stopped and procedures in flight completed "\
+             "first. A second quit exits at once. 0 (default) quits "\
+             "without tearing down", cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("drain-from", "Request of the scenario starting the teardown "\
+             "of a drained session, dsreq (default)",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("checkpoint", "File the established sessions are checkpointed "\
+             "to, in the background on the [k] key or every "\
+             "--checkpoint-intvl seconds", cxxopts::value<std::string>());
+        options.add_options()
+            ("checkpoint-intvl", "Seconds between checkpoints, 0 (default) "\
+             "checkpoints on demand only", cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("restore", "Checkpoint file the sessions are restored from at "\
+             "start, the scenario continues from their saved procedure",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("reject-fail", "Responses with a rejection cause fail their "\
+             "session and are timed apart from the accepted responses");
+        options.add_options()
+            ("ignore-overload", "Keep the configured session rate when the "\
+             "peer advertises overload, the overload is still reported");
+        options.add_options()
+            ("adaptive-rto", "Retransmission timeout estimated from the "\
+             "response times of each peer, bounded by the T3 timer, with "\
+             "a randomized backoff of the retransmissions");
+        options.add_options()
+            ("retrans-rate", "Retransmissions per second of all sessions, "\
+             "retransmissions over the budget are deferred. 0 (default) "\
+             "is unlimited", cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("trace-sample", "Every n'th session records the timestamps of "\
+             "its procedure steps, written as a Chrome trace on exit. 0 "\
+             "(default) traces no session", cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("trace-file", "Chrome trace file of the sampled sessions, "\
+             "<pid>_trace.json (default)", cxxopts::value<std::string>());
+        options.add_options()
+            ("stats-shm", "Name of the POSIX shared memory segment the "\
+             "statistics are published to, read with gsim-stat",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("stats-shm-intvl", "Milliseconds between updates of the "\
+             "statistics segment, 100 (default)",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("cluster-agents", "Run as the coordinator of N agents, the "\
+             "agents get disjoint IMSI and TEID ranges and a share of the "\
+             "session rate. Local agents are started unless --cluster-listen "\
+             "is given", cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("cluster-listen", "Coordinator address the agents attach to, "\
+             "a unix socket path or host:port",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("cluster-coordinator", "Run as an agent of the coordinator at "\
+             "this address, a unix socket path or host:port",
+             cxxopts::value<std::string>());
         options.add_options()
              ("help", "Print help and exit");
         // clang-format on
@@ -0,0 +1,354 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "gtp_types.hpp"
+#include "sim_cfg.hpp"
+#include "mempool.hpp"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+#define MEM_MAP_HUGE_2M (21 << MAP_HUGE_SHIFT)
+#define MEM_MAP_HUGE_1G (30 << MAP_HUGE_SHIFT)
+
+static MemPool *s_pMemPools[MEM_POOL_MAX]  = {NULL};
+static BOOL     s_poolFailed[MEM_POOL_MAX] = {FALSE};
+static U64      s_pageSize = 0;            /* 0 when pools are disabled */
+static U64      s_poolSize = 0;
+static S32      s_node     = MEM_NODE_ANY;
+
+/**
+ * @brief
+ *    NUMA node of the CPU the calling thread runs on
+ */
+PRIVATE S32 localNode()
+{
+    U32 cpu  = 0;
+    U32 node = 0;
+
+    if (0 != syscall(SYS_getcpu, &cpu, &node, NULL))
+    {
+        return MEM_NODE_ANY;
+    }
+
+    return (S32)node;
+}
+
+MemPool::MemPool(const S8 *pName, U32 objSize)
+{
+    /* free objects are linked through their first word */
+    m_pName       = pName;
+    m_objSize     = (objSize + sizeof(VOID *) - 1) & ~(sizeof(VOID *) - 1);
+    m_pBase       = NULL;
+    m_pEnd        = NULL;
+    m_pNext       = NULL;
+    m_pFreeLst    = NULL;
+    m_mapSize     = 0;
+    m_pageSize    = 0;
+    m_thp         = FALSE;
+    m_node        = MEM_NODE_ANY;
+    m_numObjs     = 0;
+    m_numUsed     = 0;
+    m_numOverflow = 0;
+}
+
+MemPool::~MemPool()
+{
+    if (NULL != m_pBase)
+    {
+        munmap(m_pBase, m_mapSize);
+    }
+}
+
+/**
+ * @brief
+ *    Maps the pool with the requested page size, falling back to 2 MB
+ *    huge pages and then to small pages with transparent huge pages
+ *
+ * @return start of the mapping, NULL on failure
+ */
+U8 *MemPool::mapRegion(U64 size, U64 pageSize)
+{
+    const U64 sizes[] = {MEM_PAGE_SIZE_1G, MEM_PAGE_SIZE_2M};
+    const S32 flags[] = {MEM_MAP_HUGE_1G, MEM_MAP_HUGE_2M};
+
+    for (U32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        if (sizes[i] > pageSize)
+        {
+            continue;
+        }
+
+        U64   mapSize = (size + sizes[i] - 1) & ~(sizes[i] - 1);
+        VOID *p       = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | flags[i], -1, 0);
+        if (MAP_FAILED != p)
+        {
+            m_mapSize  = mapSize;
+            m_pageSize = sizes[i];
+            return (U8 *)p;
+        }
+
+        LOG_ERROR("Pool %s, %lu MB of %s pages unavailable, %s", m_pName,
+            mapSize >> 20, (sizes[i] == MEM_PAGE_SIZE_1G) ? "1G" : "2M",
+            strerror(errno));
+    }
+
+    U64   mapSize = (size + MEM_PAGE_SIZE_4K - 1) & ~(MEM_PAGE_SIZE_4K - 1);
+    VOID *p       = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (MAP_FAILED == p)
+    {
+        LOG_ERROR("Pool %s, mapping %lu bytes, %s", m_pName, mapSize,
+            strerror(errno));
+        return NULL;
+    }
+
+    m_mapSize  = mapSize;
+    m_pageSize = MEM_PAGE_SIZE_4K;
+    if (pageSize > MEM_PAGE_SIZE_4K)
+    {
+        m_thp = (0 == madvise(p, mapSize, MADV_HUGEPAGE));
+    }
+
+    return (U8 *)p;
+}
+
+/**
+ * @brief
+ *    Maps size bytes for the pool on the NUMA node. Pages are only
+ *    preferred from the node, when it runs out of memory the kernel
+ *    allocates from other nodes
+ *
+ * @param size
+ * @param pageSize 4K, 2M or 1G
+ * @param node NUMA node, MEM_NODE_ANY for the local node of the caller
+ */
+RETVAL MemPool::init(U64 size, U64 pageSize, S32 node)
+{
+    LOG_ENTERFN();
+
+    m_pBase = mapRegion(size, pageSize);
+    if (NULL == m_pBase)
+    {
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_node = (MEM_NODE_ANY == node) ? localNode() : node;
+    if (MEM_NODE_ANY != m_node)
+    {
+        unsigned long mask = 1UL << m_node;
+        if (0 != syscall(SYS_mbind, m_pBase, m_mapSize, MPOL_PREFERRED, &mask,
+                sizeof(mask) * 8, 0))
+        {
+            LOG_ERROR("Pool %s, binding to node %d, %s", m_pName, m_node,
+                strerror(errno));
+        }
+    }
+
+    m_numObjs = m_mapSize / m_objSize;
+    m_pEnd    = m_pBase + m_numObjs * m_objSize;
+    m_pNext   = m_pBase;
+
+    LOG_EXITFN(ROK);
+}
+
+VOID *MemPool::alloc()
+{
+    VOID *p = m_pFreeLst;
+
+    if (NULL != p)
+    {
+        m_pFreeLst = *(VOID **)p;
+    }
+    else if (m_pNext < m_pEnd)
+    {
+        p = m_pNext;
+        m_pNext += m_objSize;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    m_numUsed++;
+    return p;
+}
+
+VOID MemPool::release(VOID *p)
+{
+    *(VOID **)p = m_pFreeLst;
+    m_pFreeLst  = p;
+    m_numUsed--;
+}
+
+/**
+ * @brief
+ *    Node the first page of the pool is placed on, the requested node
+ *    until the pool is used
+ */
+S32 MemPool::node()
+{
+    S32 node = m_node;
+
+    if (m_pNext > m_pBase)
+    {
+        S32 actual = 0;
+        if (0 == syscall(SYS_get_mempolicy, &actual, NULL, 0, m_pBase,
+                MPOL_F_NODE | MPOL_F_ADDR))
+        {
+            node = actual;
+        }
+    }
+
+    return node;
+}
+
+/**
+ * @brief
+ *    Enables the session, tunnel, tombstone and buffer pools when huge
+ *    pages are configured, without pools the objects are allocated from
+ *    the heap. A pool is created on its first allocation, so it is placed
+ *    on the node of the thread which owns it
+ */
+PUBLIC RETVAL initMemPools()
+{
+    LOG_ENTERFN();
+
+    Config *pCfg = Config::getInstance();
+
+    s_pageSize = pCfg->getHugePageSize();
+    s_poolSize = (U64)pCfg->getMemPoolSize() << 20;
+    s_node     = pCfg->getNumaNode();
+
+    LOG_EXITFN(ROK);
+}
+
+PRIVATE MemPool *createMemPool(MemPoolId_t id, size_t size)
+{
+    const S8 *names[MEM_POOL_MAX] = {"session", "tunnel", "tombstone",
+        "buffer"};
+
+    s_poolFailed[id] = TRUE;
+    if (MEM_POOL_BUFFER == id)
+    {
+        size = MEM_POOL_BUF_SIZE;
+    }
+
+    MemPool *pPool = new MemPool(names[id], (U32)size);
+    if (ROK != pPool->init(s_poolSize, s_pageSize, s_node))
+    {
+        LOG_ERROR("Pool %s unavailable, using heap", names[id]);
+        delete pPool;
+        return NULL;
+    }
+
+    s_pMemPools[id] = pPool;
+    return pPool;
+}
+
+PUBLIC MemPool *getMemPool(MemPoolId_t id)
+{
+    return s_pMemPools[id];
+}
+
+/**
+ * @brief
+ *    Allocates an object of the pool, from the heap when pools are not
+ *    configured, the object is larger than the pool objects or the pool
+ *    is exhausted
+ */
+PUBLIC VOID *memPoolAlloc(MemPoolId_t id, size_t size)
+{
+    MemPool *pPool = s_pMemPools[id];
+
+    if (NULL == pPool && 0 != s_pageSize && !s_poolFailed[id])
+    {
+        pPool = createMemPool(id, size);
+    }
+
+    if (NULL != pPool && size <= pPool->objSize())
+    {
+        VOID *p = pPool->alloc();
+        if (NULL != p)
+        {
+            return p;
+        }
+
+        pPool->incOverflow();
+    }
+
+    return ::operator new(size);
+}
+
+PUBLIC VOID memPoolFree(MemPoolId_t id, VOID *p)
+{
+    MemPool *pPool = s_pMemPools[id];
+
+    if (NULL != pPool && pPool->owns(p))
+    {
+        pPool->release(p);
+        return;
+    }
+
+    ::operator delete(p);
+}
+
+PUBLIC U8 *bufAlloc(U32 len)
+{
+    return (U8 *)memPoolAlloc(MEM_POOL_BUFFER, len);
+}
+
+PUBLIC VOID bufFree(U8 *p)
+{
+    if (NULL != p)
+    {
+        memPoolFree(MEM_POOL_BUFFER, p);
+    }
+}
+
+PUBLIC std::string memPoolPageStr(MemPool *pPool)
+{
+    std::string str;
+
+    switch (pPool->pageSize())
+    {
+    case MEM_PAGE_SIZE_1G:
+        str = "1G";
+        break;
+    case MEM_PAGE_SIZE_2M:
+        str = "2M";
+        break;
+    default:
+        str = pPool->isThp() ? "4K+THP" : "4K";
+        break;
+    }
+
+    return str;
+}
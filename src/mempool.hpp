@@ -0,0 +1,90 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MEMPOOL_HPP_
+#define _MEMPOOL_HPP_
+
+#define MEM_PAGE_SIZE_4K         (4096ULL)
+#define MEM_PAGE_SIZE_2M         (2ULL * 1024 * 1024)
+#define MEM_PAGE_SIZE_1G         (1024ULL * 1024 * 1024)
+#define MEM_POOL_BUF_SIZE        512   /* larger buffers use the heap */
+#define MEM_NODE_ANY             -1
+
+typedef enum
+{
+   MEM_POOL_SESSION,
+   MEM_POOL_TUNNEL,
+   MEM_POOL_TOMBSTONE,
+   MEM_POOL_BUFFER,
+   MEM_POOL_MAX
+} MemPoolId_t;
+
+/**
+ * @brief
+ *    Fixed size object pool carved out of one contiguous mapping, backed
+ *    by huge pages when available and placed on a NUMA node. Objects are
+ *    handed out from a free list, and from the untouched end of the
+ *    mapping, so that pages are faulted in only as the pool grows
+ */
+class MemPool
+{
+   public:
+      MemPool(const S8 *pName, U32 objSize);
+      ~MemPool();
+
+      RETVAL      init(U64 size, U64 pageSize, S32 node);
+      VOID        *alloc();
+      VOID        release(VOID *p);
+      inline BOOL owns(const VOID *p)
+      {
+         return ((const U8 *)p >= m_pBase && (const U8 *)p < m_pEnd);
+      }
+
+      const S8    *name() { return m_pName; }
+      U32         objSize() { return m_objSize; }
+      U64         pageSize() { return m_pageSize; }
+      BOOL        isThp() { return m_thp; }
+      S32         node();
+      U64         numObjs() { return m_numObjs; }
+      U64         numUsed() { return m_numUsed; }
+      U64         numOverflow() { return m_numOverflow; }
+      VOID        incOverflow() { m_numOverflow++; }
+
+   private:
+      U8          *mapRegion(U64 size, U64 pageSize);
+
+      const S8    *m_pName;
+      U32         m_objSize;
+      U8          *m_pBase;
+      U8          *m_pEnd;
+      U8          *m_pNext;     /* first never allocated object */
+      VOID        *m_pFreeLst;
+      U64         m_mapSize;
+      U64         m_pageSize;
+      BOOL        m_thp;        /* small pages, transparent huge pages */
+      S32         m_node;       /* requested node */
+      U64         m_numObjs;
+      U64         m_numUsed;
+      U64         m_numOverflow;
+};
+
+EXTERN RETVAL     initMemPools();
+EXTERN MemPool    *getMemPool(MemPoolId_t id);
+EXTERN VOID       *memPoolAlloc(MemPoolId_t id, size_t size);
+EXTERN VOID       memPoolFree(MemPoolId_t id, VOID *p);
+EXTERN std::string memPoolPageStr(MemPool *pPool);
+
+#endif
@@ -0,0 +1,240 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "gtp_peer.hpp"
+#include "overload.hpp"
+
+/* timer unit of the EPC Timer IE, TS 29.274 section 8.87 */
+#define EPC_TIMER_UNIT(_v)       ((_v) >> 5)
+#define EPC_TIMER_VAL(_v)        ((_v) & 0x1f)
+#define EPC_TIMER_UNIT_INFINITE  7
+
+typedef struct
+{
+   BOOL     seqPres;
+   U32      seq;
+   BOOL     metricPres;
+   U8       metric;
+   BOOL     timerPres;
+   U8       timer;
+   BOOL     apnPres;
+} OverloadIe_t;
+
+/**
+ * @brief
+ *    Serial number comparison of the Overload and Load Control Sequence
+ *    Numbers, RFC 1982, a peer's sequence number may wrap
+ *
+ * @return
+ *    TRUE if seq is newer than last
+ */
+PRIVATE inline BOOL isSeqNewer(U32 seq, U32 last)
+{
+   return (S32)(seq - last) > 0;
+}
+
+/**
+ * @return
+ *    validity period of the EPC Timer IE in msec
+ */
+PRIVATE Time_t epcTimerMs(U8 timer)
+{
+   Time_t val = EPC_TIMER_VAL(timer);
+
+   switch (EPC_TIMER_UNIT(timer))
+   {
+      case 0:
+         return val * 2 * 1000;
+      case 2:
+         return val * 10 * 60 * 1000;
+      case 3:
+         return val * 60 * 60 * 1000;
+      case 4:
+         return val * 10 * 60 * 60 * 1000;
+      case EPC_TIMER_UNIT_INFINITE:
+         return GTP_OVERLOAD_NO_EXPIRY;
+      default:
+         /* other values are interpreted as multiples of 1 minute */
+         return val * 60 * 1000;
+   }
+}
+
+/**
+ * @brief
+ *    Decodes the IEs of a grouped Overload/Load Control Information IE
+ */
+PRIVATE VOID decOverloadIe(U8 *pBuf, U32 len, OverloadIe_t *pInfo)
+{
+   GtpIeHdr ieHdr;
+
+   MEMSET(pInfo, 0, sizeof(OverloadIe_t));
+   while (len >= GTP_IE_HDR_LEN)
+   {
+      decIeHdr(pBuf, &ieHdr);
+      if ((U32)ieHdr.len + GTP_IE_HDR_LEN > len)
+      {
+         break;
+      }
+
+      U8 *pVal = pBuf + GTP_IE_HDR_LEN;
+      switch (ieHdr.ieType)
+      {
+         case GTP_IE_SEQUENCE_NUMBER:
+            if (ieHdr.len >= 4)
+            {
+               pInfo->seqPres = TRUE;
+               pInfo->seq = ((U32)pVal[0] << 24) | ((U32)pVal[1] << 16) |
+                  ((U32)pVal[2] << 8) | pVal[3];
+            }
+            break;
+         case GTP_IE_METRIC:
+            if (ieHdr.len >= 1 && pVal[0] <= GTP_OVERLOAD_MAX_METRIC)
+            {
+               pInfo->metricPres = TRUE;
+               pInfo->metric = pVal[0];
+            }
+            break;
+         case GTP_IE_EPC_TIMER:
+            if (ieHdr.len >= 1)
+            {
+               pInfo->timerPres = TRUE;
+               pInfo->timer = pVal[0];
+            }
+            break;
+         case GTP_IE_APN:
+            pInfo->apnPres = TRUE;
+            break;
+         default:
+            break;
+      }
+
+      len  -= ieHdr.len + GTP_IE_HDR_LEN;
+      pBuf += ieHdr.len + GTP_IE_HDR_LEN;
+   }
+}
+
+PUBLIC VOID procOverloadInfo(PeerData *pPeer, GtpMsg *pMsg)
+{
+   LOG_ENTERFN();
+
+   PeerOverload_t *pOvld = &pPeer->overload;
+   OverloadIe_t   info;
+   GtpIeHdr       ieHdr;
+   U32            len = 0;
+   U8             *pBuf = pMsg->getIeBuf(&len);
+
+   while (len >= GTP_IE_HDR_LEN)
+   {
+      decIeHdr(pBuf, &ieHdr);
+      if ((U32)ieHdr.len + GTP_IE_HDR_LEN > len)
+      {
+         break;
+      }
+
+      if (GTP_IE_OVERLOAD_CNTRL_INFO == ieHdr.ieType)
+      {
+         decOverloadIe(pBuf + GTP_IE_HDR_LEN, ieHdr.len, &info);
+
+         /* APN level overload control is not supported */
+         if (info.seqPres && info.metricPres && info.timerPres &&
+               !info.apnPres &&
+               (!pOvld->ociPres || isSeqNewer(info.seq, pOvld->ociSeq)))
+         {
+            Time_t period = epcTimerMs(info.timer);
+
+            pOvld->ociPres   = TRUE;
+            pOvld->ociSeq    = info.seq;
+            pOvld->ociMetric = info.metric;
+            pOvld->ociExpiry = (GTP_OVERLOAD_NO_EXPIRY == period) ?
+               GTP_OVERLOAD_NO_EXPIRY : getMilliSeconds() + period;
+            LOG_INFO("Overload Control, Reduction [%d]%%, Sequence [%u]",
+                  info.metric, info.seq);
+         }
+      }
+      else if (GTP_IE_LOAD_CNTRL_INFO == ieHdr.ieType)
+      {
+         decOverloadIe(pBuf + GTP_IE_HDR_LEN, ieHdr.len, &info);
+         if (info.seqPres && info.metricPres && !info.apnPres &&
+               (!pOvld->lciPres || isSeqNewer(info.seq, pOvld->lciSeq)))
+         {
+            pOvld->lciPres   = TRUE;
+            pOvld->lciSeq    = info.seq;
+            pOvld->lciMetric = info.metric;
+         }
+      }
+
+      len  -= ieHdr.len + GTP_IE_HDR_LEN;
+      pBuf += ieHdr.len + GTP_IE_HDR_LEN;
+   }
+
+   LOG_EXITVOID();
+}
+
+PUBLIC U8 getReductionMetric(PeerData *pPeer)
+{
+   PeerOverload_t *pOvld = &pPeer->overload;
+
+   if (!pOvld->ociPres)
+   {
+      return 0;
+   }
+
+   if (GTP_OVERLOAD_NO_EXPIRY != pOvld->ociExpiry &&
+         getMilliSeconds() >= pOvld->ociExpiry)
+   {
+      return 0;
+   }
+
+   return pOvld->ociMetric;
+}
+
+PUBLIC BOOL admitSession(PeerData *pPeer)
+{
+   PeerOverload_t *pOvld = &pPeer->overload;
+   U8             metric = getReductionMetric(pPeer);
+
+   if (0 == metric)
+   {
+      return TRUE;
+   }
+
+   /* every session earns the share of the traffic that may still be sent,
+    * a session is admitted once a full share is collected
+    */
+   pOvld->credit += GTP_OVERLOAD_MAX_METRIC - metric;
+   if (pOvld->credit >= GTP_OVERLOAD_MAX_METRIC)
+   {
+      pOvld->credit -= GTP_OVERLOAD_MAX_METRIC;
+      return TRUE;
+   }
+
+   pOvld->numThrottled++;
+   return FALSE;
+}
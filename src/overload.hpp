@@ -0,0 +1,50 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _OVERLOAD_HPP_
+#define _OVERLOAD_HPP_
+
+class GtpMsg;
+
+#define GTP_OVERLOAD_NO_EXPIRY   ((Time_t)~0)
+#define GTP_OVERLOAD_MAX_METRIC  100
+
+/**
+ * @brief
+ *    Updates the overload and load control state of a peer from the node
+ *    level Overload Control Information and Load Control Information IEs
+ *    of a received message. Information with a sequence number not newer
+ *    than the one already stored is ignored
+ */
+PUBLIC VOID procOverloadInfo(PeerData *pPeer, GtpMsg *pMsg);
+
+/**
+ * @brief
+ *    Loss based admission of a new session towards the peer. The share of
+ *    sessions given by the reduction metric of the peer is rejected
+ *
+ * @return
+ *    FALSE if the session is to be throttled
+ */
+PUBLIC BOOL admitSession(PeerData *pPeer);
+
+/**
+ * @return
+ *    the reduction in %, requested by the peer and not yet expired
+ */
+PUBLIC U8 getReductionMetric(PeerData *pPeer);
+
+#endif
@@ -0,0 +1,631 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <net/if.h>
+#include <net/ethernet.h>
+#include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <linux/if_packet.h>
+#include <vector>
+
+#include "types.hpp"
+#include "macros.hpp"
+#include "logger.hpp"
+#include "error.hpp"
+#include "gtp_types.hpp"
+#include "transport.hpp"
+#include "socket.hpp"
+#include "sim_cfg.hpp"
+#include "packet.hpp"
+
+#define PKT_ETH_HDR_LEN   sizeof(struct ether_header)
+#define PKT_IP_HDR_LEN    sizeof(struct iphdr)
+#define PKT_UDP_HDR_LEN   sizeof(struct udphdr)
+#define PKT_HDRS_LEN      (PKT_ETH_HDR_LEN + PKT_IP_HDR_LEN + PKT_UDP_HDR_LEN)
+#define PKT_TX_DATA_OFF   TPACKET_ALIGN(sizeof(struct tpacket3_hdr))
+#define PKT_MAX_PAYLOAD   (PKT_FRAME_SIZE - PKT_TX_DATA_OFF - PKT_HDRS_LEN)
+#define PKT_DFLT_TTL      64
+#define PKT_MIN_RCVBUF    1
+
+/**
+ * @brief
+ *    Internet checksum of the IPv4 header
+ */
+PRIVATE U16 ipChecksum(const U8 *pHdr, U32 len)
+{
+    U32 sum = 0;
+    for (U32 i = 0; i + 1 < len; i += 2)
+    {
+        sum += (pHdr[i] << 8) | pHdr[i + 1];
+    }
+
+    while (sum >> 16)
+    {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+
+    return (U16)~sum;
+}
+
+PacketTransport::PacketTransport(string ifName, string peerMac)
+{
+    m_ifName     = ifName;
+    m_peerMacStr = peerMac;
+    m_fd         = -1;
+    m_ifIndex    = 0;
+    m_localIp    = 0;
+    m_ipId       = 0;
+    m_pRing      = (U8 *)MAP_FAILED;
+    m_ringSz     = 0;
+    m_pRxRing    = NULL;
+    m_pTxRing    = NULL;
+    m_rxBlock    = 0;
+    m_txFrame    = 0;
+    m_txFrameNr  = 0;
+    m_txPending  = 0;
+    m_numSocks   = 0;
+    m_rxHead     = 0;
+    MEMSET(m_localMac, 0, PKT_ETH_ADDR_LEN);
+    MEMSET(m_peerMac, 0, PKT_ETH_ADDR_LEN);
+    for (U32 i = 0; i < GSIM_MAX_SOCK_CNT; i++)
+    {
+        m_socks[i] = NULL;
+        m_ports[i] = 0;
+    }
+}
+
+PacketTransport::~PacketTransport()
+{
+    if (MAP_FAILED != (VOID *)m_pRing)
+    {
+        munmap(m_pRing, m_ringSz);
+    }
+
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        delete m_socks[i];
+    }
+
+    for (U32 i = m_rxHead; i < m_rxQ.size(); i++)
+    {
+        delete m_rxQ[i];
+    }
+}
+
+S32 PacketTransport::readyFd()
+{
+    return m_fd;
+}
+
+U32 PacketTransport::capabilities()
+{
+    return TRANS_CAP_BATCH_SEND | TRANS_CAP_BATCH_RECV | TRANS_CAP_READY_FD;
+}
+
+const S8 *PacketTransport::name()
+{
+    return "packet";
+}
+
+/**
+ * @brief
+ *    Sets up the TPACKET_V3 RX and TX rings and maps them, the RX ring is
+ *    followed by the TX ring in the mapping
+ */
+RETVAL PacketTransport::setupRings()
+{
+    LOG_ENTERFN();
+
+    S32 version = TPACKET_V3;
+    if (setsockopt(m_fd, SOL_PACKET, PACKET_VERSION, &version,
+            sizeof(version)) < 0)
+    {
+        LOG_ERROR("TPACKET_V3 not supported, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    struct tpacket_req3 req;
+    MEMSET(&req, 0, sizeof(req));
+    req.tp_block_size       = PKT_BLOCK_SIZE;
+    req.tp_block_nr         = PKT_RX_BLOCKS;
+    req.tp_frame_size       = PKT_FRAME_SIZE;
+    req.tp_frame_nr         = (PKT_BLOCK_SIZE / PKT_FRAME_SIZE) * PKT_RX_BLOCKS;
+    req.tp_retire_blk_tov   = PKT_RX_BLOCK_TMO;
+    if (setsockopt(m_fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+    {
+        LOG_ERROR("Packet RX ring setup failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    MEMSET(&req, 0, sizeof(req));
+    req.tp_block_size = PKT_BLOCK_SIZE;
+    req.tp_block_nr   = PKT_TX_BLOCKS;
+    req.tp_frame_size = PKT_FRAME_SIZE;
+    req.tp_frame_nr   = (PKT_BLOCK_SIZE / PKT_FRAME_SIZE) * PKT_TX_BLOCKS;
+    if (setsockopt(m_fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0)
+    {
+        LOG_ERROR("Packet TX ring setup failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_txFrameNr = req.tp_frame_nr;
+    m_ringSz    = (size_t)PKT_BLOCK_SIZE * (PKT_RX_BLOCKS + PKT_TX_BLOCKS);
+    m_pRing     = (U8 *)mmap(NULL, m_ringSz, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, m_fd, 0);
+    if (MAP_FAILED == (VOID *)m_pRing)
+    {
+        LOG_ERROR("Packet ring mmap() failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_pRxRing = m_pRing;
+    m_pTxRing = m_pRing + (size_t)PKT_BLOCK_SIZE * PKT_RX_BLOCKS;
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Destination MAC address of the frames. Taken from the configuration,
+ *    else from the ARP cache for the peer IP address. Loopback interfaces
+ *    use the zero address, any other interface falls back to broadcast
+ */
+RETVAL PacketTransport::resolvePeerMac(IpAddr *pPeerIp)
+{
+    LOG_ENTERFN();
+
+    U32 mac[PKT_ETH_ADDR_LEN];
+
+    if (!m_peerMacStr.empty())
+    {
+        if (PKT_ETH_ADDR_LEN != sscanf(m_peerMacStr.c_str(),
+                                    "%x:%x:%x:%x:%x:%x", &mac[0], &mac[1],
+                                    &mac[2], &mac[3], &mac[4], &mac[5]))
+        {
+            LOG_ERROR("Invalid peer MAC address [%s]", m_peerMacStr.c_str());
+            LOG_EXITFN(RFAILED);
+        }
+
+        for (U32 i = 0; i < PKT_ETH_ADDR_LEN; i++)
+        {
+            m_peerMac[i] = (U8)mac[i];
+        }
+
+        LOG_EXITFN(ROK);
+    }
+
+    struct ifreq ifr;
+    MEMSET(&ifr, 0, sizeof(ifr));
+    STRNCPY(ifr.ifr_name, m_ifName.c_str(), IFNAMSIZ - 1);
+    if (ioctl(m_fd, SIOCGIFFLAGS, &ifr) == 0 && (ifr.ifr_flags & IFF_LOOPBACK))
+    {
+        MEMSET(m_peerMac, 0, PKT_ETH_ADDR_LEN);
+        LOG_EXITFN(ROK);
+    }
+
+    MEMSET(m_peerMac, 0xff, PKT_ETH_ADDR_LEN);
+    if (IP_ADDR_TYPE_V4 != pPeerIp->ipAddrType)
+    {
+        LOG_EXITFN(ROK);
+    }
+
+    FILE *pArp = fopen("/proc/net/arp", "r");
+    if (NULL == pArp)
+    {
+        LOG_EXITFN(ROK);
+    }
+
+    S8 line[256];
+    S8 ip[64];
+    S8 macStr[64];
+    S8 dev[64];
+    while (NULL != fgets(line, sizeof(line), pArp))
+    {
+        if (3 == sscanf(line, "%63s %*s %*s %63s %*s %63s", ip, macStr, dev))
+        {
+            struct in_addr addr;
+            if (inet_pton(AF_INET, ip, &addr) == 1 &&
+                ntohl(addr.s_addr) == pPeerIp->u.ipv4Addr.addr &&
+                m_ifName == dev &&
+                PKT_ETH_ADDR_LEN == sscanf(macStr, "%x:%x:%x:%x:%x:%x",
+                                        &mac[0], &mac[1], &mac[2], &mac[3],
+                                        &mac[4], &mac[5]))
+            {
+                for (U32 i = 0; i < PKT_ETH_ADDR_LEN; i++)
+                {
+                    m_peerMac[i] = (U8)mac[i];
+                }
+                break;
+            }
+        }
+    }
+    fclose(pArp);
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Binds a UDP socket to the connection port, the port the frames of the
+ *    connection are sent from and received on
+ */
+RETVAL PacketTransport::addSocket(IPEndPoint ep)
+{
+    LOG_ENTERFN();
+
+    GSimSocket *pSock = NULL;
+    try
+    {
+        pSock = new GSimSocket(SOCK_TYPE_GTPC, ep, m_numSocks);
+    }
+    catch (ErrCodeEn &e)
+    {
+        LOG_EXITFN(e);
+    }
+
+    RETVAL ret = pSock->bindSocket();
+    if (ROK != ret)
+    {
+        delete pSock;
+        LOG_EXITFN(ret);
+    }
+
+    /* datagrams are read from the RX ring, the socket keeps none */
+    S32 rcvBuf = PKT_MIN_RCVBUF;
+    setsockopt(pSock->fd(), SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+
+    m_ports[m_numSocks]   = pSock->localPort();
+    m_socks[m_numSocks++] = pSock;
+    LOG_EXITFN(ROK);
+}
+
+RETVAL PacketTransport::init()
+{
+    LOG_ENTERFN();
+
+    RETVAL     ret = ROK;
+    IPEndPoint locListnerEp;
+    IPEndPoint locSenderEp;
+
+    Config *pCfg = Config::getInstance();
+
+    if (IP_ADDR_TYPE_V4 != pCfg->getLocalIpAddr()->ipAddrType)
+    {
+        LOG_ERROR("Packet transport supports IPv4 only");
+        LOG_EXITFN(RFAILED);
+    }
+    m_localIp = pCfg->getLocalIpAddr()->u.ipv4Addr.addr;
+
+    m_fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_IP));
+    if (m_fd < 0)
+    {
+        LOG_ERROR("Packet socket creation failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_ifIndex = if_nametoindex(m_ifName.c_str());
+    if (0 == m_ifIndex)
+    {
+        LOG_ERROR("Unknown interface [%s]", m_ifName.c_str());
+        LOG_EXITFN(RFAILED);
+    }
+
+    struct ifreq ifr;
+    MEMSET(&ifr, 0, sizeof(ifr));
+    STRNCPY(ifr.ifr_name, m_ifName.c_str(), IFNAMSIZ - 1);
+    if (ioctl(m_fd, SIOCGIFHWADDR, &ifr) < 0)
+    {
+        LOG_ERROR("Reading MAC address of [%s] failed, [%s]",
+            m_ifName.c_str(), strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+    MEMCPY(m_localMac, ifr.ifr_hwaddr.sa_data, PKT_ETH_ADDR_LEN);
+
+    IpAddr peerIp = pCfg->getRemoteIpAddr();
+    if (ROK != resolvePeerMac(&peerIp) || ROK != setupRings())
+    {
+        LOG_EXITFN(RFAILED);
+    }
+
+    /* frames sent by this socket are not looped back to its RX ring, and
+     * are handed to the driver without going through the qdisc
+     */
+    S32 one = 1;
+    setsockopt(m_fd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &one, sizeof(one));
+    setsockopt(m_fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one));
+
+    struct sockaddr_ll addr;
+    MEMSET(&addr, 0, sizeof(addr));
+    addr.sll_family   = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_IP);
+    addr.sll_ifindex  = m_ifIndex;
+    if (bind(m_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        LOG_ERROR("Packet socket bind failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    locSenderEp.port   = 0;
+    locSenderEp.ipAddr = *pCfg->getLocalIpAddr();
+    ret                = addSocket(locSenderEp);
+    if (ROK != ret)
+    {
+        LOG_FATAL("Binding to GTP local sending Socket");
+        LOG_EXITFN(ret);
+    }
+
+    locListnerEp.port   = pCfg->getLocalGtpcPort();
+    locListnerEp.ipAddr = *pCfg->getLocalIpAddr();
+    ret                 = addSocket(locListnerEp);
+    if (ROK != ret)
+    {
+        LOG_FATAL("Binding to GTP Listener Socket");
+        LOG_EXITFN(ret);
+    }
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Builds the Ethernet, IPv4 and UDP headers followed by the GTP message
+ *    in the frame. The UDP checksum is left zero, which IPv4 permits
+ *
+ * @return
+ *    FALSE if the message does not fit into a frame
+ */
+BOOL PacketTransport::encFrame(U8 *pFrame, TransMsg_t *pMsg, U32 *pLen)
+{
+    U32 payloadLen = pMsg->pBuf->len;
+    if (payloadLen > PKT_MAX_PAYLOAD)
+    {
+        return FALSE;
+    }
+
+    struct ether_header *pEth = (struct ether_header *)pFrame;
+    MEMCPY(pEth->ether_dhost, m_peerMac, PKT_ETH_ADDR_LEN);
+    MEMCPY(pEth->ether_shost, m_localMac, PKT_ETH_ADDR_LEN);
+    pEth->ether_type = htons(ETHERTYPE_IP);
+
+    struct iphdr *pIp = (struct iphdr *)(pFrame + PKT_ETH_HDR_LEN);
+    pIp->version      = 4;
+    pIp->ihl          = PKT_IP_HDR_LEN / 4;
+    pIp->tos          = 0;
+    pIp->tot_len  = htons(PKT_IP_HDR_LEN + PKT_UDP_HDR_LEN + payloadLen);
+    pIp->id       = htons(m_ipId++);
+    pIp->frag_off = htons(IP_DF);
+    pIp->ttl      = PKT_DFLT_TTL;
+    pIp->protocol = IPPROTO_UDP;
+    pIp->check    = 0;
+    pIp->saddr    = htonl(m_localIp);
+    pIp->daddr    = htonl(pMsg->pDst->ipAddr.u.ipv4Addr.addr);
+    pIp->check    = htons(ipChecksum((U8 *)pIp, PKT_IP_HDR_LEN));
+
+    struct udphdr *pUdp =
+        (struct udphdr *)(pFrame + PKT_ETH_HDR_LEN + PKT_IP_HDR_LEN);
+    pUdp->source = htons(m_ports[pMsg->connId]);
+    pUdp->dest   = htons(pMsg->pDst->port);
+    pUdp->len    = htons(PKT_UDP_HDR_LEN + payloadLen);
+    pUdp->check  = 0;
+
+    MEMCPY(pFrame + PKT_HDRS_LEN, pMsg->pBuf->pVal, payloadLen);
+    *pLen = PKT_HDRS_LEN + payloadLen;
+
+    return TRUE;
+}
+
+/**
+ * @brief
+ *    Hands the frames queued in the TX ring to the kernel
+ */
+VOID PacketTransport::flush()
+{
+    if (m_txPending)
+    {
+        if (::send(m_fd, NULL, 0, MSG_DONTWAIT) < 0 && EAGAIN != errno &&
+            ENOBUFS != errno)
+        {
+            LOG_ERROR("Packet TX ring flush failed, [%s]", strerror(errno));
+        }
+
+        m_txPending = 0;
+    }
+}
+
+/**
+ * @brief
+ *    Writes a frame per message into the TX ring and flushes the ring once.
+ *    When the ring is full the queued frames are flushed and the sender
+ *    waits for free frames, messages are dropped if none frees up
+ */
+U32 PacketTransport::send(TransMsg_t *pMsgs, U32 cnt)
+{
+    LOG_ENTERFN();
+
+    U32 numSent = 0;
+    for (U32 i = 0; i < cnt; i++)
+    {
+        TransMsg_t *pMsg = &pMsgs[i];
+        if (pMsg->connId >= m_numSocks ||
+            IP_ADDR_TYPE_V4 != pMsg->pDst->ipAddr.ipAddrType)
+        {
+            LOG_ERROR("Invalid destination, connection id [%d]", pMsg->connId);
+            delete pMsg->pBuf;
+            continue;
+        }
+
+        U8 *pFrame = m_pTxRing + (size_t)m_txFrame * PKT_FRAME_SIZE;
+        struct tpacket3_hdr *pHdr = (struct tpacket3_hdr *)pFrame;
+
+        U32 waits = 0;
+        while (TP_STATUS_AVAILABLE !=
+                   __atomic_load_n(&pHdr->tp_status, __ATOMIC_ACQUIRE) &&
+               waits++ < PKT_MAX_SEND_WAIT)
+        {
+            if (TP_STATUS_WRONG_FORMAT & pHdr->tp_status)
+            {
+                LOG_ERROR("Packet TX frame rejected by the kernel");
+                __atomic_store_n(&pHdr->tp_status, TP_STATUS_AVAILABLE,
+                    __ATOMIC_RELEASE);
+                break;
+            }
+
+            flush();
+            struct pollfd pfd;
+            pfd.fd     = m_fd;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, 1);
+        }
+
+        U32 len = 0;
+        if (TP_STATUS_AVAILABLE != pHdr->tp_status ||
+            !encFrame(pFrame + PKT_TX_DATA_OFF, pMsg, &len))
+        {
+            LOG_ERROR("GTP message dropped, length [%d]", pMsg->pBuf->len);
+            delete pMsg->pBuf;
+            continue;
+        }
+
+        pHdr->tp_len     = len;
+        pHdr->tp_snaplen = len;
+        __atomic_store_n(&pHdr->tp_status, TP_STATUS_SEND_REQUEST,
+            __ATOMIC_RELEASE);
+
+        m_txFrame = (m_txFrame + 1) % m_txFrameNr;
+        m_txPending++;
+        numSent++;
+        delete pMsg->pBuf;
+    }
+
+    flush();
+
+    LOG_EXITFN(numSent);
+}
+
+/**
+ * @brief
+ *    Queues the UDP payload of the frame if it is addressed to one of the
+ *    connection ports, timeNs is the kernel receive time of the frame
+ */
+VOID PacketTransport::decFrame(U8 *pFrame, U32 len, U64 timeNs)
+{
+    if (len < PKT_HDRS_LEN)
+    {
+        return;
+    }
+
+    struct ether_header *pEth = (struct ether_header *)pFrame;
+    struct iphdr *pIp = (struct iphdr *)(pFrame + PKT_ETH_HDR_LEN);
+    if (ETHERTYPE_IP != ntohs(pEth->ether_type) || 4 != pIp->version ||
+        IPPROTO_UDP != pIp->protocol || htonl(m_localIp) != pIp->daddr ||
+        (ntohs(pIp->frag_off) & (IP_MF | IP_OFFMASK)))
+    {
+        return;
+    }
+
+    U32 ipHdrLen = pIp->ihl * 4;
+    if (len < PKT_ETH_HDR_LEN + ipHdrLen + PKT_UDP_HDR_LEN)
+    {
+        return;
+    }
+
+    struct udphdr *pUdp =
+        (struct udphdr *)(pFrame + PKT_ETH_HDR_LEN + ipHdrLen);
+    U16 dstPort = ntohs(pUdp->dest);
+    U32 udpLen  = ntohs(pUdp->len);
+    U32 offset  = PKT_ETH_HDR_LEN + ipHdrLen + PKT_UDP_HDR_LEN;
+    if (udpLen < PKT_UDP_HDR_LEN ||
+        offset + udpLen - PKT_UDP_HDR_LEN > len)
+    {
+        return;
+    }
+
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        if (m_ports[i] == dstPort)
+        {
+            UdpData_t *pMsg = new UdpData_t;
+            BUFFER_CPY(&pMsg->buf, pFrame + offset, udpLen - PKT_UDP_HDR_LEN);
+            pMsg->connId                      = i;
+            pMsg->timeNs                      = timeNs;
+            pMsg->peerEp.ipAddr.ipAddrType    = IP_ADDR_TYPE_V4;
+            pMsg->peerEp.ipAddr.u.ipv4Addr.addr = ntohl(pIp->saddr);
+            pMsg->peerEp.port                 = ntohs(pUdp->source);
+            m_rxQ.push_back(pMsg);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Reads the retired RX ring blocks and returns the queued messages
+ */
+U32 PacketTransport::recv(UdpData_t **ppMsgs, U32 max)
+{
+    for (;;)
+    {
+        struct tpacket_block_desc *pBlock =
+            (struct tpacket_block_desc *)(m_pRxRing +
+                                          (size_t)m_rxBlock * PKT_BLOCK_SIZE);
+        if (!(__atomic_load_n(&pBlock->hdr.bh1.block_status,
+                  __ATOMIC_ACQUIRE) &
+                TP_STATUS_USER))
+        {
+            break;
+        }
+
+        struct tpacket3_hdr *pPkt =
+            (struct tpacket3_hdr *)((U8 *)pBlock +
+                                    pBlock->hdr.bh1.offset_to_first_pkt);
+        for (U32 i = 0; i < pBlock->hdr.bh1.num_pkts; i++)
+        {
+            decFrame((U8 *)pPkt + pPkt->tp_mac, pPkt->tp_snaplen,
+                ((U64)pPkt->tp_sec * 1000000000ULL) + pPkt->tp_nsec);
+            pPkt = (struct tpacket3_hdr *)((U8 *)pPkt + pPkt->tp_next_offset);
+        }
+
+        __atomic_store_n(&pBlock->hdr.bh1.block_status, TP_STATUS_KERNEL,
+            __ATOMIC_RELEASE);
+        m_rxBlock = (m_rxBlock + 1) % PKT_RX_BLOCKS;
+    }
+
+    U32 cnt = 0;
+    while (cnt < max && m_rxHead < m_rxQ.size())
+    {
+        ppMsgs[cnt++] = m_rxQ[m_rxHead++];
+    }
+
+    if (m_rxHead == m_rxQ.size())
+    {
+        m_rxQ.clear();
+        m_rxHead = 0;
+    }
+
+    return cnt;
+}
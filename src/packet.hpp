@@ -0,0 +1,88 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#ifndef _PACKET_HPP_
+#define _PACKET_HPP_
+
+#include <vector>
+
+#define PKT_FRAME_SIZE           2048
+#define PKT_BLOCK_SIZE           (1 << 20)
+#define PKT_RX_BLOCKS            16
+#define PKT_TX_BLOCKS            16
+#define PKT_RX_BLOCK_TMO         1    /* milli seconds */
+#define PKT_ETH_ADDR_LEN         6
+#define PKT_MAX_SEND_WAIT        1000 /* ring full retries before dropping */
+
+/**
+ * @brief
+ *    AF_PACKET transport with TPACKET_V3 mmap'd TX and RX rings. The
+ *    Ethernet, IPv4 and UDP headers are built around the encoded GTP message
+ *    directly in the TX ring frames, a send() call flushes all of its frames
+ *    with one system call. Received frames are read from the RX ring blocks
+ *    and matched to the connections by UDP destination port. UDP sockets
+ *    stay bound to the connection ports, so that the kernel does not answer
+ *    the peer with ICMP port unreachable, their receive buffers are kept
+ *    minimal. Only IPv4 is supported and CAP_NET_RAW is required
+ */
+class PacketTransport: public Transport
+{
+   public:
+      PacketTransport(string ifName, string peerMac);
+      ~PacketTransport();
+
+      RETVAL      init();
+      U32         send(TransMsg_t *pMsgs, U32 cnt);
+      U32         recv(UdpData_t **ppMsgs, U32 max);
+      S32         readyFd();
+      U32         capabilities();
+      const S8    *name();
+
+   private:
+      RETVAL      setupRings();
+      RETVAL      resolvePeerMac(IpAddr *pPeerIp);
+      RETVAL      addSocket(IPEndPoint ep);
+      BOOL        encFrame(U8 *pFrame, TransMsg_t *pMsg, U32 *pLen);
+      VOID        decFrame(U8 *pFrame, U32 len, U64 timeNs);
+      VOID        flush();
+
+      string      m_ifName;
+      string      m_peerMacStr;
+      S32         m_fd;
+      S32         m_ifIndex;
+      U8          m_localMac[PKT_ETH_ADDR_LEN];
+      U8          m_peerMac[PKT_ETH_ADDR_LEN];
+      U32         m_localIp;
+      U16         m_ipId;
+
+      U8          *m_pRing;
+      size_t      m_ringSz;
+      U8          *m_pRxRing;
+      U8          *m_pTxRing;
+      U32         m_rxBlock;
+      U32         m_txFrame;
+      U32         m_txFrameNr;
+      U32         m_txPending;
+
+      GSimSocket  *m_socks[GSIM_MAX_SOCK_CNT];
+      U16         m_ports[GSIM_MAX_SOCK_CNT];
+      U32         m_numSocks;
+
+      std::vector<UdpData_t *> m_rxQ;
+      U32         m_rxHead;
+};
+
+#endif
@@ -0,0 +1,284 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "gtp_types.hpp"
+#include "sim_cfg.hpp"
+#include "transport.hpp"
+#include "poller.hpp"
+
+static PollMode_t  s_mode        = POLL_MODE_INTERRUPT;
+static PollMode_t  s_activeMode  = POLL_MODE_INTERRUPT;
+static U32         s_busyPollUs  = 0;
+static U32         s_autoRate    = 0;
+static U32         s_idleSpins   = 0;
+static U32         s_backoffUs   = 1;
+static Time_t      s_windowStart = 0;
+static U64         s_windowRecvd = 0;
+static U64         s_lastCpuUsec = 0;
+static U64         s_lastNumMsgs = 0;
+static PollStats_t s_stats[POLL_MODE_MAX];
+
+PRIVATE U64 threadCpuUsec()
+{
+    struct rusage usage;
+
+    if (0 != getrusage(RUSAGE_THREAD, &usage))
+    {
+        return s_lastCpuUsec;
+    }
+
+    return (U64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+        usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/**
+ * @brief
+ *    Charges the CPU time and the messages since the previous call to the
+ *    active mode
+ */
+PRIVATE VOID accountPollStats()
+{
+    U64 cpuUsec = threadCpuUsec();
+    U64 numMsgs = getNumTransMsgs();
+
+    s_stats[s_activeMode].cpuUsec += cpuUsec - s_lastCpuUsec;
+    s_stats[s_activeMode].numMsgs += numMsgs - s_lastNumMsgs;
+    s_lastCpuUsec = cpuUsec;
+    s_lastNumMsgs = numMsgs;
+}
+
+PRIVATE VOID setActivePollMode(PollMode_t mode)
+{
+    if (mode == s_activeMode)
+    {
+        return;
+    }
+
+    accountPollStats();
+    s_activeMode = mode;
+    s_idleSpins  = 0;
+    s_backoffUs  = 1;
+
+    if (0 != s_busyPollUs && ROK != getTransport()->setBusyPoll(
+            (POLL_MODE_BUSY == mode) ? s_busyPollUs : 0))
+    {
+        LOG_DEBUG("Busy polling of the device queues unavailable");
+    }
+
+    LOG_INFO("Polling the transport in %s mode", pollModeStr(mode));
+}
+
+PUBLIC RETVAL initPoller()
+{
+    LOG_ENTERFN();
+
+    Config *pCfg = Config::getInstance();
+
+    s_busyPollUs  = pCfg->getBusyPoll();
+    s_autoRate    = pCfg->getBusyPollRate();
+    s_lastCpuUsec = threadCpuUsec();
+    s_lastNumMsgs = getNumTransMsgs();
+    MEMSET(s_stats, 0, sizeof(s_stats));
+
+    for (U32 i = 0; i < POLL_MODE_MAX; i++)
+    {
+        if (pCfg->getPollMode() == pollModeStr((PollMode_t)i))
+        {
+            setPollMode((PollMode_t)i);
+        }
+    }
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Switches between busy and interrupt mode on the receive rate of the
+ *    last interval, with hysteresis so that the mode does not flap around
+ *    the threshold
+ */
+PRIVATE VOID updateAutoMode()
+{
+    Time_t now     = getMilliSeconds();
+    Time_t elapsed = now - s_windowStart;
+
+    if (elapsed < GSIM_AUTO_RATE_INTVL)
+    {
+        return;
+    }
+
+    U64 rate = (s_windowRecvd * 1000) / elapsed;
+    if (POLL_MODE_INTERRUPT == s_activeMode && rate >= s_autoRate)
+    {
+        setActivePollMode(POLL_MODE_BUSY);
+    }
+    else if (POLL_MODE_BUSY == s_activeMode && rate < s_autoRate / 2)
+    {
+        setActivePollMode(POLL_MODE_INTERRUPT);
+    }
+
+    s_windowStart = now;
+    s_windowRecvd = 0;
+}
+
+/**
+ * @brief
+ *    Backs off when the busy reads return nothing, spinning first, then
+ *    yielding the CPU and then sleeping for exponentially longer times
+ */
+PRIVATE VOID busyBackoff()
+{
+    s_idleSpins++;
+    if (s_idleSpins <= GSIM_BUSY_SPIN_IDLE)
+    {
+        return;
+    }
+
+    if (s_idleSpins <= GSIM_BUSY_YIELD_IDLE)
+    {
+        sched_yield();
+        return;
+    }
+
+    struct timespec ts;
+    ts.tv_sec  = 0;
+    ts.tv_nsec = s_backoffUs * 1000;
+    nanosleep(&ts, NULL);
+
+    if (s_backoffUs < GSIM_BUSY_MAX_BACKOFF)
+    {
+        s_backoffUs <<= 1;
+    }
+}
+
+/**
+ * @brief
+ *    Reads the keyboard and the transport once in the active mode
+ *
+ * @param maxWait
+ *    milliseconds until the next task has to run, an interrupt mode poll
+ *    blocks at most this long
+ */
+PUBLIC VOID pollIo(Time_t maxWait)
+{
+    U32 numRecvd = 0;
+
+    if (POLL_MODE_AUTO == s_mode)
+    {
+        updateAutoMode();
+    }
+
+    if (POLL_MODE_BUSY == s_activeMode)
+    {
+        numRecvd = spinPoll();
+        if (numRecvd > 0)
+        {
+            s_idleSpins = 0;
+            s_backoffUs = 1;
+        }
+        else
+        {
+            busyBackoff();
+        }
+    }
+    else
+    {
+        numRecvd = socketPoll((S32)maxWait);
+    }
+
+    s_windowRecvd += numRecvd;
+}
+
+/**
+ * @brief
+ *    Selects the mode, auto starts in interrupt mode
+ */
+PUBLIC VOID setPollMode(PollMode_t mode)
+{
+    s_mode        = mode;
+    s_windowStart = getMilliSeconds();
+    s_windowRecvd = 0;
+    setActivePollMode((POLL_MODE_AUTO == mode) ? POLL_MODE_INTERRUPT : mode);
+}
+
+PUBLIC VOID nextPollMode()
+{
+    setPollMode((PollMode_t)((s_mode + 1) % POLL_MODE_MAX));
+}
+
+PUBLIC PollMode_t getPollMode()
+{
+    return s_mode;
+}
+
+PUBLIC PollMode_t getActivePollMode()
+{
+    return s_activeMode;
+}
+
+PUBLIC const S8 *pollModeStr(PollMode_t mode)
+{
+    switch (mode)
+    {
+    case POLL_MODE_INTERRUPT:
+        return "interrupt";
+    case POLL_MODE_BUSY:
+        return "busy";
+    case POLL_MODE_AUTO:
+        return "auto";
+    default:
+        return "invalid";
+    }
+}
+
+/**
+ * @brief
+ *    CPU time and messages of the interrupt and the busy mode, up to now
+ */
+PUBLIC PollStats_t *getPollStats()
+{
+    accountPollStats();
+    return s_stats;
+}
+
+PUBLIC VOID logPollStats()
+{
+    PollStats_t *pStats = getPollStats();
+
+    for (U32 i = POLL_MODE_INTERRUPT; i <= POLL_MODE_BUSY; i++)
+    {
+        if (0 == pStats[i].numMsgs)
+        {
+            continue;
+        }
+
+        LOG_INFO("Poll mode %s, %lu messages, %lu us CPU, %.2f us/message",
+            pollModeStr((PollMode_t)i), pStats[i].numMsgs, pStats[i].cpuUsec,
+            (double)pStats[i].cpuUsec / pStats[i].numMsgs);
+    }
+}
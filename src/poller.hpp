@@ -0,0 +1,50 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POLLER_HPP_
+#define _POLLER_HPP_
+
+#define GSIM_POLL_MAX_WAIT       100   /* ms, blocking poll in interrupt mode */
+#define GSIM_BUSY_SPIN_IDLE      256   /* empty reads before yielding */
+#define GSIM_BUSY_YIELD_IDLE     1024  /* empty reads before sleeping */
+#define GSIM_BUSY_MAX_BACKOFF    64    /* us */
+#define GSIM_AUTO_RATE_INTVL     100   /* ms, receive rate sampling */
+
+typedef enum
+{
+   POLL_MODE_INTERRUPT,    /* blocks until a message or the next deadline */
+   POLL_MODE_BUSY,         /* spins on non-blocking reads */
+   POLL_MODE_AUTO,         /* busy while the receive rate is high */
+   POLL_MODE_MAX
+} PollMode_t;
+
+typedef struct
+{
+   U64         cpuUsec;    /* user and system time of the thread */
+   U64         numMsgs;    /* messages sent and received */
+} PollStats_t;
+
+EXTERN RETVAL     initPoller();
+EXTERN VOID       pollIo(Time_t maxWait);
+EXTERN VOID       setPollMode(PollMode_t mode);
+EXTERN VOID       nextPollMode();
+EXTERN PollMode_t getPollMode();
+EXTERN PollMode_t getActivePollMode();
+EXTERN const S8   *pollModeStr(PollMode_t mode);
+EXTERN PollStats_t *getPollStats();
+EXTERN VOID       logPollStats();
+
+#endif
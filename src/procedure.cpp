@@ -27,11 +27,16 @@
 #include "gtp_ie.hpp"
 #include "gtp_msg.hpp"
 #include "procedure.hpp"
+#include "validate.hpp"
+#include "store.hpp"
 
 Job::Job()
 {
    m_type    = JOB_TYPE_INV;
    m_pGtpMsg = NULL;
+   m_pRules  = NULL;
+   m_pStore  = NULL;
+   m_pPatch  = NULL;
 }
 
 Job::Job(GtpMsg *pGtpMsg, JobType_t taskType)
@@ -44,16 +49,60 @@ Job::Job(GtpMsg *pGtpMsg, JobType_t taskType)
    m_numRcvRetrans = 0;
    m_numTimeOut    = 0;
    m_numUnexp      = 0;
+   m_numRejected   = 0;
+   MEMSET(m_numCause, 0, sizeof(m_numCause));
+   m_pRules        = NULL;
+   m_pStore        = NULL;
+   m_pPatch        = NULL;
 
    STRCPY(m_msgName, gtpGetMsgName(pGtpMsg->type()));
 }
 
+/**
+ * @brief
+ *    Wait of a UE session between two procedures, in milliseconds
+ */
+Job::Job(Time_t wait)
+{
+   m_type          = JOB_TYPE_WAIT;
+   m_pGtpMsg       = NULL;
+   m_wait          = wait;
+   m_numSnd        = 0;
+   m_numRcv        = 0;
+   m_numSndRetrans = 0;
+   m_numRcvRetrans = 0;
+   m_numTimeOut    = 0;
+   m_numUnexp      = 0;
+   m_numRejected   = 0;
+   MEMSET(m_numCause, 0, sizeof(m_numCause));
+   m_pRules        = NULL;
+   m_pStore        = NULL;
+   m_pPatch        = NULL;
+
+   STRCPY(m_msgName, "Wait");
+}
+
 Job::~Job()
 {
    if (m_pGtpMsg)
    {
       delete m_pGtpMsg;
    }
+
+   if (m_pRules)
+   {
+      delete m_pRules;
+   }
+
+   if (m_pStore)
+   {
+      delete m_pStore;
+   }
+
+   if (m_pPatch)
+   {
+      delete m_pPatch;
+   }
 }
 
 /**
@@ -19,6 +19,9 @@
 
 class Job;
 class Procedure;
+class ValidateRules;
+class StoreRules;
+class PatchRules;
 
 typedef std::vector<Job*>        JobSequence;
 typedef JobSequence::iterator    JobSeqItr;
@@ -48,6 +51,7 @@ class Job
       Job();
       ~Job();
       Job(GtpMsg*, JobType_t);
+      Job(Time_t wait);
 
       GtpMsg*        getGtpMsg();
       inline JobType_t type() { return m_type; }
@@ -59,7 +63,12 @@ class Job
       Counter        m_numRcvRetrans;
       Counter        m_numTimeOut;
       Counter        m_numUnexp;
+      Counter        m_numRejected;  /* responses with a rejection cause */
+      Counter        m_numCause[GTP_CAUSE_MAX];
       S8             m_msgName[GTP_MSG_NAME_LEN];
+      ValidateRules  *m_pRules;      /* NULL if the message is not validated */
+      StoreRules     *m_pStore;      /* values stored from a received msg */
+      PatchRules     *m_pPatch;      /* values patched into a sent msg */
 
    private:
       GtpMsg         *m_pGtpMsg;
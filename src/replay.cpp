@@ -0,0 +1,832 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#include <iostream>
+#include <iomanip>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <list>
+#include <map>
+#include <vector>
+#include <unordered_map>
+
+#include "types.hpp"
+#include "macros.hpp"
+#include "logger.hpp"
+#include "error.hpp"
+#include "timer.hpp"
+#include "task.hpp"
+#include "gtp_types.hpp"
+#include "gtp_macro.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "gtp_peer.hpp"
+#include "sim_cfg.hpp"
+#include "transport.hpp"
+#include "scenario.hpp"
+#include "traffic.hpp"
+#include "replay.hpp"
+#include "latency.hpp"
+
+#define PCAP_GLOBAL_HDR_LEN   24
+#define PCAP_REC_HDR_LEN      16
+#define PCAP_MAGIC_USEC       0xa1b2c3d4
+#define PCAP_MAGIC_NSEC       0xa1b23c4d
+#define PCAP_LINK_ETHERNET    1
+#define PCAP_LINK_RAW         101
+#define PCAP_LINK_LINUX_SLL   113
+#define PCAP_ETH_HDR_LEN      14
+#define PCAP_SLL_HDR_LEN      16
+#define PCAP_ETH_P_IP         0x0800
+#define PCAP_ETH_P_VLAN       0x8100
+#define PCAP_ETH_P_QINQ       0x88a8
+#define PCAP_IP_PROTO_UDP     17
+#define PCAP_UDP_HDR_LEN      8
+#define GTPC_LEN_OFFSET       4 /* octets not counted in the length */
+
+static ReplayTask *s_pReplay = NULL;
+
+PRIVATE U16 rd16be(const U8 *p)
+{
+    return (U16)((p[0] << 8) | p[1]);
+}
+
+PRIVATE U32 rd32be(const U8 *p)
+{
+    return ((U32)p[0] << 24) | ((U32)p[1] << 16) | ((U32)p[2] << 8) | p[3];
+}
+
+PcapReader::PcapReader()
+{
+    m_fd       = -1;
+    m_pMap     = (U8 *)MAP_FAILED;
+    m_size     = 0;
+    m_off      = 0;
+    m_released = 0;
+    m_swap     = FALSE;
+    m_nsec     = FALSE;
+    m_linkType = 0;
+}
+
+PcapReader::~PcapReader()
+{
+    if (MAP_FAILED != (VOID *)m_pMap)
+    {
+        munmap(m_pMap, m_size);
+    }
+
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+/**
+ * @brief
+ *    Reads a 32 bit field of the file in the byte order of the file
+ */
+U32 PcapReader::rd32(const U8 *p)
+{
+    U32 val;
+    MEMCPY(&val, p, sizeof(val));
+    return m_swap ? __builtin_bswap32(val) : val;
+}
+
+RETVAL PcapReader::open(const string &file)
+{
+    LOG_ENTERFN();
+
+    m_fd = ::open(file.c_str(), O_RDONLY);
+    if (m_fd < 0)
+    {
+        LOG_ERROR("Opening capture [%s], [%s]", file.c_str(), strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) < 0 || st.st_size < PCAP_GLOBAL_HDR_LEN)
+    {
+        LOG_ERROR("Invalid capture [%s]", file.c_str());
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_size = st.st_size;
+    m_pMap = (U8 *)mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (MAP_FAILED == (VOID *)m_pMap)
+    {
+        LOG_ERROR("Mapping capture [%s], [%s]", file.c_str(), strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+    madvise(m_pMap, m_size, MADV_SEQUENTIAL);
+
+    U32 magic;
+    MEMCPY(&magic, m_pMap, sizeof(magic));
+    if (PCAP_MAGIC_USEC == magic || PCAP_MAGIC_NSEC == magic)
+    {
+        m_swap = FALSE;
+    }
+    else if (PCAP_MAGIC_USEC == __builtin_bswap32(magic) ||
+             PCAP_MAGIC_NSEC == __builtin_bswap32(magic))
+    {
+        m_swap = TRUE;
+    }
+    else
+    {
+        LOG_ERROR("Capture [%s] is not in pcap format", file.c_str());
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_nsec     = (PCAP_MAGIC_NSEC == rd32(m_pMap));
+    m_linkType = rd32(m_pMap + 20);
+    if (PCAP_LINK_ETHERNET != m_linkType && PCAP_LINK_RAW != m_linkType &&
+        PCAP_LINK_LINUX_SLL != m_linkType)
+    {
+        LOG_ERROR("Unsupported capture link type [%d]", m_linkType);
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_off = PCAP_GLOBAL_HDR_LEN;
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Drops the consumed pages of the mapping from the page cache of the
+ *    process, they are read again from the file if accessed
+ */
+VOID PcapReader::release()
+{
+    if (m_off - m_released < REPLAY_RELEASE_LEN)
+    {
+        return;
+    }
+
+    size_t pageSz = sysconf(_SC_PAGESIZE);
+    size_t end    = m_off & ~(pageSz - 1);
+    madvise(m_pMap + m_released, end - m_released, MADV_DONTNEED);
+    m_released = end;
+}
+
+/**
+ * @brief
+ *    Decodes the link, IPv4 and UDP headers of a captured frame. Fragments
+ *    and truncated packets are skipped
+ */
+BOOL PcapReader::decFrame(const U8 *pFrame, U32 len, PcapPkt *pPkt)
+{
+    U32 off   = 0;
+    U16 proto = PCAP_ETH_P_IP;
+
+    if (PCAP_LINK_ETHERNET == m_linkType)
+    {
+        if (len < PCAP_ETH_HDR_LEN)
+        {
+            return FALSE;
+        }
+
+        off   = PCAP_ETH_HDR_LEN;
+        proto = rd16be(pFrame + 12);
+        while ((PCAP_ETH_P_VLAN == proto || PCAP_ETH_P_QINQ == proto) &&
+               off + 4 <= len)
+        {
+            proto = rd16be(pFrame + off + 2);
+            off += 4;
+        }
+    }
+    else if (PCAP_LINK_LINUX_SLL == m_linkType)
+    {
+        if (len < PCAP_SLL_HDR_LEN)
+        {
+            return FALSE;
+        }
+
+        off   = PCAP_SLL_HDR_LEN;
+        proto = rd16be(pFrame + 14);
+    }
+
+    if (PCAP_ETH_P_IP != proto || off + 20 > len ||
+        4 != (pFrame[off] >> 4) || PCAP_IP_PROTO_UDP != pFrame[off + 9] ||
+        (rd16be(pFrame + off + 6) & 0x3fff))
+    {
+        return FALSE;
+    }
+
+    const U8 *pIp   = pFrame + off;
+    U32      ipLen  = (pIp[0] & 0x0f) * 4;
+    off += ipLen;
+    if (off + PCAP_UDP_HDR_LEN > len)
+    {
+        return FALSE;
+    }
+
+    const U8 *pUdp   = pFrame + off;
+    U32      udpLen  = rd16be(pUdp + 4);
+    off += PCAP_UDP_HDR_LEN;
+    if (udpLen < PCAP_UDP_HDR_LEN || off + udpLen - PCAP_UDP_HDR_LEN > len)
+    {
+        return FALSE;
+    }
+
+    pPkt->srcIp   = rd32be(pIp + 12);
+    pPkt->dstIp   = rd32be(pIp + 16);
+    pPkt->srcPort = rd16be(pUdp);
+    pPkt->dstPort = rd16be(pUdp + 2);
+    pPkt->pData   = pFrame + off;
+    pPkt->len     = udpLen - PCAP_UDP_HDR_LEN;
+
+    return TRUE;
+}
+
+/**
+ * @brief
+ *    Returns the next UDP packet of the capture
+ *
+ * @return
+ *    FALSE at the end of the capture
+ */
+BOOL PcapReader::next(PcapPkt *pPkt)
+{
+    while (m_off + PCAP_REC_HDR_LEN <= m_size)
+    {
+        const U8 *pRec   = m_pMap + m_off;
+        U32      tsSec   = rd32(pRec);
+        U32      tsFrac  = rd32(pRec + 4);
+        U32      capLen  = rd32(pRec + 8);
+        if (m_off + PCAP_REC_HDR_LEN + capLen > m_size)
+        {
+            break;
+        }
+
+        m_off += PCAP_REC_HDR_LEN + capLen;
+        release();
+
+        if (decFrame(pRec + PCAP_REC_HDR_LEN, capLen, pPkt))
+        {
+            pPkt->tsNs = (U64)tsSec * 1000000000ULL +
+                (m_nsec ? tsFrac : (U64)tsFrac * 1000);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+PUBLIC ReplayTask *getReplayTask()
+{
+    return s_pReplay;
+}
+
+ReplayTask::ReplayTask(string file, U32 speed)
+{
+    m_file       = file;
+    m_speed      = speed;
+    m_wakeTime   = 0;
+    m_startTime  = 0;
+    m_started    = FALSE;
+    m_firstTsNs  = 0;
+    m_pktValid   = FALSE;
+    m_eof        = FALSE;
+    m_localIp    = 0;
+    m_localPort  = 0;
+    m_localKnown = FALSE;
+    m_nextTeid   = 0;
+    m_numSkipped = 0;
+    MEMSET(&m_pkt, 0, sizeof(m_pkt));
+    MEMSET(m_latency, 0, sizeof(m_latency));
+
+    Config *pCfg         = Config::getInstance();
+    m_peerEp.ipAddr      = pCfg->getRemoteIpAddr();
+    m_peerEp.port        = pCfg->getRemoteGtpcPort();
+    m_imsiGen.init(pCfg->getImsi());
+
+    s_pReplay = this;
+}
+
+ReplayTask::~ReplayTask()
+{
+    for (ReplaySsnMap::iterator itr = m_locTeidMap.begin();
+         itr != m_locTeidMap.end(); itr++)
+    {
+        ReplaySession *pSsn = itr->second;
+        for (U32 i = 0; i < pSsn->pending.size(); i++)
+        {
+            delete pSsn->pending[i];
+        }
+        delete pSsn;
+    }
+
+    s_pReplay = NULL;
+}
+
+RETVAL ReplayTask::init()
+{
+    LOG_ENTERFN();
+
+    RETVAL ret = m_reader.open(m_file);
+    if (ROK == ret)
+    {
+        LOG_INFO("Replaying [%s], speed [%d]", m_file.c_str(), m_speed);
+    }
+
+    LOG_EXITFN(ret);
+}
+
+/**
+ * @brief
+ *    Checks the packet carries a complete GTPv2-C message
+ */
+BOOL ReplayTask::isGtpcMsg(const PcapPkt *pPkt)
+{
+    if (pPkt->len < GTP_MSG_HDR_LEN_WITHOUT_TEID ||
+        pPkt->len > GTP_MSG_BUF_LEN || 2 != (pPkt->pData[0] >> 5))
+    {
+        return FALSE;
+    }
+
+    GtpLength_t len = 0;
+    GTP_MSG_GET_LEN(pPkt->pData, len);
+    if ((U32)len + GTPC_LEN_OFFSET > pPkt->len ||
+        (GTP_CHK_T_BIT_PRESENT(pPkt->pData) && pPkt->len < GTP_MSG_HDR_LEN))
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief
+ *    Sends the captured messages that are due, at most a burst per run, and
+ *    sleeps until the next one is due
+ */
+RETVAL ReplayTask::run(VOID *arg)
+{
+    LOG_ENTERFN();
+
+    Time_t now     = getMilliSeconds();
+    U32    numPkts = 0;
+
+    while (!m_eof)
+    {
+        if (!m_pktValid)
+        {
+            if (!m_reader.next(&m_pkt))
+            {
+                m_eof = TRUE;
+                break;
+            }
+
+            if (!isGtpcMsg(&m_pkt))
+            {
+                continue;
+            }
+
+            m_pktValid = TRUE;
+            if (!m_started)
+            {
+                m_started   = TRUE;
+                m_startTime = now;
+                m_firstTsNs = m_pkt.tsNs;
+            }
+        }
+
+        if (0 != m_speed && m_pkt.tsNs > m_firstTsNs)
+        {
+            Time_t due = m_startTime +
+                (m_pkt.tsNs - m_firstTsNs) / (1000000ULL * m_speed);
+            if (due > now)
+            {
+                m_wakeTime = due;
+                pause();
+                LOG_EXITFN(ROK);
+            }
+        }
+
+        if (numPkts++ >= REPLAY_MAX_BURST)
+        {
+            m_wakeTime = now;
+            pause();
+            LOG_EXITFN(ROK);
+        }
+
+        procPkt(&m_pkt);
+        m_pktValid = FALSE;
+    }
+
+    LOG_INFO("Replay of [%s] finished", m_file.c_str());
+    stop();
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Creates the replayed session of a captured Create Session Request. The
+ *    captured IMSI is mapped to a generated one, the same captured IMSI
+ *    always maps to the same generated IMSI
+ */
+ReplaySession *ReplayTask::newSession(Buffer *pBuf)
+{
+    LOG_ENTERFN();
+
+    U8 *pImsiIe = getImsiBufPtr(pBuf);
+    if (NULL == pImsiIe)
+    {
+        LOG_EXITFN((ReplaySession *)NULL);
+    }
+
+    GtpMsg gtpMsg(pBuf);
+    gtpMsg.decode();
+    GtpFteid *pFteid =
+        dynamic_cast<GtpFteid *>(gtpMsg.getIe(GTP_IE_FTEID, 0, 1));
+    if (NULL == pFteid)
+    {
+        LOG_EXITFN((ReplaySession *)NULL);
+    }
+
+    GtpImsiKey capImsi;
+    MEMSET(&capImsi, 0, sizeof(capImsi));
+    GTP_GET_IE_LEN(pImsiIe, capImsi.len);
+    if (capImsi.len > sizeof(capImsi.val))
+    {
+        LOG_EXITFN((ReplaySession *)NULL);
+    }
+    MEMCPY(capImsi.val, pImsiIe + GTP_IE_HDR_LEN, capImsi.len);
+
+    ReplaySession *pSsn = new ReplaySession;
+    ReplayImsiMap::iterator imsi = m_imsiMap.find(capImsi);
+    if (m_imsiMap.end() == imsi)
+    {
+        MEMSET(&pSsn->imsi, 0, sizeof(pSsn->imsi));
+        m_imsiGen.allocNew(&pSsn->imsi);
+        m_imsiMap.insert(std::make_pair(capImsi, pSsn->imsi));
+    }
+    else
+    {
+        pSsn->imsi = imsi->second;
+    }
+
+    pSsn->locTeid  = ++m_nextTeid;
+    pSsn->remTeid  = 0;
+    pSsn->remKnown = FALSE;
+    pSsn->waiting  = FALSE;
+    pSsn->capTeids.push_back(pFteid->getTeid());
+    m_capTeidMap[pFteid->getTeid()] = pSsn;
+    m_locTeidMap[pSsn->locTeid]      = pSsn;
+
+    Stats::incStats(GSIM_STAT_NUM_SESSIONS_CREATED);
+    Stats::incStats(GSIM_STAT_NUM_SESSIONS);
+
+    LOG_EXITFN(pSsn);
+}
+
+VOID ReplayTask::deleteSession(ReplaySession *pSsn)
+{
+    for (U32 i = 0; i < pSsn->capTeids.size(); i++)
+    {
+        ReplaySsnMap::iterator itr = m_capTeidMap.find(pSsn->capTeids[i]);
+        if (m_capTeidMap.end() != itr && itr->second == pSsn)
+        {
+            m_capTeidMap.erase(itr);
+        }
+    }
+
+    for (U32 i = 0; i < pSsn->pending.size(); i++)
+    {
+        delete pSsn->pending[i];
+    }
+
+    m_locTeidMap.erase(pSsn->locTeid);
+    delete pSsn;
+}
+
+/**
+ * @brief
+ *    A captured Create Session Response maps the TEID the captured peer
+ *    assigned to the session, later requests of the replayed side are
+ *    addressed with it
+ */
+VOID ReplayTask::learnPeerTeid(const PcapPkt *pPkt)
+{
+    GtpMsgType_t msgType = GTPC_MSG_TYPE_INVALID;
+    GTP_MSG_GET_TYPE(pPkt->pData, msgType);
+    if (GTPC_MSG_CS_RSP != msgType || !GTP_CHK_T_BIT_PRESENT(pPkt->pData))
+    {
+        return;
+    }
+
+    GtpTeid_t teid = rd32be(pPkt->pData + 4);
+    ReplaySsnMap::iterator itr = m_capTeidMap.find(teid);
+    if (m_capTeidMap.end() == itr)
+    {
+        return;
+    }
+
+    Buffer buf;
+    BUFFER_CPY(&buf, pPkt->pData, pPkt->len);
+    GtpMsg gtpMsg(&buf);
+    gtpMsg.decode();
+    GtpFteid *pFteid =
+        dynamic_cast<GtpFteid *>(gtpMsg.getIe(GTP_IE_FTEID, 0, 1));
+    if (NULL != pFteid)
+    {
+        ReplaySession *pSsn = itr->second;
+        pSsn->capTeids.push_back(pFteid->getTeid());
+        m_capTeidMap[pFteid->getTeid()] = pSsn;
+    }
+}
+
+/**
+ * @brief
+ *    Replays a captured packet. Requests of the replayed side are sent, the
+ *    messages of the captured peer are only used to map its TEIDs
+ */
+VOID ReplayTask::procPkt(const PcapPkt *pPkt)
+{
+    LOG_ENTERFN();
+
+    GtpMsgType_t msgType = GTPC_MSG_TYPE_INVALID;
+    GTP_MSG_GET_TYPE(pPkt->pData, msgType);
+    GtpMsgCategory_t msgCat = gtpGetMsgCategory(msgType);
+
+    if (!m_localKnown)
+    {
+        if (GTPC_MSG_CS_REQ != msgType)
+        {
+            m_numSkipped++;
+            LOG_EXITVOID();
+        }
+
+        m_localIp    = pPkt->srcIp;
+        m_localPort  = pPkt->srcPort;
+        m_localKnown = TRUE;
+    }
+
+    if (pPkt->dstIp == m_localIp && pPkt->dstPort == m_localPort)
+    {
+        learnPeerTeid(pPkt);
+        LOG_EXITVOID();
+    }
+
+    if (pPkt->srcIp != m_localIp || pPkt->srcPort != m_localPort ||
+        GTPC_MSG_ECHO_REQ == msgType || GTP_MSG_CAT_RSP == msgCat ||
+        GTP_MSG_CAT_ACK == msgCat || GTP_MSG_CAT_INV == msgCat ||
+        !GTP_CHK_T_BIT_PRESENT(pPkt->pData))
+    {
+        m_numSkipped++;
+        LOG_EXITVOID();
+    }
+
+    Buffer *pBuf = new Buffer;
+    BUFFER_CPY(pBuf, pPkt->pData, pPkt->len);
+
+    GtpTeid_t teid = 0;
+    GTP_MSG_DEC_TEID(pBuf->pVal, teid);
+
+    ReplaySession *pSsn = NULL;
+    if (GTPC_MSG_CS_REQ == msgType && 0 == teid)
+    {
+        pSsn = newSession(pBuf);
+    }
+    else
+    {
+        ReplaySsnMap::iterator itr = m_capTeidMap.find(teid);
+        if (m_capTeidMap.end() != itr)
+        {
+            pSsn = itr->second;
+        }
+    }
+
+    if (NULL == pSsn)
+    {
+        LOG_DEBUG("Captured [%s] of unknown session skipped, TEID [%u]",
+            gtpGetMsgName(msgType), teid);
+        m_numSkipped++;
+        delete pBuf;
+        LOG_EXITVOID();
+    }
+
+    /* requests of a session are held until the peer has answered the
+     * previous one, when replaying faster than the peer responds
+     */
+    if (pSsn->waiting)
+    {
+        if (pSsn->pending.size() < REPLAY_MAX_PENDING)
+        {
+            pSsn->pending.push_back(pBuf);
+        }
+        else
+        {
+            m_numSkipped++;
+            delete pBuf;
+        }
+        LOG_EXITVOID();
+    }
+
+    sendReq(pSsn, pBuf);
+
+    LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Rewrites the sequence number, the TEIDs and the IMSI of a captured
+ *    request and sends it to the peer
+ */
+VOID ReplayTask::sendReq(ReplaySession *pSsn, Buffer *pBuf)
+{
+    LOG_ENTERFN();
+
+    GtpMsg gtpMsg(pBuf);
+    gtpMsg.decode();
+    delete pBuf;
+
+    GtpMsgHdr msgHdr;
+    msgHdr.teid = pSsn->remTeid;
+    msgHdr.seqN = generateSeqNum(&m_peerEp, GTP_MSG_CAT_REQ);
+    GSIM_SET_MASK(msgHdr.pres, GTP_MSG_HDR_TEID_PRES);
+    GSIM_SET_MASK(msgHdr.pres, GTP_MSG_HDR_SEQ_PRES);
+    gtpMsg.setMsgHdr(&msgHdr);
+
+    GtpMsgType_t msgType = gtpMsg.type();
+    if (GTPC_MSG_CS_REQ == msgType)
+    {
+        gtpMsg.setImsi(&pSsn->imsi);
+        gtpMsg.setSenderFteid(pSsn->locTeid,
+            Config::getInstance()->getLocalIpAddr());
+    }
+
+    U8  buf[GTP_MSG_BUF_LEN];
+    U32 len = 0;
+    MEMSET(buf, 0, GTP_MSG_BUF_LEN);
+    gtpMsg.encode(buf, &len);
+
+    pSsn->waiting = TRUE;
+
+    /* the send time is set when the message is handed to the transport */
+    ReplayTrans trans;
+    trans.msgType = msgType;
+    trans.sentNs  = 0;
+    trans.locTeid = pSsn->locTeid;
+    ReplayTrans *pTrans = &(m_transMap[msgHdr.seqN] = trans);
+    if (msgType < GTPC_MSG_TYPE_MAX)
+    {
+        m_latency[msgType].sent++;
+    }
+
+    Buffer *pOut = new Buffer;
+    BUFFER_CPY(pOut, buf, len);
+    sendMsg(TRANS_CONN_ID_SEND, &m_peerEp, pOut, &pTrans->sentNs);
+
+    LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Matches a message of the peer to the replayed request by sequence
+ *    number and records the response latency of the request type
+ */
+VOID ReplayTask::procGtpcMsg(UdpData_t *pData)
+{
+    LOG_ENTERFN();
+
+    U8             *pGtp    = pData->buf.pVal;
+    GtpMsgType_t   msgType  = GTPC_MSG_TYPE_INVALID;
+    GtpSeqNumber_t seqN     = 0;
+    GTP_MSG_GET_TYPE(pGtp, msgType);
+    GTP_MSG_GET_SEQN(pGtp, seqN);
+
+    GtpMsgCategory_t msgCat = gtpGetMsgCategory(msgType);
+    ReplayTransMap::iterator trans = m_transMap.find(seqN);
+    if ((GTP_MSG_CAT_RSP != msgCat && GTP_MSG_CAT_ACK != msgCat) ||
+        m_transMap.end() == trans)
+    {
+        LOG_DEBUG("Unexpected [%s] received", gtpGetMsgName(msgType));
+        Stats::incStats(GSIM_STAT_UNEXCEPTED_MSG_RECD);
+        delete pData;
+        LOG_EXITVOID();
+    }
+
+    /* timed against the kernel receive time, so that the latency does not
+     * include the time the response waited to be read
+     */
+    U64 rcvdNs = (0 != pData->timeNs) ? pData->timeNs : getWallNanoSeconds();
+    U64 latency = (rcvdNs > trans->second.sentNs) ?
+        rcvdNs - trans->second.sentNs : 0;
+    getRspTimeHist()->record(latency);
+
+    ReplayLatency *pLat   = &m_latency[trans->second.msgType];
+    if (0 == pLat->answered || latency < pLat->minNs)
+    {
+        pLat->minNs = latency;
+    }
+    if (latency > pLat->maxNs)
+    {
+        pLat->maxNs = latency;
+    }
+    pLat->sumNs += latency;
+    pLat->answered++;
+
+    ReplaySsnMap::iterator ssn = m_locTeidMap.find(trans->second.locTeid);
+    m_transMap.erase(trans);
+    if (m_locTeidMap.end() == ssn)
+    {
+        delete pData;
+        LOG_EXITVOID();
+    }
+
+    ReplaySession *pSsn = ssn->second;
+    pSsn->waiting       = FALSE;
+    if (GTPC_MSG_CS_RSP == msgType && !pSsn->remKnown)
+    {
+        GtpMsg gtpMsg(&pData->buf);
+        gtpMsg.decode();
+        GtpFteid *pFteid =
+            dynamic_cast<GtpFteid *>(gtpMsg.getIe(GTP_IE_FTEID, 0, 1));
+        if (NULL == pFteid)
+        {
+            LOG_DEBUG("Session rejected, TEID [%u]", pSsn->locTeid);
+            Stats::incStats(GSIM_STAT_NUM_SESSIONS_FAIL);
+            Stats::decStats(GSIM_STAT_NUM_SESSIONS);
+            deleteSession(pSsn);
+            pSsn = NULL;
+        }
+        else
+        {
+            pSsn->remTeid  = pFteid->getTeid();
+            pSsn->remKnown = TRUE;
+        }
+    }
+    else if (GTPC_MSG_DS_RSP == msgType)
+    {
+        Stats::incStats(GSIM_STAT_NUM_SESSIONS_SUCC);
+        Stats::decStats(GSIM_STAT_NUM_SESSIONS);
+        deleteSession(pSsn);
+        pSsn = NULL;
+    }
+
+    if (NULL != pSsn && !pSsn->pending.empty())
+    {
+        Buffer *pBuf = pSsn->pending.front();
+        pSsn->pending.erase(pSsn->pending.begin());
+        sendReq(pSsn, pBuf);
+    }
+
+    delete pData;
+    LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Prints the response latency of every replayed request type
+ */
+VOID ReplayTask::printStats()
+{
+    std::cout << std::endl << "Replay: " << m_file << ", skipped "
+              << m_numSkipped << ", unanswered " << m_transMap.size()
+              << std::endl;
+    std::cout << std::left << std::setw(24) << "Request" << std::right
+              << std::setw(10) << "Sent" << std::setw(10) << "Answered"
+              << std::setw(10) << "Min(us)" << std::setw(10) << "Avg(us)"
+              << std::setw(10) << "Max(us)" << std::endl;
+
+    for (U32 i = 0; i < GTPC_MSG_TYPE_MAX; i++)
+    {
+        ReplayLatency *pLat = &m_latency[i];
+        if (0 == pLat->sent)
+        {
+            continue;
+        }
+
+        U64 avg = pLat->answered ? pLat->sumNs / pLat->answered : 0;
+        std::cout << std::left << std::setw(24)
+                  << gtpGetMsgName((GtpMsgType_t)i) << std::right
+                  << std::setw(10) << pLat->sent << std::setw(10)
+                  << pLat->answered << std::setw(10) << pLat->minNs / 1000
+                  << std::setw(10) << avg / 1000 << std::setw(10)
+                  << pLat->maxNs / 1000 << std::endl;
+    }
+}
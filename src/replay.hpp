@@ -0,0 +1,171 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#ifndef _REPLAY_HPP_
+#define _REPLAY_HPP_
+
+#include <map>
+#include <vector>
+
+#define REPLAY_DFLT_SPEED        1          /* captured pace */
+#define REPLAY_MAX_BURST         256        /* messages sent per task run */
+#define REPLAY_MAX_PENDING       16         /* held per session, peer TEID */
+#define REPLAY_RELEASE_LEN       (8 << 20)  /* pcap bytes released at once */
+
+/**
+ * @brief
+ *    GTP-C packet of a capture file, addresses are in host byte order
+ */
+typedef struct
+{
+    U64        tsNs;
+    U32        srcIp;
+    U32        dstIp;
+    U16        srcPort;
+    U16        dstPort;
+    const U8   *pData;
+    U32        len;
+} PcapPkt;
+
+/**
+ * @brief
+ *    Sequential reader of a pcap file. The file is mapped, not read, and the
+ *    pages already consumed are released as the reader advances, so captures
+ *    larger than the memory can be replayed. Ethernet, Linux cooked and raw
+ *    IP link types with IPv4/UDP are decoded, other packets are skipped
+ */
+class PcapReader
+{
+   public:
+      PcapReader();
+      ~PcapReader();
+
+      RETVAL      open(const string &file);
+      BOOL        next(PcapPkt *pPkt);
+
+   private:
+      U32         rd32(const U8 *p);
+      BOOL        decFrame(const U8 *pFrame, U32 len, PcapPkt *pPkt);
+      VOID        release();
+
+      S32         m_fd;
+      U8          *m_pMap;
+      size_t      m_size;
+      size_t      m_off;
+      size_t      m_released;
+      BOOL        m_swap;
+      BOOL        m_nsec;
+      U32         m_linkType;
+};
+
+/**
+ * @brief
+ *    Captured session mapped to a replayed one, the captured IMSI and TEIDs
+ *    are replaced by the generated IMSI, the local TEID allocated here and
+ *    the TEID assigned by the device under test. A session has one request
+ *    outstanding at a time, later requests wait in pending
+ */
+typedef struct
+{
+    GtpImsiKey              imsi;
+    GtpTeid_t               locTeid;
+    GtpTeid_t               remTeid;
+    BOOL                    remKnown;
+    BOOL                    waiting;    /* request outstanding */
+    std::vector<Buffer *>   pending;
+    std::vector<GtpTeid_t>  capTeids;
+} ReplaySession;
+
+typedef struct
+{
+    GtpMsgType_t   msgType;
+    U64            sentNs;
+    GtpTeid_t      locTeid;
+} ReplayTrans;
+
+typedef struct
+{
+    Counter        sent;
+    Counter        answered;
+    U64            sumNs;
+    U64            minNs;
+    U64            maxNs;
+} ReplayLatency;
+
+typedef std::map<GtpTeid_t, ReplaySession *>               ReplaySsnMap;
+typedef std::map<GtpImsiKey, GtpImsiKey, CompareImsiKey>    ReplayImsiMap;
+typedef std::map<GtpSeqNumber_t, ReplayTrans>               ReplayTransMap;
+
+/**
+ * @brief
+ *    Replays the GTP-C requests of a capture against the remote peer. The
+ *    side of the capture sending the first Create Session Request is
+ *    replayed, its requests are sent at the captured times divided by the
+ *    speed factor, or as fast as possible with speed 0. Sequence numbers,
+ *    IMSIs and TEIDs are rewritten per replayed session and the response
+ *    latency is measured per request type
+ */
+class ReplayTask: public Task
+{
+   public:
+      ReplayTask(string file, U32 speed);
+      ~ReplayTask();
+
+      RETVAL      init();
+      RETVAL      run(VOID *arg = NULL);
+      VOID        procGtpcMsg(UdpData_t *pData);
+      VOID        printStats();
+
+   protected:
+      Time_t      wake() { return m_wakeTime; }
+
+   private:
+      BOOL        isGtpcMsg(const PcapPkt *pPkt);
+      VOID        procPkt(const PcapPkt *pPkt);
+      VOID        learnPeerTeid(const PcapPkt *pPkt);
+      ReplaySession *newSession(Buffer *pBuf);
+      VOID        sendReq(ReplaySession *pSsn, Buffer *pBuf);
+      VOID        deleteSession(ReplaySession *pSsn);
+
+      PcapReader      m_reader;
+      string          m_file;
+      U32             m_speed;
+      Time_t          m_wakeTime;
+      Time_t          m_startTime;
+      BOOL            m_started;
+      U64             m_firstTsNs;
+      PcapPkt         m_pkt;
+      BOOL            m_pktValid;
+      BOOL            m_eof;
+
+      U32             m_localIp;
+      U16             m_localPort;
+      BOOL            m_localKnown;
+      IPEndPoint      m_peerEp;
+      GtpTeid_t       m_nextTeid;
+      GtpImsiGenerator m_imsiGen;
+
+      ReplaySsnMap    m_capTeidMap;
+      ReplaySsnMap    m_locTeidMap;
+      ReplayImsiMap   m_imsiMap;
+      ReplayTransMap  m_transMap;
+      ReplayLatency   m_latency[GTPC_MSG_TYPE_MAX];
+      Counter         m_numSkipped;
+};
+
+EXTERN ReplayTask *getReplayTask();
+
+#endif
@@ -0,0 +1,159 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <unistd.h>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "gtp_types.hpp"
+#include "sim_cfg.hpp"
+#include "gtp_peer.hpp"
+#include "retrans.hpp"
+
+typedef struct
+{
+   U32         tokens;         /* retransmissions left in the budget */
+   Time_t      lastRefill;     /* ms */
+} RetransBudget_t;
+
+static RetransBudget_t  s_budget = {0, 0};
+static U32              s_randState = 0;
+
+/**
+ * @return
+ *    a pseudo random number, xorshift32
+ */
+PRIVATE U32 retransRand()
+{
+   if (0 == s_randState)
+   {
+      s_randState = (U32)getpid() ^ (U32)getMilliSeconds() ^ 0x9e3779b9;
+   }
+
+   s_randState ^= s_randState << 13;
+   s_randState ^= s_randState >> 17;
+   s_randState ^= s_randState << 5;
+
+   return s_randState;
+}
+
+PUBLIC VOID rtoSample(PeerData *pPeer, U64 rttNs)
+{
+   PeerRto_t *pRto = &pPeer->rto;
+   U64       rtt   = rttNs / 1000;
+
+   if (0 == pRto->srtt)
+   {
+      pRto->srtt   = rtt ? rtt : 1;
+      pRto->rttvar = rtt / 2;
+   }
+   else
+   {
+      U64 delta = (pRto->srtt > rtt) ? pRto->srtt - rtt : rtt - pRto->srtt;
+      pRto->rttvar = (3 * pRto->rttvar + delta) / 4;
+      pRto->srtt   = (7 * pRto->srtt + rtt) / 8;
+      if (0 == pRto->srtt)
+      {
+         pRto->srtt = 1;
+      }
+   }
+
+   U64 var = 4 * pRto->rttvar;
+   pRto->rto = pRto->srtt +
+      ((var > RTO_CLOCK_GRANULARITY) ? var : RTO_CLOCK_GRANULARITY);
+}
+
+PUBLIC U32 getRetransWait(PeerData *pPeer, U32 retryCnt)
+{
+   U32 t3 = Config::getInstance()->getT3Timer();
+
+   if (!Config::getInstance()->getAdaptiveRto() || 0 == pPeer->rto.srtt)
+   {
+      return t3;
+   }
+
+   U64 wait = pPeer->rto.rto / 1000;
+   if (wait < RTO_MIN)
+   {
+      wait = RTO_MIN;
+   }
+
+   for (U32 i = 0; i < retryCnt && wait < t3; i++)
+   {
+      wait *= 2;
+   }
+   if (wait > t3)
+   {
+      wait = t3;
+   }
+
+   if (0 == retryCnt)
+   {
+      return (U32)wait;
+   }
+
+   /* the retransmissions of the requests timing out together are spread
+    * over the second half of the backoff
+    */
+   return (U32)(wait / 2 + retransRand() % (wait / 2 + 1));
+}
+
+PUBLIC BOOL takeRetransToken(U32 *pWait)
+{
+   U32 rate = Config::getInstance()->getRetransRate();
+
+   if (0 == rate)
+   {
+      return TRUE;
+   }
+
+   /* the budget refills at rate tokens per second, up to a second of
+    * retransmissions
+    */
+   Time_t now = getMilliSeconds();
+   if (0 == s_budget.lastRefill)
+   {
+      s_budget.tokens = rate;
+      s_budget.lastRefill = now;
+   }
+   else if (now > s_budget.lastRefill)
+   {
+      U64 fill = ((now - s_budget.lastRefill) * rate) / 1000;
+      if (0 != fill)
+      {
+         fill += s_budget.tokens;
+         s_budget.tokens = (fill > rate) ? rate : (U32)fill;
+         s_budget.lastRefill = now;
+      }
+   }
+
+   if (0 != s_budget.tokens)
+   {
+      s_budget.tokens--;
+      return TRUE;
+   }
+
+   U32 intvl = (rate < 1000) ? 1000 / rate : 1;
+   *pWait = intvl + retransRand() % intvl;
+
+   return FALSE;
+}
@@ -0,0 +1,57 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RETRANS_HPP_
+#define _RETRANS_HPP_
+
+#define RTO_MIN                  10    /* ms, lower bound of adaptive T3 */
+#define RTO_CLOCK_GRANULARITY    1000  /* us, wake times are in ms */
+
+/**
+ * @brief
+ *    Updates the retransmission timeout of the peer with the response time
+ *    of a request, responses to retransmitted requests are not sampled
+ *
+ * @param rttNs
+ *    nanoseconds between the request sent and the response received
+ */
+PUBLIC VOID rtoSample(PeerData *pPeer, U64 rttNs);
+
+/**
+ * @return
+ *    msec to wait for the response of a request before its retryCnt + 1
+ *    retransmission. The configured T3 timer, or with --adaptive-rto the
+ *    timeout of the peer doubled for every retransmission sent, bounded
+ *    by T3 and randomized so that the requests timing out together do not
+ *    retransmit together
+ */
+PUBLIC U32 getRetransWait(PeerData *pPeer, U32 retryCnt);
+
+/**
+ * @brief
+ *    Takes a retransmission out of the global budget of --retrans-rate
+ *    retransmissions per second
+ *
+ * @param pWait
+ *    msec after which the retransmission is attempted again, when the
+ *    budget is exhausted
+ *
+ * @return
+ *    FALSE if the retransmission is to be deferred
+ */
+PUBLIC BOOL takeRetransToken(U32 *pWait);
+
+#endif
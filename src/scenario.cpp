@@ -33,6 +33,7 @@ using namespace pugi;
 #include "task.hpp"
 #include "sim_cfg.hpp"
 #include "scenario.hpp"
+#include "ssn_table.hpp"
 
 class Scenario* Scenario::m_pMainScn = NULL;  
 EXTERN VOID parseXmlScenario(const S8*, JobSequence*) throw (ErrCodeEn);
@@ -59,6 +60,8 @@ Scenario::Scenario()
 {
    m_scnRunIntvl = Config::getInstance()->getScnRunInterval();
    m_ifType = (GtpIfType_t)Config::getInstance()->getIfType();
+   m_pSsnTable = new SessionTable;
+   m_hasVars = FALSE;
 }
 
 Scenario::~Scenario()
@@ -68,6 +71,8 @@ Scenario::~Scenario()
       Procedure *proc = m_procSeq[i];
       delete proc;
    }
+
+   delete m_pSsnTable;
 }
 
 
@@ -105,6 +110,10 @@ VOID Scenario::init(const S8 *pScnFile) throw (ErrCodeEn)
    }
 
    createProcedure(&jobSeq);
+   if (m_hasVars)
+   {
+      m_pSsnTable->enableVars();
+   }
 }
 
 /**
@@ -129,6 +138,7 @@ VOID Scenario::createProcedure(JobSequence *jobSeq)
    for (JobSeqItr itr = jobSeq->begin(); itr != jobSeq->end(); itr++) 
    {
       Job *job = *itr;
+      m_hasVars = m_hasVars || NULL != job->m_pStore || NULL != job->m_pPatch;
 
       if (TRUE == fullProc)
       {
@@ -17,6 +17,27 @@
 #ifndef _SCENARIO_HPP_
 #define _SCENARIO_HPP_
 
+#include <map>
+
+class UeSession;
+class Tombstone;
+class SessionTable;
+
+struct CompareImsiKey
+{
+   bool operator() (const GtpImsiKey& left, const GtpImsiKey& right) const
+   {
+      return (MEMCMP(left.val, right.val, left.len) < 0);
+   }
+};
+
+typedef std::map<GtpImsiKey, UeSession*, CompareImsiKey> UeSessionMap;
+typedef std::pair<GtpImsiKey, UeSession*>                UeSessionMapPair;
+typedef UeSessionMap::iterator                           UeSessionMapItr;
+
+typedef std::map<GtpImsiKey, Tombstone*, CompareImsiKey> TombstoneMap;
+typedef TombstoneMap::iterator                           TombstoneMapItr;
+
 typedef enum
 {
    SCN_TYPE_INVALID,
@@ -28,6 +49,7 @@ typedef enum
 class Scenario
 {
    public:
+      Scenario();
       ~Scenario();
 
       static class Scenario* getInstance();
@@ -39,15 +61,29 @@ class Scenario
 
       ProcSequence   m_procSeq;
 
+      /* UE sessions executing this scenario, keyed by IMSI. Each scenario
+       * keeps its own sessions, so that an initiating and a waiting
+       * scenario can run in the same process for the same IMSI
+       */
+      UeSessionMap   m_ueSessionMap;
+
+      /* hot fields of the sessions in m_ueSessionMap, for the sweeps over
+       * all sessions
+       */
+      SessionTable   *m_pSsnTable;
+
+      /* tombstones of completed UE sessions, keyed by IMSI */
+      TombstoneMap   m_tombstoneMap;
+
       ProcedureItr   getFirstProcedure();
       ProcedureItr   getNextProcedure(ProcedureItr current);
       BOOL           isScenarioEnd(ProcedureItr current);
 
    private:
-      Scenario();
       VOID createProcedure(JobSequence *jobSeq);
 
       static class Scenario   *m_pMainScn;
+      BOOL           m_hasVars;     /* a job stores or patches variables */
       U32            m_lastRunTime;
       U32            m_scnRunIntvl;
 
@@ -17,6 +17,8 @@
 #include <list>
 #include <vector>
 #include <map>
+#include <deque>
+#include <unordered_map>
 
 #include "types.hpp"
 #include "error.hpp"
@@ -35,14 +37,34 @@
 #include "procedure.hpp"
 #include "gtp_stats.hpp"
 #include "gtp_peer.hpp"
+#include "overload.hpp"
+#include "retrans.hpp"
+#include "trace.hpp"
 #include "scenario.hpp"
+#include "ssn_table.hpp"
+#include "validate.hpp"
+#include "store.hpp"
 #include "tunnel.hpp"
 #include "traffic.hpp"
 #include "session.hpp"
+#include "tombstone.hpp"
+#include "mempool.hpp"
+#include "latency.hpp"
+#include "drain.hpp"
+#include "checkpoint.hpp"
 
-static UeSessionMap  s_ueSessionMap;
 static U32           g_sessionId = 0;
 
+/**
+ * @return
+ *    name of a procedure step in the session traces
+ */
+PRIVATE inline const S8 *procName(Procedure *pProc)
+{
+   Job *pJob = (NULL != pProc->m_initial) ? pProc->m_initial : pProc->m_wait;
+   return (NULL != pJob) ? pJob->m_msgName : NULL;
+}
+
 /**
  * @brief
  *    Constructor
@@ -54,20 +76,22 @@ UeSession::UeSession(Scenario *pScn, GtpImsiKey imsi)
    m_pScn = pScn;
    m_retryCnt = 0;
    m_sessionId = ++g_sessionId;
-   m_t3time = Config::getInstance()->getT3Timer();
-   m_nodeType = Config::getInstance()->getNodeType();
-   m_n3req = Config::getInstance()->getN3Requests();
    m_peerEp.ipAddr = Config::getInstance()->getRemoteIpAddr();
    m_peerEp.port = Config::getInstance()->getRemoteGtpcPort();
    m_bitmask = 0;
+   m_wakeTime = 0;
+   m_currRunTime = 0;
+   m_pPdnLst = NULL;
+   m_pCurrPdn = NULL;
    m_imsiKey = imsi;
-   m_bearerVec.reserve(GTP_MAX_BEARERS);
    m_currProcItr = m_pScn->getFirstProcedure();
 
-   for (U32 i = 0; i < GTP_MAX_BEARERS; i++)
-   {
-      m_bearerVec[i] = NULL;
-   }
+   m_slot = m_pScn->m_pSsnTable->add(this);
+   m_pScn->m_pSsnTable->updatePeer(m_slot, getPeerIndex(&m_peerEp));
+
+   m_traceId = traceSampleSession();
+   GSIM_TRACE(m_traceId, TRACE_SSN_CREATED, NULL, m_sessionId);
+   GSIM_TRACE(m_traceId, TRACE_STEP, procName(*m_currProcItr), 0);
 
    LOG_DEBUG("Creating UE Session [%d]", m_sessionId);
 }
@@ -79,7 +103,14 @@ UeSession::UeSession(Scenario *pScn, GtpImsiKey imsi)
  */
 UeSession::~UeSession()
 {
-   s_ueSessionMap.erase(m_imsiKey);
+   GSIM_TRACE(m_traceId, TRACE_SSN_END, NULL, m_sessionId);
+   m_pScn->m_ueSessionMap.erase(m_imsiKey);
+   m_pScn->m_pSsnTable->del(m_slot);
+
+   if (GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_WAITING_FOR_RSP))
+   {
+      delPeerTrans(&m_peerEp, m_currProcCache.seqNumber, this);
+   }
 
    if (NULL != m_currProcCache.sentMsg)
       delete m_currProcCache.sentMsg;
@@ -87,72 +118,179 @@ UeSession::~UeSession()
    if (NULL != m_prevProcCache.sentMsg)
       delete m_prevProcCache.sentMsg;
 
-   for (GtpcPdnLstItr pPdn = m_pdnLst.begin(); pPdn != m_pdnLst.end(); pPdn++)
+   /* bearers are stored inline and released along with the session */
+   while (NULL != m_pPdnLst)
    {
+      GtpcPdn *pPdn = m_pPdnLst;
+      m_pPdnLst = pPdn->pNext;
+
       /* delete the c-plane tunnels */
-      GtpcTun *pCTun = (*pPdn)->pCTun;
-      if (NULL != pCTun)
+      if (NULL != pPdn->pCTun)
       {
-         deleteCTun(pCTun);
-         pCTun = NULL;
-      }
-      
-      for (U32 i = 0; i < GTP_MAX_BEARERS; i++)
-      {
-         GtpBearer *bearer = m_bearerVec[i];
-         if (NULL != bearer)
-         {
-            if (GSIM_CHK_BEARER_MASK((*pPdn)->bearerMask, bearer->getEbi()))
-            {
-               GSIM_UNSET_BEARER_MASK((*pPdn)->bearerMask, bearer->getEbi());
-               delete bearer;
-            }
-         }
+         deleteCTun(pPdn->pCTun);
       }
 
-      delete *pPdn;
+      delete pPdn;
    }
 
    LOG_DEBUG("Deleting UE Session [%d]", m_sessionId);
 }
 
+VOID *UeSession::operator new(size_t size)
+{
+   return memPoolAlloc(MEM_POOL_SESSION, size);
+}
+
+VOID UeSession::operator delete(VOID *p)
+{
+   memPoolFree(MEM_POOL_SESSION, p);
+}
+
 RETVAL UeSession::run(VOID *arg)
 {
    RETVAL      ret = ROK;
 
    LOG_TRACE("Running UeSession [%d]", m_sessionId);
-   m_lastRunTime = m_currRunTime;
-   m_currRunTime = getMilliSeconds();
+   m_currRunTime = (U32)getMilliSeconds();
+   GSIM_UNSET_MASK(m_bitmask, GSIM_UE_SSN_DRAIN_PARKED);
 
-   if (GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_SCN_COMPLETE))
+   if (NULL != arg)
    {
-      ret = handleDeadCall(arg);
+      LOG_TRACE("Processing Recv() Task");
+      ret = handleRecv((UdpData_t*)arg);
    }
    else
    {
-      if (NULL != arg)
+      /* while draining, a session between two procedures moves on to the
+       * teardown, procedures in flight are completed first
+       */
+      if (isDraining() &&
+          !GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_TEARDOWN) &&
+          !GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_WAITING_FOR_RSP) &&
+          !GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_SEND_RSP))
+      {
+         BOOL parked = FALSE;
+         ret = handleDrain(&parked);
+         if (ROK != ret || parked)
+         {
+            syncSlot();
+            LOG_EXITFN(ret);
+         }
+      }
+
+      if (PROC_TYPE_WAIT == (*m_currProcItr)->type())
       {
-         LOG_TRACE("Processing Recv() Task");
-         ret = handleRecv((UdpData_t*)arg);
+         LOG_TRACE("Processing Wait() Task");
+         ret = handleWait();
       }
       else
       {
-         if (PROC_TYPE_WAIT == (*m_currProcItr)->type())
-         {
-            LOG_TRACE("Processing Wait() Task");
-            ret = handleWait();
-         }
-         else
-         {
-            LOG_TRACE("Processing Send() Task");
-            ret = handleSend();
-         }
+         LOG_TRACE("Processing Send() Task");
+         ret = handleSend();
       }
    }
 
+   syncSlot();
    LOG_EXITFN(ret);
 }
 
+/**
+ * @brief
+ *    Sessions due to send the initial request of a procedure are batched
+ *    by the job of the request, the other runs are not batched
+ */
+const VOID *UeSession::batchKey()
+{
+   if (isDraining() ||
+       GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_WAITING_FOR_RSP) ||
+       GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_SEND_RSP) ||
+       PROC_TYPE_WAIT == (*m_currProcItr)->type())
+   {
+      return NULL;
+   }
+
+   return (*m_currProcItr)->m_initial;
+}
+
+/**
+ * @brief
+ *    Sends the request of the same job for cnt sessions. The job, its
+ *    message template, the run time and the retransmission wait of the peer
+ *    are looked up once for the batch, each session then only sets its own
+ *    header, IMSI, TEIDs and variables in the template to encode it
+ *
+ * @param ppTasks
+ *    sessions with the batch key of this session
+ * @param cnt
+ * @param pRets
+ */
+VOID UeSession::runBatch(Task **ppTasks, U32 cnt, RETVAL *pRets)
+{
+   LOG_ENTERFN();
+
+   Job            *pJob    = (*m_currProcItr)->m_initial;
+   U32            now      = (U32)getMilliSeconds();
+   SessionTable   *pTable  = m_pScn->m_pSsnTable;
+   U8             peerIdx  = SSN_PEER_INVALID;
+   U32            rtxWait  = 0;
+
+   for (U32 i = 0; i < cnt; i++)
+   {
+      UeSession *pSsn = static_cast<UeSession *>(ppTasks[i]);
+
+      pSsn->m_currRunTime = now;
+      GSIM_UNSET_MASK(pSsn->m_bitmask, GSIM_UE_SSN_DRAIN_PARKED);
+      pRets[i] = pSsn->handleOutReqMsg(pJob);
+      if (ROK != pRets[i])
+      {
+         LOG_ERROR("Sending request message to peer, Error [%d]", pRets[i]);
+         pRets[i] = ROK_OVER;
+         continue;
+      }
+
+      /* sessions of a scenario mostly share a peer */
+      if (SSN_PEER_INVALID == pTable->peerIdx(pSsn->m_slot) ||
+          peerIdx != pTable->peerIdx(pSsn->m_slot))
+      {
+         peerIdx = pTable->peerIdx(pSsn->m_slot);
+         rtxWait = getRetransWait(addPeerData(pSsn->m_peerEp), 0);
+      }
+
+      pSsn->m_wakeTime = now + rtxWait;
+      pSsn->pause();
+      pSsn->syncSlot();
+   }
+
+   LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Copies the fields of the session swept over by the SessionTable
+ */
+VOID UeSession::syncSlot()
+{
+   SessionTable *pTable = m_pScn->m_pSsnTable;
+
+   pTable->update(m_slot, state(), m_bitmask,
+         (U16)(m_currProcItr - m_pScn->getFirstProcedure()), m_wakeTime);
+   if (NULL != m_pCurrPdn && NULL != m_pCurrPdn->pCTun)
+   {
+      pTable->updateTeids(m_slot, m_pCurrPdn->pCTun->m_locTeid,
+            m_pCurrPdn->pCTun->m_remTeid);
+   }
+}
+
+/**
+ * @brief
+ *    Session variables of the <store> and <patch> tags, kept in the slot of
+ *    the session, NULL if the scenario uses none
+ */
+GtpSsnVar_t *UeSession::vars()
+{
+   return m_pScn->m_pSsnTable->vars(m_slot);
+}
+
 RETVAL UeSession::handleSend()
 {
    LOG_ENTERFN();
@@ -170,6 +308,8 @@ RETVAL UeSession::handleSend()
          Stats::incStats(GSIM_STAT_NUM_SESSIONS_FAIL);
          delete m_currProcCache.sentMsg;
          m_currProcCache.sentMsg = NULL;
+         delPeerTrans(&m_peerEp, m_currProcCache.seqNumber, this);
+         GSIM_UNSET_MASK(this->m_bitmask, GSIM_UE_SSN_WAITING_FOR_RSP);
 
          /* request retry exceeded n3-requests. terminate the 
           * UE session Task
@@ -181,7 +321,7 @@ RETVAL UeSession::handleSend()
    {
       GtpMsg *gtpMsg = currProc->m_trigMsg->getGtpMsg();
       ret = handleOutRspMsg(gtpMsg);
-      if (ROK != ret)
+      if (ROK != ret && ROK_OVER != ret)
       {
          /* sending a response message failed, terminate the Task */
          LOG_ERROR("Sending response message to peer, Error [%d]", ret);
@@ -195,14 +335,14 @@ RETVAL UeSession::handleSend()
        * message is received. so after processing sending the request
        * out do not finish the task
        */
-      GtpMsg *gtpMsg = currProc->m_initial->getGtpMsg();
-      ret = handleOutReqMsg(gtpMsg);
+      ret = handleOutReqMsg(currProc->m_initial);
       if (ROK == ret)
       {
          /* update the wakeup time and pause this task until then,
           * for retransmissing the request message
           */
-         m_wakeTime = m_currRunTime + m_t3time;
+         m_wakeTime = m_currRunTime +
+            getRetransWait(addPeerData(m_peerEp), 0);
          pause();
       }
       else
@@ -216,13 +356,13 @@ RETVAL UeSession::handleSend()
    LOG_EXITFN(ret);
 }
 
-RETVAL UeSession::handleOutReqMsg(GtpMsg *gtpMsg)
+RETVAL UeSession::handleOutReqMsg(Job *pJob)
 {
    LOG_ENTERFN();
 
    RETVAL      ret = ROK;
    GtpcPdn     *pPdn = NULL;
-   Procedure   *currProc = *m_currProcItr;
+   GtpMsg      *gtpMsg = pJob->getGtpMsg();
 
    if (GTPC_MSG_CS_REQ == gtpMsg->type())
    {
@@ -230,7 +370,8 @@ RETVAL UeSession::handleOutReqMsg(GtpMsg *gtpMsg)
       Stats::incStats(GSIM_STAT_NUM_SESSIONS_CREATED);
       Stats::incStats(GSIM_STAT_NUM_SESSIONS);
       pPdn = createPdn();
-      m_pdnLst.push_back(pPdn);
+      pPdn->pNext = m_pPdnLst;
+      m_pPdnLst = pPdn;
       m_pCurrPdn = pPdn;
    }
    else
@@ -246,17 +387,24 @@ RETVAL UeSession::handleOutReqMsg(GtpMsg *gtpMsg)
    m_currProcCache.reqType = gtpMsg->type();
    UdpData_t *pNwData = new UdpData_t;
    encGtpcOutMsg(pPdn, gtpMsg, &pNwData->buf, &m_peerEp);
+   if (NULL != pJob->m_pPatch)
+   {
+      pJob->m_pPatch->patch(&pNwData->buf, vars());
+   }
 
    /* initial message, send the message over default send socket */
    m_retryCnt      = 0;
-   pNwData->connId = 0;
+   GSIM_UNSET_MASK(this->m_bitmask, GSIM_UE_SSN_RETRANS_DEFERRED);
+   pNwData->connId = TRANS_CONN_ID_SEND;
    pNwData->peerEp = m_peerEp;
 
    LOG_DEBUG("Sending GTPC Message [%s]", gtpGetMsgName(msgType));
    Buffer *buf = new Buffer(pNwData->buf);
-   sendMsg(pNwData->connId, &pNwData->peerEp, buf);
-   currProc->m_initial->m_numSnd++;
+   sendMsg(pNwData->connId, &pNwData->peerEp, buf, &pNwData->timeNs);
+   pJob->m_numSnd++;
+   GSIM_TRACE(m_traceId, TRACE_REQ_SENT, pJob->m_msgName, 0);
    m_currProcCache.sentMsg = pNwData;
+   addPeerTrans(&m_peerEp, m_currProcCache.seqNumber, this);
    GSIM_SET_MASK(this->m_bitmask, GSIM_UE_SSN_WAITING_FOR_RSP);
 
    LOG_EXITFN(ret);
@@ -275,33 +423,52 @@ RETVAL UeSession::handleOutReqTimeout()
 
    RETVAL      ret = ROK;
    Procedure   *currProc = *m_currProcItr;
+   U32         wait = 0;
 
    /* Recived task is run because GTP-C message request timedout
     * waiting for a response, retransmit the request message
     */
-   if (m_retryCnt >= m_n3req)
+   if (m_retryCnt >= Config::getInstance()->getN3Requests())
    {
       delete m_currProcCache.sentMsg;
       m_currProcCache.sentMsg = NULL;
       LOG_DEBUG("Maximum Retries reached");
       ret = ERR_MAX_RETRY_EXCEEDED;
    }
+   else if (!takeRetransToken(&wait))
+   {
+      /* retransmission budget exhausted, the retransmission is tried
+       * again later and does not count towards n3-requests
+       */
+      LOG_DEBUG("Retransmission deferred by [%u] ms", wait);
+      if (!GSIM_CHK_MASK(this->m_bitmask, GSIM_UE_SSN_RETRANS_DEFERRED))
+      {
+         GSIM_SET_MASK(this->m_bitmask, GSIM_UE_SSN_RETRANS_DEFERRED);
+         Stats::incStats(GSIM_STAT_NUM_RETRANS_DEFERRED);
+      }
+      m_wakeTime = m_currRunTime + wait;
+      pause();
+   }
    else
    {
       /* we have already processed this message, the task is run again
        * after retransmission timeout expiry
        */
       LOG_DEBUG("Retransmissing GTP Message");
+      GSIM_UNSET_MASK(this->m_bitmask, GSIM_UE_SSN_RETRANS_DEFERRED);
       Buffer *buf = new Buffer(m_currProcCache.sentMsg->buf);
       sendMsg(m_currProcCache.sentMsg->connId,\
             &m_currProcCache.sentMsg->peerEp, buf);
 
       currProc->m_initial->m_numSndRetrans++;
       m_retryCnt++;
+      GSIM_TRACE(m_traceId, TRACE_RETRANS, currProc->m_initial->m_msgName,
+            m_retryCnt);
 
       // if response is not received within T3 timer expiry
       // wakeup and retransmit request message
-      m_wakeTime = m_currRunTime + m_t3time;
+      m_wakeTime = m_currRunTime +
+         getRetransWait(addPeerData(m_peerEp), m_retryCnt);
       pause();
    }
 
@@ -319,6 +486,10 @@ RETVAL UeSession::handleOutRspMsg(GtpMsg *gtpMsg)
    UdpData_t *pNwData = new UdpData_t;
    encGtpcOutMsg(pPdn, currProc->m_trigMsg->getGtpMsg(), &pNwData->buf,\
          &m_peerEp);
+   if (NULL != currProc->m_trigMsg->m_pPatch)
+   {
+      currProc->m_trigMsg->m_pPatch->patch(&pNwData->buf, vars());
+   }
 
    /* send the response/triggered message over the same socket
     * over which the request/command is received
@@ -330,6 +501,7 @@ RETVAL UeSession::handleOutRspMsg(GtpMsg *gtpMsg)
    Buffer *buf = new Buffer(pNwData->buf);
    sendMsg(pNwData->connId, &pNwData->peerEp, buf);
    currProc->m_trigMsg->m_numSnd++;
+   GSIM_TRACE(m_traceId, TRACE_RSP_SENT, currProc->m_trigMsg->m_msgName, 0);
 
    delete m_prevProcCache.sentMsg;
    m_prevProcCache.sentMsg = pNwData;
@@ -341,10 +513,11 @@ RETVAL UeSession::handleOutRspMsg(GtpMsg *gtpMsg)
    if (m_pScn->isScenarioEnd(m_currProcItr))
    {
       handleCompletedTask();
-      LOG_EXITFN(ROK);
+      LOG_EXITFN(ROK_OVER);
    }
 
    m_currProcItr = m_pScn->getNextProcedure(m_currProcItr);
+   GSIM_TRACE(m_traceId, TRACE_STEP, procName(*m_currProcItr), 0);
    this->stop();
 
    LOG_EXITFN(ROK);
@@ -366,7 +539,7 @@ RETVAL UeSession::handleRecv(UdpData_t *data)
    {
       LOG_DEBUG("Processing Incoming Request message");
       ret = handleIncReqMsg(&gtpMsg, data);
-      if (ROK != ret)
+      if (ROK != ret && ROK_OVER != ret)
       {
          LOG_ERROR("Processing Incoming Request Message, Error [%d]", ret);
       }
@@ -375,7 +548,7 @@ RETVAL UeSession::handleRecv(UdpData_t *data)
    {
       LOG_DEBUG("Processing Incoming Response message");
       ret = handleIncRspMsg(&gtpMsg, data);
-      if (ROK != ret)
+      if (ROK != ret && ROK_OVER != ret)
       {
          LOG_ERROR("Processing Incoming Response Message, Error [%d]", ret);
       }
@@ -391,7 +564,18 @@ RETVAL UeSession::handleIncReqMsg(GtpMsg *rcvdReq, UdpData_t *rcvdData)
 
    if (isExpectedReq(rcvdReq))
    {
-      (*m_currProcItr)->m_initial->m_numRcv++;
+      Job *pReqJob = (*m_currProcItr)->m_initial;
+      pReqJob->m_numRcv++;
+      GSIM_TRACE(m_traceId, TRACE_REQ_RCVD, pReqJob->m_msgName, 0);
+      if (NULL != pReqJob->m_pRules)
+      {
+         pReqJob->m_pRules->validate(rcvdReq);
+      }
+
+      if (NULL != pReqJob->m_pStore)
+      {
+         pReqJob->m_pStore->store(rcvdReq, vars());
+      }
    }
    else if (isPrevProcReq(rcvdReq))
    {
@@ -419,7 +603,8 @@ RETVAL UeSession::handleIncReqMsg(GtpMsg *rcvdReq, UdpData_t *rcvdData)
       Stats::incStats(GSIM_STAT_NUM_SESSIONS);
       pdn = createPdn();
       m_pCurrPdn = pdn;
-      m_pdnLst.push_back(pdn);
+      pdn->pNext = m_pPdnLst;
+      m_pPdnLst = pdn;
    }
    else
    {
@@ -438,9 +623,9 @@ RETVAL UeSession::handleIncReqMsg(GtpMsg *rcvdReq, UdpData_t *rcvdData)
 
    /* run the procedure again to send the response */
    GSIM_SET_MASK(this->m_bitmask, GSIM_UE_SSN_SEND_RSP);
-   this->run();
+   RETVAL ret = this->run();
 
-   LOG_EXITFN(ROK);
+   LOG_EXITFN(ret);
 }
 
 BOOL UeSession::isExpectedRsp(GtpMsg *rspMsg)
@@ -513,13 +698,52 @@ PUBLIC RETVAL UeSession::handleIncRspMsg(GtpMsg *rspMsg, UdpData_t *rcvdData)
 {
    LOG_ENTERFN();
 
-   Procedure *currProc = *m_currProcItr;
+   RETVAL      ret = ROK;
+   Procedure   *currProc = *m_currProcItr;
 
    if (isExpectedRsp(rspMsg))
    {
       LOG_DEBUG("Expected response message received");
 
-      currProc->m_trigMsg->m_numRcv++;
+      Job        *pRspJob = currProc->m_trigMsg;
+      GtpCause_t cause    = rspMsg->getCause();
+      BOOL       rejected = GTP_CAUSE_IS_REJECT(cause);
+      BOOL       failed   = rejected && Config::getInstance()->getRejectFail();
+
+      pRspJob->m_numRcv++;
+      pRspJob->m_numCause[cause]++;
+      GSIM_TRACE(m_traceId, TRACE_RSP_RCVD, pRspJob->m_msgName, cause);
+      Stats::incCause(cause);
+      if (rejected)
+      {
+         LOG_DEBUG("Response rejected with cause [%d]", cause);
+         pRspJob->m_numRejected++;
+         Stats::incStats(GSIM_STAT_NUM_REJECTED);
+      }
+
+      if (NULL != pRspJob->m_pRules)
+      {
+         pRspJob->m_pRules->validate(rspMsg);
+      }
+
+      if (NULL != pRspJob->m_pStore)
+      {
+         pRspJob->m_pStore->store(rspMsg, vars());
+      }
+
+      procOverloadInfo(addPeerData(rcvdData->peerEp), rspMsg);
+
+      /* a response to a retransmitted request can not be matched to one
+       * of the sends, it is not timed
+       */
+      if (NULL != m_currProcCache.sentMsg && 0 == m_retryCnt &&
+          rcvdData->timeNs > m_currProcCache.sentMsg->timeNs)
+      {
+         U64         rtt   = rcvdData->timeNs - m_currProcCache.sentMsg->timeNs;
+         LatencyHist *pHist = failed ? getRejectTimeHist() : getRspTimeHist();
+         pHist->record(rtt);
+         rtoSample(addPeerData(rcvdData->peerEp), rtt);
+      }
 
       m_prevProcCache.connId = rcvdData->connId;
       m_prevProcCache.seqNumber = m_currProcCache.seqNumber;
@@ -529,18 +753,30 @@ PUBLIC RETVAL UeSession::handleIncRspMsg(GtpMsg *rspMsg, UdpData_t *rcvdData)
       m_prevProcItr = m_currProcItr;
 
       decAndStoreGtpcIncMsg(m_pCurrPdn, rspMsg, &rcvdData->peerEp);
+      delPeerTrans(&m_peerEp, m_currProcCache.seqNumber, this);
       GSIM_UNSET_MASK(this->m_bitmask, GSIM_UE_SSN_WAITING_FOR_RSP);
 
       delete m_currProcCache.sentMsg;
       m_currProcCache.sentMsg = NULL;
 
-      if (m_pScn->isScenarioEnd(m_currProcItr))
+      if (failed)
+      {
+         /* the peer keeps no context for a rejected session, it is not
+          * torn down
+          */
+         Stats::incStats(GSIM_STAT_NUM_SESSIONS_FAIL);
+         Stats::decStats(GSIM_STAT_NUM_SESSIONS);
+         ret = ROK_OVER;
+      }
+      else if (m_pScn->isScenarioEnd(m_currProcItr))
       {
          handleCompletedTask();
+         ret = ROK_OVER;
       }
       else
       {
          m_currProcItr = m_pScn->getNextProcedure(m_currProcItr);
+         GSIM_TRACE(m_traceId, TRACE_STEP, procName(*m_currProcItr), 0);
       }
    }
    else if (isPrevProcRsp(rspMsg))
@@ -556,7 +792,7 @@ PUBLIC RETVAL UeSession::handleIncRspMsg(GtpMsg *rspMsg, UdpData_t *rcvdData)
       currProc->m_trigMsg->m_numUnexp++;
    }
 
-   LOG_EXITFN(ROK);
+   LOG_EXITFN(ret);
 }
 
 RETVAL UeSession::handleWait()
@@ -566,32 +802,222 @@ RETVAL UeSession::handleWait()
    Procedure *currProc = *m_currProcItr;
 
    /* pause the task until wake up time */
-   m_wakeTime = m_currRunTime + currProc->m_wait->wait();
+   m_wakeTime = m_currRunTime + (U32)currProc->m_wait->wait();
    pause();
 
    m_prevProcItr = m_currProcItr;
    m_currProcItr = m_pScn->getNextProcedure(m_currProcItr);
+   GSIM_TRACE(m_traceId, TRACE_STEP, procName(*m_currProcItr), 0);
 
    LOG_EXITFN(ROK);
 }
 
+/**
+ * @brief
+ *    Sessions which have not sent a request yet are dropped. Others park
+ *    until the drain task releases their teardown, unless they are past it
+ *
+ * @param pParked
+ *
+ * @return ROK_OVER if the session is dropped
+ */
+RETVAL UeSession::handleDrain(BOOL *pParked)
+{
+   LOG_ENTERFN();
+
+   if (NULL == m_pPdnLst)
+   {
+      LOG_DEBUG("Dropping UE Session [%d], not started", m_sessionId);
+      LOG_EXITFN(ROK_OVER);
+   }
+
+   GSIM_SET_MASK(m_bitmask, GSIM_UE_SSN_TEARDOWN);
+
+   ProcedureItr teardownItr = getDrainProcedure();
+   if (m_currProcItr <= teardownItr)
+   {
+      m_currProcItr = teardownItr;
+      GSIM_SET_MASK(m_bitmask, GSIM_UE_SSN_DRAIN_PARKED);
+      addDrainSession(&m_imsiKey);
+      stop();
+      *pParked = TRUE;
+   }
+
+   LOG_EXITFN(ROK);
+}
+
+BOOL UeSession::isWaiting()
+{
+   return (TASK_STATE_PAUSED == state() &&
+         !GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_WAITING_FOR_RSP));
+}
+
+/**
+ * @brief
+ *    Starts the teardown of a parked session
+ *
+ * @return FALSE if the session is no longer parked
+ */
+BOOL UeSession::releaseDrain()
+{
+   if (!GSIM_CHK_MASK(m_bitmask, GSIM_UE_SSN_DRAIN_PARKED))
+   {
+      return FALSE;
+   }
+
+   GSIM_UNSET_MASK(m_bitmask, GSIM_UE_SSN_DRAIN_PARKED);
+   resumeTask();
+
+   return TRUE;
+}
+
+/**
+ * @brief
+ *    Saves the session to a checkpoint record, only sessions with an
+ *    established PDN are saved. Called in the checkpoint child, so it must
+ *    not allocate memory
+ *
+ * @param pRec
+ * @param now
+ *    milliseconds since the simulator start
+ *
+ * @return FALSE if the session is not established
+ */
+BOOL UeSession::save(CkptSession_t *pRec, U32 now)
+{
+   if (NULL == m_pCurrPdn || NULL == m_pCurrPdn->pCTun ||
+       0 == m_pCurrPdn->pCTun->m_remTeid ||
+       m_currProcItr == m_pScn->m_procSeq.end())
+   {
+      return FALSE;
+   }
+
+   /* a request in flight is sent again after the restore */
+   MEMSET(pRec, 0, sizeof(CkptSession_t));
+   pRec->imsiKey    = m_imsiKey;
+   pRec->procIndx   = m_currProcItr - m_pScn->m_procSeq.begin();
+   pRec->peerEp     = m_peerEp;
+   pRec->cTunPeerEp = m_pCurrPdn->pCTun->m_peerEp;
+   pRec->cTeidLoc   = m_pCurrPdn->pCTun->m_locTeid;
+   pRec->cTeidRem   = m_pCurrPdn->pCTun->m_remTeid;
+   pRec->bearerMask = m_pCurrPdn->bearerMask;
+   if (NULL != vars())
+   {
+      MEMCPY(pRec->vars, vars(), sizeof(pRec->vars));
+   }
+   else
+   {
+      MEMSET(pRec->vars, 0, sizeof(pRec->vars));
+   }
+
+   if (isWaiting() && m_wakeTime > now)
+   {
+      pRec->wakeIn = m_wakeTime - now;
+   }
+
+   for (U32 i = 0; i < GTP_MAX_BEARERS; i++)
+   {
+      if (m_bearers[i].inUse())
+      {
+         pRec->ebi[i]        = m_bearers[i].getEbi();
+         pRec->dfltBearer[i] = m_bearers[i].isDfltBearer();
+         pRec->uTeid[i]      = m_bearers[i].allocatedTeid();
+      }
+   }
+
+   return TRUE;
+}
+
+/**
+ * @brief
+ *    Creates a session from its checkpoint record, the session continues
+ *    with the saved procedure
+ *
+ * @param pScn
+ * @param pRec
+ *
+ * @return NULL if the record does not fit the scenario
+ */
+UeSession* UeSession::restore(Scenario *pScn, const CkptSession_t *pRec)
+{
+   LOG_ENTERFN();
+
+   if (pRec->procIndx >= pScn->m_procSeq.size() ||
+       pRec->imsiKey.len > sizeof(pRec->imsiKey.val) ||
+       NULL != getUeSession(pScn, pRec->imsiKey) ||
+       NULL != findCTun(pRec->cTeidLoc))
+   {
+      LOG_ERROR("Invalid checkpoint record, TEID [%u]", pRec->cTeidLoc);
+      LOG_EXITFN(NULL);
+   }
+
+   UeSession *pSsn = createUeSession(pScn, pRec->imsiKey);
+   pSsn->m_peerEp      = pRec->peerEp;
+   pSsn->m_currProcItr = pScn->m_procSeq.begin() + pRec->procIndx;
+   if (NULL != pSsn->vars())
+   {
+      MEMCPY(pSsn->vars(), pRec->vars, sizeof(pRec->vars));
+   }
+
+   GtpcPdn *pPdn    = new GtpcPdn;
+   pPdn->pUeSession = pSsn;
+   pPdn->bearerMask = pRec->bearerMask;
+   pPdn->pCTun      = new GtpcTun(pRec->cTeidLoc);
+   pPdn->pCTun->m_remTeid    = pRec->cTeidRem;
+   pPdn->pCTun->m_peerEp     = pRec->cTunPeerEp;
+   pPdn->pCTun->m_pPdn       = pPdn;
+   pPdn->pCTun->m_pUeSession = pSsn;
+   pSsn->m_pPdnLst  = pPdn;
+   pSsn->m_pCurrPdn = pPdn;
+
+   for (U32 i = 0; i < GTP_MAX_BEARERS; i++)
+   {
+      if (0 != pRec->ebi[i])
+      {
+         pSsn->m_bearers[i].restore(pRec->ebi[i], pRec->dfltBearer[i],
+               pRec->uTeid[i]);
+      }
+   }
+
+   Stats::incStats(GSIM_STAT_NUM_SESSIONS_CREATED);
+   Stats::incStats(GSIM_STAT_NUM_SESSIONS);
+
+   Job *pJob = (*pSsn->m_currProcItr)->m_initial;
+   if (0 != pRec->wakeIn)
+   {
+      /* the remainder of the wait procedure */
+      pSsn->m_wakeTime = (U32)getMilliSeconds() + pRec->wakeIn;
+      pSsn->pause();
+   }
+   else if (NULL != pJob && JOB_TYPE_RECV == pJob->type())
+   {
+      /* waits for the request of the peer */
+      pSsn->stop();
+   }
+
+   pScn->m_pSsnTable->updatePeer(pSsn->m_slot, getPeerIndex(&pSsn->m_peerEp));
+   pSsn->syncSlot();
+
+   LOG_EXITFN(pSsn);
+}
+
 /**
  * @brief
  *    Creates a new UE Session with imsi = imsiKey
  *    Used when the session is created by this simulator entity
  *
+ * @param pScn
+ *    scenario to be executed by the UE session
  * @param imsiKey
- * @param pGtpMsg
  *
  * @return 
  */
-UeSession* UeSession::createUeSession(GtpImsiKey imsiKey)
+UeSession* UeSession::createUeSession(Scenario *pScn, GtpImsiKey imsiKey)
 {
    U8    *pImsi = imsiKey.val;
 
-   Scenario *pScn = Scenario::getInstance();
    UeSession *pUeSsn = new UeSession(pScn, imsiKey);
-   s_ueSessionMap.insert(UeSessionMapPair(imsiKey, pUeSsn));
+   pScn->m_ueSessionMap.insert(UeSessionMapPair(imsiKey, pUeSsn));
 
    LOG_ERROR("Creating UE Session [%x%x%x%x%x%x%x%x]",\
          pImsi[0], pImsi[1], pImsi[2], pImsi[3], pImsi[4], pImsi[5],\
@@ -623,14 +1049,14 @@ UeSession* UeSession::getUeSession(GtpTeid_t teid)
    LOG_EXITFN(pUeSession);
 }
 
-UeSession* UeSession::getUeSession(GtpImsiKey imsiKey)
+UeSession* UeSession::getUeSession(Scenario *pScn, GtpImsiKey imsiKey)
 {
    LOG_ENTERFN();
 
    UeSession *pUeSession = NULL;
 
-   UeSessionMapItr   itr = s_ueSessionMap.find(imsiKey);
-   if (itr != s_ueSessionMap.end())
+   UeSessionMapItr   itr = pScn->m_ueSessionMap.find(imsiKey);
+   if (itr != pScn->m_ueSessionMap.end())
    {
       pUeSession = itr->second;
    }
@@ -687,10 +1113,14 @@ VOID UeSession::createBearers
          GtpIe *pIe = pGtpMsg->getIe(GTP_IE_BEARER_CNTXT, instance, i);
          GtpBearerContext *bearerCntxt = dynamic_cast<GtpBearerContext *>(pIe);
          GtpEbi_t ebi = bearerCntxt->getEbi();
+         if (ebi < GTP_MIN_EBI || ebi >= GTP_MIN_EBI + GTP_MAX_BEARERS)
+         {
+            LOG_ERROR("Invalid EBI [%d] in Bearer Context", ebi);
+            continue;
+         }
 
-         GtpBearer *pBearer = new GtpBearer(pPdn, ebi);
+         m_bearers[GTP_BEARER_INDEX(ebi)].create(ebi);
          GSIM_SET_BEARER_MASK(pPdn->bearerMask, ebi);
-         m_bearerVec[GTP_BEARER_INDEX(ebi)] = pBearer;
       }
    }
 
@@ -712,7 +1142,14 @@ const IPEndPoint  *pPeerEp
    {
       GtpFteid *pFteid = dynamic_cast<GtpFteid *>\
             (pGtpMsg->getIe(GTP_IE_FTEID, 0, 1));
-      pPdn->pCTun->m_remTeid = pFteid->getTeid();
+
+      /* a rejected Create Session Response may not carry the sender
+       * F-TEID of the peer
+       */
+      if (NULL != pFteid)
+      {
+         pPdn->pCTun->m_remTeid = pFteid->getTeid();
+      }
    }
 
    pPdn->pCTun->m_peerEp.ipAddr.ipAddrType = IP_ADDR_TYPE_V4;
@@ -779,7 +1216,10 @@ IPEndPoint  *peerEp
       GtpIe *pIe = pGtpMsg->getIe(GTP_IE_BEARER_CNTXT, 0, i);
       GtpBearerContext *bearerCntxt = dynamic_cast<GtpBearerContext*>(pIe);
       GtpBearer *pBearer = this->getBearer(bearerCntxt->getEbi());
-      bearerCntxt->setGtpuTeid(pBearer->localTeid(), 0);
+      if (NULL != pBearer)
+      {
+         bearerCntxt->setGtpuTeid(pBearer->localTeid(), 0);
+      }
    }
 
    MEMSET(buf, 0, GTP_MSG_BUF_LEN);
@@ -790,97 +1230,109 @@ IPEndPoint  *peerEp
    LOG_EXITVOID();
 }
 
-RETVAL UeSession::handleDeadCall(VOID *arg)
+GtpBearer* UeSession::getBearer(GtpEbi_t ebi)
 {
    LOG_ENTERFN();
 
-   RETVAL ret = ROK;
-
-   if (NULL == arg)
+   GtpBearer *pBearer = NULL;
+   if (ebi >= GTP_MIN_EBI && ebi < GTP_MIN_EBI + GTP_MAX_BEARERS && \
+       m_bearers[GTP_BEARER_INDEX(ebi)].inUse())
    {
-      /* Session run invoked because of deadcall timer expiry */
-      if (m_currRunTime >= m_wakeTime)
-      {
-         ret = ROK_OVER;
-         Stats::decStats(GSIM_STAT_NUM_DEADCALLS);
-      }
-   }
-   else
-   {
-      /* A retransmitted message is received for a session whose scenario
-       * is already completed
-       */
-      UdpData_t *data = (UdpData_t*)arg;
-      GtpMsg rcvdMsg(&data->buf);
-
-      if (isPrevProcReq(&rcvdMsg))
-      {
-         /* resend the request response */
-         Buffer *buf = new Buffer(m_prevProcCache.sentMsg->buf);
-         sendMsg(m_prevProcCache.sentMsg->connId,\
-               &m_prevProcCache.sentMsg->peerEp, buf);
-         (*m_prevProcItr)->m_initial->m_numRcvRetrans++;
-         (*m_prevProcItr)->m_trigMsg->m_numSndRetrans++;
-      }
-      else if (isPrevProcRsp(&rcvdMsg))
-      {
-         (*m_prevProcItr)->m_trigMsg->m_numRcvRetrans++;
-      }
-      else
-      {
-         (*m_prevProcItr)->m_initial->m_numUnexp++;
-      }
-
-      m_wakeTime = m_currRunTime + (m_wakeTime - m_lastRunTime);
-      pause();
-      delete data;
+      pBearer = &m_bearers[GTP_BEARER_INDEX(ebi)];
    }
 
-   LOG_EXITFN(ret);
+   LOG_EXITFN(pBearer);
 }
 
-GtpBearer* UeSession::getBearer(GtpEbi_t ebi)
+/**
+ * @brief Contructor, the bearer is not in use until created
+ */
+GtpBearer::GtpBearer()
 {
-   LOG_ENTERFN();
-
-   GtpBearer *pBearer = m_bearerVec[GTP_BEARER_INDEX(ebi)];
-
-   LOG_EXITFN(pBearer);
+   m_ebi = 0;
+   m_isDefBearer = FALSE;
+   m_pUTun = NULL;
 }
 
-GtpcPdnLst* UeSession::getPdnList()
+/**
+ * @brief Destructor
+ */
+GtpBearer::~GtpBearer()
 {
-   return &m_pdnLst;
+   delete m_pUTun;
 }
 
 /**
- * @brief Contructor
+ * @brief Takes the bearer into use for the EBI
  *
- * @param pPdn
  * @param ebi
  */
-GtpBearer::GtpBearer(GtpcPdn  *pPdn, GtpEbi_t ebi)
+VOID GtpBearer::create(GtpEbi_t ebi)
 {
-   m_pPdn = pPdn;
+   release();
    m_ebi = ebi;
-   m_pUTun = new GtpuTun;
 }
 
+VOID GtpBearer::release()
+{
+   delete m_pUTun;
+   m_pUTun = NULL;
+   m_ebi = 0;
+   m_isDefBearer = FALSE;
+}
 
 /**
- * @brief Destructor
+ * @brief Returns the local user plane TEID, the user plane tunnel is
+ *    allocated on first use
  */
-GtpBearer::~GtpBearer()
+GtpTeid_t GtpBearer::localTeid()
 {
-   delete m_pUTun;
+   if (NULL == m_pUTun)
+   {
+      m_pUTun = new GtpuTun;
+   }
+
+   return m_pUTun->localTeid();
+}
+
+/**
+ * @brief Returns the local user plane TEID, 0 if it was never used
+ */
+GtpTeid_t GtpBearer::allocatedTeid()
+{
+   return (NULL == m_pUTun) ? 0 : m_pUTun->localTeid();
 }
 
-PUBLIC VOID cleanupUeSessions()
+/**
+ * @brief Takes the bearer into use with its checkpointed user plane TEID
+ *
+ * @param ebi
+ * @param dflt
+ * @param uTeid 0 if the user plane tunnel was not allocated
+ */
+VOID GtpBearer::restore(GtpEbi_t ebi, BOOL dflt, GtpTeid_t uTeid)
+{
+   create(ebi);
+   m_isDefBearer = dflt;
+   if (0 != uTeid)
+   {
+      m_pUTun = new GtpuTun(uTeid);
+   }
+}
+
+PUBLIC VOID cleanupUeSessions(Scenario *pScn)
 {
-   UeSessionMapItr ueItr = s_ueSessionMap.begin();
-   for (; ueItr != s_ueSessionMap.end(); ueItr++)
+   SessionTable *pTable = pScn->m_pSsnTable;
+
+   /* session destructor removes the session from the map and frees its
+    * slot, the slots are not moved
+    */
+   for (U32 slot = pTable->numSlots(); slot > 0; slot--)
    {
-      delete ueItr->second;
+      if (pTable->isUsed(slot - 1))
+      {
+         pTable->session(slot - 1)->abort();
+      }
    }
 }
 
@@ -888,12 +1340,13 @@ PUBLIC GtpcTun* getS11S4CTun(UeSession *pUeSession)
 {
    LOG_ENTERFN();
 
-   GtpcPdnLst  *pPdnLst = pUeSession->getPdnList();
    GtpcTun     *pCTun = NULL;
-   
-   for (GtpcPdnLstItr b = pPdnLst->begin(); b != pPdnLst->end(); b++)
+
+   /* the most recently created PDN is at the head of the list */
+   GtpcPdn     *pPdn = pUeSession->getPdnList();
+   if (NULL != pPdn)
    {
-      pCTun = (*b)->pCTun;
+      pCTun = pPdn->pCTun;
    }
 
    LOG_EXITFN(pCTun);
@@ -953,15 +1406,30 @@ VOID UeSession::handleCompletedTask()
 
    Stats::incStats(GSIM_STAT_NUM_SESSIONS_SUCC);
    Stats::decStats(GSIM_STAT_NUM_SESSIONS);
+   GSIM_TRACE(m_traceId, TRACE_SSN_DONE, NULL, 0);
 
-   /* the scenario for this UE session is complete, wait for deal-call
-    * timer expiry to cleanup the sessions. This is required to handle
-    * any delayed or retransmitted response or request messages
+   /* the scenario for this UE session is complete, a tombstone is kept
+    * until the dead call timer expiry to handle any delayed or
+    * retransmitted response or request messages. The session is deleted
+    * by the caller
     */
-   Stats::incStats(GSIM_STAT_NUM_DEADCALLS);
-   GSIM_SET_MASK(m_bitmask, GSIM_UE_SSN_SCN_COMPLETE);
-   m_wakeTime = m_lastRunTime + Config::getInstance()->getDeadCallWait();
-   pause();
+   Tombstone *pTomb = new Tombstone;
+   pTomb->m_pScn      = m_pScn;
+   pTomb->m_pProc     = *m_prevProcItr;
+   pTomb->m_pSentMsg  = m_prevProcCache.sentMsg;
+   pTomb->m_expiry    = m_currRunTime + \
+         Config::getInstance()->getDeadCallWait();
+   pTomb->m_seqNumber = m_prevProcCache.seqNumber;
+   pTomb->m_reqType   = (GtpMsgType_t)m_prevProcCache.reqType;
+   pTomb->m_rspType   = (GtpMsgType_t)m_prevProcCache.rspType;
+   pTomb->m_imsiKey   = m_imsiKey;
+   if (NULL != m_pCurrPdn && NULL != m_pCurrPdn->pCTun)
+   {
+      pTomb->m_teid   = m_pCurrPdn->pCTun->m_locTeid;
+   }
+
+   m_prevProcCache.sentMsg = NULL;
+   addTombstone(pTomb);
 
    LOG_EXITVOID();
 }
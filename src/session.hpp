@@ -19,23 +19,12 @@
 
 class Scenario;
 class UeSession;
+struct _CkptSession_t_;
 
 #define GSIM_SET_BEARER_MASK(_b, _e) GSIM_SET_MASK((_b), (1 << (_e)))
 #define GSIM_UNSET_BEARER_MASK(_b, _e) GSIM_UNSET_MASK((_b), (1 << (_e)))
 #define GSIM_CHK_BEARER_MASK(_b, _e) GSIM_CHK_MASK((_b), (1 << (_e)))
 
-struct CompareImsiKey
-{
-   bool operator() (const GtpImsiKey& left, const GtpImsiKey& right) const
-   {
-      return (MEMCMP(left.val, right.val, left.len) < 0);
-   }
-};
-
-typedef std::map<GtpImsiKey, UeSession*, CompareImsiKey> UeSessionMap;
-typedef std::pair<GtpImsiKey, UeSession*>                UeSessionMapPair;
-typedef UeSessionMap::iterator                           UeSessionMapItr;
-
 class GtpcPdn
 {
    public:
@@ -43,6 +32,7 @@ class GtpcPdn
       {
          pCTun      = NULL;
          pUeSession = NULL;
+         pNext      = NULL;
          bearerMask = 0;
       }
 
@@ -52,6 +42,7 @@ class GtpcPdn
                             */
 
       UeSession   *pUeSession;
+      GtpcPdn     *pNext;  /* next PDN connection of the UE session */
 
       U32         bearerMask; /* bitmask represents a bearer
                                * for e.g. bearer-id = 6, 6th lsb will be
@@ -59,29 +50,34 @@ class GtpcPdn
                                */
 };
 
+/**
+ * @brief
+ *    EPS bearer, stored inline in the UE session. The user plane tunnel is
+ *    allocated only when its TEID is first used, it is not applicable for
+ *    S11, S4 and S10 interfaces
+ */
 class GtpBearer
 {
    private:
+      GtpEbi_t m_ebi;        /* 0 when the bearer is not in use */
       BOOL     m_isDefBearer;
-      U8       m_ebi;
-      GtpcPdn  *m_pPdn;
-      GtpuTun  *m_pUTun;     /* not applicable for S11, S4, S10 interfaces */
+      GtpuTun  *m_pUTun;
 
    public:
+      GtpBearer();
       ~GtpBearer();
-      GtpBearer(GtpcPdn*, GtpEbi_t);
 
+      VOID      create(GtpEbi_t ebi);
+      VOID      release();
+      BOOL      inUse() {return (0 != m_ebi);}
       GtpEbi_t  getEbi() {return m_ebi;}
-      GtpTeid_t localTeid() {return m_pUTun->localTeid();}
+      GtpTeid_t localTeid();
       VOID      setDfltBearer(BOOL b) {m_isDefBearer = b;}
-
+      BOOL      isDfltBearer() {return m_isDefBearer;}
+      GtpTeid_t allocatedTeid();
+      VOID      restore(GtpEbi_t ebi, BOOL dflt, GtpTeid_t uTeid);
 };
 
-typedef std::list<GtpcPdn *>        GtpcPdnLst;
-typedef GtpcPdnLst::iterator        GtpcPdnLstItr;
-
-typedef std::vector<GtpBearer*>     GtpBearerVec;
-
 typedef struct
 {
    GtpMsgType_t   reqType;
@@ -91,16 +87,19 @@ typedef struct
 
 typedef struct _ProcCache_t_
 {
+   UdpData_t         *sentMsg;
    GtpSeqNumber_t    seqNumber;
-   GtpMsgType_t      reqType;
-   GtpMsgType_t      rspType;
    TransConnId       connId;
-   UdpData_t         *sentMsg;
+   U8                reqType;   /* GtpMsgType_t */
+   U8                rspType;   /* GtpMsgType_t */
 
    _ProcCache_t_()
    {
       sentMsg = NULL;
       seqNumber = 0;
+      connId = 0;
+      reqType = GTPC_MSG_TYPE_INVALID;
+      rspType = GTPC_MSG_TYPE_INVALID;
    }
 } ProcCache_t;
 
@@ -110,42 +109,60 @@ class UeSession: public Task
       UeSession(Scenario *pScn, GtpImsiKey);
       ~UeSession();
 
+      static VOID       *operator new(size_t size);
+      static VOID       operator delete(VOID *p);
+
       RETVAL            run(VOID *arg = NULL);  
-      static UeSession  *createUeSession(GtpImsiKey);
+      const VOID        *batchKey();
+      VOID              runBatch(Task **ppTasks, U32 cnt, RETVAL *pRets);
+      static UeSession  *createUeSession(Scenario*, GtpImsiKey);
       static UeSession  *getUeSession(GtpTeid_t);
-      static UeSession  *getUeSession(GtpImsiKey);
+      static UeSession  *getUeSession(Scenario*, GtpImsiKey);
       static GtpcTun*   getCTun(GtpTeid_t teid);
       VOID              deleteTunnel(GtpTeid_t teid);
       GtpcPdn           *createPdn();
       VOID              deletePdn();
-      GtpcPdnLst        *getPdnList();
+      GtpcPdn           *getPdnList() { return m_pPdnLst; }
       GtpImsiKey        m_imsiKey;
 
       inline Time_t     wake() { return m_wakeTime; }
 
+      /* paused in a wait procedure */
+      BOOL              isWaiting();
+      BOOL              releaseDrain();
+
+      /* checkpoint of an established session */
+      BOOL              save(struct _CkptSession_t_ *pRec, U32 now);
+      static UeSession  *restore(Scenario*, const struct _CkptSession_t_*);
+
    private:
 #define GSIM_UE_SSN_WAITING_FOR_RSP       (1 << 0)
-#define GSIM_UE_SSN_SCN_COMPLETE          (1 << 1)
 #define GSIM_UE_SSN_SEND_RSP              (1 << 2)
 #define GSIM_UE_SSN_PREV_PROC_PRES        (1 << 3)
-      U32               m_bitmask;
-      U32               m_n3req;
-      Time_t            m_t3time;
-      Time_t            m_lastRunTime;
-      Time_t            m_currRunTime;
-      U32               m_retryCnt;
-      U32               m_sessionId;
-      IPEndPoint        m_peerEp;
-      EpcNodeType_t     m_nodeType; 
-      GtpcPdnLst        m_pdnLst;     
-      GtpBearerVec      m_bearerVec;
-      Time_t            m_wakeTime;
-      GtpcPdn           *m_pCurrPdn;
+#define GSIM_UE_SSN_TEARDOWN              (1 << 4)
+#define GSIM_UE_SSN_DRAIN_PARKED          (1 << 5)
+#define GSIM_UE_SSN_RETRANS_DEFERRED      (1 << 6)
       Scenario          *m_pScn;
-      ProcCache_t       m_prevProcCache;
-      ProcCache_t       m_currProcCache;
+      GtpcPdn           *m_pPdnLst;   /* most recently created PDN first */
+      GtpcPdn           *m_pCurrPdn;
       ProcedureItr      m_currProcItr;
       ProcedureItr      m_prevProcItr;
+      ProcCache_t       m_prevProcCache;
+      ProcCache_t       m_currProcCache;
+      IPEndPoint        m_peerEp;
+
+      /* times in milliseconds since the simulator start, wraps after
+       * 49 days of run time
+       */
+      U32               m_wakeTime;
+      U32               m_currRunTime;
+      U32               m_sessionId;
+      U8                m_bitmask;
+      U8                m_retryCnt;
+      U32               m_traceId;    /* 0 if the session is not traced */
+      U32               m_slot;       /* in the SessionTable of m_pScn */
+
+      GtpBearer         m_bearers[GTP_MAX_BEARERS]; /* GTP_BEARER_INDEX */
 
       BOOL              isExpectedRsp(GtpMsg *rspMsg);
       BOOL              isExpectedReq(GtpMsg *rspMsg);
@@ -165,14 +182,16 @@ class UeSession: public Task
       RETVAL            handleIncReqMsg(GtpMsg *pGtpMsg, UdpData_t *rcvdData);
       RETVAL            handleIncRspMsg(GtpMsg *pGtpMsg, UdpData_t *rcvdData);
       RETVAL            handleOutRspMsg(GtpMsg *gtpMsg);
-      RETVAL            handleOutReqMsg(GtpMsg *gtpMsg);
+      RETVAL            handleOutReqMsg(Job *pJob);
       RETVAL            handleOutReqTimeout();
-      RETVAL            handleDeadCall(VOID *arg);
       VOID              handleCompletedTask();
+      RETVAL            handleDrain(BOOL *pParked);
+      VOID              syncSlot();
+      GtpSsnVar_t       *vars();
 };
 
 EXTERN UeSession* getUeSession(const U8* pImsi);
-EXTERN VOID       cleanupUeSessions();
+EXTERN VOID       cleanupUeSessions(Scenario *pScn);
 EXTERN GtpcTun*   getS11S4CTun(UeSession *pUeSession);
 
 #endif
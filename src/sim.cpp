@@ -16,10 +16,12 @@
 
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 
 using std::vector;
 
 #include "types.hpp"
+#include "error.hpp"
 #include "logger.hpp"
 #include "macros.hpp"
 #include "timer.hpp"
@@ -34,14 +36,25 @@ using std::vector;
 #include "sim_cfg.hpp"
 #include "transport.hpp"
 #include "task.hpp"
+#include "gtp_peer.hpp"
 #include "traffic.hpp"
 #include "keyboard.hpp"
 #include "display.hpp"
 #include "scenario.hpp"
-#include "gtp_peer.hpp"
+#include "validate.hpp"
+#include "replay.hpp"
+#include "mempool.hpp"
+#include "affinity.hpp"
+#include "poller.hpp"
+#include "latency.hpp"
+#include "cluster.hpp"
+#include "trace.hpp"
+#include "drain.hpp"
+#include "checkpoint.hpp"
+#include "stats_shm.hpp"
 #include "sim.hpp"
 
-EXTERN VOID      cleanupUeSessions();
+EXTERN VOID      cleanupUeSessions(Scenario *pScn);
 class Simulator *Simulator::pSim = NULL;
 
 Simulator *Simulator::getInstance()
@@ -80,8 +93,54 @@ VOID Simulator::run(VOID *arg)
 {
     LOG_ENTERFN();
 
+    Config     *pCfg    = Config::getInstance();
+    ReplayTask *pReplay = NULL;
+
+    /* the coordinator runs no traffic, it loads the scenario to show the
+     * statistics of the agents
+     */
+    if (isClusterCoordinator())
+    {
+        m_pScn = Scenario::getInstance();
+        m_pScn->init(pCfg->getScnFile());
+        initStatsShm(m_pScn);
+        runClusterCoordinator();
+        closeStatsShm();
+        printLatencyStats();
+        Stats::printCauseStats();
+        TaskMgr::deleteAllTasks();
+        LOG_EXITVOID();
+    }
+
+    if (isClusterAgent())
+    {
+        joinCluster();
+    }
+
+    /* pinned first, so that the pools are allocated on the node of the
+     * scheduler CPU
+     */
+    initAffinity();
+
+    /* pools are created on first use, on the node of this thread */
+    initMemPools();
+
     m_pScn = Scenario::getInstance();
-    m_pScn->init(Config::getInstance()->getScnFile());
+    if (pCfg->getReplayFile().empty())
+    {
+        m_pScn->init(pCfg->getScnFile());
+        initDrain(m_pScn);
+    }
+    else
+    {
+        pReplay = new ReplayTask(pCfg->getReplayFile(),
+            pCfg->getReplaySpeed());
+        if (ROK != pReplay->init())
+        {
+            pReplay->abort();
+            throw GsimError("Unable to replay " + pCfg->getReplayFile());
+        }
+    }
 
     /* Creates UDP sockets for listing of gtp messages */
     LOG_DEBUG("Initializing Transport connections");
@@ -91,6 +150,9 @@ VOID Simulator::run(VOID *arg)
         LOG_EXITVOID();
     }
 
+    checkIrqAffinity();
+    initPoller();
+
     // Initialing the Keyboard to process user inputs
     Keyboard *pKb = Keyboard::getInstance();
     pKb->init();
@@ -98,10 +160,26 @@ VOID Simulator::run(VOID *arg)
     // Initialing the Display task to display session statistics on terminal
     Display *pDisp = Display::getInstance();
     pDisp->init();
+    initTrace();
 
-    if (SCN_TYPE_INITIATING == m_pScn->getScnType())
+    if (NULL == pReplay)
     {
-        TrafficTask *pTTask = new TrafficTask;
+        restoreCheckpoint(m_pScn);
+        initCheckpoint(m_pScn);
+    }
+
+    initStatsShm((NULL == pReplay) ? m_pScn : NULL);
+
+    if (NULL != pReplay)
+    {
+        IPEndPoint peer;
+        peer.ipAddr = pCfg->getRemoteIpAddr();
+        peer.port   = pCfg->getRemoteGtpcPort();
+        addPeerData(peer);
+    }
+    else if (SCN_TYPE_INITIATING == m_pScn->getScnType())
+    {
+        TrafficTask *pTTask = new TrafficTask(m_pScn);
         if (pTTask == NULL)
         {
             LOG_ERROR("Traffic Task Init");
@@ -116,12 +194,29 @@ VOID Simulator::run(VOID *arg)
         addPeerData(peer);
     }
 
+    if (isClusterAgent())
+    {
+        clusterAgentReady();
+    }
+
     LOG_DEBUG("Generating Signalling traffic");
     startScheduler();
 
+    leaveCluster();
+    closeStatsShm();
     pKb->abort();
+    if (NULL != pReplay)
+    {
+        pReplay->printStats();
+    }
+    printLatencyStats();
+    Stats::printCauseStats();
+    printValidateStats(m_pScn);
+    writeTrace();
+    logPollStats();
     TaskMgr::deleteAllTasks();
     deletePeerTable();
+    closeTransport();
 
     LOG_EXITVOID();
 }
@@ -158,26 +253,20 @@ VOID Simulator::startScheduler()
             TaskMgr::resumePausedTasks();
         }
 
-        TaskList *  pRunningTasks = TaskMgr::getRunningTasks();
-        TaskListItr itr           = pRunningTasks->begin();
-        while (itr != pRunningTasks->end())
-        {
-            Task *t = *itr;
-
-            // increment the iterator here, because after the task is run
-            // it will be paused state which will move the task from running
-            // task list to paused task list.
-            itr++;
-            if (ROK != t->run())
-            {
-                t->abort();
-            }
-        }
+        TaskMgr::runTasks();
 
         getMilliSeconds();
 
-        // read the sockets for keyboard events and gtp messages
-        socketPoll(1);
+        // read the sockets for keyboard events and gtp messages, paused
+        // tasks are not resumed while the traffic is paused
+        Time_t maxWait = GSIM_POLL_MAX_WAIT;
+        if (Keyboard::key != KB_KEY_PAUSE_TRAFFIC)
+        {
+            maxWait = TaskMgr::nextWakeDelay(GSIM_POLL_MAX_WAIT);
+        }
+
+        pollIo(maxWait);
+        pollClusterAgent();
     }
 
     LOG_EXITVOID();
@@ -34,6 +34,7 @@
 #include "help.hpp"
 #include "gtp_types.hpp"
 #include "sim_cfg.hpp"
+#include "mempool.hpp"
 
 static Config *pCfg        = NULL;
 static S8      DFLT_IMSI[] = "112233445566778";
@@ -86,6 +87,28 @@ Config::Config()
     m_traceMsg                           = FALSE;
     pid_t pid                            = getpid();
     m_localIpAddrStr                     = DFLT_LOCAL_IP_ADDR;
+    m_transportType                      = DFLT_TRANSPORT;
+    m_sqPollIdle                         = 0;
+    m_packetIf                           = DFLT_PACKET_IF;
+    m_replaySpeed                        = DFLT_REPLAY_SPEED;
+    m_hugePageSize                       = 0;
+    m_memPoolSize                        = DFLT_MEM_POOL_SIZE;
+    m_numaNode                           = DFLT_NUMA_NODE;
+    m_schedCpu                           = DFLT_SCHED_CPU;
+    m_workerCpus                         = DFLT_WORKER_CPUS;
+    m_pollMode                           = DFLT_POLL_MODE;
+    m_busyPoll                           = DFLT_BUSY_POLL;
+    m_busyPollRate                       = DFLT_BUSY_POLL_RATE;
+    m_clusterAgents                      = DFLT_CLUSTER_AGENTS;
+    m_drainRate                          = DFLT_DRAIN_RATE;
+    m_drainFrom                          = DFLT_DRAIN_FROM;
+    m_checkpointIntvl                    = DFLT_CHECKPOINT_INTVL;
+    m_statsShmIntvl                      = DFLT_STATS_SHM_INTVL;
+    m_rejectFail                         = FALSE;
+    m_ignoreOverload                     = FALSE;
+    m_adaptiveRto                        = FALSE;
+    m_retransRate                        = DFLT_RETRANS_RATE;
+    m_traceSample                        = DFLT_TRACE_SAMPLE;
 
     saveIp(m_localIpAddrStr, &locIpAddr);
 
@@ -123,12 +146,24 @@ VOID Config::setConfig(cxxopts::ParseResult options)
         throw GsimError("Mandatory argument 'node' is missing");
     }
 
+    if (options.count("replay"))
+    {
+        auto value = options["replay"].as<std::string>();
+        setReplayFile(value);
+    }
+
+    if (options.count("replay-speed"))
+    {
+        auto value = options["replay-speed"].as<std::uint32_t>();
+        setReplaySpeed(value);
+    }
+
     if (options.count("scenario"))
     {
         auto value = options["scenario"].as<std::string>();
         setScenarioFile(value);
     }
-    else
+    else if (m_replayFile.empty())
     {
         throw GsimError("Mandatory argument 'scenario' is missing");
     }
@@ -216,6 +251,198 @@ VOID Config::setConfig(cxxopts::ParseResult options)
         auto value = options["log-level"].as<std::string>();
         setLogLevel(value);
     }
+
+    if (options.count("transport"))
+    {
+        auto value = options["transport"].as<std::string>();
+        setTransportType(value);
+    }
+
+    if (options.count("sqpoll-idle"))
+    {
+        auto value = options["sqpoll-idle"].as<std::uint32_t>();
+        setSqPollIdle(value);
+    }
+
+    if (options.count("packet-if"))
+    {
+        auto value = options["packet-if"].as<std::string>();
+        setPacketIf(value);
+    }
+
+    if (options.count("peer-mac"))
+    {
+        auto value = options["peer-mac"].as<std::string>();
+        setPeerMac(value);
+    }
+
+    if (options.count("huge-pages"))
+    {
+        auto value = options["huge-pages"].as<std::string>();
+        setHugePages(value);
+    }
+
+    if (options.count("mem-pool-size"))
+    {
+        auto value = options["mem-pool-size"].as<std::uint32_t>();
+        setMemPoolSize(value);
+    }
+
+    if (options.count("numa-node"))
+    {
+        auto value = options["numa-node"].as<std::int32_t>();
+        setNumaNode(value);
+    }
+
+    if (options.count("sched-cpu"))
+    {
+        auto value = options["sched-cpu"].as<std::int32_t>();
+        setSchedCpu(value);
+    }
+
+    if (options.count("worker-cpus"))
+    {
+        auto value = options["worker-cpus"].as<std::string>();
+        setWorkerCpus(value);
+    }
+
+    if (options.count("poll-mode"))
+    {
+        auto value = options["poll-mode"].as<std::string>();
+        setPollMode(value);
+    }
+
+    if (options.count("busy-poll"))
+    {
+        auto value = options["busy-poll"].as<std::uint32_t>();
+        setBusyPoll(value);
+    }
+
+    if (options.count("busy-poll-rate"))
+    {
+        auto value = options["busy-poll-rate"].as<std::uint32_t>();
+        setBusyPollRate(value);
+    }
+
+    if (options.count("cluster-agents"))
+    {
+        auto value = options["cluster-agents"].as<std::uint32_t>();
+        setClusterAgents(value);
+    }
+
+    if (options.count("cluster-listen"))
+    {
+        auto value = options["cluster-listen"].as<std::string>();
+        setClusterListen(value);
+    }
+
+    if (options.count("cluster-coordinator"))
+    {
+        auto value = options["cluster-coordinator"].as<std::string>();
+        setClusterCoordinator(value);
+    }
+
+    if (options.count("drain-rate"))
+    {
+        auto value = options["drain-rate"].as<std::uint32_t>();
+        setDrainRate(value);
+    }
+
+    if (options.count("drain-from"))
+    {
+        auto value = options["drain-from"].as<std::string>();
+        setDrainFrom(value);
+    }
+
+    if (options.count("checkpoint"))
+    {
+        auto value = options["checkpoint"].as<std::string>();
+        setCheckpointFile(value);
+    }
+
+    if (options.count("checkpoint-intvl"))
+    {
+        auto value = options["checkpoint-intvl"].as<std::uint32_t>();
+        setCheckpointIntvl(value);
+    }
+
+    if (options.count("restore"))
+    {
+        auto value = options["restore"].as<std::string>();
+        setRestoreFile(value);
+    }
+
+    if (options.count("stats-shm"))
+    {
+        auto value = options["stats-shm"].as<std::string>();
+        setStatsShm(value);
+    }
+
+    if (options.count("stats-shm-intvl"))
+    {
+        auto value = options["stats-shm-intvl"].as<std::uint32_t>();
+        setStatsShmIntvl(value);
+    }
+
+    if (options.count("reject-fail"))
+    {
+        setRejectFail(TRUE);
+    }
+
+    if (options.count("ignore-overload"))
+    {
+        setIgnoreOverload(TRUE);
+    }
+
+    if (options.count("adaptive-rto"))
+    {
+        setAdaptiveRto(TRUE);
+    }
+
+    if (options.count("retrans-rate"))
+    {
+        auto value = options["retrans-rate"].as<std::uint32_t>();
+        setRetransRate(value);
+    }
+
+    if (options.count("trace-sample"))
+    {
+        auto value = options["trace-sample"].as<std::uint32_t>();
+        setTraceSample(value);
+    }
+
+    if (options.count("trace-file"))
+    {
+        auto value = options["trace-file"].as<std::string>();
+        setTraceFile(value);
+    }
+
+    if (0 != m_traceSample && m_traceFile.empty())
+    {
+        m_traceFile = std::to_string(getpid()) + "_trace.json";
+    }
+
+    if (0 != m_checkpointIntvl && m_checkpointFile.empty())
+    {
+        throw GsimError("Checkpoint interval given without a checkpoint file");
+    }
+
+    if ((!m_checkpointFile.empty() || !m_restoreFile.empty()) &&
+        (!m_replayFile.empty() || 0 != m_clusterAgents))
+    {
+        throw GsimError("Checkpoints are taken of scenario sessions, not of "
+                        "replays or a cluster coordinator");
+    }
+
+    if (!m_clusterCoordinator.empty() && 0 != m_clusterAgents)
+    {
+        throw GsimError("A cluster agent can not run agents of its own");
+    }
+
+    if (0 != m_clusterAgents && !m_replayFile.empty())
+    {
+        throw GsimError("Cluster mode runs scenarios, not replays");
+    }
 }
 
 VOID Config::setNoOfCalls(U32 n)
@@ -567,6 +794,350 @@ Time_t Config::getDeadCallWait()
     return m_deadCallWait;
 }
 
+VOID Config::setTransportType(string type) throw(ErrCodeEn)
+{
+    if (type != "udp" && type != "io_uring" && type != "packet")
+    {
+        throw GsimError("Invalid transport " + type);
+    }
+
+    m_transportType = type;
+}
+
+string Config::getTransportType()
+{
+    return m_transportType;
+}
+
+VOID Config::setSqPollIdle(U32 ms)
+{
+    m_sqPollIdle = ms;
+}
+
+U32 Config::getSqPollIdle()
+{
+    return m_sqPollIdle;
+}
+
+VOID Config::setPacketIf(string ifName)
+{
+    m_packetIf = ifName;
+}
+
+string Config::getPacketIf()
+{
+    return m_packetIf;
+}
+
+VOID Config::setPeerMac(string mac)
+{
+    m_peerMac = mac;
+}
+
+string Config::getPeerMac()
+{
+    return m_peerMac;
+}
+
+VOID Config::setReplayFile(string file)
+{
+    m_replayFile = file;
+}
+
+string Config::getReplayFile()
+{
+    return m_replayFile;
+}
+
+VOID Config::setReplaySpeed(U32 speed)
+{
+    m_replaySpeed = speed;
+}
+
+U32 Config::getReplaySpeed()
+{
+    return m_replaySpeed;
+}
+
+VOID Config::setHugePages(string pages) throw(ErrCodeEn)
+{
+    if (pages == "off")
+    {
+        m_hugePageSize = 0;
+    }
+    else if (pages == "4k")
+    {
+        m_hugePageSize = MEM_PAGE_SIZE_4K;
+    }
+    else if (pages == "2m")
+    {
+        m_hugePageSize = MEM_PAGE_SIZE_2M;
+    }
+    else if (pages == "1g")
+    {
+        m_hugePageSize = MEM_PAGE_SIZE_1G;
+    }
+    else
+    {
+        throw GsimError("Invalid huge page size " + pages);
+    }
+}
+
+U64 Config::getHugePageSize()
+{
+    return m_hugePageSize;
+}
+
+VOID Config::setMemPoolSize(U32 mb)
+{
+    m_memPoolSize = mb;
+}
+
+U32 Config::getMemPoolSize()
+{
+    return m_memPoolSize;
+}
+
+VOID Config::setNumaNode(S32 node)
+{
+    m_numaNode = node;
+}
+
+S32 Config::getNumaNode()
+{
+    return m_numaNode;
+}
+
+VOID Config::setSchedCpu(S32 cpu) throw(ErrCodeEn)
+{
+    if (cpu < 0)
+    {
+        throw GsimError("Invalid scheduler CPU " + std::to_string(cpu));
+    }
+
+    m_schedCpu = cpu;
+}
+
+S32 Config::getSchedCpu()
+{
+    return m_schedCpu;
+}
+
+VOID Config::setWorkerCpus(string cpus)
+{
+    m_workerCpus = cpus;
+}
+
+string Config::getWorkerCpus()
+{
+    return m_workerCpus;
+}
+
+VOID Config::setPollMode(string mode) throw(ErrCodeEn)
+{
+    if (mode != "interrupt" && mode != "busy" && mode != "auto")
+    {
+        throw GsimError("Invalid poll mode " + mode);
+    }
+
+    m_pollMode = mode;
+}
+
+string Config::getPollMode()
+{
+    return m_pollMode;
+}
+
+VOID Config::setBusyPoll(U32 usec)
+{
+    m_busyPoll = usec;
+}
+
+U32 Config::getBusyPoll()
+{
+    return m_busyPoll;
+}
+
+VOID Config::setBusyPollRate(U32 rate)
+{
+    m_busyPollRate = rate;
+}
+
+U32 Config::getBusyPollRate()
+{
+    return m_busyPollRate;
+}
+
+VOID Config::setClusterAgents(U32 n)
+{
+    m_clusterAgents = n;
+}
+
+U32 Config::getClusterAgents()
+{
+    return m_clusterAgents;
+}
+
+VOID Config::setClusterListen(string addr)
+{
+    m_clusterListen = addr;
+}
+
+string Config::getClusterListen()
+{
+    return m_clusterListen;
+}
+
+VOID Config::setClusterCoordinator(string addr)
+{
+    m_clusterCoordinator = addr;
+}
+
+string Config::getClusterCoordinator()
+{
+    return m_clusterCoordinator;
+}
+
+VOID Config::setDrainRate(U32 rate)
+{
+    m_drainRate = rate;
+}
+
+U32 Config::getDrainRate()
+{
+    return m_drainRate;
+}
+
+VOID Config::setDrainFrom(string req)
+{
+    m_drainFrom = req;
+}
+
+string Config::getDrainFrom()
+{
+    return m_drainFrom;
+}
+
+VOID Config::setCheckpointFile(string file)
+{
+    m_checkpointFile = file;
+}
+
+string Config::getCheckpointFile()
+{
+    return m_checkpointFile;
+}
+
+VOID Config::setCheckpointIntvl(U32 sec)
+{
+    m_checkpointIntvl = sec;
+}
+
+U32 Config::getCheckpointIntvl()
+{
+    return m_checkpointIntvl;
+}
+
+VOID Config::setRestoreFile(string file)
+{
+    m_restoreFile = file;
+}
+
+string Config::getRestoreFile()
+{
+    return m_restoreFile;
+}
+
+VOID Config::setStatsShm(string name)
+{
+    if (name.empty() || string::npos != name.find('/', 1))
+    {
+        throw GsimError("Invalid stats segment name " + name);
+    }
+
+    m_statsShm = ('/' == name[0]) ? name : "/" + name;
+}
+
+string Config::getStatsShm()
+{
+    return m_statsShm;
+}
+
+VOID Config::setStatsShmIntvl(U32 msec)
+{
+    if (0 == msec)
+    {
+        throw GsimError("Invalid stats segment update interval");
+    }
+
+    m_statsShmIntvl = msec;
+}
+
+U32 Config::getStatsShmIntvl()
+{
+    return m_statsShmIntvl;
+}
+
+VOID Config::setRejectFail(BOOL b)
+{
+    m_rejectFail = b;
+}
+
+BOOL Config::getRejectFail()
+{
+    return m_rejectFail;
+}
+
+VOID Config::setIgnoreOverload(BOOL b)
+{
+    m_ignoreOverload = b;
+}
+
+BOOL Config::getIgnoreOverload()
+{
+    return m_ignoreOverload;
+}
+
+VOID Config::setAdaptiveRto(BOOL b)
+{
+    m_adaptiveRto = b;
+}
+
+BOOL Config::getAdaptiveRto()
+{
+    return m_adaptiveRto;
+}
+
+VOID Config::setRetransRate(U32 rate)
+{
+    m_retransRate = rate;
+}
+
+U32 Config::getRetransRate()
+{
+    return m_retransRate;
+}
+
+VOID Config::setTraceSample(U32 n)
+{
+    m_traceSample = n;
+}
+
+U32 Config::getTraceSample()
+{
+    return m_traceSample;
+}
+
+VOID Config::setTraceFile(string file)
+{
+    m_traceFile = file;
+}
+
+string Config::getTraceFile()
+{
+    return m_traceFile;
+}
+
 void Config::setNodeType(std::string node)
 {
     if (!STRCASECMP(node.c_str(), "MME"))
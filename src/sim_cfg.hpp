@@ -35,6 +35,24 @@ using namespace std;
 #define DFLT_MAX_SESSION_RATE 1000000 // 1 session per rate period
 #define DFLT_TRACE_MSG_FILE_NAME_LEN 64
 #define DFLT_DEAD_CALL_WAIT 20000 // milli seconds
+#define DFLT_TRANSPORT "udp"
+#define DFLT_PACKET_IF "lo"
+#define DFLT_REPLAY_SPEED 1 // captured pace, 0 replays as fast as possible
+#define DFLT_HUGE_PAGES "off"  // memory pools disabled
+#define DFLT_MEM_POOL_SIZE 64  // MB per memory pool
+#define DFLT_NUMA_NODE -1      // node of the thread owning the pool
+#define DFLT_SCHED_CPU -1      // not pinned
+#define DFLT_WORKER_CPUS ""    // not pinned
+#define DFLT_POLL_MODE "interrupt"
+#define DFLT_BUSY_POLL 50      // us of device queue busy polling per read
+#define DFLT_BUSY_POLL_RATE 20000 // messages/s above which auto mode spins
+#define DFLT_CLUSTER_AGENTS 0  // cluster mode disabled
+#define DFLT_DRAIN_RATE 0      // quit without tearing down the sessions
+#define DFLT_DRAIN_FROM "dsreq"
+#define DFLT_CHECKPOINT_INTVL 0 // checkpoints taken on demand only
+#define DFLT_STATS_SHM_INTVL 100 // ms between updates of the stats segment
+#define DFLT_RETRANS_RATE 0     // retransmissions per second, 0 unlimited
+#define DFLT_TRACE_SAMPLE 0     // session tracing disabled
 
 typedef enum {
     DISP_TARGET_NONE,
@@ -72,6 +90,36 @@ public:
     VOID setLogLevel(string logLvl);
     VOID setTraceMsg(BOOL);
     VOID setTraceMsgFile(string);
+    VOID setTransportType(string type) throw(ErrCodeEn);
+    VOID setSqPollIdle(U32 ms);
+    VOID setPacketIf(string ifName);
+    VOID setPeerMac(string mac);
+    VOID setReplayFile(string file);
+    VOID setReplaySpeed(U32 speed);
+    VOID setHugePages(string pages) throw(ErrCodeEn);
+    VOID setMemPoolSize(U32 mb);
+    VOID setNumaNode(S32 node);
+    VOID setSchedCpu(S32 cpu) throw(ErrCodeEn);
+    VOID setWorkerCpus(string cpus);
+    VOID setPollMode(string mode) throw(ErrCodeEn);
+    VOID setBusyPoll(U32 usec);
+    VOID setBusyPollRate(U32 rate);
+    VOID setClusterAgents(U32 n);
+    VOID setClusterListen(string addr);
+    VOID setClusterCoordinator(string addr);
+    VOID setDrainRate(U32 rate);
+    VOID setDrainFrom(string req);
+    VOID setCheckpointFile(string file);
+    VOID setCheckpointIntvl(U32 sec);
+    VOID setRestoreFile(string file);
+    VOID setStatsShm(string name);
+    VOID setStatsShmIntvl(U32 msec);
+    VOID setRejectFail(BOOL b);
+    VOID setIgnoreOverload(BOOL b);
+    VOID setAdaptiveRto(BOOL b);
+    VOID setRetransRate(U32 rate);
+    VOID setTraceSample(U32 n);
+    VOID setTraceFile(string file);
 
     IpAddr        getRemoteIpAddr();
     string        getRemIpAddrStr();
@@ -102,6 +150,36 @@ public:
     Time_t        getDeadCallWait();
     void          setNodeType(std::string node);
     std::string   getNodeTypeStr();
+    string        getTransportType();
+    U32           getSqPollIdle();
+    string        getPacketIf();
+    string        getPeerMac();
+    string        getReplayFile();
+    U32           getReplaySpeed();
+    U64           getHugePageSize();
+    U32           getMemPoolSize();
+    S32           getNumaNode();
+    S32           getSchedCpu();
+    string        getWorkerCpus();
+    string        getPollMode();
+    U32           getBusyPoll();
+    U32           getBusyPollRate();
+    U32           getClusterAgents();
+    string        getClusterListen();
+    string        getClusterCoordinator();
+    U32           getDrainRate();
+    string        getDrainFrom();
+    string        getCheckpointFile();
+    U32           getCheckpointIntvl();
+    string        getRestoreFile();
+    string        getStatsShm();
+    U32           getStatsShmIntvl();
+    BOOL          getRejectFail();
+    BOOL          getIgnoreOverload();
+    BOOL          getAdaptiveRto();
+    U32           getRetransRate();
+    U32           getTraceSample();
+    string        getTraceFile();
 
 private:
     Config();
@@ -133,6 +211,36 @@ private:
     string          m_imsiStr;
     Time_t          m_deadCallWait;
     string          m_nodeTypStr;
+    string          m_transportType;
+    U32             m_sqPollIdle; // io_uring SQPOLL idle, 0 disables SQPOLL
+    string          m_packetIf;   // AF_PACKET transport interface
+    string          m_peerMac;    // AF_PACKET next hop MAC, empty resolves
+    string          m_replayFile; // pcap replayed instead of the scenario
+    U32             m_replaySpeed;
+    U64             m_hugePageSize; // memory pool page size, 0 disables pools
+    U32             m_memPoolSize;  // MB
+    S32             m_numaNode;
+    S32             m_schedCpu;
+    string          m_workerCpus;
+    string          m_pollMode;
+    U32             m_busyPoll;
+    U32             m_busyPollRate;
+    U32             m_clusterAgents;      // agents run by the coordinator
+    string          m_clusterListen;      // coordinator address agents attach
+    string          m_clusterCoordinator; // agent mode, coordinator address
+    U32             m_drainRate;          // teardowns per second on quit
+    string          m_drainFrom;          // request starting the teardown
+    string          m_checkpointFile;
+    U32             m_checkpointIntvl;    // seconds, 0 on demand only
+    string          m_restoreFile;        // sessions restored at start
+    string          m_statsShm;           // POSIX shared memory name
+    U32             m_statsShmIntvl;      // ms
+    BOOL            m_rejectFail;         // rejected responses fail sessions
+    BOOL            m_ignoreOverload;     // no throttling on peer overload
+    BOOL            m_adaptiveRto;        // T3 adapted to the peer RTT
+    U32             m_retransRate;        // global retransmission budget
+    U32             m_traceSample;        // 1 in n sessions traced
+    string          m_traceFile;          // chrome trace of the sessions
 };
 
 #endif
@@ -12,346 +12,464 @@
  *
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
- */
+ */ 
 
 #include <unistd.h>
 #include <fcntl.h>
-#include <pthread.h>
 #include <errno.h>
 #include <exception>
 #include <poll.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <string.h>
-#include <list>
 
 #include "types.hpp"
 #include "macros.hpp"
 #include "logger.hpp"
 #include "error.hpp"
-#include "thread.hpp"
-#include "transport.hpp"
-#include "keyboard.hpp"
 #include "gtp_types.hpp"
+#include "transport.hpp"
 #include "socket.hpp"
 #include "sim_cfg.hpp"
 #include "gtp_macro.hpp"
 
-/******************* Function Declarations ***********************************/
-EXTERN VOID procGtpcMsg(UdpData_t *data);
-PRIVATE RETVAL sendMsgV4(GSimSocket *pSock, IPEndPoint *pDst, Buffer *data);
-PRIVATE RETVAL sendMsgV6(GSimSocket *pSock, IPEndPoint *pDst, Buffer *data);
-PRIVATE RETVAL handleGtpcSock(GSimSocket *pSock);
-PRIVATE RETVAL handleGtpuSock(GSimSocket *pSock);
-PRIVATE VOID handleStdinSock(GSimSocket *pSock);
-/******************* Function Declarations ***********************************/
-
-GSimSocket *       g_gsimSockArr[GSIM_MAX_SOCK_CNT];
-GSimPollFd         s_pollFdArr[GSIM_MAX_POLL_FDS];
-static U32         s_pollFdCnt = 0;
-static GSimSocket *s_pListener = NULL;
-static GSimSocket *s_pSender   = NULL;
-static U8          s_recvBuf[GSIM_UDP_READ_LEN];
+static U8                      s_recvBuf[TRANS_MAX_BATCH][GSIM_UDP_READ_LEN];
+static struct mmsghdr          s_recvHdrs[TRANS_MAX_BATCH];
+static struct iovec            s_recvIov[TRANS_MAX_BATCH];
+static struct sockaddr_storage s_recvAddrs[TRANS_MAX_BATCH];
+static U64                     s_recvCtrl[TRANS_MAX_BATCH]
+                                         [GSIM_RECV_CTRL_LEN / sizeof(U64)];
+static struct mmsghdr          s_sendHdrs[TRANS_MAX_BATCH];
+static struct iovec            s_sendIov[TRANS_MAX_BATCH];
+static struct sockaddr_storage s_sendAddrs[TRANS_MAX_BATCH];
 
 /**
  * @brief
- *    Reads the UDP socket, allocates socket buffer
+ *    Encodes the endpoint to a socket address
  *
  * @return
+ *    length of the socket address
  */
-RETVAL GSimSocket::recvMsgV4(UdpData_t **msg)
+PUBLIC socklen_t encSockAddr(IPEndPoint *pEp, struct sockaddr_storage *pAddr)
 {
-    struct sockaddr_in fromAddr;
-    socklen_t          fromLen = sizeof(sockaddr_in);
-
-    S32 recvLen = recvfrom(m_fd, s_recvBuf, GSIM_UDP_READ_LEN, MSG_DONTWAIT,
-        (struct sockaddr *)&fromAddr, &fromLen);
-    if (recvLen > 0)
+    if (IP_ADDR_TYPE_V4 == pEp->ipAddr.ipAddrType)
     {
-        *msg = new UdpData_t;
-        BUFFER_CPY(&(*msg)->buf, s_recvBuf, recvLen);
-        (*msg)->connId                        = m_pollFdIndex;
-        (*msg)->peerEp.ipAddr.ipAddrType      = IP_ADDR_TYPE_V4;
-        (*msg)->peerEp.ipAddr.u.ipv4Addr.addr = ntohl(fromAddr.sin_addr.s_addr);
-        (*msg)->peerEp.port                   = ntohs(fromAddr.sin_port);
-        return ROK;
+        struct sockaddr_in *pAddr4 = (struct sockaddr_in *)pAddr;
+        pAddr4->sin_addr.s_addr    = htonl(pEp->ipAddr.u.ipv4Addr.addr);
+        pAddr4->sin_family         = AF_INET;
+        pAddr4->sin_port           = htons(pEp->port);
+        MEMSET(pAddr4->sin_zero, '\0', sizeof(pAddr4->sin_zero));
+        return sizeof(struct sockaddr_in);
     }
 
-    return RFAILED;
+    struct sockaddr_in6 *pAddr6 = (struct sockaddr_in6 *)pAddr;
+    MEMSET(pAddr6, 0, sizeof(struct sockaddr_in6));
+    MEMCPY(pAddr6->sin6_addr.s6_addr, pEp->ipAddr.u.ipv6Addr.addr,
+        pEp->ipAddr.u.ipv6Addr.len);
+    pAddr6->sin6_family = AF_INET6;
+    pAddr6->sin6_port   = htons(pEp->port);
+    return sizeof(struct sockaddr_in6);
 }
 
 /**
  * @brief
- *    Peeks the gtp message, and reads the message of gtp msg length
- *    and fills the UdpData_t structre from IPv6 socket
- *
- * @param data
+ *    Decodes a socket address to the endpoint
+ */
+PUBLIC VOID decSockAddr(struct sockaddr_storage *pAddr, IPEndPoint *pEp)
+{
+    if (AF_INET == pAddr->ss_family)
+    {
+        struct sockaddr_in *pAddr4  = (struct sockaddr_in *)pAddr;
+        pEp->ipAddr.ipAddrType      = IP_ADDR_TYPE_V4;
+        pEp->ipAddr.u.ipv4Addr.addr = ntohl(pAddr4->sin_addr.s_addr);
+        pEp->port                   = ntohs(pAddr4->sin_port);
+    }
+    else
+    {
+        struct sockaddr_in6 *pAddr6 = (struct sockaddr_in6 *)pAddr;
+        pEp->ipAddr.ipAddrType      = IP_ADDR_TYPE_V6;
+        pEp->ipAddr.u.ipv6Addr.len  = IPV6_ADDR_MAX_LEN;
+        MEMCPY(pEp->ipAddr.u.ipv6Addr.addr, pAddr6->sin6_addr.s6_addr,
+            IPV6_ADDR_MAX_LEN);
+        pEp->port = ntohs(pAddr6->sin6_port);
+    }
+}
+
+/**
+ * @brief
+ *    Kernel receive time of the datagram, from the SO_TIMESTAMPNS control
+ *    message
  *
  * @return
+ *    nanoseconds of CLOCK_REALTIME, 0 without a timestamp
  */
-RETVAL GSimSocket::recvMsgV6(UdpData_t **msg)
+PUBLIC U64 decRecvTimestamp(struct msghdr *pHdr)
 {
-    struct sockaddr_in6 fromAddr;
-    socklen_t           fromLen = 0;
-
-    U32 recvLen = recvfrom(m_fd, s_recvBuf, GSIM_UDP_READ_LEN, MSG_DONTWAIT,
-        (struct sockaddr *)&fromAddr, &fromLen);
-    if (recvLen > 0)
+    for (struct cmsghdr *pCmsg = CMSG_FIRSTHDR(pHdr); NULL != pCmsg;
+         pCmsg = CMSG_NXTHDR(pHdr, pCmsg))
     {
-        *msg = new UdpData_t;
-        BUFFER_CPY(&(*msg)->buf, s_recvBuf, recvLen);
-        (*msg)->connId                   = m_pollFdIndex;
-        (*msg)->peerEp.ipAddr.ipAddrType = IP_ADDR_TYPE_V4;
-        MEMCPY((*msg)->peerEp.ipAddr.u.ipv6Addr.addr,
-            fromAddr.sin6_addr.s6_addr, IPV6_ADDR_MAX_LEN);
-        (*msg)->peerEp.port = ntohs(fromAddr.sin6_port);
-        return ROK;
+        if (SOL_SOCKET == pCmsg->cmsg_level &&
+            SCM_TIMESTAMPNS == pCmsg->cmsg_type)
+        {
+            struct timespec ts;
+            MEMCPY(&ts, CMSG_DATA(pCmsg), sizeof(ts));
+            return ((U64)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+        }
     }
 
-    return RFAILED;
+    return 0;
 }
 
-RETVAL GSimSocket::recvMsg(UdpData_t **msg)
+/**
+ * @brief
+ *    Reads at most max datagrams from the UDP socket with one recvmmsg() and
+ *    allocates a UdpData_t for each of them
+ *
+ * @return
+ *    number of datagrams read
+ */
+U32 GSimSocket::recvMsgs(UdpData_t **ppMsgs, U32 max)
 {
     LOG_ENTERFN();
 
-    RETVAL ret = ROK;
+    U32 cnt = (max < TRANS_MAX_BATCH) ? max : TRANS_MAX_BATCH;
+    for (U32 i = 0; i < cnt; i++)
+    {
+        s_recvIov[i].iov_base                = s_recvBuf[i];
+        s_recvIov[i].iov_len                 = GSIM_UDP_READ_LEN;
+        s_recvHdrs[i].msg_hdr.msg_name       = &s_recvAddrs[i];
+        s_recvHdrs[i].msg_hdr.msg_namelen    = sizeof(struct sockaddr_storage);
+        s_recvHdrs[i].msg_hdr.msg_iov        = &s_recvIov[i];
+        s_recvHdrs[i].msg_hdr.msg_iovlen     = 1;
+        s_recvHdrs[i].msg_hdr.msg_control    = s_recvCtrl[i];
+        s_recvHdrs[i].msg_hdr.msg_controllen = GSIM_RECV_CTRL_LEN;
+        s_recvHdrs[i].msg_hdr.msg_flags      = 0;
+    }
 
-    if (IP_ADDR_TYPE_V4 == m_ep.ipAddr.ipAddrType)
+    S32 numRecvd = recvmmsg(m_fd, s_recvHdrs, cnt, MSG_DONTWAIT, NULL);
+    if (numRecvd <= 0)
     {
-        ret = recvMsgV4(msg);
+        LOG_EXITFN(0);
     }
-    else
+
+    for (S32 i = 0; i < numRecvd; i++)
     {
-        ret = recvMsgV6(msg);
+        UdpData_t *pMsg = new UdpData_t;
+        BUFFER_CPY(&pMsg->buf, s_recvBuf[i], s_recvHdrs[i].msg_len);
+        pMsg->connId = m_connId;
+        pMsg->timeNs = decRecvTimestamp(&s_recvHdrs[i].msg_hdr);
+        decSockAddr(&s_recvAddrs[i], &pMsg->peerEp);
+        ppMsgs[i] = pMsg;
     }
 
-    LOG_EXITFN(ret);
+    LOG_EXITFN((U32)numRecvd);
 }
 
-PRIVATE RETVAL sendMsgV4(GSimSocket *pSock, IPEndPoint *pDst, Buffer *data)
+/**
+ * @brief
+ *    Sends the messages with sendmmsg(), TRANS_MAX_BATCH messages per system
+ *    call. Buffers of all the messages are released
+ *
+ * @return
+ *    number of messages sent
+ */
+U32 GSimSocket::sendMsgs(TransMsg_t *pMsgs, U32 cnt)
 {
     LOG_ENTERFN();
 
-    struct sockaddr_in destAddr;
-
-    destAddr.sin_addr.s_addr = htonl(pDst->ipAddr.u.ipv4Addr.addr);
-    destAddr.sin_family      = AF_INET;
-    destAddr.sin_port        = htons(pDst->port);
-    MEMSET(destAddr.sin_zero, '\0', sizeof(destAddr.sin_zero));
-
-    S32 ret = sendto(pSock->fd(), (VOID *)data->pVal, (size_t)data->len,
-        MSG_DONTWAIT, (struct sockaddr *)&destAddr, sizeof(destAddr));
-    if (ret < 0)
+    U32 numSent = 0;
+    for (U32 base = 0; base < cnt; base += TRANS_MAX_BATCH)
     {
-        LOG_FATAL("Socket sendto() failed, [%s]", strerror(errno));
-        LOG_EXITFN(ERR_SYS_SOCK_SEND);
-    }
+        U32 batch = cnt - base;
+        if (batch > TRANS_MAX_BATCH)
+        {
+            batch = TRANS_MAX_BATCH;
+        }
 
-    delete data;
-    LOG_EXITFN(ROK);
-}
+        for (U32 i = 0; i < batch; i++)
+        {
+            TransMsg_t *pMsg = &pMsgs[base + i];
+
+            s_sendIov[i].iov_base             = pMsg->pBuf->pVal;
+            s_sendIov[i].iov_len              = pMsg->pBuf->len;
+            s_sendHdrs[i].msg_hdr.msg_name    = &s_sendAddrs[i];
+            s_sendHdrs[i].msg_hdr.msg_namelen =
+                encSockAddr(pMsg->pDst, &s_sendAddrs[i]);
+            s_sendHdrs[i].msg_hdr.msg_iov        = &s_sendIov[i];
+            s_sendHdrs[i].msg_hdr.msg_iovlen     = 1;
+            s_sendHdrs[i].msg_hdr.msg_control    = NULL;
+            s_sendHdrs[i].msg_hdr.msg_controllen = 0;
+            s_sendHdrs[i].msg_hdr.msg_flags      = 0;
+        }
 
-PRIVATE RETVAL sendMsgV6(GSimSocket *pSock, IPEndPoint *pDst, Buffer *data)
-{
-    struct sockaddr_in6 destAddr;
+        U32 done = 0;
+        while (done < batch)
+        {
+            S32 ret = sendmmsg(m_fd, &s_sendHdrs[done], batch - done,
+                MSG_DONTWAIT);
+            if (ret <= 0)
+            {
+                LOG_FATAL("Socket sendmmsg() failed, [%s]", strerror(errno));
+                break;
+            }
 
-    MEMCPY(destAddr.sin6_addr.s6_addr, pDst->ipAddr.u.ipv6Addr.addr,
-        pDst->ipAddr.u.ipv6Addr.len);
-    destAddr.sin6_family = AF_INET6;
-    destAddr.sin6_port   = htons(pDst->port);
+            done += ret;
+        }
 
-    if (sendto(pSock->fd(), data->pVal, data->len, MSG_DONTWAIT,
-            (struct sockaddr *)&destAddr, sizeof(destAddr)) > 0)
-    {
-        return ROK;
+        numSent += done;
+        for (U32 i = 0; i < batch; i++)
+        {
+            delete pMsgs[base + i].pBuf;
+        }
     }
 
-    delete data;
-    return RFAILED;
+    LOG_EXITFN(numSent);
 }
 
-PUBLIC VOID socketPoll(S32 wait)
+GSimSocket::GSimSocket(SockType_t sockType, IPEndPoint ep, TransConnId connId)
 {
-    S32 rs; /* Number of times to execute recv().
-             * For TCP with 1 socket per call: no. of events returned by poll
-             * For UDP and TCP with 1 global socket:recv_count is a flag that
-             * stays up as long as there's data to read
-             */
+    if (IP_ADDR_TYPE_V4 == ep.ipAddr.ipAddrType)
+    {
+        m_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    }
+    else
+    {
+        m_fd = socket(AF_INET6, SOCK_DGRAM, 0);
+    }
 
-    /* Get socket events. */
-    rs = poll(s_pollFdArr, s_pollFdCnt, wait);
-    if ((rs < 0) && (errno == EINTR))
+    if (m_fd < 0)
     {
-        LOG_ERROR("poll() error, [%s]", strerror(errno));
-        return;
+        LOG_FATAL("socket system call, [%s]", strerror(errno));
+        throw ERR_SYS_SOCKET_CREATE;
     }
 
-    for (U32 pollIndx = 0; rs > 0 && pollIndx < s_pollFdCnt; pollIndx++)
+    if (fcntl(m_fd, F_SETFL, O_NONBLOCK) < 0)
     {
-        GSimSocket *pSock = g_gsimSockArr[pollIndx];
+        LOG_FATAL("socket system call, [%s]", strerror(errno));
+        close(m_fd);
+        throw ERR_SYS_SOCK_CNTRL;
+    }
 
-        if (NULL == pSock)
-        {
-            LOG_FATAL("Null Socket, Sock Array. Index [%d]", pollIndx);
-            continue;
-        }
+    m_type   = sockType;
+    m_connId = connId;
+    m_ep     = ep;
 
-        if (GSIM_CHK_MASK(s_pollFdArr[pollIndx].revents, POLLOUT))
-        {
-            GSIM_UNSET_MASK(s_pollFdArr[pollIndx].events, POLLOUT);
-        }
+    U32 sockRecvBuf = GSIM_MAX_SOCKET_RECV_BUF;
+    if (setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &sockRecvBuf,
+            sizeof(sockRecvBuf)) < 0)
+    {
+        LOG_ERROR("setsockopt() Failed, [%s]", strerror(errno));
+    }
 
-        if (GSIM_CHK_MASK(s_pollFdArr[pollIndx].revents, POLLIN))
-        {
-            rs--;
+    U32 sockSendBuf = GSIM_MAX_SOCKET_SEND_BUF;
+    if (setsockopt(m_fd, SOL_SOCKET, SO_SNDBUF, &sockSendBuf,
+            sizeof(sockSendBuf)) < 0)
+    {
+        LOG_ERROR("setsockopt() Failed, [%s]", strerror(errno));
+    }
 
-            switch (pSock->type())
-            {
-            case SOCK_TYPE_GTPC:
-            {
-                LOG_DEBUG("Reading GTP-C socket");
-                RETVAL ret = handleGtpcSock(pSock);
-                if (ROK != ret)
-                {
-                    LOG_ERROR("Reading GTP-C socket");
-                }
+    /* the receive time separates the response time of the peer from the
+     * time the datagram waits to be read
+     */
+    S32 timestamp = 1;
+    if (setsockopt(m_fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamp,
+            sizeof(timestamp)) < 0)
+    {
+        LOG_ERROR("setsockopt(SO_TIMESTAMPNS) Failed, [%s]", strerror(errno));
+    }
+}
 
-                break;
-            }
+S32 GSimSocket::fd()
+{
+    return m_fd;
+}
 
-            case SOCK_TYPE_GTPU:
-            {
-                LOG_DEBUG("Reading GTP-U socket");
-                RETVAL ret = handleGtpuSock(pSock);
-                if (ROK != ret)
-                {
-                    LOG_ERROR("Reading GTP-U socket");
-                }
+/**
+ * @brief
+ *    Local port of the socket, the port assigned by the kernel when it is
+ *    bound to port 0
+ */
+U16 GSimSocket::localPort()
+{
+    struct sockaddr_storage addr;
+    socklen_t               len = sizeof(addr);
+    IPEndPoint              ep;
 
-                break;
-            }
+    if (getsockname(m_fd, (struct sockaddr *)&addr, &len) < 0)
+    {
+        LOG_ERROR("getsockname() Failed, [%s]", strerror(errno));
+        return m_ep.port;
+    }
 
-            case SOCK_TYPE_STDIN:
-            {
-                LOG_DEBUG("Reading Keyboard Event");
-                handleStdinSock(pSock);
-                break;
-            }
+    decSockAddr(&addr, &ep);
+    return ep.port;
+}
 
-            default:
-            {
-                break;
-            }
-            }
-        }
-        else if (GSIM_CHK_MASK(s_pollFdArr[pollIndx].revents, POLLERR))
-        {
-            LOG_FATAL("Socket Error, FD [%d]", pSock->fd());
-            delete pSock;
-        }
+IpAddrTypeEn GSimSocket::ipAddrType()
+{
+    return m_ep.ipAddr.ipAddrType;
+}
 
-        s_pollFdArr[pollIndx].revents = 0;
-    }
+SockType_t GSimSocket::type()
+{
+    return m_type;
 }
 
 /**
  * @brief
- *    Handles keyboard event
- *
- * @param pSock
+ *    CPU which processed the last packet received on the socket, -1 until
+ *    a packet is received
  */
-PRIVATE VOID handleStdinSock(GSimSocket *pSock)
+S32 GSimSocket::incomingCpu()
 {
-    LOG_ENTERFN();
+    S32       cpu = -1;
+    socklen_t len = sizeof(cpu);
 
-    if (feof(stdin))
+#ifdef SO_INCOMING_CPU
+    if (getsockopt(m_fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0)
     {
-        delete pSock;
+        cpu = -1;
     }
+#endif
+
+    return cpu;
+}
+
+/**
+ * @brief
+ *    Busy polls the device queue of the socket for usec microseconds when
+ *    it is read, preferring busy polling over the interrupts of the queue.
+ *    Raising the time above net.core.busy_read needs CAP_NET_ADMIN
+ */
+RETVAL GSimSocket::setBusyPoll(U32 usec)
+{
+    S32 prefer = (usec > 0) ? 1 : 0;
+    S32 budget = GSIM_BUSY_POLL_BUDGET;
 
-    S32 input = getchar();
-    if (input == EOF)
+    if (setsockopt(m_fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) < 0)
     {
-        LOG_EXITVOID();
+        LOG_ERROR("setsockopt(SO_BUSY_POLL) Failed, [%s]", strerror(errno));
+        return RFAILED;
     }
-    else
+
+    /* the preference and the budget are available from Linux 5.11 */
+    if (setsockopt(m_fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer,
+            sizeof(prefer)) < 0 ||
+        setsockopt(m_fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &budget,
+            sizeof(budget)) < 0)
     {
-        Keyboard::getInstance()->processKey(input);
+        LOG_DEBUG("Busy poll preference not set, [%s]", strerror(errno));
     }
 
-    LOG_EXITVOID();
+    return ROK;
 }
 
-/**
- * @brief
- *    Hanldes GTP-C socket, reads GTP-C messages
- *
- * @param pSock
- *
- * @return
- */
-PRIVATE RETVAL handleGtpcSock(GSimSocket *pSock)
+GSimSocket::~GSimSocket()
 {
-    LOG_ENTERFN();
+    LOG_DEBUG("Deallocating socket, Sock FD [%d]", m_fd);
+
+    close(m_fd);
+}
 
-    RETVAL ret   = ROK;
-    U32    loops = GSIM_MAX_RECV_LOOPS;
+RETVAL GSimSocket::bindSocket()
+{
+    struct sockaddr_storage addr;
+    socklen_t               addrLen = encSockAddr(&m_ep, &addr);
 
-    while (loops && (ROK == ret))
+    if (bind(m_fd, (struct sockaddr *)&addr, addrLen) < 0)
     {
-        UdpData_t *msg = NULL;
-        ret            = pSock->recvMsg(&msg);
-        if (ROK == ret)
-        {
-            LOG_DEBUG("Process the Received messages", pSock->fd());
-            procGtpcMsg(msg);
-        }
+        LOG_FATAL("Socket Binding Failed, [%s]", strerror(errno));
+        return ERR_SYS_SOCKET_BIND;
+    }
 
-        loops--;
-    };
+    return ROK;
+}
 
-    LOG_EXITFN(ROK);
+UdpTransport::UdpTransport()
+{
+    m_numSocks     = 0;
+    m_nextRecvSock = 0;
+    m_epollFd      = -1;
+    for (U32 i = 0; i < GSIM_MAX_SOCK_CNT; i++)
+    {
+        m_socks[i] = NULL;
+    }
+}
+
+UdpTransport::~UdpTransport()
+{
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        delete m_socks[i];
+    }
+
+    if (m_epollFd >= 0)
+    {
+        close(m_epollFd);
+    }
 }
 
 /**
  * @brief
- *    Hanldes GTP-U socket, reads GTP-U Process control messages
- *
- * @param pSock
- *
- * @return
+ *    Creates and binds a socket, the next connection id is assigned to it
  */
-PRIVATE RETVAL handleGtpuSock(GSimSocket *pSock)
+RETVAL UdpTransport::addSocket(IPEndPoint ep)
 {
     LOG_ENTERFN();
 
-    RETVAL ret = ROK;
+    GSimSocket *pSock = NULL;
+    try
+    {
+        pSock = new GSimSocket(SOCK_TYPE_GTPC, ep, m_numSocks);
+    }
+    catch (ErrCodeEn &e)
+    {
+        LOG_EXITFN(e);
+    }
+
+    RETVAL ret = pSock->bindSocket();
+    if (ROK != ret)
+    {
+        delete pSock;
+        LOG_EXITFN(ret);
+    }
+
+    struct epoll_event ev;
+    ev.events   = EPOLLIN;
+    ev.data.u32 = m_numSocks;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, pSock->fd(), &ev) < 0)
+    {
+        LOG_FATAL("epoll_ctl() failed, [%s]", strerror(errno));
+        delete pSock;
+        LOG_EXITFN(ERR_SYS_SOCK_CNTRL);
+    }
 
-    LOG_EXITFN(ret);
+    m_socks[m_numSocks++] = pSock;
+    LOG_EXITFN(ROK);
 }
 
-PUBLIC RETVAL initTransport()
+RETVAL UdpTransport::init()
 {
     LOG_ENTERFN();
 
-    S16        ret = ROK;
+    RETVAL     ret = ROK;
     IPEndPoint locListnerEp;
     IPEndPoint locSenderEp;
 
     Config *pCfg = Config::getInstance();
 
-    for (U32 i = 0; i < GSIM_MAX_POLL_FDS; i++)
+    m_epollFd = epoll_create1(0);
+    if (m_epollFd < 0)
     {
-        s_pollFdArr[i].fd = -1;
+        LOG_FATAL("epoll_create1() failed, [%s]", strerror(errno));
+        LOG_EXITFN(ERR_SYS_SOCKET_CREATE);
     }
 
-    /* Simulator sends all GTP messages with source udp port number as
-     * Default GTP port + 1, using this socket
+    /* Simulator sends all the initial GTP messages using this socket, the
+     * source udp port is assigned by the system
      */
     locSenderEp.port   = 0;
     locSenderEp.ipAddr = *pCfg->getLocalIpAddr();
-    s_pSender          = new GSimSocket(SOCK_TYPE_GTPC, locSenderEp);
-    ret                = s_pSender->bindSocket();
+    ret                = addSocket(locSenderEp);
     if (ROK != ret)
     {
         LOG_FATAL("Binding to GTP local sending Socket");
@@ -363,8 +481,7 @@ PUBLIC RETVAL initTransport()
      */
     locListnerEp.port   = pCfg->getLocalGtpcPort();
     locListnerEp.ipAddr = *pCfg->getLocalIpAddr();
-    s_pListener         = new GSimSocket(SOCK_TYPE_GTPC, locListnerEp);
-    ret                 = s_pListener->bindSocket();
+    ret                 = addSocket(locListnerEp);
     if (ROK != ret)
     {
         LOG_FATAL("Binding to GTP Listener Socket");
@@ -374,182 +491,109 @@ PUBLIC RETVAL initTransport()
     LOG_EXITFN(ROK);
 }
 
-GSimSocket::GSimSocket(SockType_t sockType)
+/**
+ * @brief
+ *    Sends the messages, consecutive messages over the same connection are
+ *    sent as one batch
+ */
+U32 UdpTransport::send(TransMsg_t *pMsgs, U32 cnt)
 {
-    if (SOCK_TYPE_STDIN == sockType)
-    {
-        m_fd                               = fileno(stdin);
-        m_type                             = sockType;
-        m_pollFdIndex                      = s_pollFdCnt++;
-        g_gsimSockArr[m_pollFdIndex]       = this;
-        s_pollFdArr[m_pollFdIndex].fd      = m_fd;
-        s_pollFdArr[m_pollFdIndex].events  = POLLIN | POLLERR;
-        s_pollFdArr[m_pollFdIndex].revents = 0;
-    }
-    else
-    {
-        throw ERR_INV_SOCKET_TYPE;
-    }
-}
+    LOG_ENTERFN();
 
-GSimSocket::GSimSocket(SockType_t sockType, IPEndPoint ep)
-{
-    if (SOCK_TYPE_STDIN != sockType)
+    U32 numSent = 0;
+    U32 start   = 0;
+    while (start < cnt)
     {
-        if (IP_ADDR_TYPE_V4 == ep.ipAddr.ipAddrType)
-        {
-            m_fd = socket(AF_INET, SOCK_DGRAM, 0);
-        }
-        else
-        {
-            m_fd = socket(AF_INET6, SOCK_DGRAM, 0);
-        }
-
-        if (m_fd < 0)
+        TransConnId connId = pMsgs[start].connId;
+        U32         end    = start + 1;
+        while (end < cnt && pMsgs[end].connId == connId)
         {
-            LOG_FATAL("socket system call, [%s]", strerror(errno));
-            throw ERR_SYS_SOCKET_CREATE;
+            end++;
         }
 
-        if (fcntl(m_fd, F_SETFL, O_NONBLOCK) < 0)
+        if (connId < m_numSocks)
         {
-            LOG_FATAL("socket system call, [%s]", strerror(errno));
-            throw ERR_SYS_SOCK_CNTRL;
+            numSent += m_socks[connId]->sendMsgs(&pMsgs[start], end - start);
         }
-
-        m_type                             = sockType;
-        m_pollFdIndex                      = s_pollFdCnt++;
-        m_ep                               = ep;
-        g_gsimSockArr[m_pollFdIndex]       = this;
-        s_pollFdArr[m_pollFdIndex].fd      = m_fd;
-        s_pollFdArr[m_pollFdIndex].events  = POLLIN | POLLERR;
-        s_pollFdArr[m_pollFdIndex].revents = 0;
-
-        U32 sockRecvBuf = GSIM_MAX_SOCKET_RECV_BUF;
-        if (setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &sockRecvBuf,
-                sizeof(sockRecvBuf)) < 0)
+        else
         {
-            LOG_ERROR("setsockopt() Failed, [%s]", strerror(errno));
+            LOG_ERROR("Invalid connection id [%d]", connId);
+            for (U32 i = start; i < end; i++)
+            {
+                delete pMsgs[i].pBuf;
+            }
         }
 
-        U32 sockSendBuf = GSIM_MAX_SOCKET_SEND_BUF;
-        if (setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &sockSendBuf,
-                sizeof(sockSendBuf)) < 0)
-        {
-            LOG_ERROR("setsockopt() Failed, [%s]", strerror(errno));
-        }
+        start = end;
     }
-    else
-    {
-        throw ERR_INV_SOCKET_TYPE;
-    }
-}
-
-S32 GSimSocket::fd()
-{
-    return m_fd;
-}
 
-IpAddrTypeEn GSimSocket::ipAddrType()
-{
-    return m_ep.ipAddr.ipAddrType;
-}
-
-SockType_t GSimSocket::type()
-{
-    return m_type;
+    LOG_EXITFN(numSent);
 }
 
-GSimSocket::~GSimSocket()
-{
-    LOG_DEBUG("Deallocating socket, Sock FD [%d]", m_fd);
-
-    s_pollFdCnt--;
-    s_pollFdArr[m_pollFdIndex].fd = 0;
-    g_gsimSockArr[m_pollFdIndex]  = NULL;
-    close(m_fd);
-}
-
-RETVAL GSimSocket::bindSocket()
+/**
+ * @brief
+ *    Reads the sockets in turns, starting from the socket next to the one
+ *    read first in the previous call
+ */
+U32 UdpTransport::recv(UdpData_t **ppMsgs, U32 max)
 {
-    S16                 ret = ROK;
-    struct sockaddr_in  addr;
-    struct sockaddr_in6 addr6;
-
-    if (IP_ADDR_TYPE_V4 == m_ep.ipAddr.ipAddrType)
-    {
-        addr.sin_addr.s_addr = htonl(m_ep.ipAddr.u.ipv4Addr.addr);
-        addr.sin_family      = AF_INET;
-        addr.sin_port        = htons(m_ep.port);
-        MEMSET(addr.sin_zero, '\0', sizeof(addr.sin_zero));
-    }
-    else
-    {
-        MEMCPY(addr6.sin6_addr.s6_addr, m_ep.ipAddr.u.ipv6Addr.addr,
-            m_ep.ipAddr.u.ipv6Addr.len);
-        addr6.sin6_family = AF_INET6;
-        addr6.sin6_port   = htons(m_ep.port);
-    }
+    LOG_ENTERFN();
 
-    if (IP_ADDR_TYPE_V4 == m_ep.ipAddr.ipAddrType)
-    {
-        ret = bind(m_fd, (struct sockaddr *)&addr, sizeof(addr));
-    }
-    else
+    U32 numRecvd = 0;
+    for (U32 i = 0; i < m_numSocks && numRecvd < max; i++)
     {
-        ret = bind(m_fd, (struct sockaddr *)&addr6, sizeof(addr6));
+        GSimSocket *pSock = m_socks[(m_nextRecvSock + i) % m_numSocks];
+        numRecvd += pSock->recvMsgs(&ppMsgs[numRecvd], max - numRecvd);
     }
 
-    if (ret < 0)
+    if (m_numSocks)
     {
-        LOG_FATAL("Socket Binding Failed, [%s]", strerror(errno));
-        return ERR_SYS_SOCKET_BIND;
+        m_nextRecvSock = (m_nextRecvSock + 1) % m_numSocks;
     }
 
-    return ROK;
+    LOG_EXITFN(numRecvd);
 }
 
-/**
- * @brief
- *    Creates the socket for listening on Keyboard events from the user
- */
-PUBLIC RETVAL setupStdinSock()
+S32 UdpTransport::readyFd()
 {
-    LOG_ENTERFN();
-
-    S16 ret = ROK;
-
-    try
-    {
-        GSimSocket *pKbSock = new GSimSocket(SOCK_TYPE_STDIN);
-        (VOID) pKbSock;
-    }
-    catch (ErrCodeEn &e)
-    {
-        ret = ERR_SOCK_ALLOC;
-    }
+    return m_epollFd;
+}
 
-    LOG_EXITFN(ret);
+U32 UdpTransport::capabilities()
+{
+    return TRANS_CAP_BATCH_SEND | TRANS_CAP_BATCH_RECV | TRANS_CAP_READY_FD;
 }
 
-PUBLIC RETVAL sendMsg(TransConnId connId, IPEndPoint *pDst, Buffer *data)
+const S8 *UdpTransport::name()
 {
-    LOG_ENTERFN();
+    return "udp";
+}
 
+RETVAL UdpTransport::setBusyPoll(U32 usec)
+{
     RETVAL ret = ROK;
 
-    GSimSocket *pSock = g_gsimSockArr[connId];
-    if (NULL != pSock)
+    for (U32 i = 0; i < m_numSocks; i++)
     {
-        if (pDst->ipAddr.ipAddrType == IP_ADDR_TYPE_V4)
+        if (ROK != m_socks[i]->setBusyPoll(usec))
         {
-            ret = sendMsgV4(pSock, pDst, data);
+            ret = RFAILED;
         }
-        else
+    }
+
+    return ret;
+}
+
+S32 UdpTransport::rxCpu()
+{
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        S32 cpu = m_socks[i]->incomingCpu();
+        if (cpu >= 0)
         {
-            ret = sendMsgV6(pSock, pDst, data);
+            return cpu;
         }
     }
 
-    LOG_EXITFN(ret);
+    return -1;
 }
@@ -22,17 +22,24 @@
 #include <arpa/inet.h>
 
 #define GSIM_UDP_READ_LEN        2048
-#define GTP_HDR_PEEK_LEN         4
-#define GSIM_MAX_SOCK_CNT        3
-#define GSIM_MAX_POLL_FDS        32
+#define GSIM_MAX_SOCK_CNT        2
 #define GSIM_MAX_RECV_LOOPS      1000
 #define GSIM_MAX_SOCKET_RECV_BUF (1 << 20)
 #define GSIM_MAX_SOCKET_SEND_BUF (1 << 20)
+#define GSIM_BUSY_POLL_BUDGET    TRANS_MAX_BATCH
+#define GSIM_RECV_CTRL_LEN       CMSG_SPACE(sizeof(struct timespec))
+
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL      69
+#endif
+
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET      70
+#endif
 
 typedef enum
 {
    SOCK_TYPE_INVALID,
-   SOCK_TYPE_STDIN,
    SOCK_TYPE_GTPC,
    SOCK_TYPE_GTPU,
    SOCK_TYPE_GTPU_CTRL,
@@ -41,27 +48,61 @@ typedef enum
 
 typedef struct pollfd   GSimPollFd;
 
+EXTERN socklen_t encSockAddr(IPEndPoint *pEp, struct sockaddr_storage *pAddr);
+EXTERN VOID decSockAddr(struct sockaddr_storage *pAddr, IPEndPoint *pEp);
+EXTERN U64 decRecvTimestamp(struct msghdr *pHdr);
+
 class GSimSocket
 {
    public:
-      GSimSocket(SockType_t);
-      GSimSocket(SockType_t, IPEndPoint);
+      GSimSocket(SockType_t, IPEndPoint, TransConnId);
       ~GSimSocket();
 
       S32               fd();
+      U16               localPort();
       SockType_t        type();
       IpAddrTypeEn      ipAddrType();
       RETVAL            bindSocket();
-      RETVAL            recvMsg(UdpData_t **msg);
+      U32               recvMsgs(UdpData_t **ppMsgs, U32 max);
+      U32               sendMsgs(TransMsg_t *pMsgs, U32 cnt);
+      S32               incomingCpu();
+      RETVAL            setBusyPoll(U32 usec);
 
    private:
       S32               m_fd;
-      U32               m_pollFdIndex;
+      TransConnId       m_connId;
       SockType_t        m_type;
       IPEndPoint        m_ep;
-      RETVAL            recvMsgV6(UdpData_t **msg);
-      RETVAL            recvMsgV4(UdpData_t **msg);
 };
 
-#endif
+/**
+ * @brief
+ *    UDP socket transport, connection ids are the indices of the sockets.
+ *    Messages are sent and received with sendmmsg()/recvmmsg() and the
+ *    sockets are polled through a single epoll fd
+ */
+class UdpTransport: public Transport
+{
+   public:
+      UdpTransport();
+      ~UdpTransport();
+
+      RETVAL      init();
+      U32         send(TransMsg_t *pMsgs, U32 cnt);
+      U32         recv(UdpData_t **ppMsgs, U32 max);
+      S32         readyFd();
+      U32         capabilities();
+      const S8    *name();
+      S32         rxCpu();
+      RETVAL      setBusyPoll(U32 usec);
+
+   private:
+      RETVAL      addSocket(IPEndPoint ep);
 
+      GSimSocket  *m_socks[GSIM_MAX_SOCK_CNT];
+      U32         m_numSocks;
+      U32         m_nextRecvSock;
+      S32         m_epollFd;
+};
+
+#endif
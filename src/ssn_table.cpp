@@ -0,0 +1,113 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "task.hpp"
+#include "gtp_types.hpp"
+#include "ssn_table.hpp"
+
+SessionTable::SessionTable()
+{
+   m_numUsed = 0;
+   m_hasVars = FALSE;
+}
+
+/**
+ * @return
+ *    slot of the session, a slot freed earlier is reused first so that the
+ *    table stays dense
+ */
+U32 SessionTable::add(UeSession *pSsn)
+{
+   U32 slot = 0;
+
+   if (!m_freeSlots.empty())
+   {
+      slot = m_freeSlots.back();
+      m_freeSlots.pop_back();
+   }
+   else
+   {
+      slot = m_pSsn.size();
+      m_taskState.push_back(TASK_STATE_INVALID);
+      m_state.push_back(0);
+      m_procIdx.push_back(0);
+      m_deadline.push_back(0);
+      m_peerIdx.push_back(SSN_PEER_INVALID);
+      m_locTeid.push_back(0);
+      m_remTeid.push_back(0);
+      m_pSsn.push_back(NULL);
+      if (m_hasVars)
+      {
+         m_vars.resize(m_vars.size() + GTP_MAX_SSN_VARS);
+      }
+   }
+
+   if (m_hasVars)
+   {
+      MEMSET(vars(slot), 0, GTP_MAX_SSN_VARS * sizeof(GtpSsnVar_t));
+   }
+
+   m_pSsn[slot] = pSsn;
+   update(slot, TASK_STATE_RUNNING, 0, 0, 0);
+   updatePeer(slot, SSN_PEER_INVALID);
+   updateTeids(slot, 0, 0);
+   m_numUsed++;
+
+   return slot;
+}
+
+VOID SessionTable::del(U32 slot)
+{
+   m_taskState[slot] = TASK_STATE_INVALID;
+   m_pSsn[slot] = NULL;
+   m_freeSlots.push_back(slot);
+   m_numUsed--;
+}
+
+U32 SessionTable::countState(U8 mask)
+{
+   U32 num   = 0;
+   U32 slots = m_pSsn.size();
+
+   for (U32 slot = 0; slot < slots; slot++)
+   {
+      num += (TASK_STATE_INVALID != m_taskState[slot] &&
+            mask == (m_state[slot] & mask));
+   }
+
+   return num;
+}
+
+VOID SessionTable::collectPaused(U8 skipMask, std::vector<UeSession*> *pSsns)
+{
+   U32 slots = m_pSsn.size();
+
+   for (U32 slot = 0; slot < slots; slot++)
+   {
+      if (TASK_STATE_PAUSED == m_taskState[slot] &&
+            0 == (m_state[slot] & skipMask))
+      {
+         pSsns->push_back(m_pSsn[slot]);
+      }
+   }
+}
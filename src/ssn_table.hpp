@@ -0,0 +1,125 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SSN_TABLE_HPP_
+#define _SSN_TABLE_HPP_
+
+class UeSession;
+
+#define SSN_PEER_INVALID         0xff
+
+/**
+ * @brief
+ *    Sessions of a scenario, stored as a structure of arrays indexed by the
+ *    slot of the session. The fields sweeps over all sessions look at are
+ *    kept in dense arrays, so that a sweep is a sequential scan instead of
+ *    a walk over sessions scattered across the session pool. The rest of
+ *    the session stays in UeSession, reached by the pointer of the slot.
+ *    The fields are a copy of the session, updated at the end of every run
+ *    of the session. The session variables of the <store> and <patch> tags
+ *    are kept only here, and only when the scenario uses them
+ */
+class SessionTable
+{
+   public:
+      SessionTable();
+      ~SessionTable() {}
+
+      U32               add(UeSession *pSsn);
+      VOID              del(U32 slot);
+
+      /* allocates GTP_MAX_SSN_VARS variables per slot, called before the
+       * first session is added
+       */
+      VOID              enableVars() { m_hasVars = TRUE; }
+
+      inline VOID update(U32 slot, TaskState_t taskState, U8 state,
+            U16 procIdx, U32 deadline)
+      {
+         m_taskState[slot] = taskState;
+         m_state[slot]     = state;
+         m_procIdx[slot]   = procIdx;
+         m_deadline[slot]  = deadline;
+      }
+
+      inline VOID updatePeer(U32 slot, U8 peerIdx)
+      {
+         m_peerIdx[slot] = peerIdx;
+      }
+
+      inline VOID updateTeids(U32 slot, GtpTeid_t locTeid, GtpTeid_t remTeid)
+      {
+         m_locTeid[slot] = locTeid;
+         m_remTeid[slot] = remTeid;
+      }
+
+      /* slots in use are below numSlots(), free slots have no session */
+      inline U32        numSlots() { return m_pSsn.size(); }
+      inline U32        size() { return m_numUsed; }
+      inline UeSession* session(U32 slot) { return m_pSsn[slot]; }
+      inline BOOL       isUsed(U32 slot)
+      {
+         return (TASK_STATE_INVALID != m_taskState[slot]);
+      }
+      inline TaskState_t taskState(U32 slot)
+      {
+         return (TaskState_t)m_taskState[slot];
+      }
+      inline U8         state(U32 slot) { return m_state[slot]; }
+      inline U16        procIdx(U32 slot) { return m_procIdx[slot]; }
+      inline U32        deadline(U32 slot) { return m_deadline[slot]; }
+      inline U8         peerIdx(U32 slot) { return m_peerIdx[slot]; }
+      inline GtpTeid_t  locTeid(U32 slot) { return m_locTeid[slot]; }
+      inline GtpTeid_t  remTeid(U32 slot) { return m_remTeid[slot]; }
+
+      /* variables of the slot, NULL if the scenario has none. Adding a
+       * session may move them
+       */
+      inline GtpSsnVar_t *vars(U32 slot)
+      {
+         return m_hasVars ? &m_vars[slot * GTP_MAX_SSN_VARS] : NULL;
+      }
+
+      /**
+       * @return
+       *    number of sessions with all of the state bits of mask set
+       */
+      U32               countState(U8 mask);
+
+      /**
+       * @brief
+       *    Sessions paused outside of a request in flight, the candidates of
+       *    UeSession::isWaiting()
+       */
+      VOID              collectPaused(U8 skipMask,
+                           std::vector<UeSession*> *pSsns);
+
+   private:
+      std::vector<U8>         m_taskState;  /* TASK_STATE_INVALID if free */
+      std::vector<U8>         m_state;      /* GSIM_UE_SSN_xxx bits */
+      std::vector<U16>        m_procIdx;    /* current procedure step */
+      std::vector<U32>        m_deadline;   /* wake time, ms */
+      std::vector<U8>         m_peerIdx;
+      std::vector<GtpTeid_t>  m_locTeid;    /* c-plane TEIDs, 0 if none */
+      std::vector<GtpTeid_t>  m_remTeid;
+      std::vector<UeSession*> m_pSsn;       /* cold session data */
+      std::vector<GtpSsnVar_t> m_vars;      /* GTP_MAX_SSN_VARS per slot */
+      BOOL                    m_hasVars;
+      std::vector<U32>        m_freeSlots;
+      U32                     m_numUsed;
+};
+
+#endif
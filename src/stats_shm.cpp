@@ -0,0 +1,411 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "task.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "sim_cfg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "scenario.hpp"
+#include "tunnel.hpp"
+#include "session.hpp"
+#include "ssn_table.hpp"
+#include "mempool.hpp"
+#include "poller.hpp"
+#include "latency.hpp"
+#include "cluster.hpp"
+#include "drain.hpp"
+#include "checkpoint.hpp"
+#include "gtp_peer.hpp"
+#include "overload.hpp"
+#include "traffic.hpp"
+#include "stats_shm.hpp"
+
+typedef U64 (*StatsShmGetter_t)(U32 arg);
+
+typedef struct
+{
+   const S8          *pName;
+   StatsShmGetter_t  get;
+   U32               arg;
+} StatsShmSource_t;
+
+static StatsShmHdr_t             *s_pShm     = NULL;
+static string                    s_shmName;
+static std::vector<StatsShmSource_t> s_counters;
+static std::vector<Job *>        s_jobs;
+static PollStats_t               *s_pPollStats = NULL;
+static Scenario                  *s_pShmScn  = NULL;
+
+static const S8 *s_poolNames[MEM_POOL_MAX] =
+{
+   "pool.session.used",
+   "pool.tunnel.used",
+   "pool.tombstone.used",
+   "pool.buffer.used"
+};
+
+PRIVATE U64 getGtpStat(U32 arg)
+{
+   return Stats::getStats((GtpStat_t)arg);
+}
+
+PRIVATE U64 getSessionRate(U32 arg)
+{
+   return Config::getInstance()->getCallRate();
+}
+
+PRIVATE U64 getNumRunningTasks(U32 arg)
+{
+   return TaskMgr::getRunningTasks()->size();
+}
+
+PRIVATE U64 getPollModeStat(U32 arg)
+{
+   return (0 == arg) ? getPollMode() : getActivePollMode();
+}
+
+PRIVATE U64 getPollCpuUsec(U32 arg)
+{
+   return s_pPollStats[arg].cpuUsec;
+}
+
+PRIVATE U64 getPollMsgs(U32 arg)
+{
+   return s_pPollStats[arg].numMsgs;
+}
+
+PRIVATE U64 getPoolUsed(U32 arg)
+{
+   MemPool *pPool = getMemPool((MemPoolId_t)arg);
+   return (NULL == pPool) ? 0 : pPool->numUsed();
+}
+
+PRIVATE U64 getDrainLeft(U32 arg)
+{
+   return isDraining() ? getDrainStats()->numLeft : 0;
+}
+
+PRIVATE U64 getCkptStat(U32 arg)
+{
+   return (0 == arg) ? getCkptStats()->numTaken : getCkptStats()->numRestored;
+}
+
+PRIVATE U64 getOverloadStat(U32 arg)
+{
+   TrafficTask *pTTask = getTrafficTask();
+
+   if (NULL == pTTask)
+   {
+      return 0;
+   }
+
+   switch (arg)
+   {
+      case 0:
+         return pTTask->numThrottled();
+      case 1:
+         return pTTask->effectiveRate();
+      default:
+         return getReductionMetric(pTTask->peer());
+   }
+}
+
+/**
+ * @brief
+ *    Sessions with the state bits of arg set, counted by a scan of the
+ *    session table
+ */
+PRIVATE U64 getSsnStateCount(U32 arg)
+{
+   if (NULL == s_pShmScn)
+   {
+      return 0;
+   }
+
+   return s_pShmScn->m_pSsnTable->countState((U8)arg);
+}
+
+PRIVATE VOID addCounter(const S8 *pName, StatsShmGetter_t get, U32 arg = 0)
+{
+   StatsShmSource_t src = {pName, get, arg};
+   s_counters.push_back(src);
+}
+
+PRIVATE VOID addCounters()
+{
+   addCounter("sessions.created", getGtpStat, GSIM_STAT_NUM_SESSIONS_CREATED);
+   addCounter("sessions.active", getGtpStat, GSIM_STAT_NUM_SESSIONS);
+   addCounter("sessions.completed", getGtpStat, GSIM_STAT_NUM_SESSIONS_SUCC);
+   addCounter("sessions.aborted", getGtpStat, GSIM_STAT_NUM_SESSIONS_FAIL);
+   addCounter("sessions.dead", getGtpStat, GSIM_STAT_NUM_DEADCALLS);
+   addCounter("sessions.waiting.rsp", getSsnStateCount,
+         GSIM_UE_SSN_WAITING_FOR_RSP);
+   addCounter("sessions.parked", getSsnStateCount, GSIM_UE_SSN_DRAIN_PARKED);
+   addCounter("msgs.unexpected", getGtpStat, GSIM_STAT_UNEXCEPTED_MSG_RECD);
+   addCounter("msgs.rejected", getGtpStat, GSIM_STAT_NUM_REJECTED);
+   addCounter("msgs.invalid", getGtpStat, GSIM_STAT_NUM_INVALID);
+   addCounter("msgs.retrans.deferred", getGtpStat,
+         GSIM_STAT_NUM_RETRANS_DEFERRED);
+   addCounter("msgs.send.failed", getGtpStat, GSIM_STAT_NUM_SEND_FAILED);
+   addCounter("session.rate", getSessionRate);
+   addCounter("session.rate.effective", getOverloadStat, 1);
+   addCounter("sessions.throttled", getOverloadStat, 0);
+   addCounter("overload.reduction", getOverloadStat, 2);
+   addCounter("tasks.running", getNumRunningTasks);
+
+   /* the coordinator runs no transport */
+   if (!isClusterCoordinator())
+   {
+      addCounter("poll.mode", getPollModeStat, 0);
+      addCounter("poll.active", getPollModeStat, 1);
+      addCounter("poll.interrupt.cpu_us", getPollCpuUsec, POLL_MODE_INTERRUPT);
+      addCounter("poll.interrupt.msgs", getPollMsgs, POLL_MODE_INTERRUPT);
+      addCounter("poll.busy.cpu_us", getPollCpuUsec, POLL_MODE_BUSY);
+      addCounter("poll.busy.msgs", getPollMsgs, POLL_MODE_BUSY);
+   }
+
+   for (U32 i = 0; i < MEM_POOL_MAX; i++)
+   {
+      addCounter(s_poolNames[i], getPoolUsed, i);
+   }
+
+   addCounter("drain.left", getDrainLeft);
+   addCounter("checkpoint.taken", getCkptStat, 0);
+   addCounter("checkpoint.restored", getCkptStat, 1);
+}
+
+PRIVATE VOID setName(S8 *pDst, const S8 *pName)
+{
+   snprintf(pDst, STATS_SHM_NAME_LEN, "%.*s", STATS_SHM_NAME_LEN - 1, pName);
+}
+
+PUBLIC VOID initStatsShm(Scenario *pScn)
+{
+   LOG_ENTERFN();
+
+   Config *pCfg = Config::getInstance();
+   if (pCfg->getStatsShm().empty())
+   {
+      LOG_EXITVOID();
+   }
+
+   addCounters();
+   s_pShmScn = pScn;
+   if (NULL != pScn)
+   {
+      for (U32 i = 0; i < pScn->m_procSeq.size(); i++)
+      {
+         Procedure *pProc  = pScn->m_procSeq[i];
+         Job       *pJob[] = {pProc->m_initial, pProc->m_trigMsg,
+            pProc->m_trigReply, pProc->m_wait};
+
+         for (U32 j = 0; j < sizeof(pJob) / sizeof(pJob[0]); j++)
+         {
+            if (NULL != pJob[j])
+            {
+               s_jobs.push_back(pJob[j]);
+            }
+         }
+      }
+   }
+
+   U32 counterOff = sizeof(StatsShmHdr_t);
+   U32 jobOff     = counterOff + s_counters.size() * sizeof(StatsShmCounter_t);
+   U32 histOff    = jobOff + s_jobs.size() * sizeof(StatsShmJob_t);
+   U32 size       = histOff + 3 * sizeof(StatsShmHist_t);
+
+   s_shmName = pCfg->getStatsShm();
+   S32 fd = shm_open(s_shmName.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+   if (fd < 0 || 0 != ftruncate(fd, size))
+   {
+      if (fd >= 0)
+      {
+         close(fd);
+      }
+
+      throw GsimError("Unable to create the stats segment " + s_shmName);
+   }
+
+   VOID *pMap = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (MAP_FAILED == pMap)
+   {
+      shm_unlink(s_shmName.c_str());
+      throw GsimError("Unable to map the stats segment " + s_shmName);
+   }
+
+   s_pShm = (StatsShmHdr_t *)pMap;
+   s_pShm->version     = STATS_SHM_VERSION;
+   s_pShm->size        = size;
+   s_pShm->pid         = getpid();
+   s_pShm->numCounters = s_counters.size();
+   s_pShm->numJobs     = s_jobs.size();
+   s_pShm->numHists    = 3;
+   s_pShm->counterOff  = counterOff;
+   s_pShm->jobOff      = jobOff;
+   s_pShm->histOff     = histOff;
+   s_pShm->updateIntvl = pCfg->getStatsShmIntvl();
+   s_pShm->startTime   = time(NULL);
+   strncpy(s_pShm->node, pCfg->getNodeTypeStr().c_str(),
+      sizeof(s_pShm->node) - 1);
+
+   U8 *pBase = (U8 *)s_pShm;
+   StatsShmCounter_t *pCounter = (StatsShmCounter_t *)(pBase + counterOff);
+   for (U32 i = 0; i < s_counters.size(); i++)
+   {
+      setName(pCounter[i].name, s_counters[i].pName);
+   }
+
+   StatsShmJob_t *pJob = (StatsShmJob_t *)(pBase + jobOff);
+   for (U32 i = 0; i < s_jobs.size(); i++)
+   {
+      setName(pJob[i].name, s_jobs[i]->m_msgName);
+   }
+
+   StatsShmHist_t *pHist = (StatsShmHist_t *)(pBase + histOff);
+   setName(pHist[0].name, "rsp-time");
+   setName(pHist[1].name, "queue-delay");
+   setName(pHist[2].name, "reject-time");
+
+   /* readers accept the segment once the magic is set */
+   __atomic_store_n(&s_pShm->magic, STATS_SHM_MAGIC, __ATOMIC_RELEASE);
+   updateStatsShm();
+
+   LOG_INFO("Publishing statistics to %s, %u bytes", s_shmName.c_str(),
+      size);
+   new StatsShmTask();
+
+   LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Writes the values between the two increments of seq, the simulator
+ *    never waits for the readers
+ */
+PUBLIC VOID updateStatsShm()
+{
+   if (NULL == s_pShm)
+   {
+      return;
+   }
+
+   if (!isClusterCoordinator())
+   {
+      s_pPollStats = getPollStats();
+   }
+
+   U32 seq = s_pShm->seq;
+   __atomic_store_n(&s_pShm->seq, seq + 1, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+
+   U8 *pBase = (U8 *)s_pShm;
+   StatsShmCounter_t *pCounter =
+      (StatsShmCounter_t *)(pBase + s_pShm->counterOff);
+   for (U32 i = 0; i < s_counters.size(); i++)
+   {
+      pCounter[i].value = s_counters[i].get(s_counters[i].arg);
+   }
+
+   StatsShmJob_t *pJob = (StatsShmJob_t *)(pBase + s_pShm->jobOff);
+   for (U32 i = 0; i < s_jobs.size(); i++)
+   {
+      pJob[i].numSnd        = s_jobs[i]->m_numSnd;
+      pJob[i].numRcv        = s_jobs[i]->m_numRcv;
+      pJob[i].numSndRetrans = s_jobs[i]->m_numSndRetrans;
+      pJob[i].numRcvRetrans = s_jobs[i]->m_numRcvRetrans;
+      pJob[i].numTimeOut    = s_jobs[i]->m_numTimeOut;
+      pJob[i].numUnexp      = s_jobs[i]->m_numUnexp;
+      pJob[i].numRejected   = s_jobs[i]->m_numRejected;
+   }
+
+   StatsShmHist_t *pHist = (StatsShmHist_t *)(pBase + s_pShm->histOff);
+   getRspTimeHist()->save(&pHist[0].data);
+   getQueueDelayHist()->save(&pHist[1].data);
+   getRejectTimeHist()->save(&pHist[2].data);
+
+   s_pShm->updateTime = getMilliSeconds();
+   s_pShm->numUpdates++;
+
+   __atomic_store_n(&s_pShm->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+PUBLIC VOID closeStatsShm()
+{
+   if (NULL == s_pShm)
+   {
+      return;
+   }
+
+   /* a final update, the segment is gone once the readers unmap it */
+   updateStatsShm();
+   munmap(s_pShm, s_pShm->size);
+   shm_unlink(s_shmName.c_str());
+   s_pShm = NULL;
+   s_pShmScn = NULL;
+}
+
+RETVAL StatsShmTask::run(VOID *arg)
+{
+   updateStatsShm();
+
+   m_wakeTime = getMilliSeconds() + Config::getInstance()->getStatsShmIntvl();
+   pause();
+
+   return ROK;
+}
+
+PUBLIC RETVAL readStatsShm(const VOID *pShm, VOID *pCopy, U32 size)
+{
+   const StatsShmHdr_t *pHdr = (const StatsShmHdr_t *)pShm;
+
+   for (U32 i = 0; i < STATS_SHM_RETRIES; i++)
+   {
+      U32 seq = __atomic_load_n(&pHdr->seq, __ATOMIC_ACQUIRE);
+      if (seq & 1)
+      {
+         continue;
+      }
+
+      MEMCPY(pCopy, pShm, size);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (seq == __atomic_load_n(&pHdr->seq, __ATOMIC_RELAXED))
+      {
+         return ROK;
+      }
+   }
+
+   return RFAILED;
+}
@@ -0,0 +1,111 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _STATS_SHM_HPP_
+#define _STATS_SHM_HPP_
+
+class Scenario;
+
+#define STATS_SHM_MAGIC          0x54535347  /* "GSST" */
+#define STATS_SHM_VERSION        2
+#define STATS_SHM_NAME_LEN       32
+#define STATS_SHM_MAX_COUNTERS   64
+#define STATS_SHM_RETRIES        1000  /* reads overlapping an update */
+
+/* the segment is the header followed by the counter, job and histogram
+ * sections at the offsets of the header. The sections and their names are
+ * fixed at start, only the values change. The simulator makes seq odd
+ * while it updates the values, a reader copies the segment and retries if
+ * seq was odd or changed meanwhile, so neither side ever waits
+ */
+typedef struct
+{
+   U32            magic;
+   U32            version;
+   U32            size;          /* bytes of the segment */
+   U32            seq;           /* odd while being updated */
+   U32            pid;
+   U32            numCounters;
+   U32            numJobs;
+   U32            numHists;
+   U32            counterOff;
+   U32            jobOff;
+   U32            histOff;
+   U32            updateIntvl;   /* ms */
+   U64            startTime;     /* seconds since the epoch */
+   U64            updateTime;    /* ms since the start */
+   U64            numUpdates;
+   S8             node[8];
+} StatsShmHdr_t;
+
+typedef struct
+{
+   S8             name[STATS_SHM_NAME_LEN];
+   U64            value;
+} StatsShmCounter_t;
+
+typedef struct
+{
+   S8             name[STATS_SHM_NAME_LEN];
+   U64            numSnd;
+   U64            numRcv;
+   U64            numSndRetrans;
+   U64            numRcvRetrans;
+   U64            numTimeOut;
+   U64            numUnexp;
+   U64            numRejected;
+} StatsShmJob_t;
+
+typedef struct
+{
+   S8             name[STATS_SHM_NAME_LEN];
+   LatencyData_t  data;
+} StatsShmHist_t;
+
+/**
+ * @brief
+ *    Publishes the statistics to the --stats-shm segment every
+ *    --stats-shm-intvl milliseconds
+ */
+class StatsShmTask: public Task
+{
+   public:
+      StatsShmTask() { m_wakeTime = 0; }
+      ~StatsShmTask() {}
+      RETVAL run(VOID *arg = NULL);
+      inline Time_t wake() { return m_wakeTime; }
+
+   private:
+      Time_t            m_wakeTime;
+};
+
+/**
+ * @brief
+ *    Creates the segment for the jobs of the scenario, pScn is NULL while
+ *    replaying a capture
+ */
+EXTERN VOID          initStatsShm(Scenario *pScn);
+EXTERN VOID          updateStatsShm();
+EXTERN VOID          closeStatsShm();
+
+/**
+ * @brief
+ *    Consistent copy of a segment mapped by a reader, fails if every try
+ *    overlapped an update
+ */
+EXTERN RETVAL        readStatsShm(const VOID *pShm, VOID *pCopy, U32 size);
+
+#endif
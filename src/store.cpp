@@ -0,0 +1,329 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "store.hpp"
+
+/* T flag in the first octet of the GTPv2-C header */
+#define VAR_HDR_T_FLAG           (1 << 3)
+
+PRIVATE inline U32 encHdrLen(const U8 *pMsg)
+{
+   return (pMsg[0] & VAR_HDR_T_FLAG) ? GTP_MSG_HDR_LEN :
+      GTP_MSG_HDR_LEN_WITHOUT_TEID;
+}
+
+/**
+ * @brief
+ *    Finds the occr'th IE of a type and instance in encoded IEs
+ *
+ * @return
+ *    the IE header, NULL if the IE is not present
+ */
+PRIVATE U8* findIe(U8 *pBuf, U32 len, GtpIeType_t ieType,
+      GtpInstance_t inst, U32 occr)
+{
+   GtpIeHdr ieHdr;
+   U32      cnt = 0;
+
+   while (len >= GTP_IE_HDR_LEN)
+   {
+      decIeHdr(pBuf, &ieHdr);
+      if ((U32)ieHdr.len + GTP_IE_HDR_LEN > len)
+      {
+         break;
+      }
+
+      if (ieHdr.ieType == ieType && ieHdr.instance == inst && ++cnt == occr)
+      {
+         return pBuf;
+      }
+
+      len  -= ieHdr.len + GTP_IE_HDR_LEN;
+      pBuf += ieHdr.len + GTP_IE_HDR_LEN;
+   }
+
+   return NULL;
+}
+
+/**
+ * @brief
+ *    Finds the value of a rule in encoded IEs
+ *
+ * @return
+ *    the value, NULL if it is not present. pLen has the length of the
+ *    value
+ */
+PRIVATE U8* findValue(U8 *pBuf, U32 len, const VarRule_t *pRule, U32 *pLen)
+{
+   GtpIeHdr ieHdr;
+
+   if (GTP_IE_MAX != pRule->grpType)
+   {
+      pBuf = findIe(pBuf, len, pRule->grpType, pRule->grpInst,
+            pRule->grpOccr);
+      if (NULL == pBuf)
+      {
+         return NULL;
+      }
+
+      decIeHdr(pBuf, &ieHdr);
+      len   = ieHdr.len;
+      pBuf += GTP_IE_HDR_LEN;
+   }
+
+   pBuf = findIe(pBuf, len, pRule->ieType, pRule->inst, pRule->occr);
+   if (NULL == pBuf)
+   {
+      return NULL;
+   }
+
+   decIeHdr(pBuf, &ieHdr);
+   if (pRule->offset >= ieHdr.len)
+   {
+      return NULL;
+   }
+
+   *pLen = pRule->len ? pRule->len : ieHdr.len - pRule->offset;
+   if (pRule->offset + *pLen > ieHdr.len)
+   {
+      return NULL;
+   }
+
+   return pBuf + GTP_IE_HDR_LEN + pRule->offset;
+}
+
+StoreRules::StoreRules()
+{
+   m_numRules = 0;
+   MEMSET(m_ieRules, 0, sizeof(m_ieRules));
+}
+
+/**
+ * @return
+ *    RFAILED if the message has the maximum number of rules
+ */
+RETVAL StoreRules::addRule(const VarRule_t *pRule)
+{
+   if (m_numRules >= VAR_MAX_RULES)
+   {
+      return RFAILED;
+   }
+
+   GtpIeType_t topType = (GTP_IE_MAX != pRule->grpType) ? pRule->grpType :
+      pRule->ieType;
+
+   m_rules[m_numRules] = *pRule;
+   m_ieRules[topType] |= 1U << m_numRules;
+   m_numRules++;
+
+   return ROK;
+}
+
+/**
+ * @brief
+ *    Stores the values of the rules present in a received message into the
+ *    session variables, a rule of a value not present keeps the variable
+ */
+VOID StoreRules::store(GtpMsg *pMsg, GtpSsnVar_t *pVars)
+{
+   GtpIeHdr ieHdr;
+   U8       occr[VAR_MAX_RULES] = {0};
+   U32      len  = 0;
+   U8       *pBuf = pMsg->getIeBuf(&len);
+
+   while (len >= GTP_IE_HDR_LEN)
+   {
+      decIeHdr(pBuf, &ieHdr);
+      if ((U32)ieHdr.len + GTP_IE_HDR_LEN > len)
+      {
+         break;
+      }
+
+      U32 rules = m_ieRules[ieHdr.ieType];
+      while (0 != rules)
+      {
+         U32       indx   = __builtin_ctz(rules);
+         VarRule_t *pRule = &m_rules[indx];
+         BOOL      inGrp  = (GTP_IE_MAX != pRule->grpType);
+
+         rules &= rules - 1;
+         if ((inGrp ? pRule->grpInst : pRule->inst) != ieHdr.instance ||
+             ++occr[indx] != (inGrp ? pRule->grpOccr : pRule->occr))
+         {
+            continue;
+         }
+
+         /* the value is looked up from this IE, or inside this group */
+         VarRule_t   rule = *pRule;
+         U32         valLen = 0;
+         rule.grpType = GTP_IE_MAX;
+         rule.occr    = inGrp ? pRule->occr : 1;
+
+         U8 *pVal = inGrp ?
+            findValue(pBuf + GTP_IE_HDR_LEN, ieHdr.len, &rule, &valLen) :
+            findValue(pBuf, ieHdr.len + GTP_IE_HDR_LEN, &rule, &valLen);
+         if (NULL == pVal || valLen > GTP_SSN_VAR_LEN)
+         {
+            LOG_DEBUG("Value of IE [%d] not stored", pRule->ieType);
+            continue;
+         }
+
+         pVars[pRule->var].len = valLen;
+         MEMCPY(pVars[pRule->var].val, pVal, valLen);
+      }
+
+      len  -= ieHdr.len + GTP_IE_HDR_LEN;
+      pBuf += ieHdr.len + GTP_IE_HDR_LEN;
+   }
+}
+
+PatchRules::PatchRules()
+{
+   m_numPatches = 0;
+}
+
+/**
+ * @brief
+ *    Compiles a rule into the offset of its value in the encoded template
+ *
+ * @return
+ *    RFAILED if the template has no such value or the message has the
+ *    maximum number of rules
+ */
+RETVAL PatchRules::addRule(const VarRule_t *pRule, GtpMsg *pTemplate)
+{
+   U8  buf[GTP_MSG_BUF_LEN];
+   U32 len = 0;
+   U32 valLen = 0;
+
+   if (m_numPatches >= VAR_MAX_RULES)
+   {
+      return RFAILED;
+   }
+
+   MEMSET(buf, 0, GTP_MSG_BUF_LEN);
+   pTemplate->encode(buf, &len);
+
+   U32 hdrLen = encHdrLen(buf);
+   U8  *pIes  = buf + hdrLen;
+   U8  *pVal  = findValue(pIes, len - hdrLen, pRule, &valLen);
+   if (NULL == pVal || valLen > GTP_SSN_VAR_LEN)
+   {
+      return RFAILED;
+   }
+
+   VarPatch_t *pPatch = &m_patches[m_numPatches];
+   GtpIeHdr   ieHdr;
+   U8         *pIe    = pVal - pRule->offset - GTP_IE_HDR_LEN;
+
+   pPatch->ieOffset  = pVal - pIes;
+   pPatch->hdrOffset = pIe - pIes;
+   decIeHdr(pIe, &ieHdr);
+   pPatch->ieLen     = ieHdr.len;
+   pPatch->grpOffset = 0;
+   pPatch->grpLen    = 0;
+   if (GTP_IE_MAX != pRule->grpType)
+   {
+      U8 *pGrp = findIe(pIes, len - hdrLen, pRule->grpType, pRule->grpInst,
+            pRule->grpOccr);
+      decIeHdr(pGrp, &ieHdr);
+      pPatch->grpOffset = pGrp - pIes;
+      pPatch->grpLen    = ieHdr.len;
+   }
+   pPatch->len       = valLen;
+   pPatch->var       = pRule->var;
+   pPatch->rule      = *pRule;
+   m_numPatches++;
+
+   return ROK;
+}
+
+/**
+ * @brief
+ *    Checks that an encoded IE header matches the type, instance and length
+ *    of the IE a rule was compiled from
+ */
+PRIVATE inline BOOL isIeAt(U8 *pIe, GtpIeType_t ieType,
+      GtpInstance_t inst, U16 ieLen)
+{
+   GtpIeHdr ieHdr;
+
+   decIeHdr(pIe, &ieHdr);
+   return (ieHdr.ieType == ieType && ieHdr.instance == inst &&
+         ieHdr.len == ieLen);
+}
+
+/**
+ * @brief
+ *    Copies the session variables over the values of an encoded message
+ */
+VOID PatchRules::patch(Buffer *pBuf, const GtpSsnVar_t *pVars)
+{
+   U32 hdrLen = encHdrLen(pBuf->pVal);
+   U8  *pIes  = pBuf->pVal + hdrLen;
+   U32 iesLen = (pBuf->len > hdrLen) ? pBuf->len - hdrLen : 0;
+
+   for (U32 i = 0; i < m_numPatches; i++)
+   {
+      const VarPatch_t  *pPatch = &m_patches[i];
+      const VarRule_t   *pRule  = &pPatch->rule;
+      const GtpSsnVar_t *pVar   = &pVars[pPatch->var];
+      U8                *pVal   = NULL;
+      U32               valLen  = pPatch->len;
+
+      if (pVar->len != pPatch->len)
+      {
+         LOG_DEBUG("Variable [%d] of length [%d] not patched", pPatch->var,
+               pVar->len);
+         continue;
+      }
+
+      if (pPatch->ieOffset + pPatch->len <= iesLen &&
+          isIeAt(pIes + pPatch->hdrOffset, pRule->ieType, pRule->inst,
+             pPatch->ieLen) &&
+          (GTP_IE_MAX == pRule->grpType ||
+           isIeAt(pIes + pPatch->grpOffset, pRule->grpType, pRule->grpInst,
+             pPatch->grpLen)))
+      {
+         pVal = pIes + pPatch->ieOffset;
+      }
+      else
+      {
+         /* the IEs moved from where they are in the template */
+         pVal = findValue(pIes, iesLen, pRule, &valLen);
+      }
+
+      if (NULL == pVal || valLen != pPatch->len)
+      {
+         LOG_DEBUG("Value of variable [%d] not found", pPatch->var);
+         continue;
+      }
+
+      MEMCPY(pVal, pVar->val, pVar->len);
+   }
+}
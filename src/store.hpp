@@ -0,0 +1,108 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _STORE_HPP_
+#define _STORE_HPP_
+
+class GtpMsg;
+
+#define VAR_MAX_RULES            32    /* <store> or <patch> tags of a msg */
+#define VAR_NAME_LEN             32
+
+/**
+ * @brief
+ *    Location of a value in the IEs of a message, the occurr'th IE of a
+ *    type and instance, optionally inside the grpOccr'th grouped IE of
+ *    grpType. The value is len octets at offset of the IE data, len 0 is
+ *    up to the end of the IE data
+ */
+typedef struct
+{
+   GtpIeType_t       grpType;      /* GTP_IE_MAX at the top level */
+   GtpInstance_t     grpInst;
+   U8                grpOccr;
+   GtpIeType_t       ieType;
+   GtpInstance_t     inst;
+   U8                occr;
+   U16               offset;
+   U8                len;
+   U8                var;          /* index of the session variable */
+} VarRule_t;
+
+/**
+ * @brief
+ *    <store> tags of a received message, compiled into a rule table and a
+ *    bitmask of the rules for each top level IE type. The values are
+ *    copied into the session variables in one walk over the encoded IEs
+ */
+class StoreRules
+{
+   public:
+      StoreRules();
+      ~StoreRules() {}
+
+      RETVAL            addRule(const VarRule_t *pRule);
+      VOID              store(GtpMsg *pMsg, GtpSsnVar_t *pVars);
+
+   private:
+      VarRule_t         m_rules[VAR_MAX_RULES];
+      U32               m_numRules;
+      U32               m_ieRules[GTP_IE_MAX];  /* rules of each IE type */
+};
+
+/**
+ * @brief
+ *    A <patch> tag of a message sent, the offset of the value in the IEs
+ *    of the encoded template is found when the scenario is loaded. The IE
+ *    headers found there are kept to check that a message encoded for a
+ *    session still has the IE at that offset
+ */
+typedef struct
+{
+   U16               ieOffset;     /* from the end of the message header */
+   U16               hdrOffset;    /* of the IE holding the value */
+   U16               grpOffset;    /* of the grouped IE, if in a group */
+   U16               ieLen;
+   U16               grpLen;
+   U8                len;          /* octets the template has room for */
+   U8                var;
+   VarRule_t         rule;
+} VarPatch_t;
+
+/**
+ * @brief
+ *    <patch> tags of a message sent, the stored session variables are
+ *    copied over the encoded message at the compiled offsets. When the IEs
+ *    of a session's message moved, e.g. the sender F-TEID was encoded with
+ *    another address family, the value is looked up in the message. A
+ *    variable not stored yet, or with a length other than the room in the
+ *    template, leaves the template value
+ */
+class PatchRules
+{
+   public:
+      PatchRules();
+      ~PatchRules() {}
+
+      RETVAL            addRule(const VarRule_t *pRule, GtpMsg *pTemplate);
+      VOID              patch(Buffer *pBuf, const GtpSsnVar_t *pVars);
+
+   private:
+      VarPatch_t        m_patches[VAR_MAX_RULES];
+      U32               m_numPatches;
+};
+
+#endif
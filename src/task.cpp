@@ -16,17 +16,26 @@
 
 #include <assert.h>
 #include <list>
+#include <vector>
 
 #include "types.hpp"
 #include "logger.hpp"
 #include "timer.hpp"
 #include "task.hpp"
+#include "transport.hpp"
 
 static TaskId_t   s_taskId = 0;
 TaskList          g_runningTasks;
 TaskList          g_allTasks;
 TimeWheel         g_pausedTasks;
 
+/* batches of the running tasks collected by runTasks(), the task vectors
+ * are kept across runs to reuse their memory
+ */
+static std::vector<const VOID*>           s_batchKeys;
+static std::vector<std::vector<Task*> >   s_batchTasks;
+static std::vector<RETVAL>                s_batchRets;
+
 Task::Task()
 {
    m_allTaskItr = g_allTasks.insert(g_allTasks.end(), this);
@@ -56,6 +65,14 @@ VOID Task::abort()
    delete this;
 }
 
+VOID Task::runBatch(Task **ppTasks, U32 cnt, RETVAL *pRets)
+{
+   for (U32 i = 0; i < cnt; i++)
+   {
+      pRets[i] = ppTasks[i]->run();
+   }
+}
+
 VOID Task::pause()
 {
    ASSERT(TASK_STATE_RUNNING == m_taskState);
@@ -104,6 +121,92 @@ VOID TaskMgr::resumePausedTasks()
    g_pausedTasks.resumePausedTasks();
 }
 
+/**
+ * @brief
+ *    Runs every task in the running task list once. A task which fails
+ *    is aborted. The tasks with the same batch key are run together after
+ *    the others, and the messages of all the tasks are handed to the
+ *    transport in one send batch
+ */
+VOID TaskMgr::runTasks()
+{
+   U32 numBatches = 0;
+
+   beginSendBatch();
+   TaskListItr itr = g_runningTasks.begin();
+   while (itr != g_runningTasks.end())
+   {
+      Task *t = *itr;
+
+      // increment the iterator here, because after the task is run
+      // it will be paused state which will move the task from running
+      // task list to paused task list.
+      itr++;
+      const VOID *pKey = t->batchKey();
+      if (NULL != pKey)
+      {
+         U32 b = 0;
+         while (b < numBatches && s_batchKeys[b] != pKey)
+         {
+            b++;
+         }
+
+         if (b == numBatches)
+         {
+            if (numBatches == s_batchKeys.size())
+            {
+               s_batchKeys.resize(numBatches + 1);
+               s_batchTasks.resize(numBatches + 1);
+            }
+            s_batchKeys[b] = pKey;
+            numBatches++;
+         }
+
+         s_batchTasks[b].push_back(t);
+         continue;
+      }
+
+      if (ROK != t->run())
+      {
+         t->abort();
+      }
+   }
+
+   for (U32 b = 0; b < numBatches; b++)
+   {
+      std::vector<Task*> &tasks = s_batchTasks[b];
+      U32                cnt    = tasks.size();
+
+      s_batchRets.resize(cnt);
+      tasks[0]->runBatch(&tasks[0], cnt, &s_batchRets[0]);
+      for (U32 i = 0; i < cnt; i++)
+      {
+         if (ROK != s_batchRets[i])
+         {
+            tasks[i]->abort();
+         }
+      }
+
+      tasks.clear();
+   }
+   endSendBatch();
+}
+
+/**
+ * @brief
+ *    Milliseconds the scheduler can block before a task has to run, at
+ *    most maxWait
+ */
+Time_t TaskMgr::nextWakeDelay(Time_t maxWait)
+{
+   if (!g_runningTasks.empty())
+   {
+      return 0;
+   }
+
+   return g_pausedTasks.nextExpiry(maxWait);
+}
+
 VOID TaskMgr::deleteAllTasks()
 {
    TaskList *pTasks = getAllTasks();
@@ -37,7 +37,9 @@ class TaskMgr
       static TaskList* getRunningTasks();
       static TaskList* getAllTasks();
       static VOID resumePausedTasks();
+      static VOID runTasks();
       static VOID deleteAllTasks();
+      static Time_t nextWakeDelay(Time_t maxWait);
 };
 
 
@@ -54,12 +56,24 @@ class Task
 
       virtual RETVAL run(VOID *arg = NULL) = 0;
 
+      /* Tasks returning the same key run together through runBatch(), NULL
+       * if the next run of the task can not be batched
+       */
+      virtual const VOID *batchKey() { return NULL; }
+
+      /* Runs cnt tasks of the batch key of this task, this one included,
+       * the result of the run of each task is returned in pRets
+       */
+      virtual VOID runBatch(Task **ppTasks, U32 cnt, RETVAL *pRets);
+
       virtual VOID abort();
 
       virtual VOID stop();
 
       /* Wake this up a paused Task */
       VOID resumeTask();
+
+      inline TaskState_t state() { return m_taskState; }
    protected:
       TaskId_t        m_id;
 
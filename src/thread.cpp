@@ -15,10 +15,17 @@
  */
 
 #include "thread.hpp"
+#include "affinity.hpp"
 
 CThread::CThread()
 {
+    cpu_set_t cpuSet;
+
     pthread_attr_init(&threadAttr);
+    if (ROK == nextWorkerCpuSet(&cpuSet))
+    {
+        pthread_attr_setaffinity_np(&threadAttr, sizeof(cpuSet), &cpuSet);
+    }
 }
 
 S32 CThread::start(VOID* arg)
@@ -206,6 +206,42 @@ VOID TimeWheel::removeTask(Task *task)
     count--;
 }
 
+/**
+ * @brief
+ *    Milliseconds until the paused tasks of the earliest slot are resumed,
+ *    looking at most maxWait ahead. The lookup stops at the end of wheel
+ *    one, where the tasks of wheel two are moved into it
+ *
+ * @param maxWait
+ */
+Time_t TimeWheel::nextExpiry(Time_t maxWait)
+{
+    Time_t end = wheelBase + maxWait;
+    Time_t wheelEnd = (wheelBase / TW_ONE_SLOTS + 1) * TW_ONE_SLOTS;
+
+    /* wheel one is refilled from wheel two when the base reaches slot 0 */
+    if (0 == wheelBase % TW_ONE_SLOTS)
+    {
+        wheelEnd = wheelBase + 1;
+    }
+
+    if (wheelEnd < end)
+    {
+        end = wheelEnd;
+    }
+
+    for (Time_t time = wheelBase; time < end; time++)
+    {
+        if (!wheelOne[time % TW_ONE_SLOTS].empty())
+        {
+            /* a slot is resumed once the clock has moved past it */
+            return (time + 1 > s_clockTick) ? (time + 1 - s_clockTick) : 0;
+        }
+    }
+
+    return (end > s_clockTick) ? (end - s_clockTick) : 0;
+}
+
 TimeWheel::TimeWheel()
 {
     count     = 0;
@@ -50,6 +50,7 @@ class TimeWheel
       void wakeupTask();
       S32 resumePausedTasks();
       Counter size();
+      Time_t nextExpiry(Time_t maxWait);
 
    private:
       Time_t   wheelBase;
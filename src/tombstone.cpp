@@ -0,0 +1,245 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <map>
+#include <deque>
+#include <unordered_map>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "gtp_macro.hpp"
+#include "task.hpp"
+#include "timer.hpp"
+#include "transport.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "sim_cfg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "scenario.hpp"
+#include "tombstone.hpp"
+#include "mempool.hpp"
+
+static TombstoneQ          s_tombstoneQ;
+static TombstoneTeidMap    s_tombstoneTeidMap;
+static TombstoneTask       *s_pTombstoneTask = NULL;
+
+Tombstone::Tombstone()
+{
+   m_pScn      = NULL;
+   m_pProc     = NULL;
+   m_pSentMsg  = NULL;
+   m_expiry    = 0;
+   m_teid      = 0;
+   m_seqNumber = 0;
+   m_reqType   = GTPC_MSG_TYPE_INVALID;
+   m_rspType   = GTPC_MSG_TYPE_INVALID;
+   MEMSET(&m_imsiKey, 0, sizeof(GtpImsiKey));
+}
+
+/**
+ * @brief
+ *    Destructor, removes the tombstone from the TEID and IMSI indexes
+ */
+Tombstone::~Tombstone()
+{
+   /* a newer tombstone of a reused TEID or IMSI owns the entry */
+   if (0 != m_teid)
+   {
+      TombstoneTeidMapItr teidItr = s_tombstoneTeidMap.find(m_teid);
+      if (teidItr != s_tombstoneTeidMap.end() && teidItr->second == this)
+      {
+         s_tombstoneTeidMap.erase(teidItr);
+      }
+   }
+
+   TombstoneMapItr itr = m_pScn->m_tombstoneMap.find(m_imsiKey);
+   if (itr != m_pScn->m_tombstoneMap.end() && itr->second == this)
+   {
+      m_pScn->m_tombstoneMap.erase(itr);
+   }
+
+   delete m_pSentMsg;
+}
+
+VOID *Tombstone::operator new(size_t size)
+{
+   return memPoolAlloc(MEM_POOL_TOMBSTONE, size);
+}
+
+VOID Tombstone::operator delete(VOID *p)
+{
+   memPoolFree(MEM_POOL_TOMBSTONE, p);
+}
+
+TombstoneTask::TombstoneTask()
+{
+   m_wakeTime = 0;
+}
+
+/**
+ * @brief
+ *    Destructor, deletes the tombstones which are not expired yet
+ */
+TombstoneTask::~TombstoneTask()
+{
+   while (!s_tombstoneQ.empty())
+   {
+      delete s_tombstoneQ.front();
+      s_tombstoneQ.pop_front();
+   }
+
+   s_pTombstoneTask = NULL;
+}
+
+RETVAL TombstoneTask::run(VOID *arg)
+{
+   LOG_ENTERFN();
+
+   Time_t currTime = getMilliSeconds();
+
+   while (!s_tombstoneQ.empty() && s_tombstoneQ.front()->m_expiry <= currTime)
+   {
+      delete s_tombstoneQ.front();
+      s_tombstoneQ.pop_front();
+      Stats::decStats(GSIM_STAT_NUM_DEADCALLS);
+   }
+
+   /* a tombstone created from now on expires after the dead call wait,
+    * so the task need not run earlier than that when there are none
+    */
+   if (s_tombstoneQ.empty())
+   {
+      m_wakeTime = currTime + Config::getInstance()->getDeadCallWait();
+   }
+   else
+   {
+      m_wakeTime = s_tombstoneQ.front()->m_expiry;
+   }
+
+   pause();
+
+   LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Adds the tombstone of a completed UE session, indexed by the local
+ *    control plane TEID and by IMSI for the retransmission lookup
+ *
+ * @param pTomb
+ */
+PUBLIC VOID addTombstone(Tombstone *pTomb)
+{
+   LOG_ENTERFN();
+
+   if (NULL == s_pTombstoneTask)
+   {
+      s_pTombstoneTask = new TombstoneTask;
+   }
+
+   s_tombstoneQ.push_back(pTomb);
+   if (0 != pTomb->m_teid)
+   {
+      s_tombstoneTeidMap[pTomb->m_teid] = pTomb;
+   }
+
+   pTomb->m_pScn->m_tombstoneMap[pTomb->m_imsiKey] = pTomb;
+   Stats::incStats(GSIM_STAT_NUM_DEADCALLS);
+
+   LOG_EXITVOID();
+}
+
+PUBLIC Tombstone* findTombstone(GtpTeid_t teid)
+{
+   LOG_ENTERFN();
+
+   Tombstone *pTomb = NULL;
+
+   TombstoneTeidMapItr itr = s_tombstoneTeidMap.find(teid);
+   if (itr != s_tombstoneTeidMap.end())
+   {
+      pTomb = itr->second;
+   }
+
+   LOG_EXITFN(pTomb);
+}
+
+PUBLIC Tombstone* findTombstone(Scenario *pScn, GtpImsiKey imsiKey)
+{
+   LOG_ENTERFN();
+
+   Tombstone *pTomb = NULL;
+
+   TombstoneMapItr itr = pScn->m_tombstoneMap.find(imsiKey);
+   if (itr != pScn->m_tombstoneMap.end())
+   {
+      pTomb = itr->second;
+   }
+
+   LOG_EXITFN(pTomb);
+}
+
+/**
+ * @brief
+ *    Handles a message received for a completed UE session. A retransmitted
+ *    request of the last procedure is answered with the stored response
+ *
+ * @param pTomb
+ * @param data
+ */
+PUBLIC VOID procTombstoneMsg(Tombstone *pTomb, UdpData_t *data)
+{
+   LOG_ENTERFN();
+
+   GtpMsgType_t      msgType = GTPC_MSG_TYPE_INVALID;
+   GtpSeqNumber_t    seqNumber = 0;
+
+   GTP_MSG_GET_TYPE(data->buf.pVal, msgType);
+   GTP_MSG_GET_SEQN(data->buf.pVal, seqNumber);
+
+   if (pTomb->m_reqType == msgType && pTomb->m_seqNumber == seqNumber)
+   {
+      if (NULL != pTomb->m_pSentMsg)
+      {
+         /* resend the request response */
+         Buffer *buf = new Buffer(pTomb->m_pSentMsg->buf);
+         sendMsg(pTomb->m_pSentMsg->connId, &pTomb->m_pSentMsg->peerEp, buf);
+      }
+
+      pTomb->m_pProc->m_initial->m_numRcvRetrans++;
+      pTomb->m_pProc->m_trigMsg->m_numSndRetrans++;
+   }
+   else if (pTomb->m_rspType == msgType && pTomb->m_seqNumber == seqNumber)
+   {
+      pTomb->m_pProc->m_trigMsg->m_numRcvRetrans++;
+   }
+   else
+   {
+      pTomb->m_pProc->m_initial->m_numUnexp++;
+   }
+
+   delete data;
+
+   LOG_EXITVOID();
+}
@@ -0,0 +1,78 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TOMBSTONE_HPP__
+#define __TOMBSTONE_HPP__
+
+class Scenario;
+class Procedure;
+
+/**
+ * @brief
+ *    Record left behind by a UE session whose scenario is complete. It
+ *    holds only what is required to answer late retransmissions during
+ *    the dead call wait, the UE session itself is deleted on completion
+ */
+class Tombstone
+{
+   public:
+      Tombstone();
+      ~Tombstone();
+
+      static VOID       *operator new(size_t size);
+      static VOID       operator delete(VOID *p);
+
+      Scenario          *m_pScn;
+      Procedure         *m_pProc;     /* last procedure of the scenario */
+      UdpData_t         *m_pSentMsg;  /* last response sent to the peer,
+                                       * carries the peer and connection
+                                       */
+      Time_t            m_expiry;
+      GtpTeid_t         m_teid;
+      GtpSeqNumber_t    m_seqNumber;
+      GtpMsgType_t      m_reqType;
+      GtpMsgType_t      m_rspType;
+      GtpImsiKey        m_imsiKey;
+};
+
+typedef std::deque<Tombstone*>                  TombstoneQ;
+typedef std::unordered_map<GtpTeid_t, Tombstone*> TombstoneTeidMap;
+typedef TombstoneTeidMap::iterator              TombstoneTeidMapItr;
+
+/**
+ * @brief
+ *    Deletes the tombstones once the dead call wait expires. All tombstones
+ *    wait for the same duration, so they expire in the order of creation
+ */
+class TombstoneTask: public Task
+{
+   public:
+      TombstoneTask();
+      ~TombstoneTask();
+
+      RETVAL            run(VOID *arg = NULL);
+      inline Time_t     wake() { return m_wakeTime; }
+
+   private:
+      Time_t            m_wakeTime;
+};
+
+EXTERN VOID       addTombstone(Tombstone *pTomb);
+EXTERN Tombstone* findTombstone(GtpTeid_t teid);
+EXTERN Tombstone* findTombstone(Scenario *pScn, GtpImsiKey imsiKey);
+EXTERN VOID       procTombstoneMsg(Tombstone *pTomb, UdpData_t *data);
+
+#endif
@@ -0,0 +1,181 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "gtp_types.hpp"
+#include "sim_cfg.hpp"
+#include "latency.hpp"
+#include "trace.hpp"
+
+static TraceRec_t    *s_pRing      = NULL;
+static U64           s_numEvents   = 0;
+static U32           s_sample      = 0;
+static U32           s_numSessions = 0;
+static U32           s_numTraced   = 0;
+
+static const S8 *s_traceEventNames[TRACE_MAX] =
+{
+   "created",
+   "step",
+   "request sent",
+   "retransmit",
+   "request received",
+   "response sent",
+   "response received",
+   "completed",
+   "deleted"
+};
+
+PUBLIC VOID initTrace()
+{
+   s_sample = Config::getInstance()->getTraceSample();
+   if (0 != s_sample)
+   {
+      s_pRing = new TraceRec_t[TRACE_RING_SIZE];
+   }
+}
+
+PUBLIC U32 traceSampleSession()
+{
+   if (NULL == s_pRing || 0 != (s_numSessions++ % s_sample))
+   {
+      return 0;
+   }
+
+   return ++s_numTraced;
+}
+
+PUBLIC VOID traceEvent(U32 traceId, TraceEvent_t type, const S8 *pName,
+      U32 arg)
+{
+   TraceRec_t *pRec = &s_pRing[s_numEvents++ & (TRACE_RING_SIZE - 1)];
+
+   pRec->timeNs  = getWallNanoSeconds();
+   pRec->pName   = pName;
+   pRec->traceId = traceId;
+   pRec->arg     = arg;
+   pRec->type    = type;
+}
+
+PRIVATE VOID writeTraceRec(FILE *fp, const S8 *pPh, const S8 *pName,
+      const TraceRec_t *pRec, U64 baseNs, BOOL *pFirst)
+{
+   fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,"
+         "\"pid\":%d,\"tid\":%u", *pFirst ? "" : ",", pName, pPh,
+         (pRec->timeNs - baseNs) / 1000.0, getpid(), pRec->traceId);
+   if ('i' == pPh[0])
+   {
+      fprintf(fp, ",\"s\":\"t\",\"args\":{\"msg\":\"%s\",\"arg\":%u}",
+            pRec->pName ? pRec->pName : "", pRec->arg);
+   }
+   fprintf(fp, "}");
+   *pFirst = FALSE;
+}
+
+PUBLIC VOID writeTrace()
+{
+   LOG_ENTERFN();
+
+   if (NULL == s_pRing)
+   {
+      LOG_EXITVOID();
+   }
+
+   string fileName = Config::getInstance()->getTraceFile();
+   FILE   *fp = fopen(fileName.c_str(), "w");
+   if (NULL == fp)
+   {
+      LOG_ERROR("Opening trace file [%s]", fileName.c_str());
+      LOG_EXITVOID();
+   }
+
+   /* older events are overwritten once the ring is full, the spans of a
+    * session whose start is lost are not closed
+    */
+   U64 first = (s_numEvents > TRACE_RING_SIZE) ?
+      s_numEvents - TRACE_RING_SIZE : 0;
+   U64 baseNs = (first < s_numEvents) ?
+      s_pRing[first & (TRACE_RING_SIZE - 1)].timeNs : 0;
+   std::unordered_map<U32, U32> spans;
+   BOOL isFirst = TRUE;
+
+   fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+   for (U64 i = first; i < s_numEvents; i++)
+   {
+      const TraceRec_t *pRec = &s_pRing[i & (TRACE_RING_SIZE - 1)];
+      const S8 *pName = s_traceEventNames[pRec->type];
+
+      switch (pRec->type)
+      {
+         case TRACE_SSN_CREATED:
+            fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+                  "\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"session %u\"}}",
+                  isFirst ? "" : ",", getpid(), pRec->traceId, pRec->arg);
+            isFirst = FALSE;
+            writeTraceRec(fp, "B", "session", pRec, baseNs, &isFirst);
+            spans[pRec->traceId] = 1;
+            break;
+         case TRACE_STEP:
+            if (0 == spans.count(pRec->traceId))
+            {
+               /* the start of the session is overwritten */
+               break;
+            }
+
+            if (spans[pRec->traceId] > 1)
+            {
+               writeTraceRec(fp, "E", "step", pRec, baseNs, &isFirst);
+               spans[pRec->traceId]--;
+            }
+            writeTraceRec(fp, "B", pRec->pName ? pRec->pName : pName, pRec,
+                  baseNs, &isFirst);
+            spans[pRec->traceId]++;
+            break;
+         case TRACE_SSN_END:
+            if (spans.count(pRec->traceId))
+            {
+               for (U32 j = spans[pRec->traceId]; j > 0; j--)
+               {
+                  writeTraceRec(fp, "E", "session", pRec, baseNs, &isFirst);
+               }
+               spans.erase(pRec->traceId);
+            }
+            break;
+         default:
+            writeTraceRec(fp, "i", pName, pRec, baseNs, &isFirst);
+            break;
+      }
+   }
+   fprintf(fp, "\n]}\n");
+   fclose(fp);
+
+   LOG_INFO("Trace of [%u] sessions written to [%s]", s_numTraced,
+         fileName.c_str());
+
+   delete[] s_pRing;
+   s_pRing = NULL;
+
+   LOG_EXITVOID();
+}
@@ -0,0 +1,82 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACE_HPP_
+#define _TRACE_HPP_
+
+#define TRACE_RING_SIZE          (1 << 16)   /* events, a power of two */
+
+typedef enum
+{
+   TRACE_SSN_CREATED,
+   TRACE_STEP,          /* procedure step started */
+   TRACE_REQ_SENT,
+   TRACE_RETRANS,
+   TRACE_REQ_RCVD,
+   TRACE_RSP_SENT,
+   TRACE_RSP_RCVD,
+   TRACE_SSN_DONE,      /* scenario completed */
+   TRACE_SSN_END,       /* session deleted */
+   TRACE_MAX
+} TraceEvent_t;
+
+typedef struct
+{
+   U64               timeNs;       /* CLOCK_REALTIME */
+   const S8          *pName;       /* message or step, NULL if none */
+   U32               traceId;
+   U32               arg;          /* session id, retry count or cause */
+   U8                type;
+} TraceRec_t;
+
+/**
+ * @brief
+ *    Records an event of a sampled session, sessions not sampled have
+ *    trace id 0 and cost a compare
+ */
+#define GSIM_TRACE(_id, _type, _pName, _arg)                               \
+   do                                                                      \
+   {                                                                       \
+      if (0 != (_id))                                                      \
+      {                                                                    \
+         traceEvent((_id), (_type), (_pName), (_arg));                     \
+      }                                                                    \
+   } while (0)
+
+/**
+ * @brief
+ *    Allocates the ring of trace events when --trace-sample is set
+ */
+PUBLIC VOID initTrace();
+
+/**
+ * @return
+ *    trace id of a new session, 0 unless it is the n'th session
+ */
+PUBLIC U32 traceSampleSession();
+
+PUBLIC VOID traceEvent(U32 traceId, TraceEvent_t type, const S8 *pName,
+      U32 arg);
+
+/**
+ * @brief
+ *    Writes the events in the ring as Chrome trace JSON, each sampled
+ *    session is a thread with a span for the session and for each of its
+ *    procedure steps
+ */
+PUBLIC VOID writeTrace();
+
+#endif
@@ -16,6 +16,8 @@
 
 #include <list>
 #include <map>
+#include <deque>
+#include <unordered_map>
 #include <vector>
 
 #include "types.hpp"
@@ -33,21 +35,47 @@
 #include "gtp_msg.hpp"
 #include "procedure.hpp"
 #include "gtp_stats.hpp"
+#include "scenario.hpp"
 #include "tunnel.hpp"
 #include "session.hpp"
+#include "tombstone.hpp"
 #include "gtp_peer.hpp"
+#include "overload.hpp"
 #include "display.hpp"
 #include "traffic.hpp"
+#include "replay.hpp"
+#include "latency.hpp"
+#include "drain.hpp"
 
 EXTERN BOOL g_serverMode;
 
-TrafficTask::TrafficTask()
+static TrafficTask *s_pTrafficTask = NULL;
+
+PUBLIC TrafficTask *getTrafficTask()
+{
+   return s_pTrafficTask;
+}
+
+TrafficTask::TrafficTask(Scenario *pScn)
 {
+   m_pScn = pScn;
+   m_numCreated = 0;
    m_ratePeriod = Config::getInstance()->getSessionRatePeriod();
    m_rate = Config::getInstance()->getCallRate();
    m_maxSessions = Config::getInstance()->getNumSessions();
    string imsi = Config::getInstance()->getImsi();
    m_imsiGen.init(imsi);
+
+   IPEndPoint peer;
+   peer.ipAddr = Config::getInstance()->getRemoteIpAddr();
+   peer.port   = Config::getInstance()->getRemoteGtpcPort();
+   m_pPeer = addPeerData(peer);
+   m_ignoreOverload = Config::getInstance()->getIgnoreOverload();
+   m_numThrottled = 0;
+   m_winStart = getMilliSeconds();
+   m_winCreated = 0;
+   m_effRate = 0;
+   s_pTrafficTask = this;
 }
 
 RETVAL TrafficTask::run(VOID *arg)
@@ -57,18 +85,42 @@ RETVAL TrafficTask::run(VOID *arg)
    BOOL     abortTraffiTask = FALSE;
    LOG_DEBUG("Running TrafficTask, Session Rate [%d]", m_rate);
 
+   /* no new sessions while the established ones are torn down */
+   if (isDraining())
+   {
+      LOG_INFO("Stopping Traffic, draining sessions");
+      stop();
+      LOG_EXITFN(ROK);
+   }
+
    Time_t currTime = getMilliSeconds();
    m_lastRunTime = currTime;
-   Counter numSession = Stats::getStats(GSIM_STAT_NUM_SESSIONS_CREATED);
+   if (currTime >= m_winStart + TRAFFIC_RATE_WINDOW)
+   {
+      m_effRate = (m_winCreated * 1000) / (currTime - m_winStart);
+      m_winStart = currTime;
+      m_winCreated = 0;
+   }
+
    for (U32 i = 0; i < m_rate; i++)
    {
+      /* the sessions of the slot rejected by the peer overload reduction
+       * are not started, they are not made up later
+       */
+      if (!m_ignoreOverload && !admitSession(m_pPeer))
+      {
+         m_numThrottled++;
+         continue;
+      }
+
       GtpImsiKey imsiKey;
       MEMSET(&imsiKey, 0, sizeof(GtpImsiKey));
       m_imsiGen.allocNew(&imsiKey);
 
-      UeSession::createUeSession(imsiKey);
-      numSession++;
-      if ((0 != m_maxSessions) && (numSession >= m_maxSessions))
+      UeSession::createUeSession(m_pScn, imsiKey);
+      m_numCreated++;
+      m_winCreated++;
+      if ((0 != m_maxSessions) && (m_numCreated >= m_maxSessions))
       {
          LOG_DEBUG("Max Sessions = [%d] Created, Stopping Traffic",\
                m_maxSessions);
@@ -93,10 +145,40 @@ RETVAL TrafficTask::run(VOID *arg)
 }
 
 PUBLIC VOID procGtpcMsg(UdpData_t *data)
+{
+   /* time the message waited since the kernel received it */
+   if (0 != data->timeNs)
+   {
+      U64 now = getWallNanoSeconds();
+      if (now > data->timeNs)
+      {
+         getQueueDelayHist()->record(now - data->timeNs);
+      }
+   }
+
+   if (NULL != getReplayTask())
+   {
+      getReplayTask()->procGtpcMsg(data);
+      return;
+   }
+
+   procGtpcMsg(data, Scenario::getInstance());
+}
+
+/**
+ * @brief
+ *    Dispatches a received GTP-C message to its UE session. Initial
+ *    requests create a new session executing the scenario pScn
+ *
+ * @param data
+ * @param pScn
+ */
+PUBLIC VOID procGtpcMsg(UdpData_t *data, Scenario *pScn)
 {
    LOG_ENTERFN();
 
    UeSession      *ueSsn     = NULL;
+   Tombstone      *pTomb     = NULL;
    U8             *gtpMsgBuf = NULL;
    GtpMsgType_t   msgType    = GTPC_MSG_TYPE_INVALID;
    
@@ -111,21 +193,55 @@ PUBLIC VOID procGtpcMsg(UdpData_t *data)
       GTP_GET_IE_LEN(imsiBuf, imsiKey.len);
       MEMCPY(imsiKey.val, imsiBuf + GTP_IE_HDR_LEN, imsiKey.len);
 
-      ueSsn = UeSession::getUeSession(imsiKey);
+      ueSsn = UeSession::getUeSession(pScn, imsiKey);
       if (NULL == ueSsn)
+      {
+         pTomb = findTombstone(pScn, imsiKey);
+      }
+
+      if (NULL == ueSsn && NULL == pTomb)
       {
          addPeerData(data->peerEp); 
-         ueSsn = UeSession::createUeSession(imsiKey);
+         ueSsn = UeSession::createUeSession(pScn, imsiKey);
+      }
+      else if (NULL != pTomb)
+      {
+         procTombstoneMsg(pTomb, data);
       }
    }
    else
    {
       GtpTeid_t teid = 0;
       GTP_MSG_DEC_TEID(gtpMsgBuf, teid);
-      if (0 != teid)
+
+      /* responses are matched to the outstanding request by sequence
+       * number first, independent of the TEID in the header
+       */
+      if (GTP_MSG_CAT_RSP == gtpGetMsgCategory(msgType))
+      {
+         GtpSeqNumber_t seqNumber = 0;
+         GTP_MSG_GET_SEQN(gtpMsgBuf, seqNumber);
+         ueSsn = findPeerTrans(&data->peerEp, seqNumber);
+      }
+
+      if (NULL != ueSsn)
+      {
+         ueSsn->resumeTask();
+      }
+      else if (0 != teid)
       {
          ueSsn = UeSession::getUeSession(teid);
          if (NULL == ueSsn)
+         {
+            pTomb = findTombstone(teid);
+         }
+
+         if (NULL != pTomb)
+         {
+            /* message for a session whose scenario is already complete */
+            procTombstoneMsg(pTomb, data);
+         }
+         else if (NULL == ueSsn)
          {
             LOG_ERROR("GTPC Message received with unknown TEID [%d]", teid);
             delete data;
@@ -171,6 +287,22 @@ VOID GtpImsiGenerator::init(string imsi)
    }
 }
 
+/**
+ * @brief
+ *    Copies the digits of the last imsi without allocating memory, at most
+ *    size digits
+ *
+ * @return
+ *    number of digits copied
+ */
+U32 GtpImsiGenerator::copy(S8 *pDst, U32 size)
+{
+   U32 len = (m_len < size) ? m_len : size;
+
+   MEMCPY(pDst, m_imsiStr, len);
+   return len;
+}
+
 /**
  * @brief
  *    allocates a new imsi incremented by one
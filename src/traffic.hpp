@@ -17,12 +17,18 @@
 #ifndef __TRAFFIC_TASK__
 #define __TRAFFIC_TASK__
 
+class Scenario;
+
+#define TRAFFIC_RATE_WINDOW      1000  /* ms, effective session rate */
+
 class GtpImsiGenerator
 {
    public:
       GtpImsiGenerator();
       VOID allocNew(GtpImsiKey*);
       VOID init(string imsi);
+      string str() {return string(m_imsiStr, m_len);}
+      U32 copy(S8 *pDst, U32 size);
 
    private:
       S8    m_imsiStr[GTP_IMSI_MAX_DIGITS];
@@ -33,18 +39,31 @@ class GtpImsiGenerator
 class TrafficTask: public Task
 {
    public:
-      TrafficTask();
+      TrafficTask(Scenario *pScn);
       ~TrafficTask() {}
       RETVAL run(VOID *arg = NULL);  
       inline Time_t wake() {return m_wakeTime;}
+      U32 lastImsi(S8 *pDst, U32 size) {return m_imsiGen.copy(pDst, size);}
+      U32 configuredRate() {return (m_rate * 1000) / m_ratePeriod;}
+      U32 effectiveRate() {return m_effRate;}
+      Counter numThrottled() {return m_numThrottled;}
+      PeerData *peer() {return m_pPeer;}
 
    private:
+      Scenario          *m_pScn;
+      Counter           m_numCreated;
       U32               m_rate;
       Time_t            m_ratePeriod;   
       Time_t            m_lastRunTime;
       Counter           m_maxSessions;
       GtpImsiGenerator  m_imsiGen;
       Time_t            m_wakeTime;
+      PeerData          *m_pPeer;
+      BOOL              m_ignoreOverload;
+      Counter           m_numThrottled;   /* starts rejected on overload */
+      Time_t            m_winStart;       /* start of the rate window */
+      Counter           m_winCreated;     /* sessions created in window */
+      U32               m_effRate;        /* sessions/s of the last window */
 };
 
 /* task for sending periodic echo request messages to the peer */
@@ -60,4 +79,6 @@ class GtpcEcho: public Task
 };
 
 PUBLIC VOID procGtpcMsg(UdpData_t *data);
+PUBLIC TrafficTask *getTrafficTask();
+PUBLIC VOID procGtpcMsg(UdpData_t *data, Scenario *pScn);
 #endif
@@ -0,0 +1,424 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <list>
+#include <vector>
+
+#include "types.hpp"
+#include "macros.hpp"
+#include "logger.hpp"
+#include "error.hpp"
+#include "keyboard.hpp"
+#include "task.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "sim_cfg.hpp"
+#include "latency.hpp"
+#include "transport.hpp"
+#include "socket.hpp"
+#include "uring.hpp"
+#include "packet.hpp"
+#include "affinity.hpp"
+
+/******************* Function Declarations ***********************************/
+EXTERN VOID procGtpcMsg(UdpData_t *data);
+PRIVATE VOID handleStdin();
+PRIVATE U32 handleTransport();
+PRIVATE VOID flushSendBatch();
+/******************* Function Declarations ***********************************/
+
+static Transport *s_pTransport = NULL;
+static S32        s_stdinFd    = -1;
+static UdpData_t *s_recvMsgs[TRANS_MAX_BATCH];
+static BOOL       s_rxCpuChecked = FALSE;
+static U64        s_numMsgs      = 0;
+
+/* messages queued by sendMsg() in a send batch, the destinations are copied
+ * as the sender may free them before the batch is flushed
+ */
+static TransMsg_t s_sendMsgs[TRANS_MAX_BATCH];
+static IPEndPoint s_sendDsts[TRANS_MAX_BATCH];
+static U64        *s_pSentNs[TRANS_MAX_BATCH];
+static U32        s_numQueued    = 0;
+static U32        s_batchDepth   = 0;
+
+/**
+ * @brief
+ *    Creates the transport selected in the configuration
+ */
+PRIVATE Transport *newTransport(Config *pCfg)
+{
+    if ("io_uring" == pCfg->getTransportType())
+    {
+        return new UringTransport(pCfg->getSqPollIdle());
+    }
+    else if ("packet" == pCfg->getTransportType())
+    {
+        return new PacketTransport(pCfg->getPacketIf(), pCfg->getPeerMac());
+    }
+
+    return new UdpTransport();
+}
+
+PUBLIC VOID setTransport(Transport *pTrans)
+{
+    s_pTransport = pTrans;
+}
+
+PUBLIC Transport *getTransport()
+{
+    return s_pTransport;
+}
+
+/**
+ * @brief
+ *    Opens the connections of the installed transport. When none is
+ *    installed the configured transport is created, falling back to the
+ *    UDP transport if it can not be initialized
+ */
+PUBLIC RETVAL initTransport()
+{
+    LOG_ENTERFN();
+
+    if (NULL == s_pTransport)
+    {
+        Config *pCfg = Config::getInstance();
+        if ("udp" != pCfg->getTransportType())
+        {
+            s_pTransport = newTransport(pCfg);
+            if (ROK == s_pTransport->init())
+            {
+                LOG_EXITFN(ROK);
+            }
+
+            LOG_ERROR("%s transport unavailable, using udp",
+                s_pTransport->name());
+            delete s_pTransport;
+        }
+
+        s_pTransport = new UdpTransport();
+    }
+
+    RETVAL ret = s_pTransport->init();
+    if (ROK != ret)
+    {
+        LOG_FATAL("Initializing [%s] transport", s_pTransport->name());
+    }
+
+    LOG_EXITFN(ret);
+}
+
+PUBLIC VOID closeTransport()
+{
+    flushSendBatch();
+    s_batchDepth = 0;
+    delete s_pTransport;
+    s_pTransport = NULL;
+}
+
+/**
+ * @brief
+ *    Adds stdin to the descriptors polled for keyboard events from the user
+ */
+PUBLIC RETVAL setupStdinSock()
+{
+    LOG_ENTERFN();
+
+    s_stdinFd = fileno(stdin);
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Sends a message, or queues it while a send batch is open. A message
+ *    which the transport fails to send is counted in
+ *    GSIM_STAT_NUM_SEND_FAILED, a queued one when the batch is flushed
+ *
+ * @param connId
+ * @param pDst
+ * @param pBuf
+ *    owned by the transport from here on
+ * @param pSentNs
+ *    if not NULL, set to the wall clock time the message is handed to the
+ *    transport. A queued message sets it when the batch is flushed, it must
+ *    remain valid until then
+ *
+ * @return
+ *    ERR_SYS_SOCK_SEND if a message sent right away fails
+ */
+PUBLIC RETVAL sendMsg
+(
+TransConnId          connId,
+IPEndPoint           *pDst,
+Buffer               *pBuf,
+U64                  *pSentNs
+)
+{
+    LOG_ENTERFN();
+
+    if (0 != s_batchDepth)
+    {
+        s_pSentNs[s_numQueued]           = pSentNs;
+        s_sendDsts[s_numQueued]          = *pDst;
+        s_sendMsgs[s_numQueued].connId   = connId;
+        s_sendMsgs[s_numQueued].pDst     = &s_sendDsts[s_numQueued];
+        s_sendMsgs[s_numQueued].pBuf     = pBuf;
+        if (TRANS_MAX_BATCH == ++s_numQueued)
+        {
+            flushSendBatch();
+        }
+
+        LOG_EXITFN(ROK);
+    }
+
+    TransMsg_t msg;
+    msg.connId = connId;
+    msg.pDst   = pDst;
+    msg.pBuf   = pBuf;
+
+    if (NULL != pSentNs)
+    {
+        *pSentNs = getWallNanoSeconds();
+    }
+
+    if (1 != s_pTransport->send(&msg, 1))
+    {
+        Stats::incStats(GSIM_STAT_NUM_SEND_FAILED);
+        LOG_EXITFN(ERR_SYS_SOCK_SEND);
+    }
+
+    s_numMsgs++;
+    LOG_EXITFN(ROK);
+}
+
+PUBLIC VOID beginSendBatch()
+{
+    s_batchDepth++;
+}
+
+PUBLIC VOID endSendBatch()
+{
+    if (0 != s_batchDepth && 0 == --s_batchDepth)
+    {
+        flushSendBatch();
+    }
+}
+
+/**
+ * @brief
+ *    Hands the queued messages to the transport, a transport without
+ *    TRANS_CAP_BATCH_SEND sends them one by one inside send()
+ */
+PRIVATE VOID flushSendBatch()
+{
+    if (0 == s_numQueued)
+    {
+        return;
+    }
+
+    U64 now = getWallNanoSeconds();
+    for (U32 i = 0; i < s_numQueued; i++)
+    {
+        if (NULL != s_pSentNs[i])
+        {
+            *s_pSentNs[i] = now;
+        }
+    }
+
+    U32 numSent = s_pTransport->send(s_sendMsgs, s_numQueued);
+    if (numSent != s_numQueued)
+    {
+        LOG_ERROR("Sent [%u] of [%u] batched messages", numSent, s_numQueued);
+        for (U32 i = numSent; i < s_numQueued; i++)
+        {
+            Stats::incStats(GSIM_STAT_NUM_SEND_FAILED);
+        }
+    }
+
+    s_numMsgs += numSent;
+    s_numQueued = 0;
+}
+
+/**
+ * @brief
+ *    Waits at most wait milliseconds for keyboard events or GTP messages and
+ *    processes them. A transport without a ready fd is read on every call
+ *    without waiting
+ *
+ * @param wait
+ *
+ * @return number of GTP messages received
+ */
+PUBLIC U32 socketPoll(S32 wait)
+{
+    GSimPollFd pollFds[2];
+    U32        numFds    = 0;
+    S32        stdinIndx = -1;
+    S32        transIndx = -1;
+    S32        transFd   = s_pTransport->readyFd();
+
+    if (s_stdinFd >= 0)
+    {
+        stdinIndx                  = numFds++;
+        pollFds[stdinIndx].fd      = s_stdinFd;
+        pollFds[stdinIndx].events  = POLLIN;
+        pollFds[stdinIndx].revents = 0;
+    }
+
+    if (transFd >= 0)
+    {
+        transIndx                  = numFds++;
+        pollFds[transIndx].fd      = transFd;
+        pollFds[transIndx].events  = POLLIN;
+        pollFds[transIndx].revents = 0;
+    }
+    else
+    {
+        wait = 0;
+    }
+
+    S32 rs = poll(pollFds, numFds, wait);
+    if (rs < 0)
+    {
+        if (errno != EINTR)
+        {
+            LOG_ERROR("poll() error, [%s]", strerror(errno));
+        }
+
+        return 0;
+    }
+
+    if (stdinIndx >= 0 && pollFds[stdinIndx].revents)
+    {
+        LOG_DEBUG("Reading Keyboard Event");
+        handleStdin();
+    }
+
+    if (transIndx < 0 || GSIM_CHK_MASK(pollFds[transIndx].revents, POLLIN))
+    {
+        return handleTransport();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief
+ *    Reads the transport without waiting for it to poll readable, the
+ *    keyboard is checked once every GSIM_SPIN_STDIN_INTVL calls
+ *
+ * @return number of GTP messages received
+ */
+PUBLIC U32 spinPoll()
+{
+    static U32 numSpins = 0;
+
+    if (s_stdinFd >= 0 && 0 == (++numSpins % GSIM_SPIN_STDIN_INTVL))
+    {
+        GSimPollFd pollFd;
+        pollFd.fd      = s_stdinFd;
+        pollFd.events  = POLLIN;
+        pollFd.revents = 0;
+        if (poll(&pollFd, 1, 0) > 0)
+        {
+            handleStdin();
+        }
+    }
+
+    return handleTransport();
+}
+
+/**
+ * @brief
+ *    Number of GTP messages sent and received
+ */
+PUBLIC U64 getNumTransMsgs()
+{
+    return s_numMsgs;
+}
+
+/**
+ * @brief
+ *    Handles keyboard event
+ */
+PRIVATE VOID handleStdin()
+{
+    LOG_ENTERFN();
+
+    S32 input = getchar();
+    if (input == EOF)
+    {
+        /* stdin is closed, stop polling it */
+        s_stdinFd = -1;
+    }
+    else
+    {
+        Keyboard::getInstance()->processKey(input);
+    }
+
+    LOG_EXITVOID();
+}
+
+/**
+ * @brief
+ *    Reads the GTP-C messages available in the transport, in batches, and
+ *    processes them
+ *
+ * @return number of messages received
+ */
+PRIVATE U32 handleTransport()
+{
+    LOG_ENTERFN();
+
+    U32 numRecvd = 0;
+    while (numRecvd < GSIM_MAX_RECV_LOOPS)
+    {
+        /* the responses to a received batch leave in one send batch */
+        U32 cnt = s_pTransport->recv(s_recvMsgs, TRANS_MAX_BATCH);
+        beginSendBatch();
+        for (U32 i = 0; i < cnt; i++)
+        {
+            procGtpcMsg(s_recvMsgs[i]);
+        }
+        endSendBatch();
+
+        numRecvd += cnt;
+        if (cnt < TRANS_MAX_BATCH)
+        {
+            break;
+        }
+    }
+
+    /* the receive CPU is known once the first packet is received */
+    if (numRecvd > 0 && !s_rxCpuChecked)
+    {
+        s_rxCpuChecked = TRUE;
+        checkRxCpu(s_pTransport->rxCpu());
+    }
+
+    s_numMsgs += numRecvd;
+    LOG_EXITFN(numRecvd);
+}
@@ -17,17 +17,129 @@
 #ifndef _TRANSPORT_HPP_
 #define _TRANSPORT_HPP_
 
+/* Initial requests are sent over connection 0 and the peer initiated
+ * requests are received over connection 1, every transport has to open
+ * these two connections in init()
+ */
+#define TRANS_CONN_ID_SEND       0
+#define TRANS_CONN_ID_LISTEN     1
+
+#define TRANS_MAX_BATCH          64
+#define GSIM_SPIN_STDIN_INTVL    1024
+
+typedef enum
+{
+   TRANS_CAP_BATCH_SEND = (1 << 0), /**< send() of n messages is one call */
+   TRANS_CAP_BATCH_RECV = (1 << 1), /**< recv() of n messages is one call */
+   TRANS_CAP_READY_FD   = (1 << 2)  /**< readyFd() can be polled */
+} TransCap_t;
+
+typedef struct
+{
+   TransConnId    connId;
+   IPEndPoint     *pDst;
+   Buffer         *pBuf;
+} TransMsg_t;
+
+/**
+ * @brief
+ *    Datagram transport carrying the GTP messages of the UE sessions. The
+ *    sessions only know the connection ids, so the UDP sockets, an in-memory
+ *    channel or any other backend can be plugged in behind this interface
+ */
+class Transport
+{
+   public:
+      virtual ~Transport() {}
+
+      /**
+       * @brief
+       *    Opens the send and the listen connections
+       */
+      virtual RETVAL init() = 0;
+
+      /**
+       * @brief
+       *    Sends cnt messages. The transport owns the buffers of all the
+       *    messages passed in, sent or not
+       *
+       * @return
+       *    number of messages sent
+       */
+      virtual U32 send(TransMsg_t *pMsgs, U32 cnt) = 0;
+
+      /**
+       * @brief
+       *    Receives at most max messages without blocking, the caller owns
+       *    the messages returned
+       *
+       * @return
+       *    number of messages received
+       */
+      virtual U32 recv(UdpData_t **ppMsgs, U32 max) = 0;
+
+      /**
+       * @brief
+       *    File descriptor which polls readable when recv() has messages to
+       *    return, -1 if the transport has to be read on every poll
+       */
+      virtual S32 readyFd() = 0;
+
+      virtual U32 capabilities() = 0;
+      virtual const S8 *name() = 0;
+
+      /**
+       * @brief
+       *    CPU which processed the last received packet in the kernel, -1
+       *    when it is not known
+       */
+      virtual S32 rxCpu() { return -1; }
+
+      /**
+       * @brief
+       *    Enables busy polling of the device queues for usec microseconds
+       *    when the connections are read
+       */
+      virtual RETVAL setBusyPoll(U32) { return RFAILED; }
+};
+
+/**
+ * @brief
+ *    Installs the transport used by sendMsg() and socketPoll(), must be
+ *    called before initTransport() to replace the default UDP transport
+ */
+EXTERN VOID setTransport(Transport *pTrans);
+
+EXTERN Transport *getTransport();
+
 EXTERN RETVAL initTransport();
 
+EXTERN VOID closeTransport();
+
 EXTERN RETVAL setupStdinSock();
 
 EXTERN RETVAL sendMsg
 (
 TransConnId          connId,
 IPEndPoint           *pDst,
-Buffer               *pBuf
+Buffer               *pBuf,
+U64                  *pSentNs = NULL
 );
 
-EXTERN VOID socketPoll(S32 wait);
+/**
+ * @brief
+ *    Starts queueing the messages of sendMsg(), the queue is handed to the
+ *    transport in one send() when it is full or the outermost batch ends.
+ *    Batches nest
+ */
+EXTERN VOID beginSendBatch();
+
+EXTERN VOID endSendBatch();
+
+EXTERN U32 socketPoll(S32 wait);
+
+EXTERN U32 spinPoll();
+
+EXTERN U64 getNumTransMsgs();
 
 #endif
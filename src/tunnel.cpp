@@ -24,6 +24,7 @@
 #include "gtp_types.hpp"
 #include "sim_cfg.hpp"
 #include "tunnel.hpp"
+#include "mempool.hpp"
 
 static TunMap        s_gtpcTunMap;
 static U32           s_cTeid = 0;
@@ -42,6 +43,33 @@ PRIVATE U32 generateUTeid()
    return ++s_uTeid;
 }
 
+/**
+ * @brief
+ *    TEIDs are allocated after base, cluster agents get disjoint bases
+ */
+PUBLIC VOID setTeidBase(U32 base)
+{
+   s_cTeid = base;
+   s_uTeid = base;
+}
+
+PUBLIC VOID getTeidCounters(U32 *pCTeid, U32 *pUTeid)
+{
+   *pCTeid = s_cTeid;
+   *pUTeid = s_uTeid;
+}
+
+/**
+ * @brief
+ *    Restored sessions keep their TEIDs, new allocations continue after
+ *    the checkpointed counters
+ */
+PUBLIC VOID setTeidCounters(U32 cTeid, U32 uTeid)
+{
+   s_cTeid = cTeid;
+   s_uTeid = uTeid;
+}
+
 PUBLIC VOID deleteCTun(GtpcTun *pTun)
 {
    LOG_ENTERFN();
@@ -57,9 +85,13 @@ PUBLIC VOID deleteCTun(GtpcTun *pTun)
    LOG_EXITVOID();
 }
 
-GtpcTun::GtpcTun()
+GtpcTun::GtpcTun() : GtpcTun(generateCTeid())
 {
-   m_locTeid = generateCTeid();
+}
+
+GtpcTun::GtpcTun(GtpTeid_t locTeid)
+{
+   m_locTeid = locTeid;
    m_remTeid = 0;
    m_refCount = 1;
    m_localEp.port = Config::getInstance()->getLocalGtpcPort();
@@ -69,6 +101,16 @@ GtpcTun::GtpcTun()
    LOG_DEBUG("Creating GTP-C Tunnel, TEID [%d]", m_locTeid);
 }
 
+VOID *GtpcTun::operator new(size_t size)
+{
+   return memPoolAlloc(MEM_POOL_TUNNEL, size);
+}
+
+VOID GtpcTun::operator delete(VOID *p)
+{
+   memPoolFree(MEM_POOL_TUNNEL, p);
+}
+
 PUBLIC GtpcTun* findCTun(GtpTeid_t teid)
 {
    GtpcTun     *pTun = NULL;
@@ -83,11 +125,30 @@ PUBLIC GtpcTun* findCTun(GtpTeid_t teid)
    LOG_EXITFN(pTun);
 }
 
-GtpuTun::GtpuTun()
+GtpuTun::GtpuTun() : GtpuTun(generateUTeid())
+{
+}
+
+GtpuTun::GtpuTun(GtpTeid_t locTeid)
 {
-   m_locTeid = generateUTeid();
+   m_locTeid = locTeid;
    m_remTeid = 0;
    LOG_TRACE("GTP-U Tunnel Constructor, TEID [%d]", m_locTeid);
 }
 
+/**
+ * @brief
+ *    GTP-U tunnels share the pool of the larger GTP-C tunnels, the pool
+ *    object size is fixed by its first allocation
+ */
+VOID *GtpuTun::operator new(size_t size)
+{
+   return memPoolAlloc(MEM_POOL_TUNNEL, sizeof(GtpcTun));
+}
+
+VOID GtpuTun::operator delete(VOID *p)
+{
+   memPoolFree(MEM_POOL_TUNNEL, p);
+}
+
 
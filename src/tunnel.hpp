@@ -24,6 +24,10 @@ class GtpcTun
 {
    public:
       GtpcTun();
+      GtpcTun(GtpTeid_t locTeid);
+
+      static VOID *operator new(size_t size);
+      static VOID operator delete(VOID *p);
 
       GtpTeid_t   m_locTeid;
       GtpTeid_t   m_remTeid;
@@ -49,6 +53,11 @@ class GtpuTun
 
    public:
       GtpuTun();
+      GtpuTun(GtpTeid_t locTeid);
+
+      static VOID *operator new(size_t size);
+      static VOID operator delete(VOID *p);
+
       GtpTeid_t   localTeid() {return m_locTeid;}
       GtpTeid_t   remoteTeid() {return m_remTeid;}
 };
@@ -60,5 +69,8 @@ typedef TunMap::iterator               TunMapItr;
 EXTERN VOID       deleteCTun(GtpcTun *pTun);
 EXTERN GtpcTun*   findCTun(GtpTeid_t teid);
 PUBLIC GtpcTun*   createCTun(GtpcPdn *pPdn);
+EXTERN VOID       setTeidBase(U32 base);
+EXTERN VOID       getTeidCounters(U32 *pCTeid, U32 *pUTeid);
+EXTERN VOID       setTeidCounters(U32 cTeid, U32 uTeid);
 
 #endif
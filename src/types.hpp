@@ -110,6 +110,10 @@ typedef enum
    MSG_ACTION_MAX
 } MsgAction_t;
 
+/* message buffers are allocated from the buffer pool, see mempool.hpp */
+EXTERN U8   *bufAlloc(U32 len);
+EXTERN VOID bufFree(U8 *p);
+
 struct Buffer
 {
    U32      len;
@@ -120,13 +124,13 @@ struct Buffer
    Buffer(const Buffer &b)
    {
       len = b.len;
-      pVal = new U8[len];
+      pVal = bufAlloc(len);
       MEMCPY(pVal, b.pVal, len);
    }
 
    ~Buffer()
    {
-      delete []pVal;
+      bufFree(pVal);
    }
 };
 
@@ -135,13 +139,21 @@ struct UdpData_t
    Buffer         buf;
    TransConnId    connId;
    IPEndPoint     peerEp; 
+   U64            timeNs;  /* CLOCK_REALTIME of the kernel receive, or of
+                            * the send of a sent message, 0 if unknown
+                            */
+
+   UdpData_t()
+   {
+      timeNs = 0;
+   }
 };
 
 #define BUFFER_CPY(_buf, _src, _sz)                         \
 do                                                          \
 {                                                           \
    (_buf)->len = _sz;                                       \
-   (_buf)->pVal = new U8 [_sz];                             \
+   (_buf)->pVal = bufAlloc(_sz);                            \
    memcpy((VOID *)(_buf)->pVal, (const VOID *)(_src), _sz); \
 } while (0)
 
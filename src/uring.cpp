@@ -0,0 +1,783 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <vector>
+
+#ifdef GSIM_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+#include "types.hpp"
+#include "macros.hpp"
+#include "logger.hpp"
+#include "error.hpp"
+#include "gtp_types.hpp"
+#include "transport.hpp"
+#include "socket.hpp"
+#include "sim_cfg.hpp"
+#include "uring.hpp"
+
+/* user_data of the submissions, the lower 32 bits carry the connection id
+ * of a receive or the slot of a send
+ */
+#define URING_UD_RECV            (1ULL << 32)
+#define URING_UD_SEND            (2ULL << 32)
+#define URING_UD_TYPE_MASK       (0xffffffffULL << 32)
+#define URING_UD_INDEX_MASK      0xffffffffULL
+#define URING_SLOT_NONE          0xffffffff
+
+struct UringSendSlot
+{
+    struct msghdr           hdr;
+    struct iovec            iov;
+    struct sockaddr_storage addr;
+    Buffer *                pBuf;
+    U32                     nextFree;
+};
+
+UringTransport::UringTransport(U32 sqPollIdle)
+{
+    m_sqPollIdle  = sqPollIdle;
+    m_ringFd      = -1;
+    m_pSqRing     = MAP_FAILED;
+    m_sqRingSz    = 0;
+    m_pCqRing     = MAP_FAILED;
+    m_cqRingSz    = 0;
+    m_pSqHead     = NULL;
+    m_pSqTail     = NULL;
+    m_pSqFlags    = NULL;
+    m_pSqArray    = NULL;
+    m_sqMask      = 0;
+    m_sqEntries   = 0;
+    m_sqLocalTail = 0;
+    m_sqSubmitted = 0;
+    m_pSqes       = (struct io_uring_sqe *)MAP_FAILED;
+    m_pCqHead     = NULL;
+    m_pCqTail     = NULL;
+    m_cqMask      = 0;
+    m_pCqes       = NULL;
+    m_pBufRing    = (struct io_uring_buf_ring *)MAP_FAILED;
+    m_pRecvBufs   = NULL;
+    m_recvBufSz   = 0;
+    m_bufTail     = 0;
+    m_pSendSlots  = NULL;
+    m_freeSlot    = URING_SLOT_NONE;
+    m_numSocks    = 0;
+    m_rxHead      = 0;
+    for (U32 i = 0; i < GSIM_MAX_SOCK_CNT; i++)
+    {
+        m_socks[i]      = NULL;
+        m_recvArmed[i]  = FALSE;
+        m_recvFailed[i] = FALSE;
+    }
+}
+
+S32 UringTransport::readyFd()
+{
+    return m_ringFd;
+}
+
+U32 UringTransport::capabilities()
+{
+    return TRANS_CAP_BATCH_SEND | TRANS_CAP_BATCH_RECV | TRANS_CAP_READY_FD;
+}
+
+const S8 *UringTransport::name()
+{
+    return "io_uring";
+}
+
+RETVAL UringTransport::setBusyPoll(U32 usec)
+{
+    RETVAL ret = ROK;
+
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        if (ROK != m_socks[i]->setBusyPoll(usec))
+        {
+            ret = RFAILED;
+        }
+    }
+
+    return ret;
+}
+
+S32 UringTransport::rxCpu()
+{
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        S32 cpu = m_socks[i]->incomingCpu();
+        if (cpu >= 0)
+        {
+            return cpu;
+        }
+    }
+
+    return -1;
+}
+
+#ifdef GSIM_HAVE_IO_URING
+
+UringTransport::~UringTransport()
+{
+    /* the ring is closed first, so that the kernel no longer references the
+     * send slots and the receive buffers
+     */
+    if (m_ringFd >= 0)
+    {
+        close(m_ringFd);
+    }
+
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        delete m_socks[i];
+    }
+
+    if (NULL != m_pSendSlots)
+    {
+        for (U32 i = 0; i < URING_SEND_SLOTS; i++)
+        {
+            delete m_pSendSlots[i].pBuf;
+        }
+        delete[] m_pSendSlots;
+    }
+
+    for (U32 i = m_rxHead; i < m_rxQ.size(); i++)
+    {
+        delete m_rxQ[i];
+    }
+
+    if (MAP_FAILED != (VOID *)m_pBufRing)
+    {
+        munmap(m_pBufRing, URING_RECV_BUFS * sizeof(struct io_uring_buf));
+    }
+
+    delete[] m_pRecvBufs;
+
+    if (MAP_FAILED != (VOID *)m_pSqes)
+    {
+        munmap(m_pSqes, m_sqEntries * sizeof(struct io_uring_sqe));
+    }
+
+    if (MAP_FAILED != m_pCqRing && m_pCqRing != m_pSqRing)
+    {
+        munmap(m_pCqRing, m_cqRingSz);
+    }
+
+    if (MAP_FAILED != m_pSqRing)
+    {
+        munmap(m_pSqRing, m_sqRingSz);
+    }
+}
+
+/**
+ * @brief
+ *    Creates the io_uring instance and maps its queues
+ */
+RETVAL UringTransport::setupRing()
+{
+    LOG_ENTERFN();
+
+    struct io_uring_params params;
+    MEMSET(&params, 0, sizeof(params));
+    params.flags      = IORING_SETUP_CQSIZE;
+    params.cq_entries = URING_CQ_ENTRIES;
+    if (m_sqPollIdle)
+    {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = m_sqPollIdle;
+    }
+
+    m_ringFd = syscall(__NR_io_uring_setup, URING_SQ_ENTRIES, &params);
+    if (m_ringFd < 0)
+    {
+        LOG_ERROR("io_uring_setup() failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_sqRingSz = params.sq_off.array + params.sq_entries * sizeof(U32);
+    m_cqRingSz =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_sqRingSz = (m_sqRingSz > m_cqRingSz) ? m_sqRingSz : m_cqRingSz;
+        m_cqRingSz = m_sqRingSz;
+    }
+
+    m_pSqRing = mmap(NULL, m_sqRingSz, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    if (MAP_FAILED == m_pSqRing)
+    {
+        LOG_ERROR("io_uring SQ ring mmap() failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_pCqRing = m_pSqRing;
+    }
+    else
+    {
+        m_pCqRing = mmap(NULL, m_cqRingSz, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+        if (MAP_FAILED == m_pCqRing)
+        {
+            LOG_ERROR("io_uring CQ ring mmap() failed, [%s]", strerror(errno));
+            LOG_EXITFN(RFAILED);
+        }
+    }
+
+    m_sqEntries = params.sq_entries;
+    m_pSqes     = (struct io_uring_sqe *)mmap(NULL,
+        m_sqEntries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+    if (MAP_FAILED == (VOID *)m_pSqes)
+    {
+        LOG_ERROR("io_uring SQE mmap() failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    U8 *pSq    = (U8 *)m_pSqRing;
+    U8 *pCq    = (U8 *)m_pCqRing;
+    m_pSqHead  = (U32 *)(pSq + params.sq_off.head);
+    m_pSqTail  = (U32 *)(pSq + params.sq_off.tail);
+    m_pSqFlags = (U32 *)(pSq + params.sq_off.flags);
+    m_pSqArray = (U32 *)(pSq + params.sq_off.array);
+    m_sqMask   = *(U32 *)(pSq + params.sq_off.ring_mask);
+    m_pCqHead  = (U32 *)(pCq + params.cq_off.head);
+    m_pCqTail  = (U32 *)(pCq + params.cq_off.tail);
+    m_cqMask   = *(U32 *)(pCq + params.cq_off.ring_mask);
+    m_pCqes    = (struct io_uring_cqe *)(pCq + params.cq_off.cqes);
+
+    m_sqLocalTail = *m_pSqTail;
+    m_sqSubmitted = m_sqLocalTail;
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Registers the ring of buffers the multishot receives pick from. Each
+ *    buffer holds the recvmsg header, the source address and a datagram
+ */
+RETVAL UringTransport::setupBufRing()
+{
+    LOG_ENTERFN();
+
+    m_pBufRing = (struct io_uring_buf_ring *)mmap(NULL,
+        URING_RECV_BUFS * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == (VOID *)m_pBufRing)
+    {
+        LOG_ERROR("io_uring buffer ring mmap() failed, [%s]", strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    struct io_uring_buf_reg reg;
+    MEMSET(&reg, 0, sizeof(reg));
+    reg.ring_addr    = (U64)(unsigned long)m_pBufRing;
+    reg.ring_entries = URING_RECV_BUFS;
+    reg.bgid         = URING_BUF_GROUP;
+    if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_PBUF_RING,
+            &reg, 1) < 0)
+    {
+        LOG_ERROR("Registering io_uring buffer ring failed, [%s]",
+            strerror(errno));
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_recvBufSz = sizeof(struct io_uring_recvmsg_out) +
+                  sizeof(struct sockaddr_storage) + GSIM_RECV_CTRL_LEN +
+                  GSIM_UDP_READ_LEN;
+    m_pRecvBufs = new U8[URING_RECV_BUFS * m_recvBufSz];
+
+    /* the ring entries are indexed through a plain io_uring_buf pointer, in
+     * C++ the flexible array member of io_uring_buf_ring is not at offset 0
+     */
+    struct io_uring_buf *pBufs = (struct io_uring_buf *)m_pBufRing;
+    for (U32 i = 0; i < URING_RECV_BUFS; i++)
+    {
+        struct io_uring_buf *pBuf = &pBufs[i];
+        pBuf->addr = (U64)(unsigned long)(m_pRecvBufs + i * m_recvBufSz);
+        pBuf->len  = m_recvBufSz;
+        pBuf->bid  = i;
+    }
+
+    m_bufTail = URING_RECV_BUFS;
+    __atomic_store_n(&m_pBufRing->tail, m_bufTail, __ATOMIC_RELEASE);
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Checks that the kernel supports the operations the transport submits
+ */
+RETVAL UringTransport::probeOps()
+{
+    LOG_ENTERFN();
+
+    U32    len    = sizeof(struct io_uring_probe) +
+                    256 * sizeof(struct io_uring_probe_op);
+    U8     *pMem  = new U8[len];
+    RETVAL ret    = ROK;
+    MEMSET(pMem, 0, len);
+
+    struct io_uring_probe *pProbe = (struct io_uring_probe *)pMem;
+    if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_PROBE,
+            pProbe, 256) < 0)
+    {
+        LOG_ERROR("io_uring probe failed, [%s]", strerror(errno));
+        ret = RFAILED;
+    }
+    else
+    {
+        const U8 ops[] = {IORING_OP_RECVMSG, IORING_OP_SENDMSG};
+        for (U32 i = 0; i < sizeof(ops); i++)
+        {
+            if (ops[i] > pProbe->last_op ||
+                !(pProbe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED))
+            {
+                LOG_ERROR("io_uring operation [%u] not supported", ops[i]);
+                ret = RFAILED;
+            }
+        }
+    }
+
+    delete[] pMem;
+    LOG_EXITFN(ret);
+}
+
+/**
+ * @brief
+ *    Creates and binds a socket, the next connection id is assigned to it
+ */
+RETVAL UringTransport::addSocket(IPEndPoint ep)
+{
+    LOG_ENTERFN();
+
+    GSimSocket *pSock = NULL;
+    try
+    {
+        pSock = new GSimSocket(SOCK_TYPE_GTPC, ep, m_numSocks);
+    }
+    catch (ErrCodeEn &e)
+    {
+        LOG_EXITFN(e);
+    }
+
+    RETVAL ret = pSock->bindSocket();
+    if (ROK != ret)
+    {
+        delete pSock;
+        LOG_EXITFN(ret);
+    }
+
+    struct msghdr *pHdr = &m_recvHdrs[m_numSocks];
+    MEMSET(pHdr, 0, sizeof(struct msghdr));
+    pHdr->msg_namelen    = sizeof(struct sockaddr_storage);
+    pHdr->msg_controllen = GSIM_RECV_CTRL_LEN;
+
+    m_socks[m_numSocks++] = pSock;
+    LOG_EXITFN(ROK);
+}
+
+RETVAL UringTransport::init()
+{
+    LOG_ENTERFN();
+
+    RETVAL     ret = ROK;
+    IPEndPoint locListnerEp;
+    IPEndPoint locSenderEp;
+
+    Config *pCfg = Config::getInstance();
+
+    if (ROK != setupRing() || ROK != probeOps() || ROK != setupBufRing())
+    {
+        LOG_EXITFN(RFAILED);
+    }
+
+    m_pSendSlots = new UringSendSlot[URING_SEND_SLOTS];
+    for (U32 i = 0; i < URING_SEND_SLOTS; i++)
+    {
+        m_pSendSlots[i].pBuf     = NULL;
+        m_pSendSlots[i].nextFree = i + 1;
+    }
+    m_pSendSlots[URING_SEND_SLOTS - 1].nextFree = URING_SLOT_NONE;
+    m_freeSlot                                  = 0;
+
+    locSenderEp.port   = 0;
+    locSenderEp.ipAddr = *pCfg->getLocalIpAddr();
+    ret                = addSocket(locSenderEp);
+    if (ROK != ret)
+    {
+        LOG_FATAL("Binding to GTP local sending Socket");
+        LOG_EXITFN(ret);
+    }
+
+    locListnerEp.port   = pCfg->getLocalGtpcPort();
+    locListnerEp.ipAddr = *pCfg->getLocalIpAddr();
+    ret                 = addSocket(locListnerEp);
+    if (ROK != ret)
+    {
+        LOG_FATAL("Binding to GTP Listener Socket");
+        LOG_EXITFN(ret);
+    }
+
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        armRecv(i);
+    }
+    submit(FALSE);
+
+    /* kernels without multishot recvmsg fail the receive as soon as it is
+     * issued. Without SQPOLL it is issued by io_uring_enter(), with SQPOLL
+     * by the kernel thread, which is waited for to consume the entries
+     */
+    for (U32 i = 0; i < URING_ARM_WAIT_LOOPS &&
+         __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE) != m_sqLocalTail; i++)
+    {
+        usleep(URING_ARM_WAIT_USEC);
+        submit(FALSE);
+    }
+
+    reap();
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        if (m_recvFailed[i] || !m_recvArmed[i])
+        {
+            LOG_ERROR("io_uring multishot receive not supported");
+            LOG_EXITFN(RFAILED);
+        }
+    }
+
+    LOG_EXITFN(ROK);
+}
+
+/**
+ * @brief
+ *    Next free submission queue entry, submits the pending entries and waits
+ *    for the kernel to consume them when the queue is full
+ */
+struct io_uring_sqe *UringTransport::getSqe()
+{
+    while (m_sqLocalTail - __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE) >=
+           m_sqEntries)
+    {
+        submit(FALSE);
+    }
+
+    U32                  indx = m_sqLocalTail & m_sqMask;
+    struct io_uring_sqe *pSqe = &m_pSqes[indx];
+    MEMSET(pSqe, 0, sizeof(struct io_uring_sqe));
+    m_pSqArray[indx] = indx;
+    m_sqLocalTail++;
+
+    return pSqe;
+}
+
+/**
+ * @brief
+ *    Publishes the queued entries to the kernel. With SQPOLL the kernel
+ *    thread is woken up only if it went idle
+ *
+ * @param wait
+ *    waits for at least one completion
+ */
+VOID UringTransport::submit(BOOL wait)
+{
+    U32 toSubmit = m_sqLocalTail - m_sqSubmitted;
+    U32 flags    = wait ? IORING_ENTER_GETEVENTS : 0;
+
+    __atomic_store_n(m_pSqTail, m_sqLocalTail, __ATOMIC_RELEASE);
+    m_sqSubmitted = m_sqLocalTail;
+
+    if (m_sqPollIdle)
+    {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(m_pSqFlags, __ATOMIC_RELAXED) &
+            IORING_SQ_NEED_WAKEUP)
+        {
+            flags |= IORING_ENTER_SQ_WAKEUP;
+        }
+
+        toSubmit = 0;
+    }
+
+    if (toSubmit || flags)
+    {
+        if (syscall(__NR_io_uring_enter, m_ringFd, toSubmit, wait ? 1 : 0,
+                flags, NULL, 0) < 0 &&
+            errno != EINTR)
+        {
+            LOG_ERROR("io_uring_enter() failed, [%s]", strerror(errno));
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Arms a multishot recvmsg on the socket, it keeps posting a completion
+ *    per datagram until it runs out of buffers or fails
+ */
+VOID UringTransport::armRecv(TransConnId connId)
+{
+    struct io_uring_sqe *pSqe = getSqe();
+    pSqe->opcode              = IORING_OP_RECVMSG;
+    pSqe->fd                  = m_socks[connId]->fd();
+    pSqe->addr                = (U64)(unsigned long)&m_recvHdrs[connId];
+    pSqe->len                 = 1;
+    pSqe->ioprio              = IORING_RECV_MULTISHOT;
+    pSqe->flags               = IOSQE_BUFFER_SELECT;
+    pSqe->buf_group           = URING_BUF_GROUP;
+    pSqe->user_data           = URING_UD_RECV | connId;
+    m_recvArmed[connId]       = TRUE;
+}
+
+/**
+ * @brief
+ *    Copies the datagram out of the provided buffer and gives the buffer
+ *    back to the kernel
+ */
+VOID UringTransport::procRecvCqe(struct io_uring_cqe *pCqe)
+{
+    TransConnId connId = pCqe->user_data & URING_UD_INDEX_MASK;
+
+    if (!(pCqe->flags & IORING_CQE_F_MORE))
+    {
+        m_recvArmed[connId] = FALSE;
+    }
+
+    if (pCqe->res < 0)
+    {
+        /* running out of buffers ends a multishot receive, which is armed
+         * again once buffers are returned. Other errors would fail again
+         */
+        if (-ENOBUFS != pCqe->res)
+        {
+            LOG_ERROR("io_uring receive failed, [%s]", strerror(-pCqe->res));
+            m_recvFailed[connId] = !m_recvArmed[connId];
+        }
+        return;
+    }
+
+    U16 bid  = pCqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    U8 *pBuf = m_pRecvBufs + bid * m_recvBufSz;
+
+    struct io_uring_recvmsg_out *pOut = (struct io_uring_recvmsg_out *)pBuf;
+    U8 *pName    = pBuf + sizeof(struct io_uring_recvmsg_out);
+    U8 *pPayload = pName + m_recvHdrs[connId].msg_namelen +
+                   m_recvHdrs[connId].msg_controllen;
+
+    if (!(pOut->flags & MSG_TRUNC))
+    {
+        struct sockaddr_storage addr;
+        MEMSET(&addr, 0, sizeof(addr));
+        MEMCPY(&addr, pName, (pOut->namelen < sizeof(addr)) ?
+            pOut->namelen : sizeof(addr));
+
+        /* the control messages follow the name in the buffer */
+        struct msghdr ctrlHdr;
+        MEMSET(&ctrlHdr, 0, sizeof(ctrlHdr));
+        ctrlHdr.msg_control    = pName + m_recvHdrs[connId].msg_namelen;
+        ctrlHdr.msg_controllen = pOut->controllen;
+
+        UdpData_t *pMsg = new UdpData_t;
+        BUFFER_CPY(&pMsg->buf, pPayload, pOut->payloadlen);
+        pMsg->connId = connId;
+        pMsg->timeNs = decRecvTimestamp(&ctrlHdr);
+        decSockAddr(&addr, &pMsg->peerEp);
+        m_rxQ.push_back(pMsg);
+    }
+    else
+    {
+        LOG_ERROR("Truncated datagram dropped");
+    }
+
+    struct io_uring_buf *pRingBuf = (struct io_uring_buf *)m_pBufRing +
+                                    (m_bufTail & (URING_RECV_BUFS - 1));
+    pRingBuf->addr = (U64)(unsigned long)pBuf;
+    pRingBuf->len  = m_recvBufSz;
+    pRingBuf->bid  = bid;
+    m_bufTail++;
+}
+
+/**
+ * @brief
+ *    Processes all the completions. Received datagrams are queued for recv(),
+ *    buffers of completed sends are released
+ */
+VOID UringTransport::reap()
+{
+    U32 head = *m_pCqHead;
+    U32 tail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+    {
+        return;
+    }
+
+    for (; head != tail; head++)
+    {
+        struct io_uring_cqe *pCqe = &m_pCqes[head & m_cqMask];
+
+        if (URING_UD_RECV == (pCqe->user_data & URING_UD_TYPE_MASK))
+        {
+            procRecvCqe(pCqe);
+        }
+        else
+        {
+            U32            slot  = pCqe->user_data & URING_UD_INDEX_MASK;
+            UringSendSlot *pSlot = &m_pSendSlots[slot];
+            if (pCqe->res < 0)
+            {
+                LOG_ERROR("io_uring send failed, [%s]", strerror(-pCqe->res));
+            }
+
+            delete pSlot->pBuf;
+            pSlot->pBuf     = NULL;
+            pSlot->nextFree = m_freeSlot;
+            m_freeSlot      = slot;
+        }
+    }
+
+    __atomic_store_n(m_pCqHead, head, __ATOMIC_RELEASE);
+    __atomic_store_n(&m_pBufRing->tail, m_bufTail, __ATOMIC_RELEASE);
+
+    /* multishot receives which stopped, e.g. because the kernel ran out of
+     * buffers, are armed again now that the buffers are returned
+     */
+    BOOL rearmed = FALSE;
+    for (U32 i = 0; i < m_numSocks; i++)
+    {
+        if (!m_recvArmed[i] && !m_recvFailed[i])
+        {
+            armRecv(i);
+            rearmed = TRUE;
+        }
+    }
+
+    if (rearmed)
+    {
+        submit(FALSE);
+    }
+}
+
+/**
+ * @brief
+ *    Queues a sendmsg per message and submits them all with one system call.
+ *    The buffers are released when the sends complete
+ */
+U32 UringTransport::send(TransMsg_t *pMsgs, U32 cnt)
+{
+    LOG_ENTERFN();
+
+    U32 numSent = 0;
+    for (U32 i = 0; i < cnt; i++)
+    {
+        TransMsg_t *pMsg = &pMsgs[i];
+        if (pMsg->connId >= m_numSocks)
+        {
+            LOG_ERROR("Invalid connection id [%d]", pMsg->connId);
+            delete pMsg->pBuf;
+            continue;
+        }
+
+        while (URING_SLOT_NONE == m_freeSlot)
+        {
+            submit(TRUE);
+            reap();
+        }
+
+        U32            slot  = m_freeSlot;
+        UringSendSlot *pSlot = &m_pSendSlots[slot];
+        m_freeSlot           = pSlot->nextFree;
+
+        pSlot->pBuf         = pMsg->pBuf;
+        pSlot->iov.iov_base = pMsg->pBuf->pVal;
+        pSlot->iov.iov_len  = pMsg->pBuf->len;
+        MEMSET(&pSlot->hdr, 0, sizeof(struct msghdr));
+        pSlot->hdr.msg_name    = &pSlot->addr;
+        pSlot->hdr.msg_namelen = encSockAddr(pMsg->pDst, &pSlot->addr);
+        pSlot->hdr.msg_iov     = &pSlot->iov;
+        pSlot->hdr.msg_iovlen  = 1;
+
+        struct io_uring_sqe *pSqe = getSqe();
+        pSqe->opcode              = IORING_OP_SENDMSG;
+        pSqe->fd                  = m_socks[pMsg->connId]->fd();
+        pSqe->addr                = (U64)(unsigned long)&pSlot->hdr;
+        pSqe->len                 = 1;
+        pSqe->user_data           = URING_UD_SEND | slot;
+        numSent++;
+    }
+
+    submit(FALSE);
+
+    LOG_EXITFN(numSent);
+}
+
+U32 UringTransport::recv(UdpData_t **ppMsgs, U32 max)
+{
+    reap();
+
+    U32 cnt = 0;
+    while (cnt < max && m_rxHead < m_rxQ.size())
+    {
+        ppMsgs[cnt++] = m_rxQ[m_rxHead++];
+    }
+
+    if (m_rxHead == m_rxQ.size())
+    {
+        m_rxQ.clear();
+        m_rxHead = 0;
+    }
+
+    return cnt;
+}
+
+#else
+
+UringTransport::~UringTransport()
+{
+}
+
+RETVAL UringTransport::init()
+{
+    LOG_ERROR("io_uring transport is not supported by this build");
+    return RFAILED;
+}
+
+U32 UringTransport::send(TransMsg_t *pMsgs, U32 cnt)
+{
+    for (U32 i = 0; i < cnt; i++)
+    {
+        delete pMsgs[i].pBuf;
+    }
+
+    return 0;
+}
+
+U32 UringTransport::recv(UdpData_t **ppMsgs, U32 max)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */ 
+
+#ifndef _URING_HPP_
+#define _URING_HPP_
+
+#include <vector>
+
+#define URING_SQ_ENTRIES         256
+#define URING_CQ_ENTRIES         16384
+#define URING_SEND_SLOTS         4096
+#define URING_RECV_BUFS          1024  /* power of 2 */
+#define URING_BUF_GROUP          0
+#define URING_ARM_WAIT_USEC      100
+#define URING_ARM_WAIT_LOOPS     10000 /* 1 second */
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+struct UringSendSlot;
+
+/**
+ * @brief
+ *    io_uring UDP transport. Every socket has a multishot recvmsg armed,
+ *    which receives into buffers provided to the kernel through a buffer
+ *    ring, and the messages of a send() call are submitted with one
+ *    io_uring_enter(). With SQPOLL the kernel thread polls the submission
+ *    queue and sending costs no system call. The ring fd is the ready fd
+ */
+class UringTransport: public Transport
+{
+   public:
+      UringTransport(U32 sqPollIdle);
+      ~UringTransport();
+
+      RETVAL      init();
+      U32         send(TransMsg_t *pMsgs, U32 cnt);
+      U32         recv(UdpData_t **ppMsgs, U32 max);
+      S32         readyFd();
+      U32         capabilities();
+      const S8    *name();
+      S32         rxCpu();
+      RETVAL      setBusyPoll(U32 usec);
+
+   private:
+      RETVAL      setupRing();
+      RETVAL      setupBufRing();
+      RETVAL      probeOps();
+      RETVAL      addSocket(IPEndPoint ep);
+      struct io_uring_sqe *getSqe();
+      VOID        submit(BOOL wait);
+      VOID        armRecv(TransConnId connId);
+      VOID        reap();
+      VOID        procRecvCqe(struct io_uring_cqe *pCqe);
+
+      U32         m_sqPollIdle;
+      S32         m_ringFd;
+
+      /* submission and completion queues shared with the kernel */
+      VOID        *m_pSqRing;
+      size_t      m_sqRingSz;
+      VOID        *m_pCqRing;
+      size_t      m_cqRingSz;
+      U32         *m_pSqHead;
+      U32         *m_pSqTail;
+      U32         *m_pSqFlags;
+      U32         *m_pSqArray;
+      U32         m_sqMask;
+      U32         m_sqEntries;
+      U32         m_sqLocalTail;
+      U32         m_sqSubmitted;
+      struct io_uring_sqe *m_pSqes;
+      U32         *m_pCqHead;
+      U32         *m_pCqTail;
+      U32         m_cqMask;
+      struct io_uring_cqe *m_pCqes;
+
+      /* receive buffers provided to the kernel */
+      struct io_uring_buf_ring *m_pBufRing;
+      U8          *m_pRecvBufs;
+      U32         m_recvBufSz;
+      U16         m_bufTail;
+
+      /* in flight send requests, the buffers are released on completion */
+      UringSendSlot *m_pSendSlots;
+      U32         m_freeSlot;
+
+      GSimSocket  *m_socks[GSIM_MAX_SOCK_CNT];
+      struct msghdr m_recvHdrs[GSIM_MAX_SOCK_CNT];
+      BOOL        m_recvArmed[GSIM_MAX_SOCK_CNT];
+      BOOL        m_recvFailed[GSIM_MAX_SOCK_CNT]; /* never armed again */
+      U32         m_numSocks;
+
+      std::vector<UdpData_t *> m_rxQ;
+      U32         m_rxHead;
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "task.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "scenario.hpp"
+#include "gtp_stats.hpp"
+#include "validate.hpp"
+
+ValidateRules::ValidateRules()
+{
+   m_numRules  = 0;
+   m_presMask  = 0;
+   m_absMask   = 0;
+   m_countMask = 0;
+   MEMSET(m_ieRules, 0, sizeof(m_ieRules));
+}
+
+/**
+ * @brief
+ *    Compiles a rule into the rule table and the masks
+ *
+ * @return
+ *    RFAILED if the message has the maximum number of rules
+ */
+RETVAL ValidateRules::addRule(const VldRule_t *pRule)
+{
+   if (m_numRules >= VLD_MAX_RULES)
+   {
+      return RFAILED;
+   }
+
+   U64 bit = 1ULL << m_numRules;
+
+   m_rules[m_numRules] = *pRule;
+   m_rules[m_numRules].numFail = 0;
+   m_ieRules[pRule->ieType] |= bit;
+
+   switch (pRule->type)
+   {
+      case VLD_RULE_PRESENT:
+      case VLD_RULE_VALUE:
+         m_presMask |= bit;
+         break;
+
+      case VLD_RULE_ABSENT:
+         m_absMask |= bit;
+         break;
+
+      case VLD_RULE_COUNT:
+         m_countMask |= bit;
+         break;
+   }
+
+   m_numRules++;
+   return ROK;
+}
+
+BOOL ValidateRules::checkValue(const VldRule_t *pRule, const U8 *pData,
+      U32 len)
+{
+   if ((U32)pRule->offset + pRule->len > len)
+   {
+      return FALSE;
+   }
+
+   U32 value = 0;
+   for (U32 i = 0; i < pRule->len; i++)
+   {
+      value = (value << 8) | pData[pRule->offset + i];
+   }
+
+   value &= pRule->mask;
+   return (value >= pRule->min && value <= pRule->max);
+}
+
+/**
+ * @brief
+ *    Checks the rules in a single walk over the encoded IEs of a received
+ *    message, and counts the failures of each rule
+ *
+ * @return
+ *    TRUE if every rule passed
+ */
+BOOL ValidateRules::validate(GtpMsg *pMsg)
+{
+   GtpIeHdr ieHdr;
+   U16      count[VLD_MAX_RULES];
+   U64      seen = 0;
+   U64      fail = 0;
+   U32      len  = 0;
+   U8       *pBuf = pMsg->getIeBuf(&len);
+
+   if (0 != m_countMask)
+   {
+      MEMSET(count, 0, m_numRules * sizeof(U16));
+   }
+
+   while (len >= GTP_IE_HDR_LEN)
+   {
+      decIeHdr(pBuf, &ieHdr);
+      if ((U32)ieHdr.len + GTP_IE_HDR_LEN > len)
+      {
+         break;
+      }
+
+      U64 rules = m_ieRules[ieHdr.ieType];
+      while (0 != rules)
+      {
+         U32       indx  = __builtin_ctzll(rules);
+         VldRule_t *pRule = &m_rules[indx];
+
+         rules &= rules - 1;
+         if (pRule->inst != ieHdr.instance)
+         {
+            continue;
+         }
+
+         seen |= 1ULL << indx;
+         if (VLD_RULE_COUNT == pRule->type)
+         {
+            count[indx]++;
+         }
+         else if (VLD_RULE_VALUE == pRule->type &&
+               !checkValue(pRule, pBuf + GTP_IE_HDR_LEN, ieHdr.len))
+         {
+            fail |= 1ULL << indx;
+         }
+      }
+
+      len  -= ieHdr.len + GTP_IE_HDR_LEN;
+      pBuf += ieHdr.len + GTP_IE_HDR_LEN;
+   }
+
+   fail |= (m_presMask & ~seen) | (m_absMask & seen);
+
+   U64 rules = m_countMask;
+   while (0 != rules)
+   {
+      U32 indx = __builtin_ctzll(rules);
+
+      rules &= rules - 1;
+      if (count[indx] < m_rules[indx].min || count[indx] > m_rules[indx].max)
+      {
+         fail |= 1ULL << indx;
+      }
+   }
+
+   if (0 == fail)
+   {
+      return TRUE;
+   }
+
+   while (0 != fail)
+   {
+      U32 indx = __builtin_ctzll(fail);
+
+      fail &= fail - 1;
+      m_rules[indx].numFail++;
+      LOG_DEBUG("Validation failed, %s", m_rules[indx].desc);
+   }
+
+   Stats::incStats(GSIM_STAT_NUM_INVALID);
+   return FALSE;
+}
+
+PRIVATE VOID printJobValidateStats(Job *pJob)
+{
+   if (NULL == pJob || NULL == pJob->m_pRules)
+   {
+      return;
+   }
+
+   ValidateRules *pRules = pJob->m_pRules;
+   for (U32 i = 0; i < pRules->numRules(); i++)
+   {
+      const VldRule_t *pRule = pRules->rule(i);
+
+      std::cout << "Validate " << pJob->m_msgName << ": " << pRule->desc
+         << ", failed " << pRule->numFail << std::endl;
+      LOG_INFO("Validate %s: %s, failed [%u]", pJob->m_msgName, pRule->desc,
+            pRule->numFail);
+   }
+}
+
+PUBLIC VOID printValidateStats(Scenario *pScn)
+{
+   for (U32 i = 0; i < pScn->m_procSeq.size(); i++)
+   {
+      Procedure *proc = pScn->m_procSeq.at(i);
+
+      printJobValidateStats(proc->m_initial);
+      printJobValidateStats(proc->m_trigMsg);
+      printJobValidateStats(proc->m_trigReply);
+   }
+}
@@ -0,0 +1,90 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _VALIDATE_HPP_
+#define _VALIDATE_HPP_
+
+class GtpMsg;
+class Scenario;
+
+#define VLD_MAX_RULES            64    /* rules of a message, a bit each */
+#define VLD_MAX_VALUE_LEN        4
+#define VLD_RULE_DESC_LEN        64
+
+typedef enum
+{
+   VLD_RULE_PRESENT,    /* the IE is present */
+   VLD_RULE_ABSENT,     /* the IE is not present */
+   VLD_RULE_VALUE,      /* the IE is present and its value is in range */
+   VLD_RULE_COUNT       /* number of occurrences of the IE is in range */
+} VldRuleType_t;
+
+/**
+ * @brief
+ *    A <validate> tag of a received message. The value of a value rule is
+ *    the len octets at offset of the IE data, masked, in network order
+ */
+typedef struct
+{
+   VldRuleType_t     type;
+   GtpIeType_t       ieType;
+   GtpInstance_t     inst;
+   U16               offset;
+   U8                len;
+   U32               mask;
+   U32               min;
+   U32               max;
+   Counter           numFail;
+   S8                desc[VLD_RULE_DESC_LEN];
+} VldRule_t;
+
+/**
+ * @brief
+ *    Validation rules of a received message of the scenario, compiled at
+ *    load into a rule table and a bitmask of the rules for each IE type.
+ *    A received message is checked in one walk over its encoded IEs, the
+ *    IEs no rule looks at cost a table lookup
+ */
+class ValidateRules
+{
+   public:
+      ValidateRules();
+      ~ValidateRules() {}
+
+      RETVAL            addRule(const VldRule_t *pRule);
+      BOOL              validate(GtpMsg *pMsg);
+      inline U32        numRules() { return m_numRules; }
+      inline const VldRule_t* rule(U32 indx) { return &m_rules[indx]; }
+
+   private:
+      BOOL              checkValue(const VldRule_t *pRule, const U8 *pData,
+                           U32 len);
+
+      VldRule_t         m_rules[VLD_MAX_RULES];
+      U32               m_numRules;
+      U64               m_ieRules[GTP_IE_MAX];  /* rules of each IE type */
+      U64               m_presMask;     /* rules failing when IE absent */
+      U64               m_absMask;      /* rules failing when IE present */
+      U64               m_countMask;    /* rules checking the count */
+};
+
+/**
+ * @brief
+ *    Prints and logs the failures of each rule of the scenario
+ */
+EXTERN VOID          printValidateStats(Scenario *pScn);
+
+#endif
@@ -16,6 +16,7 @@
 
 #include <list>
 #include <vector>
+#include <string>
 #include <exception>
 
 #include "pugixml.hpp"
@@ -31,6 +32,8 @@ using namespace pugi;
 #include "gtp_ie.hpp"
 #include "gtp_msg.hpp"
 #include "procedure.hpp"
+#include "validate.hpp"
+#include "store.hpp"
 #include "xml_parser.hpp"
 
 /**
@@ -125,6 +128,7 @@ Job* XmlParser::procSend(xml_node *pSend)
 
    GtpIeLst ieLst;
    Job  *job = NULL;
+   std::vector<VarRule_t> patches;
 
    try
    {
@@ -145,6 +149,12 @@ Job* XmlParser::procSend(xml_node *pSend)
          {
             procIe(&node, &ieLst);
          }
+         else if (0 == strcmp(node.name(), "patch"))
+         {
+            VarRule_t rule;
+            procVarRule(&node, &rule, FALSE);
+            patches.push_back(rule);
+         }
          else
          {
             LOG_ERROR("Unknown Tag: %s", node.name());
@@ -155,6 +165,21 @@ Job* XmlParser::procSend(xml_node *pSend)
       pGtpMsg->encode(&ieLst);
 
       job = new Job(pGtpMsg, JOB_TYPE_SEND);
+      if (!patches.empty())
+      {
+         job->m_pPatch = new PatchRules;
+      }
+
+      for (U32 i = 0; i < patches.size(); i++)
+      {
+         if (ROK != job->m_pPatch->addRule(&patches[i], pGtpMsg))
+         {
+            LOG_ERROR("<patch> of variable [%s] does not fit <%s>",
+                  m_vars[patches[i].var].c_str(), pMsgName);
+            delete job;
+            throw ERR_XML_PROCESSING;
+         }
+      }
    }
    catch (std::exception &m)
    {
@@ -183,7 +208,9 @@ Job* XmlParser::procRecv(xml_node *pRecv)
 {
    LOG_ENTERFN();
 
-   Job     *job = NULL;
+   Job            *job    = NULL;
+   ValidateRules  *pRules = NULL;
+   StoreRules     *pStore = NULL;
 
    try
    {
@@ -200,11 +227,21 @@ Job* XmlParser::procRecv(xml_node *pRecv)
       {
          if (0 == strcmp(node.name(), "store"))
          {
-            procStore(&node);
+            if (NULL == pStore)
+            {
+               pStore = new StoreRules;
+            }
+
+            procStore(&node, pStore);
          }
          else if (0 == strcmp(node.name(), "validate"))
          {
-            procValidate(&node);
+            if (NULL == pRules)
+            {
+               pRules = new ValidateRules;
+            }
+
+            procValidate(&node, pRules);
          }
          else
          {
@@ -214,25 +251,46 @@ Job* XmlParser::procRecv(xml_node *pRecv)
 
       GtpMsg *pGtpMsg = new GtpMsg(gtpGetMsgType(pMsgName));
       job = new Job(pGtpMsg, JOB_TYPE_RECV);
+      job->m_pRules = pRules;
+      job->m_pStore = pStore;
    }
    catch (std::exception &m)
    {
+      delete pRules;
+      delete pStore;
       throw ERR_MEMORY_ALLOC;
    }
    catch (ErrCodeEn &e)
    {
+      delete pRules;
+      delete pStore;
       throw ERR_XML_PROCESSING;
    }
 
    LOG_EXITFN(job);
 }
 
+/**
+ * @brief
+ *    Processes <wait value="ms"/>, the UE session waits value milliseconds
+ *    before the next procedure
+ */
 Job* XmlParser::procWait(xml_node *pWait)
 {
    LOG_ENTERFN();
 
    Job* job = NULL;
 
+   try
+   {
+      LOG_DEBUG("Processing <%s>", pWait->name());
+      job = new Job((Time_t)pWait->attribute("value").as_uint());
+   }
+   catch (std::exception &m)
+   {
+      throw ERR_MEMORY_ALLOC;
+   }
+
    LOG_EXITFN(job);
 }
 
@@ -314,41 +372,223 @@ RETVAL XmlParser::procIe(xml_node *pXmlIe, GtpIeLst *pIeLst)
 }
 
 /**
- * @brief 
+ * @brief
+ *    Parses the location of a value of a <store> or <patch> tag,
+ *    var="name" ie="type" [instance="n"] [occurrence="n"]
+ *    [group="type" group-instance="n" group-occurrence="n"]
+ *    [offset="n"] [length="n"]
+ *
+ * @param define
+ *    a <store> defines the variable, a <patch> uses a stored variable
+ *
+ * @throw ErrCodeEn
+ *    ERR_XML_PROCESSING if the tag is invalid
+ */
+VOID XmlParser::procVarRule(xml_node *pNode, VarRule_t *pRule, BOOL define)
+{
+   const S8 *pVar     = pNode->attribute("var").value();
+   const S8 *pIeName  = pNode->attribute("ie").value();
+   const S8 *pGrpName = pNode->attribute("group").value();
+
+   MEMSET(pRule, 0, sizeof(VarRule_t));
+   pRule->ieType  = gtpGetIeType(pIeName);
+   pRule->inst    = pNode->attribute("instance").as_uint();
+   pRule->occr    = pNode->attribute("occurrence").as_uint(1);
+   pRule->grpType = GTP_IE_MAX;
+   pRule->offset  = pNode->attribute("offset").as_uint();
+   pRule->len     = pNode->attribute("length").as_uint();
+   if (0 != STRLEN(pGrpName))
+   {
+      pRule->grpType = gtpGetIeType(pGrpName);
+      pRule->grpInst = pNode->attribute("group-instance").as_uint();
+      pRule->grpOccr = pNode->attribute("group-occurrence").as_uint(1);
+      if (GTP_IE_MAX == pRule->grpType)
+      {
+         LOG_ERROR("Unknown group IE <%s> in <%s>", pGrpName, pNode->name());
+         throw ERR_XML_PROCESSING;
+      }
+   }
+
+   if (GTP_IE_MAX == pRule->ieType || 0 == STRLEN(pVar) ||
+       0 == pRule->occr || pRule->len > GTP_SSN_VAR_LEN)
+   {
+      LOG_ERROR("Invalid <%s> of IE <%s>", pNode->name(), pIeName);
+      throw ERR_XML_PROCESSING;
+   }
+
+   U32 var = 0;
+   while (var < m_vars.size() && m_vars[var] != pVar)
+   {
+      var++;
+   }
+
+   if (var == m_vars.size())
+   {
+      if (!define)
+      {
+         LOG_ERROR("<patch> of variable [%s] not stored before", pVar);
+         throw ERR_XML_PROCESSING;
+      }
+
+      if (m_vars.size() >= GTP_MAX_SSN_VARS)
+      {
+         LOG_ERROR("More than %d session variables", GTP_MAX_SSN_VARS);
+         throw ERR_XML_PROCESSING;
+      }
+
+      m_vars.push_back(pVar);
+   }
+
+   pRule->var = var;
+}
+
+/**
+ * @brief
+ *    Compiles a <store> tag of a received message, the value is stored in
+ *    a session variable for the <patch> tags of the messages sent later
  *
  * @param pStore
  *    Pointer to <store> tag xml node
  *
- * @return 
- *    ROK if processed successfully
- *    RFAILED otherwise
+ * @throw ErrCodeEn
+ *    ERR_XML_PROCESSING if the tag is invalid
  */
-RETVAL XmlParser::procStore(xml_node *pStore)
+RETVAL XmlParser::procStore(xml_node *pStore, StoreRules *pRules)
 {
-   RETVAL ret = ROK;
+   RETVAL      ret = ROK;
+   VarRule_t   rule;
 
-   LOG_DEBUG("Processing Storing <%s>", pStore->name());
+   LOG_DEBUG("Processing Storing <%s>", pStore->attribute("var").value());
+
+   procVarRule(pStore, &rule, TRUE);
+   if (ROK != pRules->addRule(&rule))
+   {
+      LOG_ERROR("More than %d <store> tags in a message", VAR_MAX_RULES);
+      throw ERR_XML_PROCESSING;
+   }
 
    return ret;
 }
 
 /**
  * @brief
+ *    Decimal or 0x prefixed hex value of an attribute
+ */
+PRIVATE U32 xmlGetUint(xml_attribute attr, U32 dflt)
+{
+   if (attr.empty())
+   {
+      return dflt;
+   }
+
+   return (U32)strtoul(attr.value(), NULL, 0);
+}
+
+/**
+ * @brief
+ *    Compiles a <validate> tag of a received message into a rule,
+ *    <validate ie="type" [instance="n"] [check="present|absent|value|count"]
+ *    [value="v" | min="v" max="v"] [offset="n" length="n" mask="v"]/>
+ *    The check is a value check when a value is given, a presence check
+ *    otherwise. Only the IEs at the top level of the message are checked
  *
  * @param pValidate
  *    Pointer to <validate> tag xml node
  *
- * @return 
- *    ROK if processed successfully
- *    RFAILED otherwise
+ * @throw ErrCodeEn
+ *    ERR_XML_PROCESSING if the tag is invalid
  */
-RETVAL XmlParser::procValidate(xml_node *pValidate)
+RETVAL XmlParser::procValidate(xml_node *pValidate, ValidateRules *pRules)
 {
-   RETVAL ret = ROK;
+   RETVAL      ret = ROK;
+   VldRule_t   rule;
+   const S8    *pIeName = pValidate->attribute("ie").value();
+   const S8    *pCheck  = pValidate->attribute("check").value();
+   BOOL        hasValue = !pValidate->attribute("value").empty() ||
+                          !pValidate->attribute("min").empty() ||
+                          !pValidate->attribute("max").empty();
 
    LOG_ENTERFN();
 
-   LOG_DEBUG("Processing Validate <%s>", pValidate->name());
+   LOG_DEBUG("Processing Validate <%s>", pIeName);
+
+   MEMSET(&rule, 0, sizeof(rule));
+   rule.ieType = gtpGetIeType(pIeName);
+   rule.inst   = pValidate->attribute("instance").as_uint();
+   if (GTP_IE_MAX == rule.ieType)
+   {
+      LOG_ERROR("Unknown IE <%s> in validate", pIeName);
+      throw ERR_XML_PROCESSING;
+   }
+
+   if (0 == STRLEN(pCheck))
+   {
+      rule.type = hasValue ? VLD_RULE_VALUE : VLD_RULE_PRESENT;
+   }
+   else if (0 == strcasecmp(pCheck, "present"))
+   {
+      rule.type = VLD_RULE_PRESENT;
+   }
+   else if (0 == strcasecmp(pCheck, "absent"))
+   {
+      rule.type = VLD_RULE_ABSENT;
+   }
+   else if (0 == strcasecmp(pCheck, "value"))
+   {
+      rule.type = VLD_RULE_VALUE;
+   }
+   else if (0 == strcasecmp(pCheck, "count"))
+   {
+      rule.type = VLD_RULE_COUNT;
+   }
+   else
+   {
+      LOG_ERROR("Unknown check <%s> in validate", pCheck);
+      throw ERR_XML_PROCESSING;
+   }
+
+   U32 value = xmlGetUint(pValidate->attribute("value"), 0);
+   rule.min  = xmlGetUint(pValidate->attribute("min"), value);
+   rule.max  = xmlGetUint(pValidate->attribute("max"),
+         pValidate->attribute("value").empty() ? 0xffffffff : value);
+   rule.offset = xmlGetUint(pValidate->attribute("offset"), 0);
+   rule.len    = xmlGetUint(pValidate->attribute("length"), 1);
+   if (rule.len < 1 || rule.len > VLD_MAX_VALUE_LEN || rule.min > rule.max ||
+       (VLD_RULE_VALUE == rule.type && !hasValue))
+   {
+      LOG_ERROR("Invalid value or range in validate <%s>", pIeName);
+      throw ERR_XML_PROCESSING;
+   }
+
+   rule.mask = xmlGetUint(pValidate->attribute("mask"),
+         (VLD_MAX_VALUE_LEN == rule.len) ? 0xffffffff :
+         (1U << (rule.len * 8)) - 1);
+
+   switch (rule.type)
+   {
+      case VLD_RULE_PRESENT:
+      case VLD_RULE_ABSENT:
+         snprintf(rule.desc, VLD_RULE_DESC_LEN, "%s[%u] %s", pIeName,
+               rule.inst, (VLD_RULE_PRESENT == rule.type) ? "present" :
+               "absent");
+         break;
+
+      case VLD_RULE_VALUE:
+         snprintf(rule.desc, VLD_RULE_DESC_LEN, "%s[%u] value %u-%u",
+               pIeName, rule.inst, rule.min, rule.max);
+         break;
+
+      case VLD_RULE_COUNT:
+         snprintf(rule.desc, VLD_RULE_DESC_LEN, "%s[%u] count %u-%u",
+               pIeName, rule.inst, rule.min, rule.max);
+         break;
+   }
+
+   if (ROK != pRules->addRule(&rule))
+   {
+      LOG_ERROR("More than %d validate rules in a message", VLD_MAX_RULES);
+      throw ERR_XML_PROCESSING;
+   }
 
    LOG_EXITFN(ret);
 }
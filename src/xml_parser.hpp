@@ -23,13 +23,15 @@ class XmlParser
 {
    private:
       xml_document   m_xmlDoc;
+      std::vector<std::string> m_vars;   /* names of the session variables */
 
       Job* procSend(xml_node *node);      
       Job* procRecv(xml_node *node);      
       Job* procWait(xml_node *node);      
       RETVAL procIe(xml_node *node, GtpIeLst *pIeLst);
-      RETVAL procStore(xml_node *node);      
-      RETVAL procValidate(xml_node *node);      
+      RETVAL procStore(xml_node *node, StoreRules *pStore);
+      VOID procVarRule(xml_node *node, VarRule_t *pRule, BOOL define);
+      RETVAL procValidate(xml_node *node, ValidateRules *pRules);
       RETVAL procComplexIe(GtpIe *pIe, xml_node *pXmlIe);
       RETVAL procGroupedIe(GtpIe *pIe, xml_node *pXmlIe);
 
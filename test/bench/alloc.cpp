@@ -0,0 +1,63 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <new>
+#include <cstdlib>
+
+#include "types.hpp"
+#include "macros.hpp"
+#include "alloc.hpp"
+
+static Counter s_numAllocs  = 0;
+static Counter s_allocBytes = 0;
+
+VOID *operator new(size_t size)
+{
+    s_numAllocs++;
+    s_allocBytes += size;
+    VOID *p = malloc(size ? size : 1);
+    if (NULL == p)
+    {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+VOID *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+VOID operator delete(VOID *p) noexcept
+{
+    free(p);
+}
+
+VOID operator delete[](VOID *p) noexcept
+{
+    free(p);
+}
+
+PUBLIC Counter benchNumAllocs()
+{
+    return s_numAllocs;
+}
+
+PUBLIC Counter benchAllocBytes()
+{
+    return s_allocBytes;
+}
@@ -0,0 +1,449 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief
+ *    gsim-codec-bench, micro benchmark of the GTP-C codec. Every message sent
+ *    by the scenarios in a directory is encoded, decoded, looked up IE by IE
+ *    and its IEs created, and the IMSI generator is run. For each case the
+ *    time, the heap bytes and the heap allocations per operation are
+ *    reported, as a table or as JSON to compare the results of two commits
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdlib>
+#include <time.h>
+#include <dirent.h>
+
+#include "cxxopts.hpp"
+#include "pugixml.hpp"
+using namespace pugi;
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "gtp_types.hpp"
+#include "gtp_macro.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "sim_cfg.hpp"
+#include "task.hpp"
+#include "gtp_peer.hpp"
+#include "traffic.hpp"
+#include "store.hpp"
+#include "xml_parser.hpp"
+#include "alloc.hpp"
+
+using std::string;
+using std::vector;
+
+#define CODEC_DFLT_SCN_DIR    "scenario"
+#define CODEC_DFLT_LOG_FILE   "/dev/null"
+#define CODEC_DFLT_ITERATIONS 100000
+
+typedef struct
+{
+    GtpIeType_t   type;
+    GtpInstance_t inst;
+    U32           occr;
+} CodecIe;
+
+class CodecResult
+{
+  public:
+    ~CodecResult();
+
+    string name;
+    string msg;
+    U32    iters;
+    U64    nsecs;
+    U64    bytes;
+    U64    allocs;
+};
+
+/* out of line, the two strings make the implicit one too big to inline */
+CodecResult::~CodecResult()
+{
+}
+
+static vector<CodecResult> s_results;
+
+PRIVATE U64 getNanoSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((U64)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/**
+ * @brief
+ *    Measurement of a benchmark case, started before its loop and recorded
+ *    after it
+ */
+class CodecTimer
+{
+  public:
+    CodecTimer()
+    {
+        m_allocs = benchNumAllocs();
+        m_bytes  = benchAllocBytes();
+        m_start  = getNanoSeconds();
+    }
+
+    VOID record(const string &name, const string &msg, U32 iters)
+    {
+        CodecResult res;
+        res.nsecs  = getNanoSeconds() - m_start;
+        res.bytes  = benchAllocBytes() - m_bytes;
+        res.allocs = benchNumAllocs() - m_allocs;
+        res.name   = name;
+        res.msg    = msg;
+        res.iters  = iters;
+        s_results.push_back(res);
+    }
+
+  private:
+    U64     m_start;
+    Counter m_allocs;
+    Counter m_bytes;
+};
+
+/**
+ * @brief
+ *    Loads the messages sent by the scenarios in the directory, one message
+ *    of each type
+ */
+PRIVATE VOID loadMsgs(const string &dir, JobSequence *pJobs,
+    vector<GtpMsg *> *pMsgs)
+{
+    DIR *pDir = opendir(dir.c_str());
+    if (NULL == pDir)
+    {
+        throw GsimError("Unable to open scenario directory " + dir);
+    }
+
+    vector<string> files;
+    struct dirent *pEnt = NULL;
+    while (NULL != (pEnt = readdir(pDir)))
+    {
+        string name = pEnt->d_name;
+        if (name.size() > 4 && name.substr(name.size() - 4) == ".xml")
+        {
+            files.push_back(dir + "/" + name);
+        }
+    }
+    closedir(pDir);
+
+    for (U32 i = 0; i < files.size(); i++)
+    {
+        parseXmlScenario(files[i].c_str(), pJobs);
+    }
+
+    for (JobSeqItr job = pJobs->begin(); job != pJobs->end(); job++)
+    {
+        if (JOB_TYPE_SEND != (*job)->type())
+        {
+            continue;
+        }
+
+        GtpMsg *pMsg = (*job)->getGtpMsg();
+        BOOL    dup  = FALSE;
+        for (U32 i = 0; i < pMsgs->size(); i++)
+        {
+            if ((*pMsgs)[i]->type() == pMsg->type())
+            {
+                dup = TRUE;
+                break;
+            }
+        }
+
+        if (!dup)
+        {
+            pMsgs->push_back(pMsg);
+        }
+    }
+}
+
+/**
+ * @brief
+ *    Encodes the message the way a session sends it, the header is updated
+ *    and the message is encoded into a cleared buffer
+ */
+PRIVATE VOID encodeMsg(GtpMsg *pMsg, U8 *pBuf, U32 *pLen)
+{
+    GtpMsgHdr hdr;
+    hdr.teid = 0x1234;
+    hdr.seqN = 0x10;
+    GSIM_SET_MASK(hdr.pres, GTP_MSG_HDR_TEID_PRES);
+    GSIM_SET_MASK(hdr.pres, GTP_MSG_HDR_SEQ_PRES);
+    pMsg->setMsgHdr(&hdr);
+
+    MEMSET(pBuf, 0, GTP_MSG_BUF_LEN);
+    pMsg->encode(pBuf, pLen);
+}
+
+/**
+ * @brief
+ *    IEs at the top level of an encoded message, with the occurrence count
+ *    of each IE type and instance
+ */
+PRIVATE vector<CodecIe> listIes(Buffer *pBuf)
+{
+    vector<CodecIe> ies;
+
+    U8 *pIeBuf = pBuf->pVal + GTP_MSG_HDR_LEN;
+    U8 *pEnd   = pBuf->pVal + pBuf->len;
+    while (pIeBuf + GTP_IE_HDR_LEN <= pEnd)
+    {
+        CodecIe ie;
+        U16     len = 0;
+        GTP_GET_IE_TYPE(pIeBuf, ie.type);
+        GTP_GET_IE_INSTANCE(pIeBuf, ie.inst);
+        GTP_GET_IE_LEN(pIeBuf, len);
+
+        ie.occr = 1;
+        for (U32 i = 0; i < ies.size(); i++)
+        {
+            if (ies[i].type == ie.type && ies[i].inst == ie.inst)
+            {
+                ie.occr++;
+            }
+        }
+
+        ies.push_back(ie);
+        pIeBuf += GTP_IE_HDR_LEN + len;
+    }
+
+    return ies;
+}
+
+PRIVATE VOID benchMsg(GtpMsg *pMsg, U32 iters)
+{
+    string msgName = gtpGetMsgName(pMsg->type());
+    U8     buf[GTP_MSG_BUF_LEN];
+    U32    len = 0;
+
+    {
+        CodecTimer timer;
+        for (U32 i = 0; i < iters; i++)
+        {
+            encodeMsg(pMsg, buf, &len);
+        }
+        timer.record("encode", msgName, iters);
+    }
+
+    Buffer encBuf;
+    BUFFER_CPY(&encBuf, buf, len);
+
+    {
+        CodecTimer timer;
+        for (U32 i = 0; i < iters; i++)
+        {
+            GtpMsg *pDecMsg = new GtpMsg(&encBuf);
+            pDecMsg->decode();
+            delete pDecMsg;
+        }
+        timer.record("decode", msgName, iters);
+    }
+
+    vector<CodecIe> ies = listIes(&encBuf);
+    if (ies.empty())
+    {
+        return;
+    }
+
+    GtpMsg decMsg(&encBuf);
+    decMsg.decode();
+    {
+        CodecTimer timer;
+        for (U32 i = 0; i < iters; i++)
+        {
+            const CodecIe *pIe = &ies[i % ies.size()];
+            if (NULL == decMsg.getIe(pIe->type, pIe->inst, pIe->occr))
+            {
+                throw GsimError("IE not found in " + msgName);
+            }
+        }
+        timer.record("getIe", msgName, iters);
+    }
+
+    {
+        CodecTimer timer;
+        for (U32 i = 0; i < iters; i++)
+        {
+            const CodecIe *pIe = &ies[i % ies.size()];
+            delete GtpIe::createGtpIe(pIe->type, pIe->inst);
+        }
+        timer.record("createGtpIe", msgName, iters);
+    }
+}
+
+PRIVATE VOID benchImsi(U32 iters)
+{
+    GtpImsiGenerator imsiGen;
+    GtpImsiKey       imsiKey;
+
+    imsiGen.init(Config::getInstance()->getImsi());
+
+    CodecTimer timer;
+    for (U32 i = 0; i < iters; i++)
+    {
+        imsiGen.allocNew(&imsiKey);
+    }
+    timer.record("imsiAllocNew", "", iters);
+}
+
+PRIVATE VOID printTable()
+{
+    std::cout << std::left << std::setw(14) << "Case" << std::setw(36)
+              << "Message" << std::right << std::setw(10) << "ns/op"
+              << std::setw(10) << "bytes/op" << std::setw(11) << "allocs/op"
+              << std::endl;
+
+    for (U32 i = 0; i < s_results.size(); i++)
+    {
+        CodecResult *pRes = &s_results[i];
+        std::cout << std::left << std::setw(14) << pRes->name << std::setw(36)
+                  << pRes->msg << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10)
+                  << (double)pRes->nsecs / pRes->iters << std::setw(10)
+                  << (double)pRes->bytes / pRes->iters << std::setw(11)
+                  << (double)pRes->allocs / pRes->iters << std::endl;
+    }
+}
+
+PRIVATE VOID printJson()
+{
+    std::cout << "{\n  \"benchmarks\": [";
+    for (U32 i = 0; i < s_results.size(); i++)
+    {
+        CodecResult *pRes = &s_results[i];
+        std::cout << (i ? ",\n" : "\n") << "    {\"name\": \"" << pRes->name
+                  << "\", \"msg\": \"" << pRes->msg
+                  << "\", \"iterations\": " << pRes->iters << std::fixed
+                  << std::setprecision(2)
+                  << ", \"ns_per_op\": " << (double)pRes->nsecs / pRes->iters
+                  << ", \"bytes_per_op\": "
+                  << (double)pRes->bytes / pRes->iters
+                  << ", \"allocs_per_op\": "
+                  << (double)pRes->allocs / pRes->iters << "}";
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        cxxopts::Options options(argv[0], "GTP Simulator codec benchmark");
+
+        // clang-format off
+        options.add_options()
+            ("scenario-dir", "Directory with the scenario files",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("iterations", "Operations per benchmark case",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("json", "Print the results as JSON");
+        options.add_options()
+            ("log-file", "Log file, none by default",
+             cxxopts::value<std::string>());
+        options.add_options()
+             ("help", "Print help and exit");
+        // clang-format on
+
+        auto results = options.parse(argc, argv);
+        if (results.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            exit(0);
+        }
+
+        string scnDir  = CODEC_DFLT_SCN_DIR;
+        string logFile = CODEC_DFLT_LOG_FILE;
+        U32    iters   = CODEC_DFLT_ITERATIONS;
+        if (results.count("scenario-dir"))
+        {
+            scnDir = results["scenario-dir"].as<std::string>();
+        }
+
+        if (results.count("log-file"))
+        {
+            logFile = results["log-file"].as<std::string>();
+        }
+
+        if (results.count("iterations"))
+        {
+            iters = results["iterations"].as<std::uint32_t>();
+        }
+
+        if (0 == iters)
+        {
+            throw GsimError("Invalid iterations 0");
+        }
+
+        Config *pCfg = Config::getInstance();
+        pCfg->setLogFile(logFile);
+        Logger::init(LOG_LVL_FATAL);
+
+        JobSequence      jobs;
+        vector<GtpMsg *> msgs;
+        loadMsgs(scnDir, &jobs, &msgs);
+
+        for (U32 i = 0; i < msgs.size(); i++)
+        {
+            benchMsg(msgs[i], iters);
+        }
+        benchImsi(iters);
+
+        if (results.count("json"))
+        {
+            printJson();
+        }
+        else
+        {
+            printTable();
+        }
+
+        for (JobSeqItr job = jobs.begin(); job != jobs.end(); job++)
+        {
+            delete *job;
+        }
+        delete pCfg;
+    }
+    catch (ErrCodeEn e)
+    {
+        std::cout << "Error: " << e << std::endl;
+        exit(e);
+    }
+    catch (GsimError &e)
+    {
+        std::cout << e.what() << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,430 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief
+ *    gsim-bench, runs the initiating and the waiting side of every scenario
+ *    pair found in a directory within one process. The two sides are
+ *    connected by the in-memory transport in loopback.cpp, so the numbers
+ *    reported reflect the simulator itself rather than the kernel UDP path.
+ *    Scenarios are paired by the interface suffix of the file name, e.g.
+ *    mme_s11.xml (initiating) with sgw_s11.xml (waiting)
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdlib>
+#include <time.h>
+#include <dirent.h>
+
+#include "cxxopts.hpp"
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "timer.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "gtp_stats.hpp"
+#include "sim_cfg.hpp"
+#include "transport.hpp"
+#include "task.hpp"
+#include "gtp_peer.hpp"
+#include "traffic.hpp"
+#include "scenario.hpp"
+#include "tunnel.hpp"
+#include "session.hpp"
+#include "loopback.hpp"
+#include "alloc.hpp"
+
+using std::string;
+using std::vector;
+
+#define BENCH_INIT_PORT 2124
+#define BENCH_WAIT_PORT 2123
+
+#define BENCH_DFLT_SCN_DIR      "scenario"
+#define BENCH_DFLT_LOG_FILE     "/dev/null"
+#define BENCH_DFLT_NUM_SESSIONS 10000
+#define BENCH_DFLT_SESSION_RATE 1000
+#define BENCH_DFLT_MAX_TIME     60
+#define BENCH_DFLT_TRANSPORT    "loopback"
+
+static LoopbackTransport *s_pLoopback = NULL;
+static UdpData_t         *s_recvMsgs[TRANS_MAX_BATCH];
+
+typedef struct
+{
+    string    name;
+    Scenario *pInit;
+    Scenario *pWait;
+} ScnPair;
+
+PRIVATE U64 getNanoSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((U64)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+/**
+ * @brief
+ *    Interface suffix of a scenario file name, "mme_s11.xml" gives "s11"
+ */
+PRIVATE string scnSuffix(const string &file)
+{
+    size_t start = file.rfind('_');
+    size_t end   = file.rfind('.');
+    if (string::npos == start || string::npos == end || end < start)
+    {
+        return "";
+    }
+
+    return file.substr(start + 1, end - start - 1);
+}
+
+/**
+ * @brief
+ *    Loads every scenario file in the directory and pairs the initiating
+ *    scenarios with the waiting scenarios of the same interface
+ */
+PRIVATE vector<ScnPair> loadScnPairs(const string &dir)
+{
+    vector<ScnPair> pairs;
+    vector<string>  files;
+
+    DIR *pDir = opendir(dir.c_str());
+    if (NULL == pDir)
+    {
+        throw GsimError("Unable to open scenario directory " + dir);
+    }
+
+    struct dirent *pEnt = NULL;
+    while (NULL != (pEnt = readdir(pDir)))
+    {
+        string name = pEnt->d_name;
+        if (name.size() > 4 && name.substr(name.size() - 4) == ".xml")
+        {
+            files.push_back(name);
+        }
+    }
+    closedir(pDir);
+
+    vector<Scenario *> initScns;
+    vector<string>     initNames;
+    vector<Scenario *> waitScns;
+    vector<string>     waitNames;
+    for (U32 i = 0; i < files.size(); i++)
+    {
+        string    path = dir + "/" + files[i];
+        Scenario *pScn = new Scenario();
+        pScn->init(path.c_str());
+        if (SCN_TYPE_INITIATING == pScn->getScnType())
+        {
+            initScns.push_back(pScn);
+            initNames.push_back(files[i]);
+        }
+        else
+        {
+            waitScns.push_back(pScn);
+            waitNames.push_back(files[i]);
+        }
+    }
+
+    for (U32 i = 0; i < initScns.size(); i++)
+    {
+        Scenario *pWait = NULL;
+        string    waitName;
+        for (U32 j = 0; j < waitScns.size(); j++)
+        {
+            if (NULL != waitScns[j] &&
+                scnSuffix(initNames[i]) == scnSuffix(waitNames[j]))
+            {
+                pWait       = waitScns[j];
+                waitName    = waitNames[j];
+                waitScns[j] = NULL;
+                break;
+            }
+        }
+
+        if (NULL == pWait)
+        {
+            std::cout << "No waiting scenario for " << initNames[i]
+                      << ", skipped" << std::endl;
+            delete initScns[i];
+            continue;
+        }
+
+        ScnPair scnPair;
+        scnPair.name  = initNames[i] + " <-> " + waitName;
+        scnPair.pInit = initScns[i];
+        scnPair.pWait = pWait;
+        pairs.push_back(scnPair);
+    }
+
+    for (U32 j = 0; j < waitScns.size(); j++)
+    {
+        delete waitScns[j];
+    }
+
+    return pairs;
+}
+
+/**
+ * @brief
+ *    Runs the scenario pair until every session on both sides has either
+ *    completed or failed, or until maxSecs elapse
+ */
+PRIVATE VOID runScnPair(ScnPair &scnPair, U32 numSessions, U32 maxSecs)
+{
+    Config *pCfg = Config::getInstance();
+
+    IPEndPoint initEp;
+    initEp.ipAddr = pCfg->getRemoteIpAddr();
+    initEp.port   = BENCH_INIT_PORT;
+    IPEndPoint waitEp;
+    waitEp.ipAddr = pCfg->getRemoteIpAddr();
+    waitEp.port   = BENCH_WAIT_PORT;
+
+    /* messages are dispatched to the scenario of the receiving connection,
+     * the initiating side sends and receives on TRANS_CONN_ID_SEND and the
+     * waiting side on TRANS_CONN_ID_LISTEN
+     */
+    Scenario *scnByConn[2];
+    scnByConn[TRANS_CONN_ID_SEND]   = scnPair.pInit;
+    scnByConn[TRANS_CONN_ID_LISTEN] = scnPair.pWait;
+    if (NULL != s_pLoopback)
+    {
+        s_pLoopback->addEp(initEp);
+        s_pLoopback->addEp(waitEp);
+    }
+    addPeerData(waitEp);
+
+    Transport *pTrans  = getTransport();
+    Counter    numMsgs = 0;
+
+    Counter baseDone = Stats::getStats(GSIM_STAT_NUM_SESSIONS_SUCC) +
+                       Stats::getStats(GSIM_STAT_NUM_SESSIONS_FAIL);
+    Counter baseSucc   = Stats::getStats(GSIM_STAT_NUM_SESSIONS_SUCC);
+    Counter baseAllocs = benchNumAllocs();
+    U64     start      = getNanoSeconds();
+    U64     deadline   = start + (U64)maxSecs * 1000000000ULL;
+
+    new TrafficTask(scnPair.pInit);
+
+    U64 now = start;
+    for (;;)
+    {
+        getMilliSeconds();
+        TaskMgr::resumePausedTasks();
+        TaskMgr::runTasks();
+
+        U32 cnt = 0;
+        do
+        {
+            cnt = pTrans->recv(s_recvMsgs, TRANS_MAX_BATCH);
+            for (U32 i = 0; i < cnt; i++)
+            {
+                procGtpcMsg(s_recvMsgs[i], scnByConn[s_recvMsgs[i]->connId]);
+            }
+            numMsgs += cnt;
+        } while (cnt == TRANS_MAX_BATCH);
+
+        Counter done = Stats::getStats(GSIM_STAT_NUM_SESSIONS_SUCC) +
+                       Stats::getStats(GSIM_STAT_NUM_SESSIONS_FAIL);
+        now = getNanoSeconds();
+        if (done - baseDone >= 2 * (Counter)numSessions || now >= deadline)
+        {
+            break;
+        }
+    }
+
+    Counter numAllocs = benchNumAllocs() - baseAllocs;
+    Counter numSucc   = Stats::getStats(GSIM_STAT_NUM_SESSIONS_SUCC) - baseSucc;
+    double  secs      = (double)(now - start) / 1e9;
+
+    std::cout << std::left << std::setw(28) << scnPair.name << std::right
+              << std::setw(10) << numSucc / 2 << std::setw(14) << std::fixed
+              << std::setprecision(0) << (numSucc / 2) / secs << std::setw(10)
+              << (numMsgs ? (double)(now - start) / numMsgs : 0.0)
+              << std::setw(16) << std::setprecision(1)
+              << (double)numAllocs / numSessions << std::endl;
+
+    TaskMgr::deleteAllTasks();
+    deletePeerTable();
+    if (NULL != s_pLoopback)
+    {
+        s_pLoopback->reset();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        cxxopts::Options options(argv[0], "GTP Simulator loopback benchmark");
+
+        // clang-format off
+        options.add_options()
+            ("scenario-dir", "Directory with the scenario files",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("num-sessions", "Number of sessions per scenario pair",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("session-rate", "Sessions created per millisecond",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("max-time", "Time limit per scenario pair in seconds",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("transport", "loopback (default), udp, io_uring or packet",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("sqpoll-idle", "io_uring SQPOLL idle time in milli seconds",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("log-file", "Log file, none by default",
+             cxxopts::value<std::string>());
+        options.add_options()
+             ("help", "Print help and exit");
+        // clang-format on
+
+        auto results = options.parse(argc, argv);
+        if (results.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            exit(0);
+        }
+
+        string scnDir      = BENCH_DFLT_SCN_DIR;
+        string logFile     = BENCH_DFLT_LOG_FILE;
+        U32    numSessions = BENCH_DFLT_NUM_SESSIONS;
+        U32    rate        = BENCH_DFLT_SESSION_RATE;
+        U32    maxSecs     = BENCH_DFLT_MAX_TIME;
+        string transport   = BENCH_DFLT_TRANSPORT;
+        if (results.count("scenario-dir"))
+        {
+            scnDir = results["scenario-dir"].as<std::string>();
+        }
+
+        if (results.count("log-file"))
+        {
+            logFile = results["log-file"].as<std::string>();
+        }
+
+        if (results.count("num-sessions"))
+        {
+            numSessions = results["num-sessions"].as<std::uint32_t>();
+        }
+
+        if (results.count("session-rate"))
+        {
+            rate = results["session-rate"].as<std::uint32_t>();
+        }
+
+        if (results.count("max-time"))
+        {
+            maxSecs = results["max-time"].as<std::uint32_t>();
+        }
+
+        if (results.count("transport"))
+        {
+            transport = results["transport"].as<std::string>();
+        }
+
+        Config *pCfg = Config::getInstance();
+        pCfg->setLogFile(logFile);
+        pCfg->setRemoteIpAddr(DFLT_LOCAL_IP_ADDR);
+        pCfg->setRemoteGtpcPort(BENCH_WAIT_PORT);
+        pCfg->setLocalGtpcPort(BENCH_WAIT_PORT);
+        pCfg->setCallRate(rate);
+        pCfg->setRatePeriod(1);
+        pCfg->setNoOfCalls(numSessions);
+        Logger::init(LOG_LVL_FATAL);
+
+        if (BENCH_DFLT_TRANSPORT == transport)
+        {
+            s_pLoopback = new LoopbackTransport();
+            setTransport(s_pLoopback);
+        }
+        else
+        {
+            /* both sides share the kernel transport, the waiting side
+             * listens on the local port the initiating side sends to
+             */
+            pCfg->setTransportType(transport);
+            if (results.count("sqpoll-idle"))
+            {
+                pCfg->setSqPollIdle(results["sqpoll-idle"].as<std::uint32_t>());
+            }
+
+            if (ROK != initTransport())
+            {
+                throw GsimError("Initializing transport " + transport);
+            }
+        }
+
+        std::cout << "Transport: " << getTransport()->name() << std::endl;
+
+        /* memory held by a session with one PDN connection and two
+         * bearers using user plane TEIDs
+         */
+        std::cout << "Session: " << sizeof(UeSession) + sizeof(GtpcPdn) +
+                     sizeof(GtpcTun) + 2 * sizeof(GtpuTun)
+                  << " bytes/session (UeSession " << sizeof(UeSession)
+                  << ", GtpcPdn " << sizeof(GtpcPdn) << ", GtpcTun "
+                  << sizeof(GtpcTun) << ", GtpuTun " << sizeof(GtpuTun)
+                  << ")" << std::endl;
+
+        vector<ScnPair> pairs = loadScnPairs(scnDir);
+
+        std::cout << std::left << std::setw(28) << "Scenario Pair"
+                  << std::right << std::setw(10) << "Sessions" << std::setw(14)
+                  << "Setups/s" << std::setw(10) << "ns/msg" << std::setw(16)
+                  << "Allocs/session" << std::endl;
+
+        for (U32 i = 0; i < pairs.size(); i++)
+        {
+            runScnPair(pairs[i], numSessions, maxSecs);
+            delete pairs[i].pInit;
+            delete pairs[i].pWait;
+        }
+
+        closeTransport();
+        delete pCfg;
+    }
+    catch (ErrCodeEn e)
+    {
+        std::cout << "Error: " << e << std::endl;
+        exit(e);
+    }
+    catch (GsimError &e)
+    {
+        std::cout << e.what() << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include "types.hpp"
+#include "macros.hpp"
+#include "logger.hpp"
+#include "error.hpp"
+#include "gtp_types.hpp"
+#include "transport.hpp"
+#include "loopback.hpp"
+
+PRIVATE BOOL isSameEp(const IPEndPoint *pA, const IPEndPoint *pB)
+{
+    if (pA->port != pB->port ||
+        pA->ipAddr.ipAddrType != pB->ipAddr.ipAddrType)
+    {
+        return FALSE;
+    }
+
+    if (IP_ADDR_TYPE_V4 == pA->ipAddr.ipAddrType)
+    {
+        return (pA->ipAddr.u.ipv4Addr.addr == pB->ipAddr.u.ipv4Addr.addr);
+    }
+
+    return (pA->ipAddr.u.ipv6Addr.len == pB->ipAddr.u.ipv6Addr.len &&
+            0 == MEMCMP(pA->ipAddr.u.ipv6Addr.addr,
+                     pB->ipAddr.u.ipv6Addr.addr, pA->ipAddr.u.ipv6Addr.len));
+}
+
+LoopbackTransport::LoopbackTransport()
+{
+    m_rxHead = 0;
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+    reset();
+}
+
+TransConnId LoopbackTransport::addEp(IPEndPoint ep)
+{
+    m_eps.push_back(ep);
+    return (TransConnId)(m_eps.size() - 1);
+}
+
+VOID LoopbackTransport::reset()
+{
+    for (U32 i = m_rxHead; i < m_rxQ.size(); i++)
+    {
+        delete m_rxQ[i];
+    }
+
+    m_rxQ.clear();
+    m_eps.clear();
+    m_rxHead = 0;
+}
+
+RETVAL LoopbackTransport::init()
+{
+    return ROK;
+}
+
+/**
+ * @brief
+ *    Queues the buffers for the endpoints matching the destinations, the
+ *    buffer contents are handed over to the receiver without a copy
+ */
+U32 LoopbackTransport::send(TransMsg_t *pMsgs, U32 cnt)
+{
+    LOG_ENTERFN();
+
+    U32 numSent = 0;
+    for (U32 i = 0; i < cnt; i++)
+    {
+        TransMsg_t *pMsg = &pMsgs[i];
+        for (U32 j = 0; pMsg->connId < m_eps.size() && j < m_eps.size(); j++)
+        {
+            if (isSameEp(&m_eps[j], pMsg->pDst))
+            {
+                UdpData_t *pData = new UdpData_t;
+                pData->buf.len   = pMsg->pBuf->len;
+                pData->buf.pVal  = pMsg->pBuf->pVal;
+                pData->connId    = (TransConnId)j;
+                pData->peerEp    = m_eps[pMsg->connId];
+                pMsg->pBuf->pVal = NULL;
+
+                m_rxQ.push_back(pData);
+                numSent++;
+                break;
+            }
+        }
+
+        delete pMsg->pBuf;
+    }
+
+    LOG_EXITFN(numSent);
+}
+
+U32 LoopbackTransport::recv(UdpData_t **ppMsgs, U32 max)
+{
+    U32 cnt = 0;
+    while (cnt < max && m_rxHead < m_rxQ.size())
+    {
+        ppMsgs[cnt++] = m_rxQ[m_rxHead++];
+    }
+
+    if (m_rxHead == m_rxQ.size())
+    {
+        m_rxQ.clear();
+        m_rxHead = 0;
+    }
+
+    return cnt;
+}
+
+S32 LoopbackTransport::readyFd()
+{
+    return -1;
+}
+
+U32 LoopbackTransport::capabilities()
+{
+    return TRANS_CAP_BATCH_SEND | TRANS_CAP_BATCH_RECV;
+}
+
+const S8 *LoopbackTransport::name()
+{
+    return "loopback";
+}
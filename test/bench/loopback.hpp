@@ -0,0 +1,62 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LOOPBACK_HPP_
+#define _LOOPBACK_HPP_
+
+#include <vector>
+
+/**
+ * @brief
+ *    In-memory datagram channel used in place of the UDP sockets. sendMsg()
+ *    queues the buffer for the endpoint whose address matches the
+ *    destination and recv() returns the queued messages in order, tagged
+ *    with the connection id of the receiving endpoint
+ */
+class LoopbackTransport: public Transport
+{
+   public:
+      LoopbackTransport();
+      ~LoopbackTransport();
+
+      /**
+       * @brief
+       *    Adds an endpoint to the channel. The first endpoint added gets
+       *    connection id TRANS_CONN_ID_SEND, the one sessions of an
+       *    initiating scenario send on
+       */
+      TransConnId addEp(IPEndPoint ep);
+
+      /**
+       * @brief
+       *    Removes all endpoints and drops any message still queued
+       */
+      VOID        reset();
+
+      RETVAL      init();
+      U32         send(TransMsg_t *pMsgs, U32 cnt);
+      U32         recv(UdpData_t **ppMsgs, U32 max);
+      S32         readyFd();
+      U32         capabilities();
+      const S8    *name();
+
+   private:
+      std::vector<IPEndPoint>    m_eps;
+      std::vector<UdpData_t *>   m_rxQ;
+      U32                        m_rxHead;
+};
+
+#endif
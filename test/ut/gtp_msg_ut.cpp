@@ -0,0 +1,270 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <string.h>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "gtp_macro.hpp"
+#include "task.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "scenario.hpp"
+#include "gtp_stats.hpp"
+#include "validate.hpp"
+#include "store.hpp"
+
+/* Cause IE of a Create Session Response, request accepted */
+static U8 s_causeIe[] = {GTP_IE_CAUSE, 0x00, 0x02, 0x00, 0x10, 0x00};
+
+/* Recovery and Cause IEs, the Cause ends the message */
+static U8 s_rspIes[] = {GTP_IE_RECOVERY, 0x00, 0x01, 0x00, 0x05,
+                        GTP_IE_CAUSE, 0x00, 0x02, 0x00, 0x10, 0x00};
+
+/* a zero length Cause IE left past the message by an earlier one */
+static U8 s_staleCause[] = {GTP_IE_CAUSE, 0x00, 0x00, 0x00};
+
+static U32 s_numInvalid = 0;
+
+/* validation counts the invalid messages, the rest of the statistics are
+ * not linked in
+ */
+VOID Stats::incStats(GtpStat_t statsType)
+{
+   if (GSIM_STAT_NUM_INVALID == statsType)
+   {
+      s_numInvalid++;
+   }
+}
+
+/* Encodes a Create Session Response of the encoded IEs into a received
+ * buffer, without the TEID the header is 4 octets shorter and so is the
+ * message length
+ */
+static VOID encodeCsRsp(Buffer *pRxBuf, U8 *pIes, U32 iesLen, BOOL teid)
+{
+   U8       buf[GTP_MSG_BUF_LEN];
+   GtpIeLst ieLst;
+   GtpIeHdr ieHdr;
+
+   for (U32 offset = 0; offset < iesLen;
+         offset += ieHdr.len + GTP_IE_HDR_LEN)
+   {
+      decIeHdr(pIes + offset, &ieHdr);
+      GtpIe *pIe = GtpIe::createGtpIe(ieHdr.ieType, ieHdr.instance);
+      pIe->decode(pIes + offset);
+      ieLst.push_back(pIe);
+   }
+
+   GtpMsg   msg(GTPC_MSG_CS_RSP);
+   msg.encode(&ieLst);
+
+   U32 len = 0;
+   MEMSET(buf, 0, GTP_MSG_BUF_LEN);
+   msg.encode(buf, &len);
+
+   if (!teid)
+   {
+      buf[0] &= ~GTP_MSG_T_BIT_PRES;
+      memmove(buf + GTPC_HDR_MAND_LEN, buf + GTP_MSG_HDR_LEN_WITHOUT_TEID,
+            len - GTP_MSG_HDR_LEN_WITHOUT_TEID);
+      len -= GTP_TEID_LEN;
+
+      U8 *pLen = buf + 2;
+      GTP_ENC_LEN(pLen, len - GTPC_HDR_MAND_LEN);
+   }
+
+   BUFFER_CPY(pRxBuf, buf, len);
+}
+
+TEST(gtpMsgTest, IeBufWithTeid)
+{
+   Buffer rxBuf;
+   encodeCsRsp(&rxBuf, s_causeIe, sizeof(s_causeIe), TRUE);
+
+   GtpMsg msg(&rxBuf);
+   U32    len = 0;
+   U8     *pIeBuf = msg.getIeBuf(&len);
+
+   EXPECT_EQ((U32)(GTP_MSG_HDR_LEN + sizeof(s_causeIe)), rxBuf.len);
+   EXPECT_EQ((U32)sizeof(s_causeIe), len);
+   EXPECT_EQ(0, memcmp(pIeBuf, s_causeIe, sizeof(s_causeIe)));
+   EXPECT_EQ(GTP_CAUSE_REQ_ACCEPTED, msg.getCause());
+}
+
+TEST(gtpMsgTest, IeBufWithoutTeid)
+{
+   Buffer rxBuf;
+   encodeCsRsp(&rxBuf, s_causeIe, sizeof(s_causeIe), FALSE);
+
+   GtpMsg msg(&rxBuf);
+   U32    len = 0;
+   U8     *pIeBuf = msg.getIeBuf(&len);
+
+   EXPECT_EQ((U32)(GTP_MSG_HDR_LEN_WITHOUT_TEID + sizeof(s_causeIe)),
+         rxBuf.len);
+   EXPECT_EQ((U32)sizeof(s_causeIe), len);
+   EXPECT_EQ(0, memcmp(pIeBuf, s_causeIe, sizeof(s_causeIe)));
+   EXPECT_EQ(GTP_CAUSE_REQ_ACCEPTED, msg.getCause());
+}
+
+TEST(gtpMsgTest, IeBufIgnoresStaleOctets)
+{
+   Buffer rxBuf;
+   encodeCsRsp(&rxBuf, s_causeIe, sizeof(s_causeIe), TRUE);
+
+   GtpMsg msg(&rxBuf);
+   U32    len = 0;
+   U8     *pIeBuf = msg.getIeBuf(&len);
+
+   MEMCPY(pIeBuf + sizeof(s_causeIe), s_staleCause, sizeof(s_staleCause));
+
+   EXPECT_TRUE(NULL != msg.getIeBufPtr(GTP_IE_CAUSE, 0, 1));
+   EXPECT_TRUE(NULL == msg.getIeBufPtr(GTP_IE_CAUSE, 0, 2));
+}
+
+/* Each rule passes on the IEs of the message and fails if the stale Cause
+ * past the last IE is walked as a second Cause
+ */
+TEST(validateTest, LastIeEndsMessage)
+{
+   Buffer rxBuf;
+   encodeCsRsp(&rxBuf, s_rspIes, sizeof(s_rspIes), TRUE);
+
+   GtpMsg msg(&rxBuf);
+   U32    len = 0;
+   U8     *pIeBuf = msg.getIeBuf(&len);
+
+   msg.decode();
+   EXPECT_EQ((U32)sizeof(s_rspIes), len);
+   MEMCPY(pIeBuf + sizeof(s_rspIes), s_staleCause, sizeof(s_staleCause));
+
+   ValidateRules rules;
+   VldRule_t     rule;
+   MEMSET(&rule, 0, sizeof(rule));
+   rule.ieType = GTP_IE_CAUSE;
+
+   rule.type = VLD_RULE_COUNT;
+   rule.min  = 1;
+   rule.max  = 1;
+   EXPECT_EQ(ROK, rules.addRule(&rule));
+
+   rule.type = VLD_RULE_VALUE;
+   rule.len  = 1;
+   rule.mask = 0xff;
+   rule.min  = GTP_CAUSE_REQ_ACCEPTED;
+   rule.max  = GTP_CAUSE_REQ_ACCEPTED;
+   EXPECT_EQ(ROK, rules.addRule(&rule));
+
+   rule.type   = VLD_RULE_PRESENT;
+   rule.ieType = GTP_IE_RECOVERY;
+   EXPECT_EQ(ROK, rules.addRule(&rule));
+
+   s_numInvalid = 0;
+   EXPECT_TRUE(rules.validate(&msg));
+   EXPECT_EQ(0U, s_numInvalid);
+   for (U32 i = 0; i < rules.numRules(); i++)
+   {
+      EXPECT_EQ(0U, rules.rule(i)->numFail);
+   }
+}
+
+/* Rules storing the Cause, the last IE of the message, the Recovery and a
+ * second Cause the message does not have into the first three variables
+ */
+static VOID addStoreRules(StoreRules *pRules)
+{
+   VarRule_t rule;
+   MEMSET(&rule, 0, sizeof(rule));
+   rule.grpType = GTP_IE_MAX;
+
+   rule.ieType = GTP_IE_CAUSE;
+   rule.occr   = 1;
+   rule.var    = 0;
+   EXPECT_EQ(ROK, pRules->addRule(&rule));
+
+   rule.ieType = GTP_IE_RECOVERY;
+   rule.var    = 1;
+   EXPECT_EQ(ROK, pRules->addRule(&rule));
+
+   rule.ieType = GTP_IE_CAUSE;
+   rule.occr   = 2;
+   rule.var    = 2;
+   EXPECT_EQ(ROK, pRules->addRule(&rule));
+}
+
+TEST(storeTest, LastIeEndsMessage)
+{
+   Buffer rxBuf;
+   encodeCsRsp(&rxBuf, s_rspIes, sizeof(s_rspIes), TRUE);
+
+   GtpMsg msg(&rxBuf);
+   U32    len = 0;
+   U8     *pIeBuf = msg.getIeBuf(&len);
+
+   MEMCPY(pIeBuf + sizeof(s_rspIes), s_staleCause, sizeof(s_staleCause));
+
+   StoreRules  rules;
+   GtpSsnVar_t vars[GTP_MAX_SSN_VARS];
+   MEMSET(vars, 0, sizeof(vars));
+   addStoreRules(&rules);
+   rules.store(&msg, vars);
+
+   EXPECT_EQ(2, vars[0].len);
+   EXPECT_EQ(0, memcmp(vars[0].val, s_causeIe + GTP_IE_HDR_LEN, 2));
+   EXPECT_EQ(1, vars[1].len);
+   EXPECT_EQ(0x05, vars[1].val[0]);
+   EXPECT_EQ(0, vars[2].len);
+}
+
+TEST(storeTest, HeaderLongerThanMessage)
+{
+   Buffer rxBuf;
+   encodeCsRsp(&rxBuf, s_rspIes, sizeof(s_rspIes), TRUE);
+
+   /* a Cause IE with a value left past the message, which the header
+    * claims
+    */
+   U8 stale[] = {GTP_IE_CAUSE, 0x00, 0x01, 0x00, 0x41};
+   U8 *pLen   = rxBuf.pVal + 2;
+   GTP_ENC_LEN(pLen, rxBuf.len - GTPC_HDR_MAND_LEN + sizeof(stale));
+
+   GtpMsg msg(&rxBuf);
+   U32    len = 0;
+   U8     *pIeBuf = msg.getIeBuf(&len);
+
+   EXPECT_EQ((U32)sizeof(s_rspIes), len);
+   MEMCPY(pIeBuf + sizeof(s_rspIes), stale, sizeof(stale));
+
+   StoreRules  rules;
+   GtpSsnVar_t vars[GTP_MAX_SSN_VARS];
+   MEMSET(vars, 0, sizeof(vars));
+   addStoreRules(&rules);
+   rules.store(&msg, vars);
+
+   EXPECT_EQ(2, vars[0].len);
+   EXPECT_EQ(0, vars[2].len);
+}
@@ -0,0 +1,77 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <list>
+#include <vector>
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <iostream>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "types.hpp"
+#include "error.hpp"
+#include "logger.hpp"
+#include "macros.hpp"
+#include "gtp_macro.hpp"
+#include "task.hpp"
+#include "gtp_types.hpp"
+#include "gtp_util.hpp"
+#include "gtp_if.hpp"
+#include "gtp_ie.hpp"
+#include "gtp_msg.hpp"
+#include "procedure.hpp"
+#include "scenario.hpp"
+#include "tunnel.hpp"
+#include "session.hpp"
+#include "tombstone.hpp"
+
+/* Upper bounds on the per session memory. A session with one PDN
+ * connection and two bearers costs a UeSession, a GtpcPdn and a GtpcTun,
+ * plus a GtpuTun for every bearer whose user plane TEID is used
+ */
+#define UT_MAX_UE_SESSION_SIZE      384
+#define UT_MAX_BEARER_SIZE          16
+#define UT_MAX_PROC_CACHE_SIZE      24
+#define UT_MAX_PDN_SIZE             32
+#define UT_MAX_TOMBSTONE_SIZE       64
+#define UT_MAX_BYTES_PER_SESSION    520
+
+TEST(sessionLayoutTest, SizeBounds)
+{
+   EXPECT_LE(sizeof(GtpBearer), (size_t)UT_MAX_BEARER_SIZE);
+   EXPECT_LE(sizeof(ProcCache_t), (size_t)UT_MAX_PROC_CACHE_SIZE);
+   EXPECT_LE(sizeof(GtpcPdn), (size_t)UT_MAX_PDN_SIZE);
+   EXPECT_LE(sizeof(UeSession), (size_t)UT_MAX_UE_SESSION_SIZE);
+   EXPECT_LE(sizeof(Tombstone), (size_t)UT_MAX_TOMBSTONE_SIZE);
+}
+
+TEST(sessionLayoutTest, BytesPerSession)
+{
+   size_t bytes = sizeof(UeSession) + sizeof(GtpcPdn) + sizeof(GtpcTun) + \
+         2 * sizeof(GtpuTun);
+
+   std::cout << "UeSession " << sizeof(UeSession) << " bytes, GtpcPdn "
+         << sizeof(GtpcPdn) << ", GtpcTun " << sizeof(GtpcTun)
+         << ", GtpBearer " << sizeof(GtpBearer) << ", GtpuTun "
+         << sizeof(GtpuTun) << ", Tombstone " << sizeof(Tombstone)
+         << std::endl;
+   std::cout << "Bytes per session (1 PDN, 2 bearers): " << bytes
+         << std::endl;
+
+   EXPECT_LE(bytes, (size_t)UT_MAX_BYTES_PER_SESSION);
+}
@@ -0,0 +1,253 @@
+/*  Copyright (C) 2013  Nithin Nellikunnu, nithin.nn@gmail.com
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @brief
+ *    gsim-stat, reads the statistics segment published by gsim --stats-shm.
+ *    The segment is mapped read-only and copied under its sequence counter,
+ *    the simulator is never blocked or signalled by the reader
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cxxopts.hpp"
+
+#include "types.hpp"
+#include "error.hpp"
+#include "macros.hpp"
+#include "task.hpp"
+#include "latency.hpp"
+#include "stats_shm.hpp"
+
+using std::string;
+using std::vector;
+
+#define STAT_DFLT_NAME        "/gsim"
+
+PRIVATE VOID printTable(const StatsShmHdr_t *pHdr)
+{
+    const U8 *pBase = (const U8 *)pHdr;
+
+    std::cout << "gsim " << pHdr->pid << " (" << pHdr->node << "), update "
+              << pHdr->numUpdates << " at " << pHdr->updateTime << "ms"
+              << std::endl;
+
+    const StatsShmCounter_t *pCounter =
+        (const StatsShmCounter_t *)(pBase + pHdr->counterOff);
+    for (U32 i = 0; i < pHdr->numCounters; i++)
+    {
+        std::cout << std::left << std::setw(STATS_SHM_NAME_LEN)
+                  << pCounter[i].name << pCounter[i].value << std::endl;
+    }
+
+    if (0 != pHdr->numJobs)
+    {
+        std::cout << std::endl << std::left
+                  << std::setw(STATS_SHM_NAME_LEN) << "Message"
+                  << "Send      Recv      Snd-Retr  Rcv-Retr  Timeout   "
+                     "Unexpected  Rejected" << std::endl;
+    }
+
+    const StatsShmJob_t *pJob = (const StatsShmJob_t *)(pBase + pHdr->jobOff);
+    for (U32 i = 0; i < pHdr->numJobs; i++)
+    {
+        std::cout << std::left << std::setw(STATS_SHM_NAME_LEN)
+                  << pJob[i].name << std::setw(10) << pJob[i].numSnd
+                  << std::setw(10) << pJob[i].numRcv << std::setw(10)
+                  << pJob[i].numSndRetrans << std::setw(10)
+                  << pJob[i].numRcvRetrans << std::setw(10)
+                  << pJob[i].numTimeOut << std::setw(12) << pJob[i].numUnexp
+                  << pJob[i].numRejected << std::endl;
+    }
+
+    std::cout << std::endl;
+    const StatsShmHist_t *pHist =
+        (const StatsShmHist_t *)(pBase + pHdr->histOff);
+    for (U32 i = 0; i < pHdr->numHists; i++)
+    {
+        LatencyHist hist(pHist[i].name);
+        hist.merge(&pHist[i].data);
+        std::cout << std::left << std::setw(STATS_SHM_NAME_LEN)
+                  << pHist[i].name << hist.count() << " samples, p50 "
+                  << hist.percentile(50) / 1000 << "us, p99 "
+                  << hist.percentile(99) / 1000 << "us, max "
+                  << hist.max() / 1000 << "us" << std::endl;
+    }
+}
+
+PRIVATE VOID printJson(const StatsShmHdr_t *pHdr)
+{
+    const U8 *pBase = (const U8 *)pHdr;
+
+    std::cout << "{\"pid\": " << pHdr->pid << ", \"node\": \"" << pHdr->node
+              << "\", \"updates\": " << pHdr->numUpdates
+              << ", \"update_ms\": " << pHdr->updateTime << ",\n"
+              << " \"counters\": {";
+
+    const StatsShmCounter_t *pCounter =
+        (const StatsShmCounter_t *)(pBase + pHdr->counterOff);
+    for (U32 i = 0; i < pHdr->numCounters; i++)
+    {
+        std::cout << (i ? ", " : "") << "\"" << pCounter[i].name << "\": "
+                  << pCounter[i].value;
+    }
+
+    std::cout << "},\n \"jobs\": [";
+    const StatsShmJob_t *pJob = (const StatsShmJob_t *)(pBase + pHdr->jobOff);
+    for (U32 i = 0; i < pHdr->numJobs; i++)
+    {
+        std::cout << (i ? ",\n   " : "\n   ") << "{\"name\": \""
+                  << pJob[i].name << "\", \"send\": " << pJob[i].numSnd
+                  << ", \"recv\": " << pJob[i].numRcv
+                  << ", \"send_retrans\": " << pJob[i].numSndRetrans
+                  << ", \"recv_retrans\": " << pJob[i].numRcvRetrans
+                  << ", \"timeout\": " << pJob[i].numTimeOut
+                  << ", \"unexpected\": " << pJob[i].numUnexp
+                  << ", \"rejected\": " << pJob[i].numRejected << "}";
+    }
+
+    std::cout << "],\n \"histograms\": {";
+    const StatsShmHist_t *pHist =
+        (const StatsShmHist_t *)(pBase + pHdr->histOff);
+    for (U32 i = 0; i < pHdr->numHists; i++)
+    {
+        LatencyHist hist(pHist[i].name);
+        hist.merge(&pHist[i].data);
+        std::cout << (i ? ", " : "") << "\"" << pHist[i].name
+                  << "\": {\"count\": " << hist.count() << ", \"p50_ns\": "
+                  << hist.percentile(50) << ", \"p99_ns\": "
+                  << hist.percentile(99) << ", \"max_ns\": " << hist.max()
+                  << "}";
+    }
+
+    std::cout << "}}" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        cxxopts::Options options(argv[0], "GTP Simulator statistics reader");
+
+        // clang-format off
+        options.add_options()
+            ("name", "Segment given to gsim --stats-shm, /gsim (default)",
+             cxxopts::value<std::string>());
+        options.add_options()
+            ("interval", "Milliseconds between reads, 0 (default) reads once",
+             cxxopts::value<std::uint32_t>());
+        options.add_options()
+            ("json", "Print the statistics as JSON");
+        options.add_options()
+             ("help", "Print help and exit");
+        // clang-format on
+
+        auto results = options.parse(argc, argv);
+        if (results.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            exit(0);
+        }
+
+        string name  = STAT_DFLT_NAME;
+        U32    intvl = 0;
+        if (results.count("name"))
+        {
+            name = results["name"].as<std::string>();
+            if ('/' != name[0])
+            {
+                name = "/" + name;
+            }
+        }
+
+        if (results.count("interval"))
+        {
+            intvl = results["interval"].as<std::uint32_t>();
+        }
+
+        S32 fd = shm_open(name.c_str(), O_RDONLY, 0);
+        struct stat st;
+        if (fd < 0 || 0 != fstat(fd, &st) ||
+            (U64)st.st_size < sizeof(StatsShmHdr_t))
+        {
+            throw GsimError("No statistics segment " + name);
+        }
+
+        VOID *pMap = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (MAP_FAILED == pMap)
+        {
+            throw GsimError("Unable to map the statistics segment " + name);
+        }
+
+        const StatsShmHdr_t *pHdr = (const StatsShmHdr_t *)pMap;
+        if (STATS_SHM_MAGIC != __atomic_load_n(&pHdr->magic, __ATOMIC_ACQUIRE)
+            || STATS_SHM_VERSION != pHdr->version ||
+            pHdr->size > (U64)st.st_size)
+        {
+            throw GsimError("Invalid statistics segment " + name);
+        }
+
+        vector<U8> copy(pHdr->size);
+        for (;;)
+        {
+            if (ROK != readStatsShm(pMap, &copy[0], copy.size()))
+            {
+                throw GsimError("Statistics segment " + name + " is busy");
+            }
+
+            if (results.count("json"))
+            {
+                printJson((const StatsShmHdr_t *)&copy[0]);
+            }
+            else
+            {
+                printTable((const StatsShmHdr_t *)&copy[0]);
+            }
+
+            if (0 == intvl)
+            {
+                break;
+            }
+
+            std::cout << std::endl;
+            usleep(intvl * 1000);
+        }
+
+        munmap(pMap, st.st_size);
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cout << "error parsing options: " << e.what() << std::endl;
+        exit(1);
+    }
+    catch (GsimError &e)
+    {
+        std::cout << e.what() << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}